@@ -50,7 +50,9 @@ _complete_rethinkdb_admin() {
 
 _complete_rethinkdb() {
     local io_backend=("--io-backend")
-    local io_backends=("native" "pool")
+    local io_backends=("pool" "uring")
+    local cluster_compression=("--cluster-compression")
+    local cluster_compressions=("none" "deflate")
     local format_args=("--format")
     local formats=("csv" "json")
     local commands=("create" "help" "serve" "admin" "proxy" "import")
@@ -59,8 +61,8 @@ _complete_rethinkdb() {
     local numb_args=("-c" "--cores" "--client-port" "--cluster-port" "--driver-port" "-o" "--port-offset" "--http-port" "--clients")
     local help_tokens=("create" "serve" "admin" "proxy" "export" "import" "dump" "restore")
     local create_tokens=("-d" "--directory" "-n" "--machine-name" "--io-backend")
-    local serve_tokens=("-d" "--directory" "--cluster-port" "--driver-port" "-o" "--port-offset" "-j" "--join" "--http-port" "-c" "--cores" "--pid-file" "--io-backend")
-    local proxy_tokens=("--log-file" "--cluster-port" "--driver-port" "-o" "--port-offset" "-j" "--join" "--http-port" "--pid-file" "--io-backend")
+    local serve_tokens=("-d" "--directory" "--cluster-port" "--driver-port" "-o" "--port-offset" "-j" "--join" "--http-port" "-c" "--cores" "--pid-file" "--io-backend" "--cluster-compression")
+    local proxy_tokens=("--log-file" "--cluster-port" "--driver-port" "-o" "--port-offset" "-j" "--join" "--http-port" "--pid-file" "--cluster-compression")
     local export_tokens=("-c" "--connect" "-a" "--auth" "-d" "--directory" "-e" "--export" "--format" "--fields")
     local import_tokens=("-c" "--connect" "-a" "--auth" "-d" "--directory" "-i" "--import" "-f" "--file" "--format" "--table" "--pkey" "--clients" "--force")
     local dump_tokens=("-c" "--connect" "-a" "--auth" "-e" "--export" "-f" "--file")
@@ -99,6 +101,12 @@ _complete_rethinkdb() {
             return
         fi
 
+        if _rethinkdb_value_in_array "$prev" "${cluster_compression[@]}"; then
+            use="${cluster_compressions[@]}"
+            COMPREPLY=( $( compgen -W "$use" -- "$cur" ) )
+            return
+        fi
+
         if _rethinkdb_value_in_array "$prev" "${format_args[@]}"; then
             use="${formats[@]}"
             COMPREPLY=( $( compgen -W "$use" -- "$cur" ) )
@@ -53,6 +53,8 @@ def generate_async_message_template(nargs):
     print "        }"
     print "    };"
     print
+    print "    class local_message_impl_t;"
+    print
     print "    class read_impl_t : public mailbox_read_callback_t {"
     print "    public:"
     print "        explicit read_impl_t(%s *_parent) : parent(_parent) { }" % mailbox_t_str
@@ -68,9 +70,31 @@ def generate_async_message_template(nargs):
     print "            parent->fun(%s);" % csep("std::move(arg#)")
     print "        }"
     print "    private:"
+    print "        friend class local_message_impl_t;"
     print "        %s *parent;" % mailbox_t_str
     print "    };"
     print
+    print "    class local_message_impl_t : public mailbox_local_message_t {"
+    print "    public:"
+    if nargs == 0:
+        print "        local_message_impl_t() { }"
+    else:
+        if nargs == 1:
+            print "        explicit local_message_impl_t(%s) :" % csep("const arg#_t &_arg#")
+        else:
+            print "        local_message_impl_t(%s) :" % csep("const arg#_t &_arg#")
+        print "            %s" % csep("arg#(_arg#)")
+        print "        { }"
+    print "        void deliver(mailbox_read_callback_t *callback) {"
+    print "            read_impl_t *reader = static_cast<read_impl_t *>(callback);"
+    print "            reader->parent->fun(%s);" % csep("std::move(arg#)")
+    print "        }"
+    if nargs > 0:
+        print "    private:"
+        for i in xrange(nargs):
+            print "        arg%d_t arg%d;" % (i, i)
+    print "    };"
+    print
     print "    read_impl_t reader;"
     print
     print "public:"
@@ -107,6 +131,19 @@ def generate_async_message_template(nargs):
     print "          %s %s::address_t dest%s) {" % (("typename" if nargs > 0 else ""),
                                                     mailbox_t_str,
                                                     cpre("const arg#_t &arg#"))
+    if nargs == 0:
+        print "    if (is_local_mailbox(src, dest.addr)) {"
+    else:
+        print "    if (%s" % " &&\n        ".join(
+            ["mailbox_local_safe_t<arg%d_t>::value" % i for i in xrange(nargs)]
+            + ["is_local_mailbox(src, dest.addr)) {"])
+    print "        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>("
+    if nargs == 0:
+        print "            new %s::local_message_impl_t()));" % mailbox_t_str
+    else:
+        print "            new typename %s::local_message_impl_t(%s)));" % (mailbox_t_str, csep("arg#"))
+    print "        return;"
+    print "    }"
     if nargs == 0:
         print "    %s::write_impl_t writer;" % mailbox_t_str
     else:
@@ -142,6 +179,11 @@ if __name__ == "__main__":
     print "    }"
     print "    bool is_nil() const { return addr.is_nil(); }"
     print "    peer_id_t get_peer() const { return addr.get_peer(); }"
+    print "    mailbox_addr_t<T> with_traffic_class(traffic_class_t traffic_class) const {"
+    print "        mailbox_addr_t<T> a;"
+    print "        a.addr = addr.with_traffic_class(traffic_class);"
+    print "        return a;"
+    print "    }"
     print
     print "    friend class mailbox_t<T>;"
     print
@@ -159,6 +201,9 @@ if __name__ == "__main__":
     print "};"
     print
     print "RDB_SERIALIZE_TEMPLATED_OUTSIDE(mailbox_addr_t);"
+    print
+    print "template <class T>"
+    print "struct mailbox_local_safe_t<mailbox_addr_t<T> > : public std::true_type { };"
 
     for nargs in xrange(15):
         generate_async_message_template(nargs)
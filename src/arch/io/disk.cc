@@ -21,6 +21,7 @@
 #include "arch/io/disk/conflict_resolving.hpp"
 #include "arch/io/disk/stats.hpp"
 #include "arch/io/disk/accounting.hpp"
+#include "arch/io/disk/uring.hpp"
 #include "backtrace.hpp"
 #include "config/args.hpp"
 #include "do_on_thread.hpp"
@@ -46,14 +47,16 @@ public:
     linux_disk_manager_t(linux_event_queue_t *queue,
                          int batch_factor,
                          int max_concurrent_io_requests,
+                         io_backend_t io_backend,
                          perfmon_collection_t *stats) :
         stack_stats(stats, "stack"),
         conflict_resolver(stats),
         accounter(batch_factor),
         backend_stats(stats, "backend", accounter.producer),
-        backend(queue, backend_stats.producer, max_concurrent_io_requests),
         outstanding_txn(0)
     {
+        init_backend(queue, max_concurrent_io_requests, io_backend);
+
         /* Hook up the `submit_fun`s of the parts of the IO stack that are above the
         queue. (The parts below the queue use the `passive_producer_t` interface instead
         of a callback function.) */
@@ -62,8 +65,8 @@ public:
         conflict_resolver.submit_fun = std::bind(&accounting_diskmgr_t::submit,
                                                  &accounter, ph::_1);
 
-        /* Hook up everything's `done_fun`. */
-        backend.done_fun = std::bind(&stats_diskmgr_2_t::done, &backend_stats, ph::_1);
+        /* Hook up everything's `done_fun`. (The backend's was hooked up by
+        `init_backend()`.) */
         backend_stats.done_fun = std::bind(&accounting_diskmgr_t::done, &accounter, ph::_1);
         accounter.done_fun = std::bind(&conflict_resolving_diskmgr_t::done,
                                        &conflict_resolver, ph::_1);
@@ -77,6 +80,38 @@ public:
                 outstanding_txn);
     }
 
+    void init_backend(linux_event_queue_t *queue, int max_concurrent_io_requests,
+                      io_backend_t io_backend) {
+        std::function<void(pool_diskmgr_t::action_t *)> backend_done_fun
+            = std::bind(&stats_diskmgr_2_t::done, &backend_stats, ph::_1);
+        switch (io_backend) {
+        case io_backend_t::uring:
+#ifndef USE_IO_URING
+#error "USE_IO_URING not defined.  Did you include uring.hpp?"
+#elif USE_IO_URING
+            if (uring_diskmgr_t::is_supported()) {
+                uring_backend.init(new uring_diskmgr_t(queue, backend_stats.producer,
+                                                       max_concurrent_io_requests));
+                uring_backend->done_fun = backend_done_fun;
+                return;
+            }
+            logWRN("io_uring is not supported by this kernel.  "
+                   "Falling back to the thread pool I/O backend.");
+#else
+            logWRN("This build does not support io_uring.  "
+                   "Falling back to the thread pool I/O backend.");
+#endif  // USE_IO_URING
+            break;
+        case io_backend_t::pool:
+            break;
+        default:
+            unreachable();
+        }
+        pool_backend.init(new pool_diskmgr_t(queue, backend_stats.producer,
+                                             max_concurrent_io_requests));
+        pool_backend->done_fun = backend_done_fun;
+    }
+
     void *create_account(int pri, int outstanding_requests_limit) {
         return new accounting_diskmgr_t::account_t(&accounter, pri, outstanding_requests_limit);
     }
@@ -142,6 +177,19 @@ public:
                      std::bind(&linux_disk_manager_t::submit_action_to_stack_stats, this,
                                a));
     }
+
+    void submit_readv(fd_t fd, scoped_array_t<iovec> &&bufs, size_t count,
+                      int64_t offset, void *account, linux_iocallback_t *cb) {
+        threadnum_t calling_thread = get_thread_id();
+
+        action_t *a = new action_t(calling_thread, cb);
+        a->make_readv(fd, std::move(bufs), count, offset);
+        a->account = static_cast<accounting_diskmgr_t::account_t *>(account);
+
+        do_on_thread(home_thread(),
+                     std::bind(&linux_disk_manager_t::submit_action_to_stack_stats, this,
+                               a));
+    }
 #endif  // USE_WRITEV
 
     void submit_read(fd_t fd, void *buf, size_t count, int64_t offset, void *account, linux_iocallback_t *cb) {
@@ -181,7 +229,8 @@ private:
     holding back operations that must be run after other, currently-running, operations.
     Then it goes to the account manager, which queues up running IO operations according
     to which account they are part of. Finally the "backend" pops the IO operations
-    from the queue.
+    from the queue. The backend is a `pool_diskmgr_t` or, if requested and supported
+    by the kernel, a `uring_diskmgr_t`; exactly one of the two gets initialized.
 
     At two points in the process--once as soon as it is submitted, and again right
     as the backend pops it off the queue--its statistics are recorded. The "stack stats"
@@ -194,7 +243,10 @@ private:
     conflict_resolving_diskmgr_t conflict_resolver;
     accounting_diskmgr_t accounter;
     stats_diskmgr_2_t backend_stats;
-    pool_diskmgr_t backend;
+    scoped_ptr_t<pool_diskmgr_t> pool_backend;
+#if USE_IO_URING
+    scoped_ptr_t<uring_diskmgr_t> uring_backend;
+#endif
 
 
     intptr_t outstanding_txn;
@@ -203,11 +255,13 @@ private:
 };
 
 io_backender_t::io_backender_t(file_direct_io_mode_t _direct_io_mode,
-                               int max_concurrent_io_requests)
+                               int max_concurrent_io_requests,
+                               io_backend_t io_backend)
     : direct_io_mode(_direct_io_mode),
       diskmgr(new linux_disk_manager_t(&linux_thread_pool_t::get_thread()->queue,
                                        DEFAULT_IO_BATCH_FACTOR,
                                        max_concurrent_io_requests,
+                                       io_backend,
                                        &stats)) { }
 
 io_backender_t::~io_backender_t() { }
@@ -350,6 +404,62 @@ void linux_file_t::writev_async(int64_t offset, size_t length,
 
 }
 
+void linux_file_t::readv_async(int64_t offset, size_t length,
+                               scoped_array_t<iovec> &&bufs,
+                               file_account_t *account, linux_iocallback_t *callback) {
+    rassert(diskmgr != NULL,
+            "No diskmgr has been constructed (are we running without an event queue?)");
+    verify_aligned_file_access(file_size, offset, length, bufs);
+
+#ifndef USE_WRITEV
+#error "USE_WRITEV not defined.  Did you include pool.hpp?"
+#elif USE_WRITEV
+    diskmgr->submit_readv(fd.get(), std::move(bufs), length, offset,
+                          account == DEFAULT_DISK_ACCOUNT
+                          ? default_account->get_account()
+                          : account->get_account(),
+                          callback);
+#else  // USE_WRITEV
+    // See the comment in writev_async.  We break up the reads into separate read
+    // calls.
+
+    struct intermediate_cb_t : public linux_iocallback_t {
+        void on_io_complete() {
+            guarantee(refcount > 0);
+            --refcount;
+            if (refcount == 0) {
+                linux_iocallback_t *local_cb = cb;
+                delete this;
+                local_cb->on_io_complete();
+            }
+        }
+
+        size_t refcount;
+        linux_iocallback_t *cb;
+    };
+
+    intermediate_cb_t *intermediate_cb = new intermediate_cb_t;
+    // Hold a refcount while we launch reads.
+    intermediate_cb->refcount = 1;
+    intermediate_cb->cb = callback;
+
+    int64_t partial_offset = offset;
+    for (size_t i = 0; i < bufs.size(); ++i) {
+        ++intermediate_cb->refcount;
+        diskmgr->submit_read(fd.get(), bufs[i].iov_base, bufs[i].iov_len,
+                             partial_offset, account == DEFAULT_DISK_ACCOUNT
+                             ? default_account->get_account()
+                             : account->get_account(),
+                             intermediate_cb);
+        partial_offset += bufs[i].iov_len;
+    }
+    guarantee(partial_offset - offset == static_cast<int64_t>(length));
+
+    // Release its refcount.
+    intermediate_cb->on_io_complete();
+#endif  // USE_WRITEV
+}
+
 bool linux_file_t::coop_lock_and_check() {
     if (flock(fd.get(), LOCK_EX | LOCK_NB) != 0) {
         rassert(get_errno() == EWOULDBLOCK);
@@ -29,7 +29,8 @@ public:
     // stops us from specifying this on a file-by-file basis, but right now there's no desire for
     // that.  See https://github.com/rethinkdb/rethinkdb/issues/97#issuecomment-19778177 .
     io_backender_t(file_direct_io_mode_t direct_io_mode,
-                   int max_concurrent_io_requests = DEFAULT_MAX_CONCURRENT_IO_REQUESTS);
+                   int max_concurrent_io_requests = DEFAULT_MAX_CONCURRENT_IO_REQUESTS,
+                   io_backend_t io_backend = io_backend_t::pool);
     ~io_backender_t();
     linux_disk_manager_t *get_diskmgr_ptr() { return diskmgr.get(); }
     file_direct_io_mode_t get_direct_io_mode() const;
@@ -86,6 +87,8 @@ public:
     // Does not guarantee the atomicity that writev guarantees.
     void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                       file_account_t *account, linux_iocallback_t *cb);
+    void readv_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
+                     file_account_t *account, linux_iocallback_t *cb);
 
     bool coop_lock_and_check();
 
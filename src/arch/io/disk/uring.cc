@@ -0,0 +1,440 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include "arch/io/disk/uring.hpp"
+
+#if USE_IO_URING
+
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "arch/io/disk.hpp"
+#include "arch/timer.hpp"
+#include "logger.hpp"
+
+#if !defined(__NR_io_uring_setup) || !defined(__NR_io_uring_enter) || !defined(__NR_io_uring_register)
+#error "io_uring system calls are not defined by your libc headers.  Build with NO_IO_URING=1."
+#endif
+
+// The largest ring we ask the kernel for.  Kernels before 5.4 refuse anything
+// bigger than 4096 entries.
+#define URING_MAX_RING_ENTRIES 4096
+
+// Every action takes at most three SQEs: a datasync, the read or write, and a
+// second datasync.
+#define URING_MAX_SQES_PER_ACTION 3
+
+// Resizes are rare, so the fallback pool doesn't need many threads.
+#define URING_FALLBACK_THREADS 2
+
+// How long we wait before offering the kernel SQEs again that it didn't take.
+#define URING_RESUBMIT_DELAY_MS 1
+
+// The stage of an action that a given SQE represents, stored in the low bits of
+// its user_data.
+enum uring_stage_t {
+    URING_STAGE_PRE_DATASYNC = 0,
+    URING_STAGE_IO = 1,
+    URING_STAGE_POST_DATASYNC = 2
+};
+#define URING_STAGE_BITS 2
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params *p) {
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+}  // namespace
+
+/* Owns the io_uring file descriptor and its memory-mapped submission and
+completion rings.  We are the only producer of SQEs and the only consumer of
+CQEs, so the only synchronization we need is with the kernel. */
+class uring_ring_t {
+public:
+    explicit uring_ring_t(unsigned entries)
+        : sq_ring(MAP_FAILED), cq_ring(MAP_FAILED), sqes(MAP_FAILED),
+          unpublished(0), unconsumed(0), max_submit_per_call(UINT_MAX) {
+        memset(&params, 0, sizeof(params));
+        int res = sys_io_uring_setup(entries, &params);
+        guarantee_err(res != -1, "Could not create io_uring instance");
+        ring_fd.reset(res);
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+
+        sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd.get(), IORING_OFF_SQ_RING);
+        guarantee_err(sq_ring != MAP_FAILED, "Could not map io_uring submission ring");
+        if (single_mmap) {
+            cq_ring = sq_ring;
+        } else {
+            cq_ring = mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd.get(), IORING_OFF_CQ_RING);
+            guarantee_err(cq_ring != MAP_FAILED, "Could not map io_uring completion ring");
+        }
+        sqes = mmap(NULL, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd.get(), IORING_OFF_SQES);
+        guarantee_err(sqes != MAP_FAILED, "Could not map io_uring submission entries");
+
+        char *sq = static_cast<char *>(sq_ring);
+        sq_tail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+
+        char *cq = static_cast<char *>(cq_ring);
+        cq_head = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    ~uring_ring_t() {
+        munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+        if (cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        munmap(sq_ring, sq_ring_size);
+        // scoped_fd_t's destructor closes the ring.
+    }
+
+    unsigned sq_entries() const { return params.sq_entries; }
+
+    void register_eventfd(fd_t event_fd) {
+        int res = sys_io_uring_register(ring_fd.get(), IORING_REGISTER_EVENTFD, &event_fd, 1);
+        guarantee_err(res == 0, "Could not register eventfd with io_uring");
+    }
+
+    void unregister_eventfd() {
+        int res = sys_io_uring_register(ring_fd.get(), IORING_UNREGISTER_EVENTFD, NULL, 0);
+        guarantee_err(res == 0, "Could not unregister eventfd from io_uring");
+    }
+
+    // Returns a zeroed SQE.  The caller must not ask for more SQEs than are
+    // free; `uring_diskmgr_t` makes sure of that by limiting how many actions it
+    // keeps in flight.
+    io_uring_sqe *get_sqe() {
+        const uint32_t tail = *sq_tail + unpublished;
+        const uint32_t index = tail & sq_mask;
+        io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes) + index;
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+        ++unpublished;
+        return sqe;
+    }
+
+    // Publishes all SQEs obtained from `get_sqe()` to the kernel, and asks it to
+    // consume them together with any that it didn't take earlier.  Returns false
+    // if some SQEs are still on the ring, in which case the caller must call
+    // `submit()` again later.
+    bool submit() {
+        if (unpublished != 0) {
+            __atomic_store_n(sq_tail, *sq_tail + unpublished, __ATOMIC_RELEASE);
+            unconsumed += unpublished;
+            unpublished = 0;
+        }
+        if (unconsumed == 0) {
+            return true;
+        }
+
+        const unsigned to_submit = std::min(unconsumed, max_submit_per_call);
+        int res;
+        do {
+            res = sys_io_uring_enter(ring_fd.get(), to_submit, 0, 0);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            // EAGAIN and EBUSY mean that the kernel is short on resources or the
+            // completion ring is full.  The SQEs stay on the ring.
+            guarantee_err(get_errno() == EAGAIN || get_errno() == EBUSY,
+                          "io_uring_enter failed");
+            return false;
+        }
+        guarantee(static_cast<unsigned>(res) <= unconsumed);
+        unconsumed -= res;
+        return unconsumed == 0;
+    }
+
+    // Makes `submit()` offer the kernel at most `limit` SQEs at a time, which
+    // lets the unit tests force short submissions.
+    void set_max_submit_per_call(unsigned limit) {
+        guarantee(limit > 0);
+        max_submit_per_call = limit;
+    }
+
+    // Calls `fun` on every available CQE and then releases them to the kernel.
+    template <class callable_t>
+    void consume_completions(const callable_t &fun) {
+        uint32_t head = *cq_head;
+        const uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe &cqe = cqes[head & cq_mask];
+            fun(cqe.user_data, cqe.res);
+            ++head;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    scoped_fd_t ring_fd;
+    io_uring_params params;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    uint32_t *sq_tail;
+    uint32_t sq_mask;
+    uint32_t *sq_array;
+
+    void *cq_ring;
+    size_t cq_ring_size;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t cq_mask;
+    io_uring_cqe *cqes;
+
+    void *sqes;
+
+    // SQEs that have been filled in but not yet made visible to the kernel.
+    unsigned unpublished;
+    // SQEs that are visible to the kernel, but that it hasn't consumed yet
+    // because an `io_uring_enter` came up short.
+    unsigned unconsumed;
+    unsigned max_submit_per_call;
+
+    DISABLE_COPYING(uring_ring_t);
+};
+
+unsigned uring_ring_entries(int max_concurrent_io_requests) {
+    guarantee(max_concurrent_io_requests > 0);
+    guarantee(max_concurrent_io_requests < MAXIMUM_MAX_CONCURRENT_IO_REQUESTS);
+    const int64_t wanted = static_cast<int64_t>(max_concurrent_io_requests)
+        * URING_MAX_SQES_PER_ACTION;
+    unsigned entries = 1;
+    while (entries < wanted && entries < URING_MAX_RING_ENTRIES) {
+        entries *= 2;
+    }
+    return entries;
+}
+
+bool uring_diskmgr_t::is_supported() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int res = sys_io_uring_setup(1, &params);
+    if (res == -1) {
+        return false;
+    }
+    scoped_fd_t fd(res);
+    return true;
+}
+
+uring_diskmgr_t::uring_diskmgr_t(linux_event_queue_t *_queue,
+                                 passive_producer_t<action_t *> *_source,
+                                 int max_concurrent_io_requests)
+    : queue(_queue),
+      source(_source),
+      ring(new uring_ring_t(uring_ring_entries(max_concurrent_io_requests))),
+      n_pending(0),
+      resubmit_timer(NULL),
+      fallback(_queue, &fallback_queue, URING_FALLBACK_THREADS) {
+    // The kernel may round the ring size up, but never down.
+    const size_t max_in_flight = std::min<size_t>(max_concurrent_io_requests,
+                                                  ring->sq_entries() / URING_MAX_SQES_PER_ACTION);
+    guarantee(max_in_flight > 0);
+    requests.resize(max_in_flight);
+    free_requests.reserve(max_in_flight);
+    for (size_t i = max_in_flight; i > 0; --i) {
+        free_requests.push_back(i - 1);
+    }
+
+    fallback.done_fun = std::bind(&uring_diskmgr_t::on_fallback_done, this, ph::_1);
+
+    ring->register_eventfd(completion_event.get_notify_fd());
+    queue->watch_resource(completion_event.get_notify_fd(), poll_event_in, this);
+
+    if (source->available->get()) { pump(); }
+    source->available->set_callback(this);
+}
+
+uring_diskmgr_t::~uring_diskmgr_t() {
+    assert_thread();
+    rassert(n_pending == 0);
+    if (resubmit_timer != NULL) {
+        cancel_timer(resubmit_timer);
+    }
+    source->available->unset_callback();
+    queue->forget_resource(completion_event.get_notify_fd(), this);
+    ring->unregister_eventfd();
+}
+
+void uring_diskmgr_t::on_source_availability_changed() {
+    assert_thread();
+    if (source->available->get()) pump();
+}
+
+void uring_diskmgr_t::on_event(DEBUG_VAR int events) {
+    assert_thread();
+    rassert(events == poll_event_in);
+    completion_event.consume_wakey_wakeys();
+    reap_completions();
+    pump();
+}
+
+void uring_diskmgr_t::on_timer() {
+    assert_thread();
+    resubmit_timer = NULL;
+    pump();
+}
+
+void uring_diskmgr_t::pump() {
+    assert_thread();
+    while (source->available->get() && !free_requests.empty()) {
+        action_t *a = source->pop();
+        submit(a);
+    }
+    flush_submissions();
+}
+
+void uring_diskmgr_t::submit(action_t *a) {
+    iovec *vecs;
+    size_t vecs_len;
+    a->get_bufs(&vecs, &vecs_len);
+
+    if (a->type == action_t::ACTION_RESIZE || vecs_len > IOV_MAX) {
+        fallback_queue.push(a);
+        return;
+    }
+
+    const size_t request_index = free_requests.back();
+    free_requests.pop_back();
+    ++n_pending;
+
+    request_t *req = &requests[request_index];
+    req->action = a;
+    req->sqes_outstanding = 0;
+    req->error = 0;
+    req->transferred = 0;
+
+    // The SQEs of one action are linked, so that the kernel runs them in order
+    // and cancels the rest of the chain if one of them fails.
+    const uint64_t tag = static_cast<uint64_t>(request_index) << URING_STAGE_BITS;
+    io_uring_sqe *sqe;
+    if (a->wrap_in_datasyncs) {
+        sqe = ring->get_sqe();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = a->fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = tag | URING_STAGE_PRE_DATASYNC;
+        ++req->sqes_outstanding;
+    }
+
+    sqe = ring->get_sqe();
+    sqe->opcode = a->type == action_t::ACTION_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = a->fd;
+    sqe->off = a->offset;
+    sqe->addr = reinterpret_cast<uintptr_t>(vecs);
+    sqe->len = vecs_len;
+    sqe->user_data = tag | URING_STAGE_IO;
+    ++req->sqes_outstanding;
+
+    if (a->wrap_in_datasyncs) {
+        sqe->flags = IOSQE_IO_LINK;
+        sqe = ring->get_sqe();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = a->fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->user_data = tag | URING_STAGE_POST_DATASYNC;
+        ++req->sqes_outstanding;
+    }
+}
+
+void uring_diskmgr_t::flush_submissions() {
+    if (ring->submit()) {
+        return;
+    }
+    // The kernel didn't take all of the SQEs.  Completions of earlier requests make
+    // us try again from `on_event()`, but there may not be any in flight, so we
+    // also try again after a short delay.
+    if (resubmit_timer == NULL) {
+        resubmit_timer = fire_timer_once(URING_RESUBMIT_DELAY_MS, this);
+    }
+}
+
+void uring_diskmgr_t::set_max_submit_per_call(unsigned limit) {
+    assert_thread();
+    ring->set_max_submit_per_call(limit);
+}
+
+void uring_diskmgr_t::reap_completions() {
+    std::vector<action_t *> finished;
+    ring->consume_completions([&](uint64_t user_data, int32_t res) {
+        const size_t request_index = user_data >> URING_STAGE_BITS;
+        const uint64_t stage = user_data & ((1 << URING_STAGE_BITS) - 1);
+        guarantee(request_index < requests.size());
+        request_t *req = &requests[request_index];
+
+        if (res < 0) {
+            // Only the first failure in a chain is interesting; the rest of the
+            // chain gets canceled because of it.
+            if (req->error == 0 || req->error == -ECANCELED) {
+                req->error = res;
+            }
+        } else if (stage == URING_STAGE_IO) {
+            req->transferred = res;
+        }
+
+        --req->sqes_outstanding;
+        if (req->sqes_outstanding > 0) {
+            return;
+        }
+
+        action_t *a = req->action;
+        if (req->error != 0) {
+            a->io_result = req->error;
+        } else if (req->transferred != static_cast<int64_t>(a->get_count())
+                   && a->type == action_t::ACTION_WRITE) {
+            // See the corresponding comment in pool.cc.
+            a->io_result = -ENOSPC;
+            logERR("Failed I/O: count (%zu) != res (%" PRIi64 ")."
+                   " Assuming we ran out of disk space.",
+                   a->get_count(), req->transferred);
+        } else {
+            guarantee(req->transferred == static_cast<int64_t>(a->get_count()),
+                      "Short read from io_uring (%" PRIi64 " of %zu bytes)",
+                      req->transferred, a->get_count());
+            a->io_result = req->transferred;
+        }
+
+        req->action = NULL;
+        free_requests.push_back(request_index);
+        --n_pending;
+        finished.push_back(a);
+    });
+
+    for (auto it = finished.begin(); it != finished.end(); ++it) {
+        done_fun(*it);
+    }
+}
+
+void uring_diskmgr_t::on_fallback_done(action_t *a) {
+    assert_thread();
+    done_fun(a);
+}
+
+#endif  // USE_IO_URING
@@ -0,0 +1,104 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#ifndef ARCH_IO_DISK_URING_HPP_
+#define ARCH_IO_DISK_URING_HPP_
+
+#include <functional>
+#include <vector>
+
+#include "arch/io/disk/pool.hpp"
+#include "arch/timer.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
+
+// io_uring needs a Linux kernel (5.1 or later) and eventfd for completion
+// notifications.  Build with NO_IO_URING=1 to leave it out entirely.
+#if defined(__linux) && !defined(NO_IO_URING) && !defined(NO_EVENTFD)
+#define USE_IO_URING 1
+#else
+#define USE_IO_URING 0
+#endif
+
+#if USE_IO_URING
+
+#include "arch/runtime/system_event/eventfd_event.hpp"
+
+class uring_ring_t;
+
+namespace unittest {
+void run_UringDiskmgr_ShortSubmit();
+}
+
+/* The uring disk manager hands IO requests straight to the kernel through an
+io_uring instance, and reaps their completions from the event loop when the
+ring's eventfd fires.  Unlike `pool_diskmgr_t`, no thread handoff is needed per
+operation.
+
+It consumes the same `pool_diskmgr_action_t` objects as `pool_diskmgr_t`, so
+it can sit under the same accounting and conflict-resolving stack.  Actions
+that io_uring can't express on all kernels we support (resizes, and vectored
+operations with more than IOV_MAX buffers) are forwarded to a small internal
+`pool_diskmgr_t`. */
+
+class uring_diskmgr_t : private availability_callback_t,
+                        private linux_event_callback_t,
+                        private timer_callback_t,
+                        public home_thread_mixin_debug_only_t {
+public:
+    typedef pool_diskmgr_action_t action_t;
+
+    /* The `uring_diskmgr_t` will draw actions to run from `source`. It will call
+    `done_fun` on each one when it's done. */
+    uring_diskmgr_t(linux_event_queue_t *queue, passive_producer_t<action_t *> *source,
+                    int max_concurrent_io_requests);
+    std::function<void(action_t *)> done_fun;
+    ~uring_diskmgr_t();
+
+    // Returns false if the running kernel doesn't let us create an io_uring
+    // instance (too old, or disabled through sysctl / seccomp).
+    static bool is_supported();
+
+private:
+    friend void unittest::run_UringDiskmgr_ShortSubmit();
+
+    // Tracks the one to three SQEs (datasync, read/write, datasync) that make up
+    // an action in flight.
+    struct request_t {
+        action_t *action;
+        int sqes_outstanding;
+        int64_t error;
+        int64_t transferred;
+    };
+
+    void on_source_availability_changed();
+    void on_event(int events);
+    void on_timer();
+
+    void pump();
+    void submit(action_t *a);
+    // Hands the queued SQEs to the kernel.  If it doesn't take all of them, we
+    // try again from the next `on_event()` or `on_timer()`, whichever is first.
+    void flush_submissions();
+    void set_max_submit_per_call(unsigned limit);
+    void reap_completions();
+    void on_fallback_done(action_t *a);
+
+    linux_event_queue_t *const queue;
+    passive_producer_t<action_t *> *const source;
+
+    scoped_ptr_t<uring_ring_t> ring;
+    eventfd_event_t completion_event;
+
+    std::vector<request_t> requests;
+    std::vector<size_t> free_requests;
+    int n_pending;
+    // Set while we wait to offer the kernel the SQEs it didn't take.
+    timer_token_t *resubmit_timer;
+
+    unlimited_fifo_queue_t<action_t *> fallback_queue;
+    pool_diskmgr_t fallback;
+
+    DISABLE_COPYING(uring_diskmgr_t);
+};
+
+#endif  // USE_IO_URING
+
+#endif  // ARCH_IO_DISK_URING_HPP_
@@ -4,6 +4,7 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
@@ -11,6 +12,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "utils.hpp"
 #include <boost/bind.hpp>
@@ -343,6 +345,8 @@ void linux_tcp_conn_t::write_handler_t::coro_pool_callback(write_queue_op_t *ope
             parent->release_write_buffer(operation->dealloc);
             parent->write_queue_limiter.unlock(operation->size);
         }
+    } else if (operation->iov != NULL) {
+        parent->perform_writev(operation->iov, operation->iovcnt);
     }
 
     if (operation->cond != NULL) {
@@ -363,6 +367,8 @@ void linux_tcp_conn_t::internal_flush_write_buffer() {
     op->buffer = current_write_buffer->buffer;
     op->size = current_write_buffer->size;
     op->dealloc = current_write_buffer.release();
+    op->iov = NULL;
+    op->iovcnt = 0;
     op->cond = NULL;
     op->keepalive = auto_drainer_t::lock_t(drainer.get());
     current_write_buffer.init(get_write_buffer());
@@ -377,6 +383,13 @@ void linux_tcp_conn_t::internal_flush_write_buffer() {
 }
 
 void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
+    iovec iov;
+    iov.iov_base = const_cast<void *>(buf);
+    iov.iov_len = size;
+    perform_writev(&iov, 1);
+}
+
+void linux_tcp_conn_t::perform_writev(iovec *iov, size_t iovcnt) {
     assert_thread();
 
     if (write_closed.is_pulsed()) {
@@ -386,8 +399,14 @@ void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
         return;
     }
 
-    while (size > 0) {
-        ssize_t res = ::write(sock.get(), buf, size);
+    while (iovcnt > 0) {
+        if (iov->iov_len == 0) {
+            ++iov;
+            --iovcnt;
+            continue;
+        }
+
+        ssize_t res = ::writev(sock.get(), iov, std::min<size_t>(iovcnt, IOV_MAX));
 
         if (res == -1 && (get_errno() == EAGAIN || get_errno() == EWOULDBLOCK)) {
             /* Wait for a notification from the event queue, or for an order to
@@ -425,10 +444,23 @@ void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
             break;
 
         } else {
-            rassert(res <= static_cast<ssize_t>(size));
-            buf = reinterpret_cast<const void *>(reinterpret_cast<const char *>(buf) + res);
-            size -= res;
             if (write_perfmon) write_perfmon->record(res);
+
+            /* Skip over the buffers that were written completely, and advance
+            into the one that was written partially, if any. */
+            size_t written = res;
+            while (written > 0) {
+                rassert(iovcnt > 0);
+                if (written >= iov->iov_len) {
+                    written -= iov->iov_len;
+                    ++iov;
+                    --iovcnt;
+                } else {
+                    iov->iov_base = reinterpret_cast<char *>(iov->iov_base) + written;
+                    iov->iov_len -= written;
+                    written = 0;
+                }
+            }
         }
     }
 }
@@ -448,6 +480,8 @@ void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THR
     /* Enqueue the write so it will happen eventually */
     op.buffer = buf;
     op.size = size;
+    op.iov = NULL;
+    op.iovcnt = 0;
     op.dealloc = NULL;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -460,6 +494,32 @@ void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THR
     if (write_closed.is_pulsed()) throw tcp_conn_write_closed_exc_t();
 }
 
+void linux_tcp_conn_t::writev(const iovec *iov, size_t iovcnt, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
+    write_op_wrapper_t sentry(this, closer);
+
+    /* `perform_writev()` modifies the `iovec`s as it goes, so give it a copy */
+    std::vector<iovec> iov_copy(iov, iov + iovcnt);
+
+    write_queue_op_t op;
+    cond_t to_signal_when_done;
+
+    /* Flush out any data that's been buffered, so that things don't get out of order */
+    if (current_write_buffer->size > 0) internal_flush_write_buffer();
+
+    op.buffer = NULL;
+    op.size = 0;
+    op.iov = iov_copy.data();
+    op.iovcnt = iov_copy.size();
+    op.dealloc = NULL;
+    op.cond = &to_signal_when_done;
+    write_queue.push(&op);
+
+    /* As in `write()`, the cond gets pulsed even if the connection is closed */
+    to_signal_when_done.wait();
+
+    if (write_closed.is_pulsed()) throw tcp_conn_write_closed_exc_t();
+}
+
 void linux_tcp_conn_t::write_buffered(const void *vbuf, size_t size, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
     write_op_wrapper_t sentry(this, closer);
 
@@ -507,6 +567,8 @@ void linux_tcp_conn_t::flush_buffer(signal_t *closer) THROWS_ONLY(tcp_conn_write
     write_queue_op_t op;
     cond_t to_signal_when_done;
     op.buffer = NULL;
+    op.iov = NULL;
+    op.iovcnt = 0;
     op.dealloc = NULL;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -5,6 +5,7 @@
 #include <stdarg.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <ifaddrs.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -105,6 +106,10 @@ public:
     pipe and throws `tcp_conn_write_closed_exc_t`. */
     void write(const void *buf, size_t size, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t);
 
+    /* writev() is like write(), but gathers the data from `iovcnt` buffers, using as
+    few `writev()` system calls as possible. */
+    void writev(const iovec *iov, size_t iovcnt, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t);
+
     /* write_buffered() is like write(), but it might not send the data until
     flush_buffer*() or write() is called. Internally, it bundles together the
     buffered writes; this may improve performance. */
@@ -244,6 +249,9 @@ private:
         write_buffer_t *dealloc;
         const void *buffer;
         size_t size;
+        // Used instead of `buffer` and `size` for vectored writes
+        iovec *iov;
+        size_t iovcnt;
         cond_t *cond;
         auto_drainer_t::lock_t keepalive;
     };
@@ -302,6 +310,9 @@ private:
     `size` bytes from `buffer` to the socket. */
     void perform_write(const void *buffer, size_t size);
 
+    /* Like `perform_write()`, but for several buffers. Modifies `iov` as it goes. */
+    void perform_writev(iovec *iov, size_t iovcnt);
+
     scoped_ptr_t<auto_drainer_t> drainer;
 };
 
@@ -101,6 +101,14 @@ enum class file_direct_io_mode_t {
     buffered_desired
 };
 
+// Which disk manager runs the actual IO operations.  `pool` runs blocking
+// syscalls on a thread pool, `uring` submits them through io_uring from the
+// event loop (and falls back to `pool` when the kernel doesn't support it).
+enum class io_backend_t {
+    pool,
+    uring
+};
+
 
 
 class semantic_checking_file_t {
@@ -137,6 +145,9 @@ public:
     // writev_async doesn't provide the atomicity guarantees of writev.
     virtual void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                               file_account_t *account, linux_iocallback_t *cb) = 0;
+    // Reads the contiguous range [offset, offset + length) into bufs, in order.
+    virtual void readv_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
+                             file_account_t *account, linux_iocallback_t *cb) = 0;
 
     virtual void *create_account(int priority, int outstanding_requests_limit) = 0;
     virtual void destroy_account(void *account) = 0;
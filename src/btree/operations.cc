@@ -971,6 +971,95 @@ void find_keyvalue_location_for_read(
     }
 }
 
+void find_keyvalues_for_read(
+        value_sizer_t *sizer,
+        superblock_t *superblock, const std::vector<const btree_key_t *> &keys,
+        keyvalue_read_callback_t *cb,
+        btree_stats_t *stats, profile::trace_t *trace) {
+    const block_id_t root_id = superblock->get_root_block_id();
+    rassert(root_id != SUPERBLOCK_ID);
+
+    buf_lock_t root;
+    if (root_id != NULL_BLOCK_ID) {
+        profile::starter_t starter("Acquire a block for read.", trace);
+        buf_lock_t tmp(superblock->expose_buf(), root_id, access_t::read);
+        root = std::move(tmp);
+    }
+    superblock->release();
+
+    find_keyvalues_for_read(sizer, &root, keys, cb, stats, trace);
+}
+
+void find_keyvalues_for_read(
+        value_sizer_t *sizer,
+        buf_lock_t *root, const std::vector<const btree_key_t *> &keys,
+        keyvalue_read_callback_t *cb,
+        btree_stats_t *stats, profile::trace_t *trace) {
+    stats->pm_keys_read.record(keys.size());
+    stats->pm_total_keys_read += keys.size();
+
+    if (root->empty()) {
+        // There is no root, so the tree is empty.
+        for (size_t i = 0; i < keys.size(); ++i) {
+            cb->on_keyvalue(i, NULL, buf_parent_t());
+        }
+        return;
+    }
+
+#ifndef NDEBUG
+    {
+        buf_read_t read(root);
+        node::validate(sizer, static_cast<const node_t *>(read.get_data_read()));
+    }
+#endif  // NDEBUG
+
+    scoped_malloc_t<void> value(sizer->max_possible_size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        // We walk down from `root` for every key, releasing the nodes below it as
+        // we go, just like `find_keyvalue_location_for_read` does.
+        buf_lock_t buf;
+        buf_lock_t *node = root;
+        for (;;) {
+            block_id_t node_id;
+            {
+                buf_read_t read(node);
+                const void *data = read.get_data_read();
+                if (!node::is_internal(static_cast<const node_t *>(data))) {
+                    break;
+                }
+
+                node_id = internal_node::lookup(
+                    static_cast<const internal_node_t *>(data), keys[i]);
+            }
+            rassert(node_id != NULL_BLOCK_ID && node_id != SUPERBLOCK_ID);
+
+            {
+                profile::starter_t starter("Acquire a block for read.", trace);
+                buf_lock_t tmp(node, node_id, access_t::read);
+                buf.reset_buf_lock();
+                buf = std::move(tmp);
+                node = &buf;
+            }
+
+#ifndef NDEBUG
+            {
+                buf_read_t read(node);
+                node::validate(sizer, static_cast<const node_t *>(read.get_data_read()));
+            }
+#endif  // NDEBUG
+        }
+
+        bool value_found;
+        {
+            buf_read_t read(node);
+            const leaf_node_t *leaf
+                = static_cast<const leaf_node_t *>(read.get_data_read());
+            value_found = leaf::lookup(sizer, leaf, keys[i], value.get());
+        }
+        cb->on_keyvalue(i, value_found ? value.get() : NULL, buf_parent_t(node));
+    }
+}
+
 void apply_keyvalue_change(
         value_sizer_t *sizer,
         keyvalue_location_t *kv_loc,
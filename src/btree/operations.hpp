@@ -276,6 +276,33 @@ void find_keyvalue_location_for_read(
         keyvalue_location_t *keyvalue_location_out,
         btree_stats_t *stats, profile::trace_t *trace);
 
+class keyvalue_read_callback_t {
+public:
+    // `value` is `NULL` if the key isn't in the tree.  Otherwise `leaf` is the leaf
+    // node that holds the value, which is needed to read blobs it refers to.
+    virtual void on_keyvalue(size_t index, const void *value, buf_parent_t leaf) = 0;
+protected:
+    virtual ~keyvalue_read_callback_t() { }
+};
+
+// Looks up several keys while holding on to the root node, so that the lookups
+// share one acquisition of the superblock and see the same version of the tree.
+// Use a snapshotted transaction, or writers wait for all of the lookups.  Calls
+// `cb->on_keyvalue(i, ...)` for `keys[i]`, in order.
+void find_keyvalues_for_read(
+        value_sizer_t *sizer,
+        superblock_t *superblock, const std::vector<const btree_key_t *> &keys,
+        keyvalue_read_callback_t *cb,
+        btree_stats_t *stats, profile::trace_t *trace);
+
+// The same, for a caller that already holds the root node, which it keeps.  `root`
+// is empty if the tree is.
+void find_keyvalues_for_read(
+        value_sizer_t *sizer,
+        buf_lock_t *root, const std::vector<const btree_key_t *> &keys,
+        keyvalue_read_callback_t *cb,
+        btree_stats_t *stats, profile::trace_t *trace);
+
 void apply_keyvalue_change(
         value_sizer_t *sizer,
         keyvalue_location_t *kv_loc,
@@ -27,13 +27,21 @@ struct btree_sindex_block_magic_t {
 
 template <>
 const block_magic_t
-btree_sindex_block_magic_t<cluster_version_t::v1_13_is_latest_disk>::value
+btree_sindex_block_magic_t<cluster_version_t::v1_13>::value
     = { { 's', 'i', 'n', 'd' } };
 
+template <>
+const block_magic_t
+btree_sindex_block_magic_t<cluster_version_t::v1_14_is_latest_disk>::value
+    = { { 's', 'i', 'n', 'e' } };
+
 cluster_version_t sindex_block_version(const btree_sindex_block_t *data) {
     if (data->magic
-        == btree_sindex_block_magic_t<cluster_version_t::v1_13_is_latest_disk>::value) {
-        return cluster_version_t::v1_13_is_latest_disk;
+        == btree_sindex_block_magic_t<cluster_version_t::v1_13>::value) {
+        return cluster_version_t::v1_13;
+    } else if (data->magic
+        == btree_sindex_block_magic_t<cluster_version_t::v1_14_is_latest_disk>::value) {
+        return cluster_version_t::v1_14_is_latest_disk;
     } else {
         crash("Unexpected magic in btree_sindex_block_t.");
     }
@@ -4,6 +4,7 @@
 
 #include "arch/types.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "buffer_cache/alt/cache_balancer.hpp"
 #include "buffer_cache/alt/stats.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "utils.hpp"
@@ -86,9 +87,10 @@ void alt_txn_throttler_t::inform_memory_limit_change(uint64_t memory_limit,
 cache_t::cache_t(serializer_t *serializer,
                  cache_balancer_t *balancer,
                  perfmon_collection_t *perfmon_collection)
-    : stats_(make_scoped<alt_cache_stats_t>(perfmon_collection)),
+    : stats_(make_scoped<alt_cache_stats_t>(perfmon_collection,
+                                            balancer->eviction_policy())),
       throttler_(MINIMUM_SOFT_UNWRITTEN_CHANGES_LIMIT),
-      page_cache_(serializer, balancer, &throttler_) { }
+      page_cache_(serializer, balancer, &throttler_, stats_.get()) { }
 
 cache_t::~cache_t() {
     guarantee(snapshot_nodes_by_block_id_.empty());
@@ -760,12 +762,18 @@ buf_read_t::~buf_read_t() {
 }
 
 const void *buf_read_t::get_data_read(uint32_t *block_size_out) {
+    // Only the first call can have to wait for the block.
+    const bool first_access = !page_acq_.has();
+    const ticks_t start_ticks = first_access ? get_ticks() : 0;
     page_t *page = lock_->get_held_page_for_read();
-    if (!page_acq_.has()) {
+    if (first_access) {
         page_acq_.init(page, &lock_->cache()->page_cache_,
                        lock_->txn()->account());
     }
     page_acq_.buf_ready_signal()->wait();
+    if (first_access) {
+        lock_->cache()->stats_->pm_acquire_latency.record(get_ticks() - start_ticks);
+    }
     *block_size_out = page_acq_.get_buf_size().value();
     return page_acq_.get_buf_read();
 }
@@ -782,12 +790,18 @@ buf_write_t::~buf_write_t() {
 }
 
 void *buf_write_t::get_data_write(uint32_t block_size) {
+    // Only the first call can have to wait for the block.
+    const bool first_access = !page_acq_.has();
+    const ticks_t start_ticks = first_access ? get_ticks() : 0;
     page_t *page = lock_->get_held_page_for_write();
-    if (!page_acq_.has()) {
+    if (first_access) {
         page_acq_.init(page, &lock_->cache()->page_cache_,
                        lock_->txn()->account());
     }
     page_acq_.buf_ready_signal()->wait();
+    if (first_access) {
+        lock_->cache()->stats_->pm_acquire_latency.record(get_ticks() - start_ticks);
+    }
     return page_acq_.get_buf_write(block_size_t::make_from_cache(block_size));
 }
 
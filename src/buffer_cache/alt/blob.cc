@@ -7,6 +7,7 @@
 
 #include "buffer_cache/alt/alt.hpp"
 #include "concurrency/pmap.hpp"
+#include "config/args.hpp"
 #include "containers/buffer_group.hpp"
 #include "containers/scoped.hpp"
 #include "math.hpp"
@@ -210,7 +211,14 @@ int64_t value_size(const char *ref, int maxreflen) {
 }
 
 
-int btree_maxreflen = 251;
+int btree_maxreflen(max_block_size_t block_size) {
+    // Btrees with the default block size always used 251, and their values depend
+    // on it.
+    if (block_size.ser_value() <= DEFAULT_BTREE_BLOCK_SIZE) {
+        return 251;
+    }
+    return block_size.value() / BTREE_INLINE_VALUE_BLOCK_FRACTION;
+}
 block_magic_t internal_node_magic = { { 'l', 'a', 'r', 'i' } };
 block_magic_t leaf_node_magic = { { 'l', 'a', 'r', 'l' } };
 
@@ -119,9 +119,14 @@ const block_id_t *internal_node_block_ids(const void *buf);
 // Returns offset and size, clamped to and relative to the index'th subtree.
 void shrink(max_block_size_t block_size, int levels, int64_t offset, int64_t size, int index, int64_t *suboffset_out, int64_t *subsize_out);
 
-// The maxreflen value (allegedly) appropriate for use with rdb_protocol btrees.
-// It's 251.  This should be renamed.
-extern int btree_maxreflen;
+// The maxreflen of the values of rdb_protocol btrees with the given block size,
+// which is the largest size of a value they store inline.  It's 251 for the
+// default block size, and a fixed fraction of the block for larger ones.  A btree
+// never changes its block size, so it never changes the format of its values.
+int btree_maxreflen(max_block_size_t block_size);
+
+// Whether a value of `proposed_size` bytes would be stored inline in the ref.
+bool size_would_be_small(int64_t proposed_size, int maxreflen);
 
 // The size of a blob, equivalent to blob_t(ref, maxreflen).valuesize().
 int64_t value_size(const char *ref, int maxreflen);
@@ -19,8 +19,10 @@ alt_cache_balancer_t::cache_data_t::cache_data_t(alt::evicter_t *_evicter) :
     bytes_loaded(evicter->get_clamped_bytes_loaded()),
     access_count(evicter->access_count()) { }
 
-alt_cache_balancer_t::alt_cache_balancer_t(uint64_t _total_cache_size) :
+alt_cache_balancer_t::alt_cache_balancer_t(uint64_t _total_cache_size,
+                                           eviction_policy_kind_t _eviction_policy) :
     total_cache_size(_total_cache_size),
+    eviction_policy_kind(_eviction_policy),
     rebalance_timer(rebalance_check_interval_ms, this),
     last_rebalance_time(0),
     read_ahead_ok(true),
@@ -8,6 +8,8 @@
 #include "errors.hpp"
 #include "time.hpp"
 
+#include "buffer_cache/alt/eviction_policy.hpp"
+
 #include "threading.hpp"
 #include "arch/timing.hpp"
 #include "concurrency/coro_pool.hpp"
@@ -30,6 +32,9 @@ public:
     // Tells caches whether to start read ahead initially
     virtual bool read_ahead_ok_at_start() const = 0;
 
+    // The eviction policy that caches should use
+    virtual eviction_policy_kind_t eviction_policy() const = 0;
+
 protected:
     friend class alt::evicter_t;
 
@@ -42,8 +47,11 @@ protected:
 // Dummy balancer that does nothing but provide the initial size of a cache
 class dummy_cache_balancer_t : public cache_balancer_t {
 public:
-    explicit dummy_cache_balancer_t(uint64_t _base_mem_per_store) :
-        base_mem_per_store_(_base_mem_per_store) { }
+    explicit dummy_cache_balancer_t(
+            uint64_t _base_mem_per_store,
+            eviction_policy_kind_t _eviction_policy = eviction_policy_kind_t::sample) :
+        base_mem_per_store_(_base_mem_per_store),
+        eviction_policy_(_eviction_policy) { }
     ~dummy_cache_balancer_t() { }
 
     uint64_t base_mem_per_store() const {
@@ -54,11 +62,16 @@ public:
         return false;
     }
 
+    eviction_policy_kind_t eviction_policy() const {
+        return eviction_policy_;
+    }
+
 private:
     void add_evicter(alt::evicter_t *) { }
     void remove_evicter(alt::evicter_t *) { }
 
     uint64_t base_mem_per_store_;
+    eviction_policy_kind_t eviction_policy_;
 
     DISABLE_COPYING(dummy_cache_balancer_t);
 };
@@ -72,7 +85,9 @@ class alt_cache_balancer_t :
     public repeating_timer_callback_t
 {
 public:
-    explicit alt_cache_balancer_t(uint64_t _total_cache_size);
+    explicit alt_cache_balancer_t(
+            uint64_t _total_cache_size,
+            eviction_policy_kind_t _eviction_policy = eviction_policy_kind_t::sample);
     ~alt_cache_balancer_t();
 
     uint64_t base_mem_per_store() const {
@@ -83,6 +98,10 @@ public:
         return true;
     }
 
+    eviction_policy_kind_t eviction_policy() const {
+        return eviction_policy_kind;
+    }
+
 private:
     friend class alt::evicter_t;
 
@@ -134,6 +153,7 @@ private:
                                    bool new_read_ahead_ok);
 
     const uint64_t total_cache_size;
+    const eviction_policy_kind_t eviction_policy_kind;
     repeating_timer_t rebalance_timer;
     microtime_t last_rebalance_time;
     bool read_ahead_ok;
@@ -4,6 +4,7 @@
 #include "buffer_cache/alt/page.hpp"
 #include "buffer_cache/alt/page_cache.hpp"
 #include "buffer_cache/alt/cache_balancer.hpp"
+#include "buffer_cache/alt/stats.hpp"
 
 namespace alt {
 
@@ -12,6 +13,7 @@ evicter_t::evicter_t()
       page_cache_(NULL),
       balancer_(NULL),
       throttler_(NULL),
+      stats_(NULL),
       bytes_loaded_counter_(0),
       access_count_counter_(0),
       access_time_counter_(INITIAL_ACCESS_TIME),
@@ -27,13 +29,16 @@ evicter_t::~evicter_t() {
 
 void evicter_t::initialize(page_cache_t *page_cache,
                            cache_balancer_t *balancer,
-                           alt_txn_throttler_t *throttler) {
+                           alt_txn_throttler_t *throttler,
+                           alt_cache_stats_t *stats) {
     guarantee(balancer != NULL);
     initialized_ = true;  // Can you really say this class is 'initialized_'?
     page_cache_ = page_cache;
     memory_limit_ = balancer->base_mem_per_store();
     page_cache_ = page_cache;
     throttler_ = throttler;
+    stats_ = stats;
+    policy_ = make_eviction_policy(balancer->eviction_policy());
     balancer_ = balancer;
     balancer_->add_evicter(this);
     throttler_->inform_memory_limit_change(memory_limit_,
@@ -88,6 +93,7 @@ void evicter_t::notify_bytes_loading(int64_t in_memory_buf_change) {
 void evicter_t::add_deferred_loaded(page_t *page) {
     assert_thread();
     guarantee(initialized_);
+    policy_->page_loading(page);
     evicted_.add(page, page->hypothetical_memory_usage(page_cache_));
 }
 
@@ -101,6 +107,7 @@ void evicter_t::catch_up_deferred_load(page_t *page) {
 void evicter_t::add_not_yet_loaded(page_t *page) {
     assert_thread();
     guarantee(initialized_);
+    policy_->page_loading(page);
     unevictable_.add(page, page->hypothetical_memory_usage(page_cache_));
     evict_if_necessary();
     notify_bytes_loading(page->hypothetical_memory_usage(page_cache_));
@@ -109,9 +116,21 @@ void evicter_t::add_not_yet_loaded(page_t *page) {
 void evicter_t::reloading_page(page_t *page) {
     assert_thread();
     guarantee(initialized_);
+    rassert(unevictable_.has_page(page));
+    policy_->page_loading(page);
     notify_bytes_loading(page->hypothetical_memory_usage(page_cache_));
 }
 
+void evicter_t::page_accessed(page_t *page, bool hit) {
+    assert_thread();
+    guarantee(initialized_);
+    rassert(unevictable_.has_page(page));
+    policy_->page_accessed(page);
+    if (stats_ != NULL) {
+        stats_->pm_hit_ratio.record(hit ? 1.0 : 0.0);
+    }
+}
+
 bool evicter_t::page_is_in_unevictable_bag(page_t *page) const {
     assert_thread();
     guarantee(initialized_);
@@ -135,7 +154,7 @@ void evicter_t::add_to_evictable_unbacked(page_t *page) {
 void evicter_t::add_to_evictable_disk_backed(page_t *page) {
     assert_thread();
     guarantee(initialized_);
-    evictable_disk_backed_.add(page, page->hypothetical_memory_usage(page_cache_));
+    policy_->bag_for(page)->add(page, page->hypothetical_memory_usage(page_cache_));
     evict_if_necessary();
     notify_bytes_loading(page->hypothetical_memory_usage(page_cache_));
 }
@@ -146,8 +165,7 @@ void evicter_t::move_unevictable_to_evictable(page_t *page) {
     rassert(unevictable_.has_page(page));
     unevictable_.remove(page, page->hypothetical_memory_usage(page_cache_));
     eviction_bag_t *new_bag = correct_eviction_category(page);
-    rassert(new_bag == &evictable_disk_backed_
-            || new_bag == &evictable_unbacked_);
+    rassert(new_bag != &unevictable_ && new_bag != &evicted_);
     new_bag->add(page, page->hypothetical_memory_usage(page_cache_));
     evict_if_necessary();
 }
@@ -171,7 +189,7 @@ eviction_bag_t *evicter_t::correct_eviction_category(page_t *page) {
     } else if (!page->is_loaded()) {
         return &evicted_;
     } else if (page->is_disk_backed()) {
-        return &evictable_disk_backed_;
+        return policy_->bag_for(page);
     } else {
         return &evictable_unbacked_;
     }
@@ -190,7 +208,7 @@ uint64_t evicter_t::in_memory_size() const {
     assert_thread();
     guarantee(initialized_);
     return unevictable_.size()
-        + evictable_disk_backed_.size()
+        + policy_->size()
         + evictable_unbacked_.size();
 }
 
@@ -212,8 +230,8 @@ void evicter_t::evict_if_necessary() THROWS_NOTHING {
     evict_if_necessary_active_ = true;
     page_t *page;
     while (in_memory_size() > memory_limit_
-           && evictable_disk_backed_.remove_oldish(&page, access_time_counter_,
-                                                   page_cache_)) {
+           && policy_->remove_victim(&page, access_time_counter_, memory_limit_,
+                                     page_cache_)) {
         evicted_.add(page, page->hypothetical_memory_usage(page_cache_));
         page->evict_self(page_cache_);
         page_cache_->consider_evicting_current_page(page->block_id());
@@ -6,12 +6,14 @@
 #include <functional>
 
 #include "buffer_cache/alt/eviction_bag.hpp"
+#include "buffer_cache/alt/eviction_policy.hpp"
 #include "concurrency/cache_line_padded.hpp"
 #include "concurrency/pubsub.hpp"
 #include "threading.hpp"
 
 class cache_balancer_t;
 class alt_txn_throttler_t;
+class alt_cache_stats_t;
 
 namespace alt {
 
@@ -33,14 +35,19 @@ public:
     eviction_bag_t *evicted_category() { return &evicted_; }
     void remove_page(page_t *page);
     void reloading_page(page_t *page);
+    // Called whenever a page gets acquired, after it has been made unevictable.
+    // `hit` tells whether the page was in memory already.
+    void page_accessed(page_t *page, bool hit);
 
     // Evicter will be unusable until initialize is called
     explicit evicter_t();
     ~evicter_t();
 
+    // `stats` may be NULL.
     void initialize(page_cache_t *page_cache,
                     cache_balancer_t *balancer,
-                    alt_txn_throttler_t *throttler);
+                    alt_txn_throttler_t *throttler,
+                    alt_cache_stats_t *stats);
     void update_memory_limit(uint64_t new_memory_limit,
                              uint64_t bytes_loaded_accounted_for,
                              uint64_t access_count_accounted_for,
@@ -74,6 +81,7 @@ private:
     page_cache_t *page_cache_;
     cache_balancer_t *balancer_;
     alt_txn_throttler_t *throttler_;
+    alt_cache_stats_t *stats_;
 
     uint64_t memory_limit_;
 
@@ -90,9 +98,10 @@ private:
     // It avoids reentrant calls to that function.
     bool evict_if_necessary_active_;
 
-    // These track every page's eviction status.
+    // These track every page's eviction status.  The evictable disk-backed pages
+    // are kept in the bags of `policy_`, which is chosen by the cache balancer.
     eviction_bag_t unevictable_;
-    eviction_bag_t evictable_disk_backed_;
+    scoped_ptr_t<eviction_policy_t> policy_;
     eviction_bag_t evictable_unbacked_;
     eviction_bag_t evicted_;
 
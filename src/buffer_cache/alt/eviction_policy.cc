@@ -0,0 +1,133 @@
+#include "buffer_cache/alt/eviction_policy.hpp"
+
+#include <algorithm>
+
+#include "buffer_cache/alt/page.hpp"
+#include "buffer_cache/alt/page_cache.hpp"
+
+// A page moves to the protected bag after this many acquisitions.
+static const uint8_t TWO_QUEUE_PROMOTE_ACCESS_COUNT = 2;
+
+// The protected bag may use at most this fraction of the memory limit.
+static const double TWO_QUEUE_MAX_PROTECTED_FRACTION = 0.75;
+
+// We remember as many evicted pages as would fit into this fraction of the memory
+// limit, but at least `TWO_QUEUE_MIN_GHOSTS`.
+static const double TWO_QUEUE_GHOST_FRACTION = 0.5;
+static const size_t TWO_QUEUE_MIN_GHOSTS = 64;
+
+const char *eviction_policy_name(eviction_policy_kind_t kind) {
+    switch (kind) {
+    case eviction_policy_kind_t::sample: return "sample";
+    case eviction_policy_kind_t::two_queue: return "2q";
+    default: unreachable();
+    }
+}
+
+bool parse_eviction_policy_name(const std::string &name,
+                                eviction_policy_kind_t *kind_out) {
+    if (name == "sample") {
+        *kind_out = eviction_policy_kind_t::sample;
+    } else if (name == "2q") {
+        *kind_out = eviction_policy_kind_t::two_queue;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace alt {
+
+scoped_ptr_t<eviction_policy_t> make_eviction_policy(eviction_policy_kind_t kind) {
+    switch (kind) {
+    case eviction_policy_kind_t::sample:
+        return scoped_ptr_t<eviction_policy_t>(new sample_eviction_policy_t);
+    case eviction_policy_kind_t::two_queue:
+        return scoped_ptr_t<eviction_policy_t>(new two_queue_eviction_policy_t);
+    default:
+        unreachable();
+    }
+}
+
+eviction_bag_t *sample_eviction_policy_t::bag_for(page_t *) {
+    return &bag_;
+}
+
+uint64_t sample_eviction_policy_t::size() const {
+    return bag_.size();
+}
+
+bool sample_eviction_policy_t::remove_victim(page_t **page_out,
+                                             uint64_t access_time_offset,
+                                             uint64_t,
+                                             page_cache_t *page_cache) {
+    return bag_.remove_oldish(page_out, access_time_offset, page_cache);
+}
+
+eviction_bag_t *two_queue_eviction_policy_t::bag_for(page_t *page) {
+    return page->eviction_state()->is_protected ? &protected_ : &probation_;
+}
+
+uint64_t two_queue_eviction_policy_t::size() const {
+    return probation_.size() + protected_.size();
+}
+
+void two_queue_eviction_policy_t::page_accessed(page_t *page) {
+    page_eviction_state_t *state = page->eviction_state();
+    if (state->access_count < UINT8_MAX) {
+        ++state->access_count;
+    }
+    if (state->access_count >= TWO_QUEUE_PROMOTE_ACCESS_COUNT) {
+        state->is_protected = true;
+    }
+}
+
+void two_queue_eviction_policy_t::page_loading(page_t *page) {
+    if (ghost_counts_.count(page->block_id()) != 0) {
+        // We evicted the page not long ago, so it's used more than once after all.
+        page->eviction_state()->is_protected = true;
+    }
+}
+
+bool two_queue_eviction_policy_t::remove_victim(page_t **page_out,
+                                                uint64_t access_time_offset,
+                                                uint64_t memory_limit,
+                                                page_cache_t *page_cache) {
+    // Demote protected pages until the protected bag is within its share of the
+    // memory limit, so that the probationary bag always has room for new pages.
+    const uint64_t max_protected_size =
+        static_cast<uint64_t>(memory_limit * TWO_QUEUE_MAX_PROTECTED_FRACTION);
+    page_t *page;
+    while (protected_.size() > max_protected_size
+           && protected_.remove_oldish(&page, access_time_offset, page_cache)) {
+        page->eviction_state()->is_protected = false;
+        page->eviction_state()->access_count = 0;
+        probation_.add(page, page->hypothetical_memory_usage(page_cache));
+    }
+
+    if (probation_.remove_oldish(page_out, access_time_offset, page_cache)) {
+        const uint64_t ghost_capacity =
+            static_cast<uint64_t>(memory_limit * TWO_QUEUE_GHOST_FRACTION)
+            / page_cache->max_block_size().ser_value();
+        remember_evicted((*page_out)->block_id(),
+                         std::max<uint64_t>(ghost_capacity, TWO_QUEUE_MIN_GHOSTS));
+        return true;
+    }
+    return protected_.remove_oldish(page_out, access_time_offset, page_cache);
+}
+
+void two_queue_eviction_policy_t::remember_evicted(block_id_t block_id,
+                                                   size_t capacity) {
+    ghost_fifo_.push_back(block_id);
+    ++ghost_counts_[block_id];
+    while (ghost_fifo_.size() > capacity) {
+        auto it = ghost_counts_.find(ghost_fifo_.front());
+        rassert(it != ghost_counts_.end());
+        if (--it->second == 0) {
+            ghost_counts_.erase(it);
+        }
+        ghost_fifo_.pop_front();
+    }
+}
+
+}  // namespace alt
@@ -0,0 +1,132 @@
+#ifndef BUFFER_CACHE_ALT_EVICTION_POLICY_HPP_
+#define BUFFER_CACHE_ALT_EVICTION_POLICY_HPP_
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "buffer_cache/alt/eviction_bag.hpp"
+#include "containers/scoped.hpp"
+#include "serializer/types.hpp"
+
+// Decides which pages a cache evicts first when it's over its memory limit.
+enum class eviction_policy_kind_t {
+    // Evicts the least recently used of a few randomly sampled pages.
+    sample,
+    // Evicts pages that have only been used once before pages that have been used
+    // repeatedly, so that a large scan or backfill can't push the working set out
+    // of the cache.  This is a sampling variant of the "2Q" policy.
+    two_queue
+};
+
+const char *eviction_policy_name(eviction_policy_kind_t kind);
+MUST_USE bool parse_eviction_policy_name(const std::string &name,
+                                         eviction_policy_kind_t *kind_out);
+
+namespace alt {
+
+class page_t;
+class page_cache_t;
+
+// The per-page state that eviction policies may use.  It's kept in the `page_t`.
+struct page_eviction_state_t {
+    page_eviction_state_t() : access_count(0), is_protected(false) { }
+
+    // How many times the page has been acquired while in memory, saturating.
+    uint8_t access_count;
+    // Set if the page has been promoted out of the probationary bag.
+    bool is_protected;
+};
+
+// An eviction policy sorts the pages that the evicter may evict (the ones that are
+// loaded, disk-backed and not in use) into one or more `eviction_bag_t`s, and
+// picks victims among them.  Which bag a page is in must be a function of its
+// state, because `evicter_t` looks the bag up again when the page leaves it.  So
+// policies only change a page's `page_eviction_state_t` while the page is in none
+// of their bags, or when they move the page between their bags themselves.
+class eviction_policy_t {
+public:
+    virtual ~eviction_policy_t() { }
+
+    // The bag that an evictable, disk-backed page belongs in.
+    virtual eviction_bag_t *bag_for(page_t *page) = 0;
+
+    // The total size of the policy's bags.
+    virtual uint64_t size() const = 0;
+
+    // Called when a page gets acquired.  The page is not in any of our bags.
+    virtual void page_accessed(page_t *page) = 0;
+
+    // Called when a page that isn't in memory is about to be loaded.  The page is
+    // not in any of our bags.
+    virtual void page_loading(page_t *page) = 0;
+
+    // Picks a page to evict and removes it from its bag.  Returns false if there
+    // are no evictable pages.
+    virtual bool remove_victim(page_t **page_out,
+                               uint64_t access_time_offset,
+                               uint64_t memory_limit,
+                               page_cache_t *page_cache) = 0;
+};
+
+scoped_ptr_t<eviction_policy_t> make_eviction_policy(eviction_policy_kind_t kind);
+
+class sample_eviction_policy_t : public eviction_policy_t {
+public:
+    sample_eviction_policy_t() { }
+
+    eviction_bag_t *bag_for(page_t *page);
+    uint64_t size() const;
+    void page_accessed(page_t *) { }
+    void page_loading(page_t *) { }
+    bool remove_victim(page_t **page_out,
+                       uint64_t access_time_offset,
+                       uint64_t memory_limit,
+                       page_cache_t *page_cache);
+
+private:
+    eviction_bag_t bag_;
+
+    DISABLE_COPYING(sample_eviction_policy_t);
+};
+
+// New pages start out in the probationary bag, and pages that get acquired a
+// second time while in memory move to the protected bag when they're released.
+// Victims come from the probationary bag whenever it isn't empty.  We remember the
+// block ids of recently evicted probationary pages, and a page that gets loaded
+// again while it's still remembered goes straight to the protected bag.  The
+// protected bag may only take up a fraction of the memory limit; beyond that, its
+// oldest pages get demoted.
+class two_queue_eviction_policy_t : public eviction_policy_t {
+public:
+    two_queue_eviction_policy_t() { }
+    ~two_queue_eviction_policy_t() { }
+
+    eviction_bag_t *bag_for(page_t *page);
+    uint64_t size() const;
+    void page_accessed(page_t *page);
+    void page_loading(page_t *page);
+    bool remove_victim(page_t **page_out,
+                       uint64_t access_time_offset,
+                       uint64_t memory_limit,
+                       page_cache_t *page_cache);
+
+private:
+    void remember_evicted(block_id_t block_id, size_t capacity);
+
+    eviction_bag_t probation_;
+    eviction_bag_t protected_;
+
+    // The block ids of recently evicted probationary pages, oldest first, and how
+    // often each of them appears in `ghost_fifo_`.
+    std::deque<block_id_t> ghost_fifo_;
+    std::unordered_map<block_id_t, uint32_t> ghost_counts_;
+
+    DISABLE_COPYING(two_queue_eviction_policy_t);
+};
+
+}  // namespace alt
+
+#endif  // BUFFER_CACHE_ALT_EVICTION_POLICY_HPP_
@@ -402,6 +402,7 @@ void page_t::add_waiter(page_acq_t *acq, cache_account_t *account) {
         = acq->page_cache()->evicter().correct_eviction_category(this);
     waiters_.push_back(acq);
     acq->page_cache()->evicter().change_to_correct_eviction_bag(old_bag, this);
+    acq->page_cache()->evicter().page_accessed(this, buf_.has());
     if (buf_.has()) {
         acq->buf_ready_signal_.pulse();
     } else if (loader_ != NULL) {
@@ -2,6 +2,7 @@
 #define BUFFER_CACHE_ALT_PAGE_HPP_
 
 #include "concurrency/cond_var.hpp"
+#include "buffer_cache/alt/eviction_policy.hpp"
 #include "containers/backindex_bag.hpp"
 #include "repli_timestamp.hpp"
 #include "serializer/buf_ptr.hpp"
@@ -55,6 +56,9 @@ public:
     uint32_t hypothetical_memory_usage(page_cache_t *page_cache) const;
     uint64_t access_time() const { return access_time_; }
 
+    // Belongs to the evicter's `eviction_policy_t`.
+    page_eviction_state_t *eviction_state() { return &eviction_state_; }
+
     bool is_loading() const {
         return loader_ != NULL && page_t::loader_is_loading(loader_);
     }
@@ -146,7 +150,8 @@ private:
     // if loader_ is non-null:  unevictable_pages_
     // else if waiters_ is non-empty: unevictable_pages_
     // else if buf_ is null: evicted_pages_ (and block_token_ is non-null)
-    // else if block_token_ is non-null: evictable_disk_backed_pages_
+    // else if block_token_ is non-null: the eviction policy's bag for the page
+    // (which may depend on eviction_state_)
     // else: evictable_unbacked_pages_ (buf_ is non-null, block_token_ is null)
     //
     // So, when loader_, waiters_, buf_, or block_token_ is touched, we might
@@ -155,6 +160,8 @@ private:
     // The logic above is implemented in page_cache_t::correct_eviction_category.
     backindex_bag_index_t eviction_index_;
 
+    page_eviction_state_t eviction_state_;
+
     DISABLE_COPYING(page_t);
 };
 
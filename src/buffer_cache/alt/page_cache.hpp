@@ -26,6 +26,7 @@
 #include "serializer/types.hpp"
 
 class alt_txn_throttler_t;
+class alt_cache_stats_t;
 class cache_balancer_t;
 class auto_drainer_t;
 class cache_t;
@@ -309,9 +310,11 @@ class page_cache_index_write_sink_t;
 
 class page_cache_t : public home_thread_mixin_t {
 public:
+    // `stats` may be NULL.
     page_cache_t(serializer_t *serializer,
                  cache_balancer_t *balancer,
-                 alt_txn_throttler_t *throttler);
+                 alt_txn_throttler_t *throttler,
+                 alt_cache_stats_t *stats = NULL);
     ~page_cache_t();
 
     // Takes a txn to be flushed.  Calls on_flush_complete() (which resets the
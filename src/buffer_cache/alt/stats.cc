@@ -3,8 +3,16 @@
 
 #include "perfmon/perfmon.hpp"
 
-alt_cache_stats_t::alt_cache_stats_t(perfmon_collection_t *parent)
+alt_cache_stats_t::alt_cache_stats_t(perfmon_collection_t *parent,
+                                     eviction_policy_kind_t eviction_policy)
     : cache_collection(),
       cache_membership(parent, &cache_collection, "cache"),
+      pm_hit_ratio(secs_to_ticks(1), false),
+      pm_hit_ratio_membership(&cache_collection, &pm_hit_ratio,
+                              std::string("hit_ratio_")
+                              + eviction_policy_name(eviction_policy)),
+      pm_acquire_latency(secs_to_ticks(1)),
+      pm_acquire_latency_membership(&cache_collection, &pm_acquire_latency,
+                                    "acquire_latency"),
       cache_collection_membership(&cache_collection) { }
 
@@ -2,11 +2,13 @@
 #ifndef BUFFER_CACHE_ALT_STATS_HPP_
 #define BUFFER_CACHE_ALT_STATS_HPP_
 
+#include "buffer_cache/alt/eviction_policy.hpp"
 #include "perfmon/perfmon.hpp"
 
 class alt_cache_stats_t {
 public:
-    explicit alt_cache_stats_t(perfmon_collection_t *parent);
+    alt_cache_stats_t(perfmon_collection_t *parent,
+                      eviction_policy_kind_t eviction_policy);
 
     perfmon_collection_t cache_collection;
     perfmon_membership_t cache_membership;
@@ -15,6 +17,17 @@ public:
       LSI: insert perfmons here
     */
 
+    // Records 1 for every page acquisition that finds the page in memory, and 0
+    // for every one that has to wait for it to be loaded.  Its name includes the
+    // eviction policy, so that the results of different policies can be compared.
+    perfmon_sampler_t pm_hit_ratio;
+    perfmon_membership_t pm_hit_ratio_membership;
+
+    // How long `buf_read_t` and `buf_write_t` wait for their block the first time
+    // they get its data, which includes waiting for the lock and loading the block.
+    perfmon_latency_histogram_t pm_acquire_latency;
+    perfmon_membership_t pm_acquire_latency_membership;
+
     perfmon_multi_membership_t cache_collection_membership;
 };
 
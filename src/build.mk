@@ -212,7 +212,7 @@ ifeq ($(SERIALIZER_DEBUG),1)
 endif
 
 ifeq ($(LEGACY_LINUX),1)
-  RT_CXXFLAGS += -DLEGACY_LINUX -DNO_EPOLL -Wno-format
+  RT_CXXFLAGS += -DLEGACY_LINUX -DNO_EPOLL -DNO_IO_URING -Wno-format
 endif
 
 ifeq ($(LEGACY_GCC),1)
@@ -227,6 +227,10 @@ ifeq ($(NO_EPOLL),1)
   RT_CXXFLAGS += -DNO_EPOLL
 endif
 
+ifeq ($(NO_IO_URING),1)
+  RT_CXXFLAGS += -DNO_IO_URING
+endif
+
 ifeq ($(THREADED_COROUTINES),1)
   RT_CXXFLAGS += -DTHREADED_COROUTINES
 endif
@@ -252,25 +252,25 @@ admin_cluster_link_t::admin_cluster_link_t(const peer_address_set_t &joins,
     log_writer(&local_issue_tracker), // TODO: come up with something else for this file
     connectivity_cluster(),
     message_multiplexer(&connectivity_cluster),
-    heartbeat_manager_client(&message_multiplexer, 'H'),
+    heartbeat_manager_client(&message_multiplexer, 'H', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL),
     heartbeat_manager(&heartbeat_manager_client),
     heartbeat_manager_client_run(&heartbeat_manager_client, &heartbeat_manager),
     mailbox_manager_client(&message_multiplexer, 'M'),
-    mailbox_manager(&mailbox_manager_client),
+    mailbox_manager(&mailbox_manager_client, &get_global_perfmon_collection()),
     mailbox_manager_client_run(&mailbox_manager_client, &mailbox_manager),
     stat_manager(&mailbox_manager),
     log_server(&mailbox_manager, &log_writer),
-    semilattice_manager_client(&message_multiplexer, 'S'),
+    semilattice_manager_client(&message_multiplexer, 'S', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL),
     semilattice_manager_cluster(new semilattice_manager_t<cluster_semilattice_metadata_t>(&semilattice_manager_client, cluster_semilattice_metadata_t())),
     semilattice_manager_client_run(&semilattice_manager_client, semilattice_manager_cluster.get()),
     cluster_metadata_view(semilattice_manager_cluster->get_root_view()),
     metadata_change_handler(&mailbox_manager, cluster_metadata_view),
-    auth_manager_client(&message_multiplexer, 'A'),
+    auth_manager_client(&message_multiplexer, 'A', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL),
     auth_manager_cluster(new semilattice_manager_t<auth_semilattice_metadata_t>(&auth_manager_client, auth_semilattice_metadata_t())),
     auth_manager_client_run(&auth_manager_client, auth_manager_cluster.get()),
     auth_metadata_view(auth_manager_cluster->get_root_view()),
     auth_change_handler(&mailbox_manager, auth_metadata_view),
-    directory_manager_client(&message_multiplexer, 'D'),
+    directory_manager_client(&message_multiplexer, 'D', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL),
     our_directory_metadata(cluster_directory_metadata_t(machine_id_t(connectivity_cluster.get_me().get_uuid()),
                                                         connectivity_cluster.get_me(),
                                                         0, // No cache = no cache size
@@ -2009,6 +2009,8 @@ namespace_id_t admin_cluster_link_t::do_admin_create_table_internal(const name_s
     obj->primary_pinnings.upgrade_version(change_request_id);
     obj->database.get_mutable() = database;
     obj->database.upgrade_version(change_request_id);
+    obj->cpu_shards.get_mutable() = default_cpu_shards();
+    obj->cpu_shards.upgrade_version(change_request_id);
 
     return id;
 }
@@ -680,6 +680,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
                           const name_string_t &machine_name,
                           const file_direct_io_mode_t direct_io_mode,
                           const int max_concurrent_io_requests,
+                          const io_backend_t io_backend,
                           bool *const result_out) {
     machine_id_t our_machine_id = generate_uuid();
 
@@ -691,7 +692,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
     machine_semilattice_metadata.datacenter = vclock_t<datacenter_id_t>(nil_uuid(), our_machine_id);
     cluster_metadata.machines.machines.insert(std::make_pair(our_machine_id, make_deletable(machine_semilattice_metadata)));
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, io_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -776,7 +777,11 @@ void run_rethinkdb_serve(const base_path_t &base_path,
                          serve_info_t *serve_info,
                          const file_direct_io_mode_t direct_io_mode,
                          const int max_concurrent_io_requests,
+                         const io_backend_t io_backend,
                          const uint64_t total_cache_size,
+                         const eviction_policy_kind_t cache_eviction_policy,
+                         const uint64_t btree_block_size,
+                         const gc_policy_t gc_policy,
                          const machine_id_t *our_machine_id,
                          const cluster_semilattice_metadata_t *cluster_metadata,
                          directory_lock_t *data_directory_lock,
@@ -806,7 +811,7 @@ void run_rethinkdb_serve(const base_path_t &base_path,
 
     logINF("Loading data from directory %s\n", base_path.path().c_str());
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, io_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -850,6 +855,9 @@ void run_rethinkdb_serve(const base_path_t &base_path,
                             cluster_metadata_file.get(),
                             auth_metadata_file.get(),
                             total_cache_size,
+                            cache_eviction_policy,
+                            btree_block_size,
+                            gc_policy,
                             *serve_info,
                             &sigint_cond);
 
@@ -866,14 +874,20 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
                              const name_string_t &machine_name,
                              const file_direct_io_mode_t direct_io_mode,
                              const int max_concurrent_io_requests,
+                             const io_backend_t io_backend,
                              const uint64_t total_cache_size,
+                             const eviction_policy_kind_t cache_eviction_policy,
+                             const uint64_t btree_block_size,
+                             const gc_policy_t gc_policy,
                              const bool new_directory,
                              serve_info_t *serve_info,
                              directory_lock_t *data_directory_lock,
                              bool *const result_out) {
     if (!new_directory) {
         run_rethinkdb_serve(base_path, serve_info, direct_io_mode,
-                            max_concurrent_io_requests, total_cache_size,
+                            max_concurrent_io_requests, io_backend, total_cache_size,
+                            cache_eviction_policy, btree_block_size,
+                            gc_policy,
                             NULL, NULL, data_directory_lock,
                             result_out);
     } else {
@@ -906,7 +920,9 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
         }
 
         run_rethinkdb_serve(base_path, serve_info, direct_io_mode,
-                            max_concurrent_io_requests, total_cache_size,
+                            max_concurrent_io_requests, io_backend, total_cache_size,
+                            cache_eviction_policy, btree_block_size,
+                            gc_policy,
                             &our_machine_id, &cluster_metadata,
                             data_directory_lock, result_out);
     }
@@ -957,12 +973,36 @@ options::help_section_t get_file_options(std::vector<options::option_t> *options
                                              strprintf("%d", DEFAULT_MAX_CONCURRENT_IO_REQUESTS)));
     help.add("--io-threads n",
              "how many simultaneous I/O operations can happen at the same time");
+    options_out->push_back(options::option_t(options::names_t("--io-backend"),
+                                             options::OPTIONAL,
+                                             "pool"));
+    help.add("--io-backend {pool|uring}",
+             "run disk I/O on a thread pool, or submit it through io_uring (Linux only)");
     options_out->push_back(options::option_t(options::names_t("--no-direct-io"),
                                              options::OPTIONAL_NO_PARAMETER));
     help.add("--no-direct-io", "disable direct I/O");
+    options_out->push_back(options::option_t(options::names_t("--gc-policy"),
+                                             options::OPTIONAL,
+                                             "greedy"));
+    help.add("--gc-policy {greedy|cost-benefit}",
+             "collect the data extents with the most garbage first, or also weigh "
+             "how long the live data in them has gone without being rewritten");
     options_out->push_back(options::option_t(options::names_t("--cache-size"),
                                              options::OPTIONAL));
     help.add("--cache-size mb", "total cache size (in megabytes) for the process");
+    options_out->push_back(options::option_t(options::names_t("--cache-eviction"),
+                                             options::OPTIONAL,
+                                             "sample"));
+    help.add("--cache-eviction {sample|2q}",
+             "evict the least recently used of a random sample of pages, or evict "
+             "pages that were used only once first");
+    options_out->push_back(options::option_t(options::names_t("--btree-block-size"),
+                                             options::OPTIONAL,
+                                             strprintf("%lld",
+                                                       DEFAULT_BTREE_BLOCK_SIZE / KILOBYTE)));
+    help.add("--btree-block-size kb",
+             "the size (in kilobytes) of the btree blocks of new table files; larger "
+             "blocks store larger documents inline");
     return help;
 }
 
@@ -1062,6 +1102,11 @@ options::help_section_t get_network_options(const bool join_required, std::vecto
                                              strprintf("%d", port_defaults::peer_port)));
     help.add("--cluster-port port", "port for receiving connections from other nodes");
 
+    options_out->push_back(options::option_t(options::names_t("--cluster-compression"),
+                                             options::OPTIONAL,
+                                             "none"));
+    help.add("--cluster-compression {none | deflate}", "compress messages to other nodes; only takes effect between nodes that both enable it");
+
     options_out->push_back(options::option_t(options::names_t("--client-port"),
                                              options::OPTIONAL,
                                              strprintf("%d", port_defaults::client_port)));
@@ -1289,6 +1334,72 @@ MUST_USE bool parse_io_threads_option(const std::map<std::string, options::value
     return true;
 }
 
+MUST_USE bool parse_io_backend_option(const std::map<std::string, options::values_t> &opts,
+                                      io_backend_t *io_backend_out) {
+    const std::string io_backend = get_single_option(opts, "--io-backend");
+    if (io_backend == "pool") {
+        *io_backend_out = io_backend_t::pool;
+    } else if (io_backend == "uring") {
+        *io_backend_out = io_backend_t::uring;
+    } else {
+        fprintf(stderr, "ERROR: io-backend must be either 'pool' or 'uring'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_cluster_compression_option(
+        const std::map<std::string, options::values_t> &opts,
+        cluster_compression_t *compression_out) {
+    const std::string compression = get_single_option(opts, "--cluster-compression");
+    if (compression == "none") {
+        *compression_out = cluster_compression_t::NONE;
+    } else if (compression == "deflate") {
+        *compression_out = cluster_compression_t::DEFLATE;
+    } else {
+        fprintf(stderr, "ERROR: cluster-compression must be either 'none' or 'deflate'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_cache_eviction_option(
+        const std::map<std::string, options::values_t> &opts,
+        eviction_policy_kind_t *policy_out) {
+    const std::string policy = get_single_option(opts, "--cache-eviction");
+    if (!parse_eviction_policy_name(policy, policy_out)) {
+        fprintf(stderr, "ERROR: cache-eviction must be either 'sample' or '2q'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_gc_policy_option(const std::map<std::string, options::values_t> &opts,
+                                     gc_policy_t *policy_out) {
+    const std::string policy = get_single_option(opts, "--gc-policy");
+    if (!parse_gc_policy_name(policy, policy_out)) {
+        fprintf(stderr, "ERROR: gc-policy must be either 'greedy' or 'cost-benefit'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_btree_block_size_option(
+        const std::map<std::string, options::values_t> &opts,
+        uint64_t *block_size_out) {
+    const int kb = get_single_int(opts, "--btree-block-size");
+    // Powers of two divide the extent size evenly.
+    if (kb < DEFAULT_BTREE_BLOCK_SIZE / KILOBYTE || kb > MAX_BTREE_BLOCK_SIZE / KILOBYTE
+        || (kb & (kb - 1)) != 0) {
+        fprintf(stderr, "ERROR: btree-block-size must be a power of two between "
+                "%lld and %lld\n",
+                DEFAULT_BTREE_BLOCK_SIZE / KILOBYTE, MAX_BTREE_BLOCK_SIZE / KILOBYTE);
+        return false;
+    }
+    *block_size_out = static_cast<uint64_t>(kb) * KILOBYTE;
+    return true;
+}
+
 file_direct_io_mode_t parse_direct_io_mode_option(const std::map<std::string, options::values_t> &opts) {
     return exists_option(opts, "--no-direct-io") ?
         file_direct_io_mode_t::buffered_desired :
@@ -1323,6 +1434,11 @@ int main_rethinkdb_create(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
         const int num_workers = get_cpu_count();
 
         bool is_new_directory = false;
@@ -1346,6 +1462,7 @@ int main_rethinkdb_create(int argc, char *argv[]) {
                                      machine_name,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      &result),
                            num_workers);
 
@@ -1436,8 +1553,33 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
+        cluster_compression_t cluster_compression;
+        if (!parse_cluster_compression_option(opts, &cluster_compression)) {
+            return EXIT_FAILURE;
+        }
+
         uint64_t total_cache_size = get_total_cache_size(opts);
 
+        eviction_policy_kind_t cache_eviction_policy;
+        if (!parse_cache_eviction_option(opts, &cache_eviction_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        gc_policy_t gc_policy;
+        if (!parse_gc_policy_option(opts, &gc_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        uint64_t btree_block_size;
+        if (!parse_btree_block_size_option(opts, &btree_block_size)) {
+            return EXIT_FAILURE;
+        }
+
         // Open and lock the directory, but do not create it
         bool is_new_directory = false;
         directory_lock_t data_directory_lock(base_path, false, &is_new_directory);
@@ -1467,7 +1609,8 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                 get_reql_http_proxy_option(opts),
                                 std::move(web_path),
                                 address_ports,
-                                get_optional_option(opts, "--config-file"));
+                                get_optional_option(opts, "--config-file"),
+                                cluster_compression);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
 
@@ -1477,7 +1620,11 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                      &serve_info,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      total_cache_size,
+                                     cache_eviction_policy,
+                                     btree_block_size,
+                                     gc_policy,
                                      static_cast<machine_id_t*>(NULL),
                                      static_cast<cluster_semilattice_metadata_t*>(NULL),
                                      &data_directory_lock,
@@ -1560,6 +1707,11 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        cluster_compression_t cluster_compression;
+        if (!parse_cluster_compression_option(opts, &cluster_compression)) {
+            return EXIT_FAILURE;
+        }
+
         get_and_set_user_group(opts);
 
         // Default to putting the log file in the current working directory
@@ -1588,7 +1740,8 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
                                 get_reql_http_proxy_option(opts),
                                 std::move(web_path),
                                 address_ports,
-                                get_optional_option(opts, "--config-file"));
+                                get_optional_option(opts, "--config-file"),
+                                cluster_compression);
 
         bool result;
         run_in_thread_pool(std::bind(&run_rethinkdb_proxy, &serve_info, &result),
@@ -1699,8 +1852,33 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
+        cluster_compression_t cluster_compression;
+        if (!parse_cluster_compression_option(opts, &cluster_compression)) {
+            return EXIT_FAILURE;
+        }
+
         uint64_t total_cache_size = get_total_cache_size(opts);
 
+        eviction_policy_kind_t cache_eviction_policy;
+        if (!parse_cache_eviction_option(opts, &cache_eviction_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        gc_policy_t gc_policy;
+        if (!parse_gc_policy_option(opts, &gc_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        uint64_t btree_block_size;
+        if (!parse_btree_block_size_option(opts, &btree_block_size)) {
+            return EXIT_FAILURE;
+        }
+
         // Attempt to create the directory early so that the log file can use it.
         // If we create the file, it will be cleaned up unless directory_initialized()
         // is called on it.  This will be done after the metadata files have been created.
@@ -1740,7 +1918,8 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                 get_reql_http_proxy_option(opts),
                                 std::move(web_path),
                                 address_ports,
-                                get_optional_option(opts, "--config-file"));
+                                get_optional_option(opts, "--config-file"),
+                                cluster_compression);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
 
@@ -1750,7 +1929,11 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                      machine_name,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      total_cache_size,
+                                     cache_eviction_policy,
+                                     btree_block_size,
+                                     gc_policy,
                                      is_new_directory,
                                      &serve_info,
                                      &data_directory_lock,
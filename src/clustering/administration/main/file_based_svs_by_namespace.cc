@@ -8,6 +8,7 @@
 #include "clustering/reactor/reactor.hpp"
 #include "rdb_protocol/store.hpp"
 #include "serializer/config.hpp"
+#include "serializer/log/lba/index_snapshot.hpp"
 #include "serializer/translator.hpp"
 #include "serializer/merger.hpp"
 #include "utils.hpp"
@@ -83,6 +84,7 @@ void
 file_based_svs_by_namespace_t::get_svs(
             perfmon_collection_t *serializers_perfmon_collection,
             namespace_id_t namespace_id,
+            int cpu_shards,
             stores_lifetimer_t *stores_out,
             scoped_ptr_t<multistore_ptr_t> *svs_out,
             rdb_context_t *ctx) {
@@ -98,7 +100,10 @@ file_based_svs_by_namespace_t::get_svs(
     // TODO: We should use N slices on M serializers, not N slices
     // on N serializers.
 
-    const int num_stores = CPU_SHARDING_FACTOR;
+    guarantee(cpu_shards > 0 && cpu_shards <= MAX_CPU_SHARDING_FACTOR,
+              "Table %s has an invalid number of CPU shards (%d) in its metadata.",
+              uuid_to_str(namespace_id).c_str(), cpu_shards);
+    const int num_stores = cpu_shards;
     scoped_array_t<scoped_ptr_t<store_t> > *stores_out_stores
         = stores_out->stores();
     stores_out_stores->init(num_stores);
@@ -122,6 +127,9 @@ file_based_svs_by_namespace_t::get_svs(
                                 namespace_id, balancer_,
                                 serializers_perfmon_collection, ctx);
         filepath_file_opener_t file_opener(serializer_filepath, io_backender_);
+        standard_serializer_t::dynamic_config_t serializer_config;
+        serializer_config.index_snapshot = true;
+        serializer_config.gc_policy = gc_policy_;
         if (res == 0) {
             // TODO: Could we handle failure when loading the serializer?  Right
             // now, we don't.
@@ -129,7 +137,7 @@ file_based_svs_by_namespace_t::get_svs(
             {
                 scoped_ptr_t<serializer_t> ser
                     = make_scoped<standard_serializer_t>(
-                        standard_serializer_t::dynamic_config_t(),
+                        serializer_config,
                         &file_opener,
                         serializers_perfmon_collection);
                 ser = make_scoped<merger_serializer_t>(std::move(ser),
@@ -141,6 +149,15 @@ file_based_svs_by_namespace_t::get_svs(
             ptrs.push_back(serializer.get());
             multiplexer.init(new serializer_multiplexer_t(ptrs));
 
+            // Every replica must split the table the same way, or their reactors
+            // won't find each other's roles.
+            const int file_cpu_shards = multiplexer->proxies.size();
+            guarantee(file_cpu_shards == num_stores,
+                      "Table file %s is split into %d CPU shards, but the table's "
+                      "metadata says that every replica has %d of them.",
+                      serializer_filepath.permanent_path().c_str(),
+                      file_cpu_shards, num_stores);
+
             // TODO: Exceptions?  Can exceptions happen, and then
             // store_views' values would leak.  That is, are we handling
             // them in the pmap?  No.
@@ -150,12 +167,13 @@ file_based_svs_by_namespace_t::get_svs(
                                          stores_out_stores, store_views.data()));
             mptr.init(new multistore_ptr_t(store_views.data(), num_stores));
         } else {
-            standard_serializer_t::create(&file_opener,
-                                          standard_serializer_t::static_config_t());
+            standard_serializer_t::static_config_t static_config;
+            static_config.block_size_ = btree_block_size_;
+            standard_serializer_t::create(&file_opener, static_config);
             {
                 scoped_ptr_t<serializer_t> ser
                     = make_scoped<standard_serializer_t>(
-                        standard_serializer_t::dynamic_config_t(),
+                        serializer_config,
                         &file_opener,
                         serializers_perfmon_collection);
                 ser = make_scoped<merger_serializer_t>(std::move(ser),
@@ -210,6 +228,9 @@ void file_based_svs_by_namespace_t::destroy_svs(namespace_id_t namespace_id) {
     const int res = ::unlink(filepath.c_str());
     guarantee_err(res == 0 || get_errno() == ENOENT,
                   "unlink failed for file %s", filepath.c_str());
+    remove_index_snapshot(
+        filepath_file_opener_t(file_name_for(namespace_id), io_backender_)
+            .index_snapshot_file_name());
 }
 
 serializer_filepath_t file_based_svs_by_namespace_t::file_name_for(namespace_id_t namespace_id) {
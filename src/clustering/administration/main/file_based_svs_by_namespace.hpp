@@ -5,20 +5,28 @@
 #include <string>
 
 #include "clustering/administration/reactor_driver.hpp"
+#include "serializer/log/config.hpp"
 
 class cache_balancer_t;
 class rdb_context_t;
 
 class file_based_svs_by_namespace_t : public svs_by_namespace_t {
 public:
+    // The btrees of new table files use blocks of `btree_block_size` bytes.
+    // Existing files keep what they were created with.  The serializers of all
+    // tables pick their data block GC victims with `gc_policy`.
     file_based_svs_by_namespace_t(io_backender_t *io_backender,
                                   cache_balancer_t *balancer,
-                                  const base_path_t& base_path)
+                                  const base_path_t& base_path,
+                                  uint64_t btree_block_size,
+                                  gc_policy_t gc_policy)
         : io_backender_(io_backender), balancer_(balancer),
-          base_path_(base_path), thread_counter_(0) { }
+          base_path_(base_path), btree_block_size_(btree_block_size),
+          gc_policy_(gc_policy), thread_counter_(0) { }
 
     void get_svs(perfmon_collection_t *serializers_perfmon_collection,
                  namespace_id_t namespace_id,
+                 int cpu_shards,
                  stores_lifetimer_t *stores_out,
                  scoped_ptr_t<multistore_ptr_t> *svs_out,
                  rdb_context_t *);
@@ -31,6 +39,8 @@ private:
     io_backender_t *io_backender_;
     cache_balancer_t *balancer_;
     const base_path_t base_path_;
+    const uint64_t btree_block_size_;
+    const gc_policy_t gc_policy_;
 
     threadnum_t next_thread(int num_db_threads);
     int thread_counter_; // should only be used by `next_thread`
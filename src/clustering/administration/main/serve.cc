@@ -81,6 +81,9 @@ bool do_serve(io_backender_t *io_backender,
               metadata_persistence::cluster_persistent_file_t *cluster_metadata_file,
               metadata_persistence::auth_persistent_file_t *auth_metadata_file,
               uint64_t total_cache_size,
+              eviction_policy_kind_t cache_eviction_policy,
+              uint64_t btree_block_size,
+              gc_policy_t gc_policy,
               const serve_info_t &serve_info,
               os_signal_cond_t *stop_cond) {
     try {
@@ -108,19 +111,19 @@ bool do_serve(io_backender_t *io_backender,
         connectivity_cluster_t connectivity_cluster;
         message_multiplexer_t message_multiplexer(&connectivity_cluster);
 
-        message_multiplexer_t::client_t heartbeat_manager_client(&message_multiplexer, 'H', SEMAPHORE_NO_LIMIT);
+        message_multiplexer_t::client_t heartbeat_manager_client(&message_multiplexer, 'H', SEMAPHORE_NO_LIMIT, traffic_class_t::CONTROL);
         heartbeat_manager_t heartbeat_manager(&heartbeat_manager_client);
         message_multiplexer_t::client_t::run_t heartbeat_manager_client_run(&heartbeat_manager_client, &heartbeat_manager);
 
         message_multiplexer_t::client_t mailbox_manager_client(&message_multiplexer, 'M');
-        mailbox_manager_t mailbox_manager(&mailbox_manager_client);
+        mailbox_manager_t mailbox_manager(&mailbox_manager_client, &get_global_perfmon_collection());
         message_multiplexer_t::client_t::run_t mailbox_manager_client_run(&mailbox_manager_client, &mailbox_manager);
 
-        message_multiplexer_t::client_t semilattice_manager_client(&message_multiplexer, 'S');
+        message_multiplexer_t::client_t semilattice_manager_client(&message_multiplexer, 'S', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL);
         semilattice_manager_t<cluster_semilattice_metadata_t> semilattice_manager_cluster(&semilattice_manager_client, cluster_metadata);
         message_multiplexer_t::client_t::run_t semilattice_manager_client_run(&semilattice_manager_client, &semilattice_manager_cluster);
 
-        message_multiplexer_t::client_t auth_manager_client(&message_multiplexer, 'A');
+        message_multiplexer_t::client_t auth_manager_client(&message_multiplexer, 'A', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL);
         semilattice_manager_t<auth_semilattice_metadata_t> auth_manager_cluster(&auth_manager_client, auth_metadata);
         message_multiplexer_t::client_t::run_t auth_manager_client_run(&auth_manager_client, &auth_manager_cluster);
 
@@ -147,7 +150,7 @@ bool do_serve(io_backender_t *io_backender,
 
         watchable_variable_t<cluster_directory_metadata_t> our_root_directory_variable(*initial_directory);
 
-        message_multiplexer_t::client_t directory_manager_client(&message_multiplexer, 'D');
+        message_multiplexer_t::client_t directory_manager_client(&message_multiplexer, 'D', DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD, traffic_class_t::CONTROL);
         directory_write_manager_t<cluster_directory_metadata_t> directory_write_manager(&directory_manager_client, our_root_directory_variable.get_watchable());
         directory_read_manager_t<cluster_directory_metadata_t> directory_read_manager(connectivity_cluster.get_connectivity_service());
         message_multiplexer_t::client_t::run_t directory_manager_client_run(&directory_manager_client, &directory_read_manager);
@@ -168,7 +171,9 @@ bool do_serve(io_backender_t *io_backender,
                 serve_info.ports.port,
                 &message_multiplexer_run,
                 serve_info.ports.client_port,
-                &heartbeat_manager));
+                &heartbeat_manager,
+                CLUSTER_CONNECTIONS_PER_PEER,
+                serve_info.cluster_compression));
 
             // Update the directory with the ip addresses that we are passing to peers
             std::set<ip_and_port_t> ips = connectivity_cluster_run->get_ips();
@@ -249,7 +254,9 @@ bool do_serve(io_backender_t *io_backender,
                               &reql_admin_interface,
                               auth_manager_cluster.get_root_view(),
                               &get_global_perfmon_collection(),
-                              serve_info.reql_http_proxy);
+                              serve_info.reql_http_proxy,
+                              io_backender,
+                              base_path);
 
         namespace_repo_t rdb_namespace_repo(&mailbox_manager,
             metadata_field(&cluster_semilattice_metadata_t::rdb_namespaces,
@@ -266,7 +273,8 @@ bool do_serve(io_backender_t *io_backender,
 
             if (i_am_a_server) {
                 // Proxies do not have caches to balance
-                cache_balancer.init(new alt_cache_balancer_t(total_cache_size));
+                cache_balancer.init(new alt_cache_balancer_t(total_cache_size,
+                                                             cache_eviction_policy));
             }
 
             // Reactor drivers
@@ -279,7 +287,8 @@ bool do_serve(io_backender_t *io_backender,
 
             if (i_am_a_server) {
                 rdb_svs_source.init(new file_based_svs_by_namespace_t(
-                    io_backender, cache_balancer.get(), base_path));
+                    io_backender, cache_balancer.get(), base_path,
+                    btree_block_size, gc_policy));
                 rdb_reactor_driver.init(new reactor_driver_t(
                         base_path,
                         io_backender,
@@ -414,6 +423,9 @@ bool serve(io_backender_t *io_backender,
            metadata_persistence::cluster_persistent_file_t *cluster_persistent_file,
            metadata_persistence::auth_persistent_file_t *auth_persistent_file,
            uint64_t total_cache_size,
+           eviction_policy_kind_t cache_eviction_policy,
+           uint64_t btree_block_size,
+           gc_policy_t gc_policy,
            const serve_info_t &serve_info,
            os_signal_cond_t *stop_cond) {
     return do_serve(io_backender,
@@ -422,6 +434,9 @@ bool serve(io_backender_t *io_backender,
                     cluster_persistent_file,
                     auth_persistent_file,
                     total_cache_size,
+                    cache_eviction_policy,
+                    btree_block_size,
+                    gc_policy,
                     serve_info,
                     stop_cond);
 }
@@ -436,6 +451,9 @@ bool serve_proxy(const serve_info_t &serve_info,
                     NULL,
                     NULL,
                     0,
+                    eviction_policy_kind_t::sample,
+                    DEFAULT_BTREE_BLOCK_SIZE,
+                    gc_policy_t::greedy,
                     serve_info,
                     stop_cond);
 }
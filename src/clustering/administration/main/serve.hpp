@@ -10,6 +10,9 @@
 #include "clustering/administration/metadata.hpp"
 #include "clustering/administration/persist.hpp"
 #include "arch/address.hpp"
+#include "buffer_cache/alt/eviction_policy.hpp"
+#include "rpc/connectivity/compression.hpp"
+#include "serializer/log/config.hpp"
 
 class os_signal_cond_t;
 
@@ -92,12 +95,14 @@ public:
                  std::string &&_reql_http_proxy,
                  std::string &&_web_assets,
                  service_address_ports_t _ports,
-                 boost::optional<std::string> _config_file) :
+                 boost::optional<std::string> _config_file,
+                 cluster_compression_t _cluster_compression) :
         joins(std::move(_joins)),
         reql_http_proxy(std::move(_reql_http_proxy)),
         web_assets(std::move(_web_assets)),
         ports(_ports),
-        config_file(_config_file)
+        config_file(_config_file),
+        cluster_compression(_cluster_compression)
     { }
 
     void look_up_peers() {
@@ -110,6 +115,7 @@ public:
     std::string web_assets;
     service_address_ports_t ports;
     boost::optional<std::string> config_file;
+    cluster_compression_t cluster_compression;
 };
 
 /* This has been factored out from `command_line.hpp` because it takes a very
@@ -120,6 +126,9 @@ bool serve(io_backender_t *io_backender,
            metadata_persistence::cluster_persistent_file_t *cluster_persistent_file,
            metadata_persistence::auth_persistent_file_t *auth_persistent_file,
            uint64_t total_cache_size,
+           eviction_policy_kind_t cache_eviction_policy,
+           uint64_t btree_block_size,
+           gc_policy_t gc_policy,
            const serve_info_t &serve_info,
            os_signal_cond_t *stop_cond);
 
@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "clustering/administration/metadata.hpp"
 
+#include <algorithm>
+
 #include "clustering/administration/database_metadata.hpp"
 #include "clustering/administration/datacenter_metadata.hpp"
 #include "clustering/administration/machine_metadata.hpp"
@@ -12,6 +14,7 @@
 #include "rdb_protocol/protocol.hpp"
 #include "region/region_map_json_adapter.hpp"
 #include "stl_utils.hpp"
+#include "threading.hpp"
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(database_semilattice_metadata_t, name);
 RDB_IMPL_SEMILATTICE_JOINABLE_1(database_semilattice_metadata_t, name);
@@ -39,18 +42,64 @@ RDB_IMPL_EQUALITY_COMPARABLE_1(machines_semilattice_metadata_t, machines);
 
 RDB_IMPL_ME_SERIALIZABLE_2_SINCE_v1_13(ack_expectation_t, expectation_, hard_durability_);
 
-RDB_IMPL_SERIALIZABLE_10_SINCE_v1_13(namespace_semilattice_metadata_t,
-                                     blueprint, primary_datacenter, replica_affinities,
-                                     ack_expectations, shards, name, primary_pinnings,
-                                     secondary_pinnings, primary_key, database);
-RDB_IMPL_SEMILATTICE_JOINABLE_10(
+template <cluster_version_t W>
+void serialize(write_message_t *wm, const namespace_semilattice_metadata_t &ns) {
+    serialize<W>(wm, ns.blueprint);
+    serialize<W>(wm, ns.primary_datacenter);
+    serialize<W>(wm, ns.replica_affinities);
+    serialize<W>(wm, ns.ack_expectations);
+    serialize<W>(wm, ns.shards);
+    serialize<W>(wm, ns.name);
+    serialize<W>(wm, ns.primary_pinnings);
+    serialize<W>(wm, ns.secondary_pinnings);
+    serialize<W>(wm, ns.primary_key);
+    serialize<W>(wm, ns.database);
+    serialize<W>(wm, ns.cpu_shards);
+}
+
+template <cluster_version_t W>
+archive_result_t deserialize(read_stream_t *s, namespace_semilattice_metadata_t *ns) {
+    archive_result_t res = deserialize<W>(s, &ns->blueprint);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->primary_datacenter);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->replica_affinities);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->ack_expectations);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->shards);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->name);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->primary_pinnings);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->secondary_pinnings);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->primary_key);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &ns->database);
+    if (bad(res)) { return res; }
+    if (W == cluster_version_t::v1_13 || W == cluster_version_t::v1_13_2) {
+        // Every replica of a table from before 1.14 has the same fixed number of
+        // CPU shards, so they all agree on this unversioned value.
+        ns->cpu_shards = vclock_t<int32_t>(CPU_SHARDING_FACTOR);
+    } else {
+        res = deserialize<W>(s, &ns->cpu_shards);
+        if (bad(res)) { return res; }
+    }
+    return archive_result_t::SUCCESS;
+}
+
+INSTANTIATE_SERIALIZABLE_SINCE_v1_13(namespace_semilattice_metadata_t);
+
+RDB_IMPL_SEMILATTICE_JOINABLE_11(
         namespace_semilattice_metadata_t,
         blueprint, primary_datacenter, replica_affinities, ack_expectations, shards,
-        name, primary_pinnings, secondary_pinnings, primary_key, database);
-RDB_IMPL_EQUALITY_COMPARABLE_10(
+        name, primary_pinnings, secondary_pinnings, primary_key, database, cpu_shards);
+RDB_IMPL_EQUALITY_COMPARABLE_11(
         namespace_semilattice_metadata_t,
         blueprint, primary_datacenter, replica_affinities, ack_expectations, shards,
-        name, primary_pinnings, secondary_pinnings, primary_key, database);
+        name, primary_pinnings, secondary_pinnings, primary_key, database, cpu_shards);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(namespaces_semilattice_metadata_t, namespaces);
 RDB_IMPL_SEMILATTICE_JOINABLE_1(namespaces_semilattice_metadata_t, namespaces);
@@ -80,13 +129,14 @@ RDB_IMPL_SERIALIZABLE_11_SINCE_v1_13(cluster_directory_metadata_t,
 
 namespace_semilattice_metadata_t new_namespace(
     uuid_u machine, uuid_u database, uuid_u datacenter,
-    const name_string_t &name, const std::string &key) {
+    const name_string_t &name, const std::string &key, int32_t cpu_shards) {
 
     namespace_semilattice_metadata_t ns;
     ns.database           = make_vclock(database, machine);
     ns.primary_datacenter = make_vclock(datacenter, machine);
     ns.name               = make_vclock(name, machine);
     ns.primary_key        = make_vclock(key, machine);
+    ns.cpu_shards         = make_vclock(cpu_shards, machine);
 
     std::map<uuid_u, ack_expectation_t> ack_expectations;
     ack_expectations[datacenter] = ack_expectation_t(1, true);
@@ -107,6 +157,10 @@ namespace_semilattice_metadata_t new_namespace(
     return ns;
 }
 
+int32_t default_cpu_shards() {
+    return std::min(get_num_db_threads(), MAX_CPU_SHARDING_FACTOR);
+}
+
 
 bool ack_expectation_t::operator==(ack_expectation_t other) const {
     return expectation_ == other.expectation_ && hard_durability_ == other.hard_durability_;
@@ -341,6 +395,7 @@ json_adapter_if_t::json_adapter_map_t with_ctx_get_json_subfields(namespace_semi
     res["secondary_pinnings"] = boost::shared_ptr<json_adapter_if_t>(new json_vclock_adapter_t<region_map_t<std::set<machine_id_t> > >(&target->secondary_pinnings, ctx));
     res["primary_key"] = boost::shared_ptr<json_adapter_if_t>(new json_vclock_adapter_t<std::string>(&target->primary_key, ctx));
     res["database"] = boost::shared_ptr<json_adapter_if_t>(new json_vclock_adapter_t<database_id_t>(&target->database, ctx));
+    res["cpu_shards"] = boost::shared_ptr<json_adapter_if_t>(new json_ctx_read_only_adapter_t<vclock_t<int32_t>, vclock_ctx_t>(&target->cpu_shards, ctx));
     return res;
 }
 
@@ -373,6 +428,7 @@ inline json_adapter_if_t::json_adapter_map_t with_ctx_get_json_subfields(namespa
     default_namespace.primary_datacenter = default_namespace.primary_datacenter.make_new_version(nil_uuid(), ctx.us);
 
     default_namespace.primary_key = default_namespace.primary_key.make_new_version("id", ctx.us);
+    default_namespace.cpu_shards = default_namespace.cpu_shards.make_new_version(default_cpu_shards(), ctx.us);
 
     deletable_t<namespace_semilattice_metadata_t> default_ns_in_deletable(default_namespace);
     return json_ctx_adapter_with_inserter_t<namespaces_semilattice_metadata_t::namespace_map_t, vclock_ctx_t>(&target->namespaces, generate_uuid, ctx, default_ns_in_deletable).get_subfields();
@@ -16,6 +16,7 @@
 #include "clustering/reactor/directory_echo.hpp"
 #include "clustering/reactor/reactor_json_adapters.hpp"
 #include "clustering/reactor/metadata.hpp"
+#include "config/args.hpp"
 #include "containers/cow_ptr.hpp"
 #include "containers/name_string.hpp"
 #include "containers/uuid.hpp"
@@ -60,7 +61,7 @@ void debug_print(printf_buffer_t *buf, const ack_expectation_t &x);
 
 class namespace_semilattice_metadata_t {
 public:
-    namespace_semilattice_metadata_t() { }
+    namespace_semilattice_metadata_t() : cpu_shards(CPU_SHARDING_FACTOR) { }
 
     vclock_t<persistable_blueprint_t> blueprint;
     vclock_t<datacenter_id_t> primary_datacenter;
@@ -72,6 +73,10 @@ public:
     vclock_t<region_map_t<std::set<machine_id_t> > > secondary_pinnings;
     vclock_t<std::string> primary_key; //TODO this should actually never be changed...
     vclock_t<database_id_t> database;
+    /* The number of CPU shards that every replica splits the table into.  It's
+    set when the table is created and never changes, because the reactors of
+    different servers match their roles by the CPU-sharded regions. */
+    vclock_t<int32_t> cpu_shards;
 };
 
 RDB_DECLARE_SERIALIZABLE(namespace_semilattice_metadata_t);
@@ -79,7 +84,11 @@ RDB_DECLARE_SERIALIZABLE(namespace_semilattice_metadata_t);
 
 namespace_semilattice_metadata_t new_namespace(
     uuid_u machine, uuid_u database, uuid_u datacenter,
-    const name_string_t &name, const std::string &key);
+    const name_string_t &name, const std::string &key, int32_t cpu_shards);
+
+/* The number of CPU shards of a new table whose creator doesn't pick one: one per
+core of this server, up to `MAX_CPU_SHARDING_FACTOR`. */
+int32_t default_cpu_shards();
 
 RDB_DECLARE_SEMILATTICE_JOINABLE(namespace_semilattice_metadata_t);
 
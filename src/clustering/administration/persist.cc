@@ -39,7 +39,7 @@ struct cluster_metadata_superblock_t {
 };
 
 // Etymology: (R)ethink(D)B (m)eta(d)ata
-// Yes, v1_13 magic is the same for both cluster and auth metadata.
+// Yes, the magic of each version is the same for both cluster and auth metadata.
 template <cluster_version_t>
 struct cluster_metadata_magic_t {
     static const block_magic_t value;
@@ -47,22 +47,33 @@ struct cluster_metadata_magic_t {
 
 template <>
 const block_magic_t
-    cluster_metadata_magic_t<cluster_version_t::v1_13_is_latest_disk>::value
+    cluster_metadata_magic_t<cluster_version_t::v1_13>::value
     = { { 'R', 'D', 'm', 'd' } };
 
+template <>
+const block_magic_t
+    cluster_metadata_magic_t<cluster_version_t::v1_14_is_latest_disk>::value
+    = { { 'R', 'D', 'm', 'e' } };
+
 template <cluster_version_t>
 struct auth_metadata_magic_t {
     static const block_magic_t value;
 };
 
 template <>
-const block_magic_t auth_metadata_magic_t<cluster_version_t::v1_13_is_latest_disk>::value
+const block_magic_t auth_metadata_magic_t<cluster_version_t::v1_13>::value
     = { { 'R', 'D', 'm', 'd' } };
 
+template <>
+const block_magic_t auth_metadata_magic_t<cluster_version_t::v1_14_is_latest_disk>::value
+    = { { 'R', 'D', 'm', 'e' } };
+
 cluster_version_t auth_superblock_version(const auth_metadata_superblock_t *sb) {
-    if (sb->magic
-        == auth_metadata_magic_t<cluster_version_t::v1_13_is_latest_disk>::value) {
-        return cluster_version_t::v1_13_is_latest_disk;
+    if (sb->magic == auth_metadata_magic_t<cluster_version_t::v1_13>::value) {
+        return cluster_version_t::v1_13;
+    } else if (sb->magic
+        == auth_metadata_magic_t<cluster_version_t::v1_14_is_latest_disk>::value) {
+        return cluster_version_t::v1_14_is_latest_disk;
     } else {
         crash("auth_metadata_superblock_t has invalid magic.");
     }
@@ -112,9 +123,11 @@ static void read_blob(cluster_version_t cluster_version,
 
 
 cluster_version_t cluster_superblock_version(const cluster_metadata_superblock_t *sb) {
-    if (sb->magic
-        == cluster_metadata_magic_t<cluster_version_t::v1_13_is_latest_disk>::value) {
-        return cluster_version_t::v1_13_is_latest_disk;
+    if (sb->magic == cluster_metadata_magic_t<cluster_version_t::v1_13>::value) {
+        return cluster_version_t::v1_13;
+    } else if (sb->magic
+        == cluster_metadata_magic_t<cluster_version_t::v1_14_is_latest_disk>::value) {
+        return cluster_version_t::v1_14_is_latest_disk;
     } else {
         crash("cluster_metadata_superblock_t has invalid magic.");
     }
@@ -134,6 +134,7 @@ public:
                             io_backender_t *io_backender,
                             reactor_driver_t *parent,
                             namespace_id_t namespace_id,
+                            int cpu_shards,
                             const blueprint_t &bp,
                             svs_by_namespace_t *svs_by_namespace,
                             rdb_context_t *_ctx) :
@@ -142,6 +143,7 @@ public:
         ctx(_ctx),
         parent_(parent),
         namespace_id_(namespace_id),
+        cpu_shards_(cpu_shards),
         svs_by_namespace_(svs_by_namespace)
     {
         coro_t::spawn_sometime(boost::bind(&watchable_and_reactor_t::initialize_reactor, this, io_backender));
@@ -319,7 +321,8 @@ private:
         perfmon_collection_t *serializers_collection = &perfmon_collections->serializers_collection;
 
         // TODO: We probably shouldn't have to pass in this perfmon collection.
-        svs_by_namespace_->get_svs(serializers_collection, namespace_id_, &stores_lifetimer_, &svs_, ctx);
+        svs_by_namespace_->get_svs(serializers_collection, namespace_id_, cpu_shards_,
+                                   &stores_lifetimer_, &svs_, ctx);
 
         auto const extract_reactor_directory_per_peer_fun =
             boost::bind(&watchable_and_reactor_t::extract_reactor_directory_per_peer,
@@ -366,6 +369,7 @@ private:
 
     reactor_driver_t *const parent_;
     const namespace_id_t namespace_id_;
+    const int cpu_shards_;
     svs_by_namespace_t *const svs_by_namespace_;
 
     stores_lifetimer_t stores_lifetimer_;
@@ -510,12 +514,14 @@ void reactor_driver_t::on_change() {
                 it->first));
         } else if (!it->second.is_deleted()) {
             const persistable_blueprint_t *pbp = NULL;
+            int cpu_shards;
 
             try {
                 pbp = &it->second.get_ref().blueprint.get_ref();
+                cpu_shards = it->second.get_ref().cpu_shards.get();
             } catch (const in_conflict_exc_t &) {
-                //Nothing to do for this namespaces, its blueprint is in
-                //conflict.
+                //Nothing to do for this namespaces, its blueprint or its
+                //number of CPU shards is in conflict.
                 continue;
             }
 
@@ -529,7 +535,7 @@ void reactor_driver_t::on_change() {
                     namespace_id_t tmp = it->first;
                     reactor_data.insert(
                             std::make_pair(tmp,
-                                           make_scoped<watchable_and_reactor_t>(base_path, io_backender, this, it->first, bp, svs_by_namespace, ctx)));
+                                           make_scoped<watchable_and_reactor_t>(base_path, io_backender, this, it->first, cpu_shards, bp, svs_by_namespace, ctx)));
                 } else {
                     struct op_closure_t {
                         static bool apply(const blueprint_t &_bp,
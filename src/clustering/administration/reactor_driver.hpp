@@ -51,7 +51,9 @@ private:
 
 class svs_by_namespace_t {
 public:
+    /* `cpu_shards` is the number of CPU shards in the table's metadata. */
     virtual void get_svs(perfmon_collection_t *perfmon_collection, namespace_id_t namespace_id,
+                         int cpu_shards,
                          stores_lifetimer_t *stores_out,
                          scoped_ptr_t<multistore_ptr_t> *svs_out,
                          rdb_context_t *) = 0;
@@ -182,7 +182,8 @@ bool cluster_reql_admin_interface_t::db_find(const name_string_t &name,
 
 bool cluster_reql_admin_interface_t::table_create(const name_string_t &name,
         counted_t<const ql::db_t> db, const boost::optional<name_string_t> &primary_dc,
-        bool hard_durability, const std::string &primary_key, signal_t *interruptor,
+        bool hard_durability, const std::string &primary_key,
+        const boost::optional<int32_t> &cpu_shards, signal_t *interruptor,
         uuid_u *namespace_id_out, std::string *error_out) {
     cluster_semilattice_metadata_t metadata;
     {
@@ -219,7 +220,8 @@ bool cluster_reql_admin_interface_t::table_create(const name_string_t &name,
 
         /* Construct a description of the new namespace */
         namespace_semilattice_metadata_t table = new_namespace(
-                my_machine_id, db->id, dc_id, name, primary_key);
+                my_machine_id, db->id, dc_id, name, primary_key,
+                cpu_shards ? *cpu_shards : default_cpu_shards());
         std::map<datacenter_id_t, ack_expectation_t> *ack_map =
                 &table.ack_expectations.get_mutable();
         for (auto pair : *ack_map) {
@@ -40,8 +40,8 @@ public:
 
     bool table_create(const name_string_t &name, counted_t<const ql::db_t> db,
             const boost::optional<name_string_t> &primary_dc, bool hard_durability,
-            const std::string &primary_key, signal_t *interruptor,
-            uuid_u *namespace_id_out, std::string *error_out);
+            const std::string &primary_key, const boost::optional<int32_t> &cpu_shards,
+            signal_t *interruptor, uuid_u *namespace_id_out, std::string *error_out);
     bool table_drop(const name_string_t &name, counted_t<const ql::db_t> db,
             signal_t *interruptor, std::string *error_out);
     bool table_list(counted_t<const ql::db_t> db,
@@ -88,7 +88,8 @@ bool backfiller_t::confirm_and_send_metainfo(region_map_t<binary_blob_t> metainf
     }
 
     /* Transmit `end_point` to the backfillee */
-    send(mailbox_manager, end_point_cont, end_point, branch_history);
+    send(mailbox_manager, end_point_cont.with_traffic_class(traffic_class_t::BACKFILL),
+         end_point, branch_history);
 
     return true;
 }
@@ -100,7 +101,8 @@ void do_send_chunk(mailbox_manager_t *mbox_manager,
                    co_semaphore_t *chunk_semaphore,
                    signal_t *interruptor) THROWS_ONLY(interrupted_exc_t) {
     chunk_semaphore->co_lock_interruptible(interruptor);
-    send(mbox_manager, chunk_addr, chunk, fifo_src->enter_write());
+    send(mbox_manager, chunk_addr.with_traffic_class(traffic_class_t::BACKFILL),
+         chunk, fifo_src->enter_write());
 }
 
 class backfiller_send_backfill_callback_t : public send_backfill_callback_t {
@@ -196,7 +198,8 @@ void backfiller_t::on_backfill(backfill_session_id_t session_id,
                      &interrupted);
 
         /* Send a confirmation */
-        send(mailbox_manager, done_cont, fifo_src.enter_write());
+        send(mailbox_manager, done_cont.with_traffic_class(traffic_class_t::BACKFILL),
+             fifo_src.enter_write());
 
     } catch (const interrupted_exc_t &) {
         /* Ignore. If we were interrupted by the backfillee, then it already
@@ -28,11 +28,14 @@
  * Basic configuration parameters.
  */
 
-// The number of hash-based CPU shards per table.
-// This "must" be hard-coded because a cluster cannot run with
-// differing cpu sharding factors.
+// The number of hash-based CPU shards of the tables that were created before a
+// table's metadata kept its own number of CPU shards.  New tables get one CPU shard
+// per core of the server that creates them, unless `table_create` says otherwise.
 #define CPU_SHARDING_FACTOR                       8
 
+// The most CPU shards a table may be split into.
+#define MAX_CPU_SHARDING_FACTOR                   64
+
 // Defines the maximum size of the batch of IO events to process on
 // each loop iteration. A larger number will increase throughput but
 // decrease concurrency
@@ -55,8 +58,10 @@
 // one account for writes, and one account for reads.
 // By adjusting the priorities of these accounts, reads
 // can be prioritized over writes or the other way around.
-#define CACHE_READS_IO_PRIORITY                   (512 / CPU_SHARDING_FACTOR)
-#define CACHE_WRITES_IO_PRIORITY                  (64 / CPU_SHARDING_FACTOR)
+// These are the priorities of all of the CPU shards of a table together.  The
+// translator_serializer_t of each CPU shard splits them by the real number of shards.
+#define CACHE_READS_IO_PRIORITY                   512
+#define CACHE_WRITES_IO_PRIORITY                  64
 
 // The cache priority to use for secondary index post construction
 // 100 = same priority as all other read operations in the cache together.
@@ -75,6 +80,14 @@
 // Size of each btree node (in bytes) on disk
 #define DEFAULT_BTREE_BLOCK_SIZE                  (4 * KILOBYTE)
 
+// The largest btree node size a table can be created with.  Leaf nodes address
+// their contents with 16-bit offsets.
+#define MAX_BTREE_BLOCK_SIZE                      (32 * KILOBYTE)
+
+// Btrees with larger nodes than the default store values of up to this fraction of
+// a node inline in their leaf nodes.
+#define BTREE_INLINE_VALUE_BLOCK_FRACTION         4
+
 // Size of each extent (in bytes)
 // This should not be too small, or garbage collection will become
 // inefficient (especially on rotational drives).
@@ -173,6 +186,44 @@
 // that the event we are waiting for has occurred in the meantime.
 #define REACTOR_RUN_UNTIL_SATISFIED_NAP           100
 
+// How many TCP connections to open to each peer in the cluster. Each one is homed
+// on a different thread, and outgoing messages are spread over them by traffic
+// class (see `traffic_class_t`), so there is no point in making this larger than
+// the number of traffic classes.
+#define CLUSTER_CONNECTIONS_PER_PEER              3
+
+// How long (in ms) to wait for a peer to open its additional connections to us
+// after the handshake on the first one, before giving up on the peer.
+#define CLUSTER_STRIPE_CONNECT_TIMEOUT_MS         10000
+
+// Messages that are sent to a peer while a write to its connection is in progress
+// are queued up and then written together with a single writev(). This caps the
+// number of bytes written at once, and with it the latency that batching can add
+// to a message: a message never waits for more than the batch that is in
+// progress when it's queued, plus the messages ahead of it in its own batch.
+#define CLUSTER_SEND_MAX_BATCH_SIZE               (256 * KILOBYTE)
+
+// On cluster connections that are compressed, messages smaller than this are sent
+// uncompressed; compressing them costs more CPU than it saves bandwidth.
+#define CLUSTER_COMPRESSION_MIN_MESSAGE_SIZE      512
+
+// Cursors opened with the `read_ahead` optarg compute their next batch while the
+// client is busy with the current one.  The batches that have been computed ahead
+// for all the cursors of one client connection take up at most about this much
+// memory; beyond that, cursors wait for CONTINUE again.  Each batch that is computed
+// ahead reserves up to CURSOR_PREFETCH_MAX_BATCH_SIZE of it before it starts, and
+// is cut off once it reaches its reservation.
+#define CURSOR_PREFETCH_MAX_MEMORY                (16 * MEGABYTE)
+#define CURSOR_PREFETCH_MAX_BATCH_SIZE            MEGABYTE
+
+// An unindexed `orderBy` keeps at most this much data in memory (unless the query's
+// `sort_memory_limit` optarg says otherwise) before it writes sorted runs to disk.
+#define SORT_DEFAULT_MEMORY_LIMIT                 (64 * MEGABYTE)
+
+// How many sorted runs an external sort merges at once.  As soon as it has written
+// this many runs of the same length, it merges them into one longer run.
+#define SORT_MAX_MERGE_FANIN                      16
+
 
 /**
  * Message scheduler configuration
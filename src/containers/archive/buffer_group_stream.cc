@@ -29,6 +29,24 @@ int64_t buffer_group_read_stream_t::read(void *p, int64_t n) {
     return original_n - n;
 }
 
+int64_t buffer_group_read_stream_t::skip(int64_t n) {
+    const int64_t original_n = n;
+
+    while (bufnum_ < group_->num_buffers() && n > 0) {
+        const_buffer_group_t::buffer_t buf = group_->get_buffer(bufnum_);
+        int64_t bytes_to_skip = std::min(buf.size - bufpos_, n);
+        n -= bytes_to_skip;
+        bufpos_ += bytes_to_skip;
+
+        if (bufpos_ == buf.size) {
+            ++bufnum_;
+            bufpos_ = 0;
+        }
+    }
+
+    return original_n - n;
+}
+
 bool buffer_group_read_stream_t::entire_stream_consumed() const {
     return bufnum_ == group_->num_buffers();
 }
@@ -16,6 +16,9 @@ public:
 
     virtual MUST_USE int64_t read(void *p, int64_t n);
 
+    // Like `read`, but doesn't copy the bytes anywhere.
+    MUST_USE int64_t skip(int64_t n);
+
     bool entire_stream_consumed() const;
 
 private:
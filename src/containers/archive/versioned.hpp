@@ -8,10 +8,10 @@ namespace archive_internal {
 
 // This is just used to implement serialize_cluster_version and
 // deserialize_cluster_version.  (cluster_version_t conveniently has a contiguous set
-// of valid representation, from v1_13 to v1_13_2_is_latest).
+// of valid representation, from v1_13 to v1_14_is_latest).
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(cluster_version_t, int8_t,
                                       cluster_version_t::v1_13,
-                                      cluster_version_t::v1_13_2_is_latest);
+                                      cluster_version_t::v1_14_is_latest);
 
 class bogus_made_up_type_t;
 
@@ -44,8 +44,11 @@ void serialize_for_version(cluster_version_t version, write_message_t *wm,
     case cluster_version_t::v1_13:
         serialize<cluster_version_t::v1_13>(wm, value);
         break;
-    case cluster_version_t::v1_13_2_is_latest:
-        serialize<cluster_version_t::v1_13_2_is_latest>(wm, value);
+    case cluster_version_t::v1_13_2:
+        serialize<cluster_version_t::v1_13_2>(wm, value);
+        break;
+    case cluster_version_t::v1_14_is_latest:
+        serialize<cluster_version_t::v1_14_is_latest>(wm, value);
         break;
     default:
         unreachable();
@@ -61,8 +64,10 @@ archive_result_t deserialize_for_version(cluster_version_t version,
     switch (version) {
     case cluster_version_t::v1_13:
         return deserialize<cluster_version_t::v1_13>(s, thing);
-    case cluster_version_t::v1_13_2_is_latest:
-        return deserialize<cluster_version_t::v1_13_2_is_latest>(s, thing);
+    case cluster_version_t::v1_13_2:
+        return deserialize<cluster_version_t::v1_13_2>(s, thing);
+    case cluster_version_t::v1_14_is_latest:
+        return deserialize<cluster_version_t::v1_14_is_latest>(s, thing);
     default:
         unreachable();
     }
@@ -80,8 +85,10 @@ size_t serialized_size_for_version(cluster_version_t version,
     switch (version) {
     case cluster_version_t::v1_13:
         return serialized_size<cluster_version_t::v1_13>(thing);
-    case cluster_version_t::v1_13_2_is_latest:
-        return serialized_size<cluster_version_t::v1_13_2_is_latest>(thing);
+    case cluster_version_t::v1_13_2:
+        return serialized_size<cluster_version_t::v1_13_2>(thing);
+    case cluster_version_t::v1_14_is_latest:
+        return serialized_size<cluster_version_t::v1_14_is_latest>(thing);
     default:
         unreachable();
     }
@@ -132,21 +139,26 @@ size_t serialized_size_for_version(cluster_version_t version,
             write_message_t *) const
 #endif
 
-#define INSTANTIATE_DESERIALIZE_SINCE_v1_13(typ)                                 \
-    template archive_result_t deserialize<cluster_version_t::v1_13>(             \
-            read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v1_13_2_is_latest>( \
+#define INSTANTIATE_DESERIALIZE_SINCE_v1_13(typ)                               \
+    template archive_result_t deserialize<cluster_version_t::v1_13>(           \
+            read_stream_t *, typ *);                                           \
+    template archive_result_t deserialize<cluster_version_t::v1_13_2>(         \
+            read_stream_t *, typ *);                                           \
+    template archive_result_t deserialize<cluster_version_t::v1_14_is_latest>( \
             read_stream_t *, typ *)
 
-#define INSTANTIATE_DESERIALIZE_SELF_SINCE_v1_13(typ)                                     \
-    template archive_result_t typ::rdb_deserialize<cluster_version_t::v1_13>(             \
-            read_stream_t *s);                                                            \
-    template archive_result_t typ::rdb_deserialize<cluster_version_t::v1_13_2_is_latest>( \
+#define INSTANTIATE_DESERIALIZE_SELF_SINCE_v1_13(typ)                                   \
+    template archive_result_t typ::rdb_deserialize<cluster_version_t::v1_13>(           \
+            read_stream_t *s);                                                          \
+    template archive_result_t typ::rdb_deserialize<cluster_version_t::v1_13_2>(         \
+            read_stream_t *s);                                                          \
+    template archive_result_t typ::rdb_deserialize<cluster_version_t::v1_14_is_latest>( \
             read_stream_t *s)
 
-#define INSTANTIATE_SERIALIZED_SIZE_SINCE_v1_13(typ)                                  \
-    template size_t serialized_size<cluster_version_t::v1_13>(const typ &)            \
-    template size_t serialized_size<cluster_version_t::v1_13_2_is_latest>(const typ &)
+#define INSTANTIATE_SERIALIZED_SIZE_SINCE_v1_13(typ)                                \
+    template size_t serialized_size<cluster_version_t::v1_13>(const typ &);         \
+    template size_t serialized_size<cluster_version_t::v1_13_2>(const typ &);       \
+    template size_t serialized_size<cluster_version_t::v1_14_is_latest>(const typ &)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v1_13(typ)        \
     INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(typ);     \
@@ -156,6 +168,14 @@ size_t serialized_size_for_version(cluster_version_t version,
     INSTANTIATE_SERIALIZE_SELF_FOR_CLUSTER_AND_DISK(typ); \
     INSTANTIATE_DESERIALIZE_SELF_SINCE_v1_13(typ)
 
+#define INSTANTIATE_DESERIALIZE_SINCE_v1_14(typ)                               \
+    template archive_result_t deserialize<cluster_version_t::v1_14_is_latest>( \
+            read_stream_t *, typ *)
+
+#define INSTANTIATE_SERIALIZABLE_SINCE_v1_14(typ)        \
+    INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(typ);     \
+    INSTANTIATE_DESERIALIZE_SINCE_v1_14(typ)
+
 #define INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(typ)                      \
     INSTANTIATE_SERIALIZE_FOR_CLUSTER(typ);                            \
     template archive_result_t deserialize<cluster_version_t::CLUSTER>( \
@@ -333,7 +333,7 @@ std::string url_encode_fields(CURL *curl_handle,
         return std::string();
     }
 
-    const std::map<std::string, counted_t<const ql::datum_t> > &fields_map =
+    const ql::datum_object_t &fields_map =
         fields->as_object();
     std::map<std::string, std::string> translated_fields;
 
@@ -639,7 +639,7 @@ v8::Handle<v8::Value> js_from_datum(const counted_t<const ql::datum_t> &datum) {
             return date;
         } else {
             v8::Handle<v8::Object> obj = v8::Object::New();
-            const std::map<std::string, counted_t<const ql::datum_t> > &source_map = datum->as_object();
+            const ql::datum_object_t &source_map = datum->as_object();
 
             for (auto it = source_map.begin(); it != source_map.end(); ++it) {
                 DECLARE_HANDLE_SCOPE(scope);
@@ -3,6 +3,7 @@
 
 #include <stdarg.h>
 #include <math.h>
+#include <string.h>
 #include <map>
 
 #include "utils.hpp"
@@ -18,6 +19,10 @@ static const char * stat_per_sec = "per_sec";
 static const char * stat_count = "count";
 static const char * stat_mean = "mean";
 static const char * stat_std_dev = "std_dev";
+static const char * stat_p50 = "p50";
+static const char * stat_p90 = "p90";
+static const char * stat_p99 = "p99";
+static const char * stat_p999 = "p999";
 static const char * no_value = "-";
 
 
@@ -289,6 +294,140 @@ scoped_ptr_t<perfmon_result_t> perfmon_rate_monitor_t::output_stat(const double
     return make_scoped<perfmon_result_t>(strprintf("%.8f", stat / ticks_to_secs(length)));
 }
 
+/* perfmon_latency_histogram_t */
+
+latency_histogram_t::latency_histogram_t() : count_(0), max_(0) {
+    memset(buckets_, 0, sizeof(buckets_));
+}
+
+int latency_histogram_t::bucket_index(ticks_t latency) {
+    if (latency < 2 * SUB_BUCKETS) {
+        return static_cast<int>(latency);
+    }
+    // The position of the highest set bit, which is at least `SUB_BUCKET_BITS + 1`.
+    const int magnitude = 63 - __builtin_clzll(latency);
+    if (magnitude >= MAX_LATENCY_BITS) {
+        return NUM_BUCKETS - 1;
+    }
+    const int shift = magnitude - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((latency >> shift) - SUB_BUCKETS);
+}
+
+ticks_t latency_histogram_t::bucket_upper_bound(int index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    } else if (index == NUM_BUCKETS - 1) {
+        // The last bucket also holds everything that's too large for the others.
+        return std::numeric_limits<ticks_t>::max();
+    }
+    const int shift = index / SUB_BUCKETS - 1;
+    const ticks_t sub_bucket = SUB_BUCKETS + index % SUB_BUCKETS;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void latency_histogram_t::record(ticks_t latency) {
+    ++buckets_[bucket_index(latency)];
+    ++count_;
+    max_ = std::max(max_, latency);
+}
+
+void latency_histogram_t::aggregate(const latency_histogram_t &other) {
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+}
+
+ticks_t latency_histogram_t::percentile(double quantile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, ceil(quantile * count_));
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_);
+        }
+    }
+    return max_;
+}
+
+perfmon_latency_histogram_t::perfmon_latency_histogram_t(ticks_t _length)
+    : perfmon_perthread_t<latency_histogram_t>(), length(_length) { }
+
+void perfmon_latency_histogram_t::update(thread_info_t *thread, ticks_t now) {
+    int interval = now / length;
+
+    if (thread->current_interval == interval) {
+        /* We're up to date; nothing to do */
+    } else if (thread->current_interval + 1 == interval) {
+        /* We're one step behind */
+        thread->last_histogram = thread->current_histogram;
+        thread->current_histogram = latency_histogram_t();
+        thread->current_interval++;
+    } else {
+        /* We're more than one step behind */
+        thread->last_histogram = thread->current_histogram = latency_histogram_t();
+        thread->current_interval = interval;
+    }
+}
+
+void perfmon_latency_histogram_t::record(ticks_t latency) {
+    ticks_t now = get_ticks();
+    rassert(get_thread_id().threadnum >= 0);
+    scoped_ptr_t<thread_info_t> *thread = &thread_data[get_thread_id().threadnum];
+    if (!thread->has()) {
+        thread->init(new thread_info_t);
+        (*thread)->current_interval = now / length;
+    }
+    update(thread->get(), now);
+    (*thread)->current_histogram.record(latency);
+}
+
+void perfmon_latency_histogram_t::get_thread_stat(latency_histogram_t *stat) {
+    rassert(get_thread_id().threadnum >= 0);
+    const scoped_ptr_t<thread_info_t> &thread = thread_data[get_thread_id().threadnum];
+    if (thread.has()) {
+        update(thread.get(), get_ticks());
+        /* Like `perfmon_sampler_t`, we report the last complete interval. */
+        *stat = thread->last_histogram;
+    }
+}
+
+latency_histogram_t perfmon_latency_histogram_t::combine_stats(
+        const latency_histogram_t *stats) {
+    latency_histogram_t aggregated;
+    for (int i = 0; i < get_num_threads(); i++) {
+        aggregated.aggregate(stats[i]);
+    }
+    return aggregated;
+}
+
+scoped_ptr_t<perfmon_result_t> perfmon_latency_histogram_t::output_stat(
+        const latency_histogram_t &aggregated) {
+    scoped_ptr_t<perfmon_result_t> stat = perfmon_result_t::alloc_map_result();
+
+    stat->insert(stat_count, new perfmon_result_t(strprintf("%" PRIu64, aggregated.count())));
+    const std::pair<const char *, double> percentiles[] = {
+        std::make_pair(stat_p50, 0.5),
+        std::make_pair(stat_p90, 0.9),
+        std::make_pair(stat_p99, 0.99),
+        std::make_pair(stat_p999, 0.999)
+    };
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); ++i) {
+        stat->insert(percentiles[i].first, new perfmon_result_t(aggregated.count() > 0
+            ? strprintf("%.8f", ticks_to_secs(aggregated.percentile(percentiles[i].second)))
+            : no_value));
+    }
+    stat->insert(stat_max, new perfmon_result_t(aggregated.count() > 0
+        ? strprintf("%.8f", ticks_to_secs(aggregated.max()))
+        : no_value));
+
+    return stat;
+}
+
 perfmon_duration_sampler_t::perfmon_duration_sampler_t(ticks_t length, bool _ignore_global_full_perfmon)
     : stat(), active(), total(), recent(length, true),
       active_membership(&stat, &active, "active_count"),
@@ -204,6 +204,87 @@ public:
     void record(double value = 1.0);
 };
 
+/* latency_histogram_t counts latencies in log-linear buckets, the way HDR
+ * histograms do: below `2 * SUB_BUCKETS` nanoseconds every value has its own
+ * bucket, and above that every power of two is split into `SUB_BUCKETS` equally
+ * wide buckets.  So a bucket is never wider than about 3% of the values in it,
+ * which is how accurate the percentiles are, and the histogram takes the same
+ * space no matter how many latencies it has seen.  Latencies of more than about a
+ * minute all go into the last bucket, but `max()` is exact.
+ */
+class latency_histogram_t {
+public:
+    latency_histogram_t();
+
+    void record(ticks_t latency);
+    void aggregate(const latency_histogram_t &other);
+
+    uint64_t count() const { return count_; }
+    ticks_t max() const { return max_; }
+    // The smallest latency that at least the fraction `quantile` of the recorded
+    // latencies don't exceed, rounded up to the end of its bucket.  0 if nothing
+    // has been recorded.
+    ticks_t percentile(double quantile) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_LATENCY_BITS = 36;
+    static const int NUM_BUCKETS = (MAX_LATENCY_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static int bucket_index(ticks_t latency);
+    static ticks_t bucket_upper_bound(int index);
+
+    uint64_t count_;
+    ticks_t max_;
+    uint64_t buckets_[NUM_BUCKETS];
+};
+
+/* perfmon_latency_histogram_t keeps a `latency_histogram_t` per thread and
+ * reports the percentiles of the latencies recorded during the last complete
+ * interval of `length` ticks, like `perfmon_sampler_t` does for its averages.  A
+ * thread's histograms are only allocated once it records something, since most
+ * of these perfmons (e.g. the per-table ones) only ever get used on one thread.
+ */
+class perfmon_latency_histogram_t : public perfmon_perthread_t<latency_histogram_t> {
+public:
+    explicit perfmon_latency_histogram_t(ticks_t length);
+    void record(ticks_t latency);
+
+private:
+    struct thread_info_t {
+        latency_histogram_t current_histogram, last_histogram;
+        int current_interval;
+    };
+
+    void update(thread_info_t *thread, ticks_t now);
+
+    void get_thread_stat(latency_histogram_t *);
+    latency_histogram_t combine_stats(const latency_histogram_t *);
+    scoped_ptr_t<perfmon_result_t> output_stat(const latency_histogram_t &);
+
+    const ticks_t length;
+    scoped_ptr_t<thread_info_t> thread_data[MAX_THREADS];
+
+    DISABLE_COPYING(perfmon_latency_histogram_t);
+};
+
+/* Records how long it lived in a `perfmon_latency_histogram_t`. */
+class block_pm_latency {
+public:
+    explicit block_pm_latency(perfmon_latency_histogram_t *_pm)
+        : start(get_ticks()), pm(_pm) { }
+    ~block_pm_latency() {
+        pm->record(get_ticks() - start);
+    }
+
+private:
+    const ticks_t start;
+    perfmon_latency_histogram_t *const pm;
+
+    DISABLE_COPYING(block_pm_latency);
+};
+
 /* perfmon_duration_sampler_t is a perfmon_t that monitors events that have a
  * starting and ending time. When something starts, call begin(); when
  * something ends, call end() with the same value as begin. It will produce
@@ -123,6 +123,17 @@ batchspec_t batchspec_t::with_at_most(uint64_t _max_els) const {
         start_time);
 }
 
+batchspec_t batchspec_t::with_max_size(int64_t _max_size) const {
+    return batchspec_t(
+        batch_type,
+        min_els,
+        max_els,
+        std::max<int64_t>(1, std::min(max_size, _max_size)),
+        first_scaledown_factor,
+        max_dur,
+        start_time);
+}
+
 batchspec_t batchspec_t::scale_down(int64_t divisor) const {
     // We divide by e.g. 7/8th of the divisor (assuming DIVISOR_SCALING_FACTOR == 8)
     // and add SCALE_CONSTANT to reduce the chances of needing a second round-trip
@@ -197,4 +208,16 @@ batcher_t::batcher_t(
 
 size_t array_size_limit() { return 100000; }
 
+size_t sort_memory_limit(env_t *env) {
+    counted_t<val_t> v = env->global_optargs.get_optarg(env, "sort_memory_limit");
+    if (!v.has()) {
+        return SORT_DEFAULT_MEMORY_LIMIT;
+    }
+    int64_t limit = v->as_int();
+    rcheck_target(v.get(), base_exc_t::GENERIC, limit > 0,
+                  strprintf("`sort_memory_limit` must be positive (got %" PRIi64 ").",
+                            limit));
+    return limit;
+}
+
 } // namespace ql
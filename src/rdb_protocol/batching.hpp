@@ -80,6 +80,7 @@ public:
     batch_type_t get_batch_type() const { return batch_type; }
     batchspec_t with_new_batch_type(batch_type_t new_batch_type) const;
     batchspec_t with_at_most(uint64_t max_els) const;
+    batchspec_t with_max_size(int64_t max_size) const;
     batchspec_t scale_down(int64_t divisor) const;
     batcher_t to_batcher() const;
 
@@ -104,6 +105,10 @@ RDB_DECLARE_SERIALIZABLE(batchspec_t);
 // TODO: make user-tunable.
 size_t array_size_limit();
 
+// How many bytes of rows an unindexed `orderBy` may keep in memory.  Set with the
+// `sort_memory_limit` global optarg.
+size_t sort_memory_limit(env_t *env);
+
 } // namespace ql
 
 #endif // RDB_PROTOCOL_BATCHING_HPP_
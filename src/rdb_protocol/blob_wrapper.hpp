@@ -24,7 +24,11 @@ public:
 
     int64_t valuesize() const;
 
-    /* This function only works in read mode. */
+    /* These functions only work in read mode. */
+    void expose_region(buf_parent_t parent, access_t mode,
+                       int64_t offset, int64_t size,
+                       buffer_group_t *buffer_group_out,
+                       blob_acq_t *acq_group_out);
     void expose_all(buf_parent_t parent, access_t mode,
                     buffer_group_t *buffer_group_out,
                     blob_acq_t *acq_group_out);
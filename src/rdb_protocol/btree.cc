@@ -1,7 +1,9 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/btree.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -14,12 +16,16 @@
 #include "btree/slice.hpp"
 #include "buffer_cache/alt/serialize_onto_blob.hpp"
 #include "concurrency/coro_pool.hpp"
+#include "concurrency/cross_thread_signal.hpp"
+#include "concurrency/pmap.hpp"
 #include "concurrency/queue/unlimited_fifo.hpp"
 #include "containers/archive/boost_types.hpp"
 #include "containers/archive/buffer_group_stream.hpp"
+#include "containers/archive/stl_types.hpp"
 #include "containers/archive/vector_stream.hpp"
 #include "containers/scoped.hpp"
 #include "rdb_protocol/blob_wrapper.hpp"
+#include "rdb_protocol/env.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/lazy_json.hpp"
 #include "rdb_protocol/serialize_datum_onto_blob.hpp"
@@ -42,7 +48,7 @@ bool rdb_value_sizer_t::fits(const void *value, int length_available) const {
 }
 
 int rdb_value_sizer_t::max_possible_size() const {
-    return blob::btree_maxreflen;
+    return blob::btree_maxreflen(block_size_);
 }
 
 block_magic_t rdb_value_sizer_t::leaf_magic() {
@@ -57,15 +63,17 @@ block_magic_t rdb_value_sizer_t::btree_leaf_magic() const {
 max_block_size_t rdb_value_sizer_t::block_size() const { return block_size_; }
 
 bool btree_value_fits(max_block_size_t bs, int data_length, const rdb_value_t *value) {
-    return blob::ref_fits(bs, data_length, value->value_ref(), blob::btree_maxreflen);
+    return blob::ref_fits(bs, data_length, value->value_ref(),
+                          blob::btree_maxreflen(bs));
 }
 
 // Remember that secondary indexes and the main btree both point to the same rdb
 // value -- you don't want to double-delete that value!
 void actually_delete_rdb_value(buf_parent_t parent, void *value) {
-    blob_t blob(parent.cache()->max_block_size(),
+    const max_block_size_t block_size = parent.cache()->max_block_size();
+    blob_t blob(block_size,
                 static_cast<rdb_value_t *>(value)->value_ref(),
-                blob::btree_maxreflen);
+                blob::btree_maxreflen(block_size));
     blob.clear(parent);
 }
 
@@ -73,9 +81,10 @@ void detach_rdb_value(buf_parent_t parent, const void *value) {
     // This const_cast is ok, since `detach_subtrees` is one of the operations
     // that does not actually change value.
     void *non_const_value = const_cast<void *>(value);
-    blob_t blob(parent.cache()->max_block_size(),
+    const max_block_size_t block_size = parent.cache()->max_block_size();
+    blob_t blob(block_size,
                 static_cast<rdb_value_t *>(non_const_value)->value_ref(),
-                blob::btree_maxreflen);
+                blob::btree_maxreflen(block_size));
     blob.detach_subtrees(parent);
 }
 
@@ -96,6 +105,59 @@ void rdb_get(const store_key_t &store_key, btree_slice_t *slice,
     }
 }
 
+class batch_get_callback_t : public keyvalue_read_callback_t {
+public:
+    batch_get_callback_t(const std::vector<const store_key_t *> *_keys,
+                         point_read_batch_response_t *_response)
+        : keys(_keys), response(_response) { }
+
+    void on_keyvalue(size_t index, const void *value, buf_parent_t leaf) {
+        if (value != NULL) {
+            response->data[*(*keys)[index]]
+                = get_data(static_cast<const rdb_value_t *>(value), leaf);
+        }
+    }
+
+private:
+    const std::vector<const store_key_t *> *keys;
+    point_read_batch_response_t *response;
+};
+
+static bool store_key_ptr_less(const store_key_t *a, const store_key_t *b) {
+    return *a < *b;
+}
+
+static bool store_key_ptr_equal(const store_key_t *a, const store_key_t *b) {
+    return *a == *b;
+}
+
+void rdb_get_batch(const std::vector<store_key_t> &keys, btree_slice_t *slice,
+                   superblock_t *superblock, point_read_batch_response_t *response,
+                   profile::trace_t *trace) {
+    // We look the keys up in order, so that consecutive lookups mostly hit the
+    // same nodes.
+    std::vector<const store_key_t *> sorted_keys;
+    sorted_keys.reserve(keys.size());
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        sorted_keys.push_back(&*it);
+    }
+    std::sort(sorted_keys.begin(), sorted_keys.end(), store_key_ptr_less);
+    sorted_keys.erase(std::unique(sorted_keys.begin(), sorted_keys.end(),
+                                  store_key_ptr_equal),
+                      sorted_keys.end());
+
+    std::vector<const btree_key_t *> btree_keys;
+    btree_keys.reserve(sorted_keys.size());
+    for (auto it = sorted_keys.begin(); it != sorted_keys.end(); ++it) {
+        btree_keys.push_back((*it)->btree_key());
+    }
+
+    rdb_value_sizer_t sizer(superblock->cache()->max_block_size());
+    batch_get_callback_t cb(&sorted_keys, response);
+    find_keyvalues_for_read(&sizer, superblock, btree_keys, &cb,
+                            &slice->stats, trace);
+}
+
 void kv_location_delete(keyvalue_location_t *kv_location,
                         const store_key_t &key,
                         repli_timestamp_t timestamp,
@@ -133,12 +195,13 @@ void kv_location_set(keyvalue_location_t *kv_location,
                      repli_timestamp_t timestamp,
                      const deletion_context_t *deletion_context,
                      rdb_modification_info_t *mod_info_out) {
-    scoped_malloc_t<rdb_value_t> new_value(blob::btree_maxreflen);
-    memset(new_value.get(), 0, blob::btree_maxreflen);
-
     const max_block_size_t block_size = kv_location->buf.cache()->max_block_size();
+    const int maxreflen = blob::btree_maxreflen(block_size);
+    scoped_malloc_t<rdb_value_t> new_value(maxreflen);
+    memset(new_value.get(), 0, maxreflen);
+
     {
-        blob_t blob(block_size, new_value->value_ref(), blob::btree_maxreflen);
+        blob_t blob(block_size, new_value->value_ref(), maxreflen);
         datum_serialize_onto_blob(
                 buf_parent_t(&kv_location->buf),
                 &blob,
@@ -713,15 +776,76 @@ typedef ql::terminal_variant_t terminal_variant_t;
 class sindex_data_t {
 public:
     sindex_data_t(const key_range_t &_pkey_range, const datum_range_t &_range,
-                  ql::map_wire_func_t wire_func, sindex_multi_bool_t _multi)
+                  ql::map_wire_func_t wire_func, sindex_multi_bool_t _multi,
+                  ql::skey_version_t _skey_version,
+                  const sindex_storage_t &_storage,
+                  const std::vector<transform_variant_t> &transforms,
+                  btree_slice_t *_primary_slice, buf_lock_t *_primary_root)
         : pkey_range(_pkey_range), range(_range),
-          func(wire_func.compile_wire_func()), multi(_multi) { }
+          func(wire_func.compile_wire_func()), multi(_multi),
+          skey_version(_skey_version), storage(_storage),
+          primary_slice(_primary_slice), primary_root(_primary_root),
+          first_map_is_covered(false) {
+        func_is_simple_selector = func->is_simple_selector(&selected_field);
+
+        const ql::map_wire_func_t *first_map = transforms.empty()
+            ? NULL
+            : boost::get<ql::map_wire_func_t>(&transforms[0]);
+        if (storage.slim && first_map != NULL) {
+            counted_t<ql::func_t> map_func = first_map->compile_wire_func();
+            std::vector<std::string> fields;
+            std::string field;
+            if (map_func->is_simple_pluck(&fields)) {
+                first_map_is_covered = is_covering(fields);
+            } else if (map_func->is_simple_selector(&field)) {
+                first_map_is_covered = is_covering(std::vector<std::string>{field});
+                first_map_field = field;
+            }
+        }
+    }
+
 private:
     friend class rget_cb_t;
+
+    bool is_covering(const std::vector<std::string> &fields) const {
+        for (auto it = fields.begin(); it != fields.end(); ++it) {
+            if (std::find(storage.covering.begin(), storage.covering.end(), *it)
+                == storage.covering.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether the covering values of a slim sindex entry can stand in for the row
+    // in the first transform.
+    bool covers_first_map(const counted_t<const ql::datum_t> &covering) const {
+        if (!first_map_is_covered || covering->get_type() != ql::datum_t::R_OBJECT) {
+            return false;
+        }
+        // Selecting a missing field is an error, whose message shows the row.
+        return !first_map_field
+            || covering->get(*first_map_field, ql::NOTHROW).has();
+    }
+
     const key_range_t pkey_range;
     const datum_range_t range;
     const counted_t<ql::func_t> func;
     const sindex_multi_bool_t multi;
+    const ql::skey_version_t skey_version;
+    // If `func` just returns a field of the row, we can compute the sindex value
+    // without loading the whole row.
+    bool func_is_simple_selector;
+    std::string selected_field;
+
+    const sindex_storage_t storage;
+    // Slim sindexes look their rows up here.
+    btree_slice_t *const primary_slice;
+    buf_lock_t *const primary_root;
+    // Whether the first transform is a map that only reads covering fields.  If it
+    // selects a single field, that's `first_map_field`.
+    bool first_map_is_covered;
+    boost::optional<std::string> first_map_field;
 };
 
 class job_data_t {
@@ -732,6 +856,7 @@ public:
                sorting_t _sorting)
         : env(_env),
           batcher(batchspec.to_batcher()),
+          transforms(_transforms),
           sorting(_sorting),
           accumulator(_terminal
                       ? ql::make_terminal(*_terminal)
@@ -744,6 +869,7 @@ public:
     job_data_t(job_data_t &&jd)
         : env(jd.env),
           batcher(std::move(jd.batcher)),
+          transforms(std::move(jd.transforms)),
           transformers(std::move(jd.transformers)),
           sorting(jd.sorting),
           accumulator(jd.accumulator.release()) {
@@ -752,6 +878,7 @@ private:
     friend class rget_cb_t;
     ql::env_t *const env;
     ql::batcher_t batcher;
+    std::vector<transform_variant_t> transforms;
     std::vector<scoped_ptr_t<ql::op_t> > transformers;
     sorting_t sorting;
     scoped_ptr_t<ql::accumulator_t> accumulator;
@@ -779,10 +906,94 @@ public:
     THROWS_ONLY(interrupted_exc_t);
     void finish() THROWS_ONLY(interrupted_exc_t);
 private:
+    // An entry of a slim sindex that we haven't looked the row up for yet.
+    struct slim_entry_t {
+        store_key_t key;
+        store_key_t primary_key;
+        // The sindex value, if the key holds it.
+        counted_t<const ql::datum_t> sindex_key_val;
+        // What the transforms get if we don't look the row up.
+        counted_t<const ql::datum_t> val;
+        bool needs_row;
+    };
+
+    // A row whose transforms we evaluate together with the rest of its batch, see
+    // `handle_pending_rows`.
+    struct pending_row_t {
+        store_key_t key;
+        counted_t<const ql::datum_t> val;
+        counted_t<const ql::datum_t> sindex_key_val;
+        counted_t<const ql::datum_t> sindex_field_val;
+
+        // Filled in by `handle_pending_rows`.
+        counted_t<const ql::datum_t> sindex_val;
+        bool in_range;
+        ql::groups_t data;
+        boost::optional<ql::exc_t> error;
+    };
+
+    // Checks the `parallel_transforms` optarg and sets up `parallel_transforms_data`.
+    void init_parallel_transforms();
+
+    done_traversing_t handle_slim_pair(scoped_key_value_t &&keyvalue,
+                                       concurrent_traversal_fifo_enforcer_signal_t waiter)
+    THROWS_ONLY(interrupted_exc_t);
+    // Looks up the rows `slim_entries` need in one batch and handles the entries.
+    done_traversing_t handle_slim_entries() THROWS_ONLY(interrupted_exc_t);
+    // Runs a row through the transforms and the accumulator, or puts it into
+    // `pending_rows` if we evaluate transforms on several threads.  `val` is empty
+    // if neither of them uses it.  We compute the sindex value from `val` unless we
+    // have `sindex_key_val` or `sindex_field_val`.
+    done_traversing_t add_row(store_key_t &&key,
+                              counted_t<const ql::datum_t> &&val,
+                              counted_t<const ql::datum_t> &&sindex_key_val,
+                              counted_t<const ql::datum_t> &&sindex_field_val)
+    THROWS_ONLY(interrupted_exc_t);
+    done_traversing_t handle_row(store_key_t &&key,
+                                 counted_t<const ql::datum_t> &&val,
+                                 counted_t<const ql::datum_t> &&sindex_key_val,
+                                 counted_t<const ql::datum_t> &&sindex_field_val);
+    // Evaluates the first `num_parallel_transforms` transforms of `pending_rows`
+    // on several threads, and then handles the rows in order.
+    done_traversing_t handle_pending_rows() THROWS_ONLY(interrupted_exc_t);
+    // Runs rows `begin` to `end` of `rows` through copies of the parallel
+    // transforms on `thread`.  Sets `*interrupted_out` if `interruptor` is pulsed.
+    void evaluate_parallel_transforms(std::vector<pending_row_t> *rows,
+                                      size_t begin, size_t end,
+                                      threadnum_t thread,
+                                      rdb_context_t *ctx,
+                                      signal_t *interruptor,
+                                      bool *interrupted_out);
+
+    void update_last_key(const store_key_t &key);
+    // Returns false if the row is out of the sindex range.
+    bool compute_sindex_val(const store_key_t &key,
+                            const counted_t<const ql::datum_t> &val,
+                            counted_t<const ql::datum_t> &&sindex_key_val,
+                            counted_t<const ql::datum_t> &&sindex_field_val,
+                            counted_t<const ql::datum_t> *sindex_val_out);
+    // Runs the transforms from `first_transform` on and the accumulator.
+    done_traversing_t accumulate_row(store_key_t &&key,
+                                     ql::groups_t *data,
+                                     counted_t<const ql::datum_t> &&sindex_val,
+                                     size_t first_transform);
+
     const io_data_t io; // How do get data in/out.
     job_data_t job; // What to do next (stateful).
     const boost::optional<sindex_data_t> sindex; // Optional sindex information.
 
+    // Slim sindex entries waiting for `handle_slim_entries`, in traversal order.
+    std::vector<slim_entry_t> slim_entries;
+
+    // How many of the leading transforms we evaluate on several threads, or 0 if
+    // we evaluate them all here.  `parallel_transforms_data` holds them and the
+    // query's global optargs, serialized, because every thread needs its own copy
+    // of the compiled functions.
+    size_t num_parallel_transforms;
+    std::vector<char> parallel_transforms_data;
+    // Rows waiting for `handle_pending_rows`, in traversal order.
+    std::vector<pending_row_t> pending_rows;
+
     // State for internal bookkeeping.
     bool bad_init;
     scoped_ptr_t<profile::disabler_t> disabler;
@@ -796,16 +1007,87 @@ rget_cb_t::rget_cb_t(io_data_t &&_io,
     : io(std::move(_io)),
       job(std::move(_job)),
       sindex(std::move(_sindex)),
+      num_parallel_transforms(0),
       bad_init(false) {
     io.response->last_key = !reversed(job.sorting)
         ? range.left
         : (!range.right.unbounded ? range.right.key : store_key_t::max());
+    try {
+        init_parallel_transforms();
+    } catch (const ql::exc_t &e) {
+        io.response->result = e;
+        bad_init = true;
+    } catch (const ql::datum_exc_t &e) {
+        io.response->result = ql::exc_t(e, NULL);
+        bad_init = true;
+    }
     disabler.init(new profile::disabler_t(job.env->trace));
     sampler.init(new profile::sampler_t("Range traversal doc evaluation.",
                                         job.env->trace));
 }
 
+// Whether every thread can evaluate `transform` on its own copy, independently of
+// the other rows.  `group` and `distinct` aren't, because of the state they keep
+// between rows.
+static bool is_parallelizable(const transform_variant_t &transform) {
+    if (const ql::map_wire_func_t *map = boost::get<ql::map_wire_func_t>(&transform)) {
+        return map->compile_wire_func()->is_deterministic();
+    } else if (const ql::concatmap_wire_func_t *concatmap
+               = boost::get<ql::concatmap_wire_func_t>(&transform)) {
+        return concatmap->compile_wire_func()->is_deterministic();
+    } else if (const ql::filter_wire_func_t *filter
+               = boost::get<ql::filter_wire_func_t>(&transform)) {
+        return filter->filter_func.compile_wire_func()->is_deterministic()
+            && (!filter->default_filter_val
+                || filter->default_filter_val->compile_wire_func()->is_deterministic());
+    }
+    return false;
+}
+
+void rget_cb_t::init_parallel_transforms() {
+    // Profiles only cover this thread.
+    if (job.env->get_rdb_ctx() == NULL || job.env->trace.has()
+        || get_num_threads() <= 1) {
+        return;
+    }
+    counted_t<ql::val_t> v
+        = job.env->global_optargs.get_optarg(job.env, "parallel_transforms");
+    if (!v.has() || !v->as_bool()) {
+        return;
+    }
+
+    // Non-deterministic functions may have side effects, or depend on the order
+    // we evaluate the rows in, so we stop at the first one.
+    std::vector<transform_variant_t> parallel_transforms;
+    while (parallel_transforms.size() < job.transforms.size()
+           && is_parallelizable(job.transforms[parallel_transforms.size()])) {
+        parallel_transforms.push_back(job.transforms[parallel_transforms.size()]);
+    }
+    if (parallel_transforms.empty()) {
+        return;
+    }
+
+    write_message_t wm;
+    serialize_for_version(cluster_version_t::CLUSTER, &wm, parallel_transforms);
+    serialize_for_version(cluster_version_t::CLUSTER, &wm,
+                          job.env->global_optargs.get_all_optargs());
+    vector_stream_t stream;
+    stream.reserve(wm.size());
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    stream.swap(&parallel_transforms_data);
+    num_parallel_transforms = parallel_transforms.size();
+}
+
 void rget_cb_t::finish() THROWS_ONLY(interrupted_exc_t) {
+    if (!slim_entries.empty()
+        && boost::get<ql::exc_t>(&io.response->result) == NULL) {
+        handle_slim_entries();
+    }
+    if (!pending_rows.empty()
+        && boost::get<ql::exc_t>(&io.response->result) == NULL) {
+        handle_pending_rows();
+    }
     job.accumulator->finish(&io.response->result);
     if (job.accumulator->should_send_batch()) {
         io.response->truncated = true;
@@ -822,20 +1104,45 @@ THROWS_ONLY(interrupted_exc_t) {
         return done_traversing_t::YES;
     }
 
+    if (sindex && sindex->storage.slim) {
+        return handle_slim_pair(std::move(keyvalue), waiter);
+    }
+
     // Load the key and value.
     store_key_t key(keyvalue.key());
     if (sindex && !sindex->pkey_range.contains_key(ql::datum_t::extract_primary(key))) {
         return done_traversing_t::NO;
     }
 
+    // Binary keys that weren't truncated hold the sindex value, so we don't need
+    // the row to compute it.
+    counted_t<const ql::datum_t> sindex_key_val;
+    if (sindex && sindex->skey_version == ql::skey_version_t::BINARY) {
+        sindex_key_val = ql::datum_t::decode_secondary(key);
+    }
+
     lazy_json_t row(static_cast<const rdb_value_t *>(keyvalue.value()),
                     keyvalue.expose_buf());
     counted_t<const ql::datum_t> val;
+    // If we only need the row to compute a simple sindex function, this is the
+    // field it selects.
+    counted_t<const ql::datum_t> sindex_field_val;
     // We only load the value if we actually use it (`count` does not).
-    if (job.accumulator->uses_val() || job.transformers.size() != 0 || sindex) {
+    if (job.accumulator->uses_val() || job.transformers.size() != 0) {
         val = row.get();
         io.slice->stats.pm_keys_read.record();
         io.slice->stats.pm_total_keys_read += 1;
+    } else if (sindex && !sindex_key_val.has()) {
+        if (sindex->func_is_simple_selector) {
+            sindex_field_val = row.get_field(sindex->selected_field);
+        }
+        if (!sindex_field_val.has()) {
+            // Let the sindex function produce whatever error it does.
+            val = row.get();
+        }
+        row.reset();
+        io.slice->stats.pm_keys_read.record();
+        io.slice->stats.pm_total_keys_read += 1;
     } else {
         row.reset();
     }
@@ -843,41 +1150,214 @@ THROWS_ONLY(interrupted_exc_t) {
     keyvalue.reset();
     waiter.wait_interruptible();
 
+    return add_row(std::move(key), std::move(val), std::move(sindex_key_val),
+                   std::move(sindex_field_val));
+}
+
+// How many slim sindex entries we collect before looking their rows up.
+static const size_t SLIM_SINDEX_LOOKUP_BATCH_SIZE = 64;
+
+done_traversing_t rget_cb_t::handle_slim_pair(
+        scoped_key_value_t &&keyvalue,
+        concurrent_traversal_fifo_enforcer_signal_t waiter)
+THROWS_ONLY(interrupted_exc_t) {
+    slim_entry_t entry;
+    entry.key = store_key_t(keyvalue.key());
+    entry.primary_key = ql::datum_t::extract_primary(entry.key);
+    if (!sindex->pkey_range.contains_key(entry.primary_key)) {
+        return done_traversing_t::NO;
+    }
+
+    entry.sindex_key_val = ql::datum_t::decode_secondary(entry.key);
+    // We need the row to compute the sindex value if the key doesn't hold it, or
+    // to transform or accumulate it unless the covering values will do.
+    entry.needs_row = !entry.sindex_key_val.has();
+    if (job.accumulator->uses_val() || job.transformers.size() != 0) {
+        counted_t<const ql::datum_t> covering
+            = get_data(static_cast<const rdb_value_t *>(keyvalue.value()),
+                       keyvalue.expose_buf());
+        if (sindex->covers_first_map(covering)) {
+            entry.val = std::move(covering);
+        } else {
+            entry.needs_row = true;
+        }
+    }
+    keyvalue.reset();
+    waiter.wait_interruptible();
+
+    slim_entries.push_back(std::move(entry));
+    if (slim_entries.size() >= SLIM_SINDEX_LOOKUP_BATCH_SIZE) {
+        return handle_slim_entries();
+    }
+    return done_traversing_t::NO;
+}
+
+class slim_entry_lookup_callback_t : public keyvalue_read_callback_t {
+public:
+    explicit slim_entry_lookup_callback_t(
+            std::vector<counted_t<const ql::datum_t> > *_rows)
+        : rows(_rows) { }
+
+    void on_keyvalue(size_t index, const void *value, buf_parent_t leaf) {
+        if (value != NULL) {
+            (*rows)[index] = get_data(static_cast<const rdb_value_t *>(value), leaf);
+        }
+    }
+
+private:
+    std::vector<counted_t<const ql::datum_t> > *rows;
+};
+
+done_traversing_t rget_cb_t::handle_slim_entries() THROWS_ONLY(interrupted_exc_t) {
+    std::vector<slim_entry_t> entries;
+    entries.swap(slim_entries);
+
+    // We look the primary keys up in order, so that consecutive lookups mostly hit
+    // the same nodes.
+    std::vector<size_t> lookups;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].needs_row) {
+            lookups.push_back(i);
+        }
+    }
+    std::sort(lookups.begin(), lookups.end(), [&](size_t l, size_t r) {
+            return entries[l].primary_key < entries[r].primary_key;
+        });
+
+    if (!lookups.empty()) {
+        std::vector<const btree_key_t *> keys;
+        keys.reserve(lookups.size());
+        for (auto it = lookups.begin(); it != lookups.end(); ++it) {
+            keys.push_back(entries[*it].primary_key.btree_key());
+        }
+        std::vector<counted_t<const ql::datum_t> > rows(lookups.size());
+        slim_entry_lookup_callback_t cb(&rows);
+        rdb_value_sizer_t sizer(io.slice->cache()->max_block_size());
+        find_keyvalues_for_read(&sizer, sindex->primary_root, keys, &cb,
+                                &sindex->primary_slice->stats,
+                                job.env->trace.get_or_null());
+        for (size_t i = 0; i < lookups.size(); ++i) {
+            entries[lookups[i]].val = std::move(rows[i]);
+        }
+    }
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->needs_row && !it->val.has()) {
+            // The sindex and the primary btree are from the same snapshot, so this
+            // shouldn't happen, but there's nothing to return for the entry.
+            continue;
+        }
+        done_traversing_t done = add_row(std::move(it->key), std::move(it->val),
+                                         std::move(it->sindex_key_val),
+                                         counted_t<const ql::datum_t>());
+        if (done == done_traversing_t::YES) {
+            return done;
+        }
+    }
+    return done_traversing_t::NO;
+}
+
+// How many rows we collect before evaluating their transforms on several threads.
+// We may read this many rows past the end of a batch.
+static const size_t PARALLEL_TRANSFORMS_BATCH_SIZE = 1024;
+// We don't bother another thread for fewer rows than this.
+static const size_t PARALLEL_TRANSFORMS_MIN_ROWS_PER_THREAD = 64;
+
+done_traversing_t rget_cb_t::add_row(
+        store_key_t &&key,
+        counted_t<const ql::datum_t> &&val,
+        counted_t<const ql::datum_t> &&sindex_key_val,
+        counted_t<const ql::datum_t> &&sindex_field_val)
+THROWS_ONLY(interrupted_exc_t) {
+    if (num_parallel_transforms == 0) {
+        return handle_row(std::move(key), std::move(val), std::move(sindex_key_val),
+                          std::move(sindex_field_val));
+    }
+    pending_row_t row;
+    row.key = std::move(key);
+    row.val = std::move(val);
+    row.sindex_key_val = std::move(sindex_key_val);
+    row.sindex_field_val = std::move(sindex_field_val);
+    row.in_range = false;
+    pending_rows.push_back(std::move(row));
+    if (pending_rows.size() >= PARALLEL_TRANSFORMS_BATCH_SIZE) {
+        return handle_pending_rows();
+    }
+    return done_traversing_t::NO;
+}
+
+void rget_cb_t::update_last_key(const store_key_t &key) {
+    if ((io.response->last_key < key && !reversed(job.sorting)) ||
+        (io.response->last_key > key && reversed(job.sorting))) {
+        io.response->last_key = key;
+    }
+}
+
+bool rget_cb_t::compute_sindex_val(const store_key_t &key,
+                                   const counted_t<const ql::datum_t> &val,
+                                   counted_t<const ql::datum_t> &&sindex_key_val,
+                                   counted_t<const ql::datum_t> &&sindex_field_val,
+                                   counted_t<const ql::datum_t> *sindex_val_out) {
+    if (!sindex) {
+        return true;
+    }
+    counted_t<const ql::datum_t> sindex_val;
+    if (sindex_key_val.has()) {
+        // The key of a multi index already holds the right element.
+        sindex_val = std::move(sindex_key_val);
+    } else {
+        sindex_val = sindex_field_val.has()
+            ? std::move(sindex_field_val)
+            : sindex->func->call(job.env, val)->as_datum();
+        if (sindex->multi == sindex_multi_bool_t::MULTI
+            && sindex_val->get_type() == ql::datum_t::R_ARRAY) {
+            boost::optional<uint64_t> tag = *ql::datum_t::extract_tag(key);
+            guarantee(tag);
+            sindex_val = sindex_val->get(*tag, ql::NOTHROW);
+            guarantee(sindex_val);
+        }
+    }
+    if (!sindex->range.contains(sindex_val)) {
+        return false;
+    }
+    *sindex_val_out = std::move(sindex_val);
+    return true;
+}
+
+done_traversing_t rget_cb_t::accumulate_row(store_key_t &&key,
+                                            ql::groups_t *data,
+                                            counted_t<const ql::datum_t> &&sindex_val,
+                                            size_t first_transform) {
+    for (size_t i = first_transform; i < job.transformers.size(); ++i) {
+        (*job.transformers[i])(job.env, data, sindex_val);
+        //                                    ^^^^^^^^^^ NULL if no sindex
+    }
+    // We need lots of extra data for the accumulation because we might be
+    // accumulating `rget_item_t`s for a batch.
+    return (*job.accumulator)(job.env,
+                              data,
+                              std::move(key),
+                              std::move(sindex_val)); // NULL if no sindex
+}
+
+done_traversing_t rget_cb_t::handle_row(
+        store_key_t &&key,
+        counted_t<const ql::datum_t> &&val,
+        counted_t<const ql::datum_t> &&sindex_key_val,
+        counted_t<const ql::datum_t> &&sindex_field_val) {
     try {
         // Update the last considered key.
-        if ((io.response->last_key < key && !reversed(job.sorting)) ||
-            (io.response->last_key > key && reversed(job.sorting))) {
-            io.response->last_key = key;
-        }
+        update_last_key(key);
 
         // Check whether we're out of sindex range.
         counted_t<const ql::datum_t> sindex_val; // NULL if no sindex.
-        if (sindex) {
-            sindex_val = sindex->func->call(job.env, val)->as_datum();
-            if (sindex->multi == sindex_multi_bool_t::MULTI
-                && sindex_val->get_type() == ql::datum_t::R_ARRAY) {
-                boost::optional<uint64_t> tag = *ql::datum_t::extract_tag(key);
-                guarantee(tag);
-                sindex_val = sindex_val->get(*tag, ql::NOTHROW);
-                guarantee(sindex_val);
-            }
-            if (!sindex->range.contains(sindex_val)) {
-                return done_traversing_t::NO;
-            }
+        if (!compute_sindex_val(key, val, std::move(sindex_key_val),
+                                std::move(sindex_field_val), &sindex_val)) {
+            return done_traversing_t::NO;
         }
 
         ql::groups_t data = {{counted_t<const ql::datum_t>(), ql::datums_t{val}}};
-
-        for (auto it = job.transformers.begin(); it != job.transformers.end(); ++it) {
-            (**it)(job.env, &data, sindex_val);
-            //                     ^^^^^^^^^^ NULL if no sindex
-        }
-        // We need lots of extra data for the accumulation because we might be
-        // accumulating `rget_item_t`s for a batch.
-        return (*job.accumulator)(job.env,
-                                  &data,
-                                  std::move(key),
-                                  std::move(sindex_val)); // NULL if no sindex
+        return accumulate_row(std::move(key), &data, std::move(sindex_val), 0);
     } catch (const ql::exc_t &e) {
         io.response->result = e;
         return done_traversing_t::YES;
@@ -891,6 +1371,150 @@ THROWS_ONLY(interrupted_exc_t) {
     }
 }
 
+done_traversing_t rget_cb_t::handle_pending_rows() THROWS_ONLY(interrupted_exc_t) {
+    std::vector<pending_row_t> rows;
+    rows.swap(pending_rows);
+
+    // We compute the sindex values here, since the sindex function is shared with
+    // the rest of the read.  Nothing past the first error gets evaluated.
+    size_t num_evaluated = rows.size();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        pending_row_t *row = &rows[i];
+        try {
+            row->in_range = compute_sindex_val(row->key, row->val,
+                                               std::move(row->sindex_key_val),
+                                               std::move(row->sindex_field_val),
+                                               &row->sindex_val);
+        } catch (const ql::exc_t &e) {
+            row->error = e;
+        } catch (const ql::datum_exc_t &e) {
+#ifndef NDEBUG
+            unreachable();
+#else
+            row->error = ql::exc_t(e, NULL);
+#endif // NDEBUG
+        }
+        if (row->error) {
+            num_evaluated = i;
+            break;
+        }
+        if (row->in_range) {
+            row->data = {{counted_t<const ql::datum_t>(), ql::datums_t{row->val}}};
+        }
+    }
+
+    if (num_evaluated != 0) {
+        const size_t num_threads = get_num_threads();
+        const size_t num_chunks = std::max<size_t>(
+            1, std::min(num_threads,
+                        num_evaluated / PARALLEL_TRANSFORMS_MIN_ROWS_PER_THREAD));
+        const int home_thread = get_thread_id().threadnum;
+        rdb_context_t *ctx = job.env->get_rdb_ctx();
+        bool interrupted = false;
+        pmap(num_chunks, [&](int i) {
+                evaluate_parallel_transforms(
+                    &rows,
+                    num_evaluated * i / num_chunks,
+                    num_evaluated * (i + 1) / num_chunks,
+                    threadnum_t(static_cast<int32_t>((home_thread + i) % num_threads)),
+                    ctx,
+                    job.env->interruptor,
+                    &interrupted);
+            });
+        if (interrupted) {
+            throw interrupted_exc_t();
+        }
+    }
+
+    // The rest of the transforms and the accumulator see the rows in key order,
+    // just like they would without the other threads.
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        update_last_key(it->key);
+        if (it->error) {
+            io.response->result = *it->error;
+            return done_traversing_t::YES;
+        }
+        if (!it->in_range) {
+            continue;
+        }
+        try {
+            done_traversing_t done = accumulate_row(std::move(it->key), &it->data,
+                                                    std::move(it->sindex_val),
+                                                    num_parallel_transforms);
+            if (done == done_traversing_t::YES) {
+                return done;
+            }
+        } catch (const ql::exc_t &e) {
+            io.response->result = e;
+            return done_traversing_t::YES;
+        } catch (const ql::datum_exc_t &e) {
+#ifndef NDEBUG
+            unreachable();
+#else
+            io.response->result = ql::exc_t(e, NULL);
+            return done_traversing_t::YES;
+#endif // NDEBUG
+        }
+    }
+    return done_traversing_t::NO;
+}
+
+void rget_cb_t::evaluate_parallel_transforms(std::vector<pending_row_t> *rows,
+                                             size_t begin, size_t end,
+                                             threadnum_t thread,
+                                             rdb_context_t *ctx,
+                                             signal_t *interruptor,
+                                             bool *interrupted_out) {
+    cross_thread_signal_t ct_interruptor(interruptor, thread);
+    on_thread_t rethreader(thread);
+
+    // Everything that we make here is destroyed before we leave the thread, except
+    // for the datums in `rows`, which are safe to share.
+    std::vector<transform_variant_t> transforms;
+    std::map<std::string, ql::wire_func_t> optargs;
+    inplace_vector_read_stream_t read_stream(&parallel_transforms_data);
+    archive_result_t res = deserialize_for_version(cluster_version_t::CLUSTER,
+                                                   &read_stream, &transforms);
+    guarantee_deserialization(res, "parallel transforms");
+    res = deserialize_for_version(cluster_version_t::CLUSTER, &read_stream, &optargs);
+    guarantee_deserialization(res, "parallel transforms");
+
+    ql::env_t env(ctx, &ct_interruptor, std::move(optargs),
+                  profile_bool_t::DONT_PROFILE);
+    std::vector<scoped_ptr_t<ql::op_t> > ops;
+    for (auto it = transforms.begin(); it != transforms.end(); ++it) {
+        ops.push_back(ql::make_op(*it));
+    }
+
+    try {
+        for (size_t i = begin; i < end; ++i) {
+            pending_row_t *row = &(*rows)[i];
+            if (!row->in_range) {
+                continue;
+            }
+            try {
+                for (auto op = ops.begin(); op != ops.end(); ++op) {
+                    (**op)(&env, &row->data, row->sindex_val);
+                }
+            } catch (const ql::exc_t &e) {
+                row->error = e;
+            } catch (const ql::datum_exc_t &e) {
+#ifndef NDEBUG
+                unreachable();
+#else
+                row->error = ql::exc_t(e, NULL);
+#endif // NDEBUG
+            }
+            if (row->error) {
+                // The rows after this one don't matter anymore.
+                break;
+            }
+        }
+    } catch (const interrupted_exc_t &) {
+        *interrupted_out = true;
+    }
+}
+
 // TODO: Having two functions which are 99% the same sucks.
 void rdb_rget_slice(
     btree_slice_t *slice,
@@ -927,16 +1551,26 @@ void rdb_rget_secondary_slice(
     sorting_t sorting,
     const ql::map_wire_func_t &sindex_func,
     sindex_multi_bool_t sindex_multi,
+    ql::skey_version_t sindex_skey_version,
+    const sindex_storage_t &sindex_storage,
+    btree_slice_t *primary_slice,
+    buf_lock_t *primary_root,
     rget_read_response_t *response) {
     r_sanity_check(boost::get<ql::exc_t>(&response->result) == NULL);
     profile::starter_t starter("Do range scan on secondary index.", ql_env->trace);
+    // The reader doesn't know how this sindex encodes its keys, so this is where
+    // the datum range turns into keys.
+    const key_range_t sindex_keyrange = sindex_region.inner.intersection(
+        sindex_range.to_sindex_keyrange(sindex_skey_version));
     rget_cb_t callback(
         io_data_t(response, slice),
         job_data_t(ql_env, batchspec, transforms, terminal, sorting),
-        sindex_data_t(pk_range, sindex_range, sindex_func, sindex_multi),
-        sindex_region.inner);
+        sindex_data_t(pk_range, sindex_range, sindex_func, sindex_multi,
+                      sindex_skey_version, sindex_storage, transforms,
+                      primary_slice, primary_root),
+        sindex_keyrange);
     btree_concurrent_traversal(
-        superblock, sindex_region.inner, &callback,
+        superblock, sindex_keyrange, &callback,
         (!reversed(sorting) ? FORWARD : BACKWARD));
     callback.finish();
 }
@@ -1064,7 +1698,8 @@ void rdb_modification_report_cb_t::on_mod_report_sub(
 }
 
 void compute_keys(const store_key_t &primary_key, counted_t<const ql::datum_t> doc,
-                  ql::map_wire_func_t *mapping, sindex_multi_bool_t multi, ql::env_t *env,
+                  ql::map_wire_func_t *mapping, sindex_multi_bool_t multi,
+                  ql::skey_version_t skey_version, ql::env_t *env,
                   std::vector<store_key_t> *keys_out) {
     guarantee(keys_out->empty());
     counted_t<const ql::datum_t> index =
@@ -1073,24 +1708,32 @@ void compute_keys(const store_key_t &primary_key, counted_t<const ql::datum_t> d
     if (multi == sindex_multi_bool_t::MULTI && index->get_type() == ql::datum_t::R_ARRAY) {
         for (uint64_t i = 0; i < index->size(); ++i) {
             keys_out->push_back(
-                store_key_t(index->get(i, ql::THROW)->print_secondary(primary_key, i)));
+                store_key_t(index->get(i, ql::THROW)->print_secondary(
+                                skey_version, primary_key, i)));
         }
     } else {
-        keys_out->push_back(store_key_t(index->print_secondary(primary_key)));
+        keys_out->push_back(
+            store_key_t(index->print_secondary(skey_version, primary_key)));
     }
 }
 
 void serialize_sindex_info(write_message_t *wm,
                            const ql::map_wire_func_t &mapping,
-                           const sindex_multi_bool_t &multi) {
+                           const sindex_multi_bool_t &multi,
+                           const sindex_storage_t &storage) {
     serialize_cluster_version(wm, cluster_version_t::LATEST_DISK);
     serialize_for_version(cluster_version_t::LATEST_DISK, wm, mapping);
     serialize_for_version(cluster_version_t::LATEST_DISK, wm, multi);
+    serialize_for_version(cluster_version_t::LATEST_DISK, wm,
+                          ql::skey_version_t::LATEST);
+    serialize_for_version(cluster_version_t::LATEST_DISK, wm, storage);
 }
 
 void deserialize_sindex_info(const std::vector<char> &data,
                              ql::map_wire_func_t *mapping,
-                             sindex_multi_bool_t *multi) {
+                             sindex_multi_bool_t *multi,
+                             ql::skey_version_t *skey_version,
+                             sindex_storage_t *storage) {
     inplace_vector_read_stream_t read_stream(&data);
     cluster_version_t cluster_version;
     archive_result_t success
@@ -1100,11 +1743,54 @@ void deserialize_sindex_info(const std::vector<char> &data,
     guarantee_deserialization(success, "sindex description");
     success = deserialize_for_version(cluster_version, &read_stream, multi);
     guarantee_deserialization(success, "sindex description");
+    switch (cluster_version) {
+    case cluster_version_t::v1_13:
+    case cluster_version_t::v1_13_2:
+        *skey_version = ql::skey_version_t::PRINTED;
+        *storage = sindex_storage_t();
+        break;
+    case cluster_version_t::v1_14_is_latest_disk:
+        success = deserialize<cluster_version_t::v1_14_is_latest_disk>(
+            &read_stream, skey_version);
+        guarantee_deserialization(success, "sindex description");
+        success = deserialize<cluster_version_t::v1_14_is_latest_disk>(
+            &read_stream, storage);
+        guarantee_deserialization(success, "sindex description");
+        break;
+    default:
+        unreachable();
+    }
 
     guarantee(static_cast<size_t>(read_stream.tell()) == data.size(),
               "An sindex description was incompletely deserialized.");
 }
 
+// What a slim sindex entry holds for `row`: an object with the row's values of
+// the covering fields, or null if it has none of them or they don't fit into the
+// leaf node.  Slim values never have blocks of their own, so the sindex deletion
+// contexts, which leave the blocks of values alone, can't leak any.
+static counted_t<const ql::datum_t> slim_sindex_value(
+        const counted_t<const ql::datum_t> &row, const sindex_storage_t &storage,
+        max_block_size_t block_size) {
+    std::map<std::string, counted_t<const ql::datum_t> > fields;
+    for (auto it = storage.covering.begin(); it != storage.covering.end(); ++it) {
+        counted_t<const ql::datum_t> field = row->get(*it, ql::NOTHROW);
+        if (field.has()) {
+            fields[*it] = field;
+        }
+    }
+    if (!fields.empty()) {
+        counted_t<const ql::datum_t> value
+            = make_counted<const ql::datum_t>(std::move(fields));
+        const size_t size = datum_serialized_size(
+            value, ql::datum_serialization_format_t::INDEXED);
+        if (blob::size_would_be_small(size, blob::btree_maxreflen(block_size))) {
+            return value;
+        }
+    }
+    return make_counted<const ql::datum_t>(ql::datum_t::R_NULL);
+}
+
 /* Used below by rdb_update_sindexes. */
 void rdb_update_single_sindex(
         const store_t::sindex_access_t *sindex,
@@ -1119,7 +1805,10 @@ void rdb_update_single_sindex(
 
     ql::map_wire_func_t mapping;
     sindex_multi_bool_t multi;
-    deserialize_sindex_info(sindex->sindex.opaque_definition, &mapping, &multi);
+    ql::skey_version_t skey_version;
+    sindex_storage_t storage;
+    deserialize_sindex_info(sindex->sindex.opaque_definition, &mapping, &multi,
+                            &skey_version, &storage);
 
     // TODO we have no rdb context here. People should not be able to do anything
     // that requires an environment like gets from other tables etc. but we don't
@@ -1137,7 +1826,8 @@ void rdb_update_single_sindex(
 
             std::vector<store_key_t> keys;
 
-            compute_keys(modification->primary_key, deleted, &mapping, multi, &env, &keys);
+            compute_keys(modification->primary_key, deleted, &mapping, multi, skey_version,
+                         &env, &keys);
 
             for (auto it = keys.begin(); it != keys.end(); ++it) {
                 promise_t<superblock_t *> return_superblock_local;
@@ -1177,7 +1867,15 @@ void rdb_update_single_sindex(
 
             std::vector<store_key_t> keys;
 
-            compute_keys(modification->primary_key, added, &mapping, multi, &env, &keys);
+            compute_keys(modification->primary_key, added, &mapping, multi, skey_version,
+                         &env, &keys);
+
+            // Full sindexes share the row's blob with the primary btree.
+            counted_t<const ql::datum_t> slim_value;
+            if (storage.slim) {
+                slim_value = slim_sindex_value(added, storage,
+                                               super_block->cache()->max_block_size());
+            }
 
             for (auto it = keys.begin(); it != keys.end(); ++it) {
                 promise_t<superblock_t *> return_superblock_local;
@@ -1194,10 +1892,16 @@ void rdb_update_single_sindex(
                                                      env.trace.get_or_null(),
                                                      &return_superblock_local);
 
-                    kv_location_set(&kv_location, *it,
-                                    modification->info.added.second,
-                                    repli_timestamp_t::distant_past,
-                                    deletion_context);
+                    if (storage.slim) {
+                        kv_location_set(&kv_location, *it, slim_value,
+                                        repli_timestamp_t::distant_past,
+                                        deletion_context, NULL);
+                    } else {
+                        kv_location_set(&kv_location, *it,
+                                        modification->info.added.second,
+                                        repli_timestamp_t::distant_past,
+                                        deletion_context);
+                    }
                     // The keyvalue location gets destroyed here.
                 }
                 super_block = return_superblock_local.wait();
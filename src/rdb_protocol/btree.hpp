@@ -62,6 +62,13 @@ void rdb_get(
     point_read_response_t *response,
     profile::trace_t *trace);
 
+void rdb_get_batch(
+    const std::vector<store_key_t> &keys,
+    btree_slice_t *slice,
+    superblock_t *superblock,
+    point_read_batch_response_t *response,
+    profile::trace_t *trace);
+
 enum return_vals_t {
     NO_RETURN_VALS = 0,
     RETURN_VALS = 1
@@ -199,6 +206,12 @@ void rdb_rget_secondary_slice(
     sorting_t sorting,
     const ql::map_wire_func_t &sindex_func,
     sindex_multi_bool_t sindex_multi,
+    ql::skey_version_t sindex_skey_version,
+    const sindex_storage_t &sindex_storage,
+    // Slim sindexes look the rows up in the primary btree, whose root the caller
+    // keeps locked for the duration of the call.
+    btree_slice_t *primary_slice,
+    buf_lock_t *primary_root,
     rget_read_response_t *response);
 
 void rdb_distribution_get(int max_depth,
@@ -228,12 +241,18 @@ struct rdb_modification_report_t {
 
 RDB_DECLARE_SERIALIZABLE(rdb_modification_report_t);
 
+// New sindexes always print their keys with `ql::skey_version_t::LATEST`.
+// Descriptions written by 1.13 have neither a key version nor a storage, and
+// deserialize as full sindexes with `ql::skey_version_t::PRINTED` keys.
 void serialize_sindex_info(write_message_t *wm,
                            const ql::map_wire_func_t &mapping,
-                           const sindex_multi_bool_t &multi);
+                           const sindex_multi_bool_t &multi,
+                           const sindex_storage_t &storage);
 void deserialize_sindex_info(const std::vector<char> &data,
                              ql::map_wire_func_t *mapping,
-                             sindex_multi_bool_t *multi);
+                             sindex_multi_bool_t *multi,
+                             ql::skey_version_t *skey_version,
+                             sindex_storage_t *storage);
 
 /* An rdb_modification_cb_t is passed to BTree operations and allows them to
  * modify the secondary while they perform an operation. */
@@ -72,7 +72,7 @@ store_t::store_t(serializer_t *serializer,
       ctx(_ctx),
       changefeed_server((ctx == NULL || ctx->manager == NULL)
                         ? NULL
-                        : new ql::changefeed::server_t(ctx->manager))
+                        : new ql::changefeed::server_t(ctx->manager, ctx))
 {
     cache.init(new cache_t(serializer, balancer, &perfmon_collection));
     general_cache_conn.init(new cache_conn_t(cache.get()));
@@ -862,7 +862,8 @@ MUST_USE bool store_t::acquire_sindex_superblock_for_read(
         superblock_t *superblock,
         scoped_ptr_t<real_superblock_t> *sindex_sb_out,
         std::vector<char> *opaque_definition_out,
-        uuid_u *sindex_uuid_out)
+        uuid_u *sindex_uuid_out,
+        release_superblock_t release_superblock)
     THROWS_ONLY(sindex_not_ready_exc_t) {
     assert_thread();
     rassert(sindex_uuid_out != NULL);
@@ -871,7 +872,9 @@ MUST_USE bool store_t::acquire_sindex_superblock_for_read(
     buf_lock_t sindex_block
         = acquire_sindex_block_for_read(superblock->expose_buf(),
                                         superblock->get_sindex_block_id());
-    superblock->release();
+    if (release_superblock == release_superblock_t::RELEASE) {
+        superblock->release();
+    }
 
     /* Figure out what the superblock for this index is. */
     secondary_index_t sindex;
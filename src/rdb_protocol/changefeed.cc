@@ -5,9 +5,11 @@
 #include "concurrency/cross_thread_signal.hpp"
 #include "concurrency/interruptor.hpp"
 #include "containers/archive/boost_types.hpp"
+#include "containers/archive/vector_stream.hpp"
 #include "rpc/mailbox/typed.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/env.hpp"
+#include "rdb_protocol/func.hpp"
 #include "rdb_protocol/val.hpp"
 
 #include "debug.hpp"
@@ -16,9 +18,49 @@ namespace ql {
 
 namespace changefeed {
 
-server_t::server_t(mailbox_manager_t *_manager)
+std::string spec_t::key() const {
+    if (empty()) {
+        return std::string();
+    }
+    write_message_t wm;
+    serialize<cluster_version_t::CLUSTER>(&wm, *this);
+    vector_stream_t stream;
+    stream.reserve(wm.size());
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    return std::string(stream.vector().begin(), stream.vector().end());
+}
+
+// This is a cluster-only type, so we only support the latest version.
+RDB_IMPL_ME_SERIALIZABLE_2(spec_t, transforms, optargs);
+INSTANTIATE_SERIALIZABLE_SELF_FOR_CLUSTER(spec_t);
+
+// The object that subscribers see for a change, before any transformations.
+static counted_t<const datum_t> change_val(const msg_t::change_t &change) {
+    auto null = make_counted<const datum_t>(datum_t::R_NULL);
+    std::map<std::string, counted_t<const datum_t> > obj{
+        {"new_val", change.new_val.has() ? change.new_val : null},
+        {"old_val", change.old_val.has() ? change.old_val : null}
+    };
+    return make_counted<const datum_t>(std::move(obj));
+}
+
+server_t::spec_info_t::spec_info_t(const std::string &_key, const spec_t &_spec)
+    : key(_key),
+      spec(_spec),
+      num_clients(0),
+      sending(false),
+      num_queued(0),
+      num_sent(0) {
+    for (auto it = spec.transforms.begin(); it != spec.transforms.end(); ++it) {
+        ops.push_back(make_op(*it));
+    }
+}
+
+server_t::server_t(mailbox_manager_t *_manager, rdb_context_t *_ctx)
     : uuid(generate_uuid()),
       manager(_manager),
+      ctx(_ctx),
       stop_mailbox(manager, std::bind(&server_t::stop_mailbox_cb, this, ph::_1)) { }
 
 server_t::~server_t() { }
@@ -36,7 +78,7 @@ void server_t::stop_mailbox_cb(client_t::addr_t addr) {
     }
 }
 
-void server_t::add_client(const client_t::addr_t &addr) {
+void server_t::add_client(const client_t::addr_t &addr, const spec_t &spec) {
     auto_drainer_t::lock_t lock(&drainer);
     rwlock_in_line_t spot(&clients_lock, access_t::write);
     spot.write_signal()->wait_lazily_unordered();
@@ -45,6 +87,14 @@ void server_t::add_client(const client_t::addr_t &addr) {
     // that's fine.
     if (!info->cond.has()) {
         info->stamp = 0;
+        info->spec_key = spec.key();
+        if (!info->spec_key.empty()) {
+            scoped_ptr_t<spec_info_t> *spec_info = &specs[info->spec_key];
+            if (!spec_info->has()) {
+                spec_info->init(new spec_info_t(info->spec_key, spec));
+            }
+            (*spec_info)->num_clients += 1;
+        }
         cond_t *stopped = new cond_t();
         info->cond.init(stopped);
         // We spawn now so the auto drainer lock is acquired immediately.
@@ -67,10 +117,19 @@ void server_t::add_client_cb(signal_t *stopped, client_t::addr_t addr) {
     send_all_with_lock(coro_lock, msg_t(msg_t::stop_t()));
     rwlock_in_line_t coro_spot(&clients_lock, access_t::write);
     coro_spot.write_signal()->wait_lazily_unordered();
-    size_t erased = clients.erase(addr);
+    auto it = clients.find(addr);
     // This is true even if we have multiple shards per btree because
     // `add_client` only spawns one of us.
-    guarantee(erased == 1);
+    guarantee(it != clients.end());
+    if (!it->second.spec_key.empty()) {
+        auto spec_it = specs.find(it->second.spec_key);
+        guarantee(spec_it != specs.end());
+        spec_it->second->num_clients -= 1;
+        if (spec_it->second->num_clients == 0) {
+            specs.erase(spec_it);
+        }
+    }
+    clients.erase(it);
 }
 
 struct stamped_msg_t {
@@ -90,10 +149,31 @@ RDB_MAKE_SERIALIZABLE_3(stamped_msg_t, server_uuid, stamp, submsg);
 // always ackquire a drainer lock before sending because we sometimes send a
 // `stop_t` during destruction, and you can't acquire a drain lock on a draining
 // `auto_drainer_t`.)
-void server_t::send_all_with_lock(const auto_drainer_t::lock_t &, msg_t msg) {
+void server_t::send_all_with_lock(const auto_drainer_t::lock_t &lock, msg_t msg) {
     rwlock_in_line_t spot(&clients_lock, access_t::read);
     spot.read_signal()->wait_lazily_unordered();
+
+    // Evaluating the specs could take a while, and we're on the write path, so we
+    // only queue the message for them here.  Going through the queue even when
+    // it isn't a change keeps every client's messages in order.
+    for (auto it = specs.begin(); it != specs.end(); ++it) {
+        spec_info_t *info = it->second.get();
+        info->queue.push_back(msg);
+        info->num_queued += 1;
+        if (!info->sending) {
+            info->sending = true;
+            coro_t::spawn_sometime(std::bind(&server_t::send_spec_msgs,
+                                             this,
+                                             info,
+                                             lock,
+                                             auto_drainer_t::lock_t(&info->drainer)));
+        }
+    }
+
     for (auto it = clients.begin(); it != clients.end(); ++it) {
+        if (!it->second.spec_key.empty()) {
+            continue;
+        }
         uint64_t stamp;
         {
             // We don't need a write lock as long as we make sure the coroutine
@@ -105,6 +185,85 @@ void server_t::send_all_with_lock(const auto_drainer_t::lock_t &, msg_t msg) {
     }
 }
 
+void server_t::send_spec_msgs(spec_info_t *info,
+                              auto_drainer_t::lock_t lock,
+                              auto_drainer_t::lock_t spec_lock) {
+    // When the server shuts down we stop evaluating the spec, but we still send the
+    // `stop_t`s its clients are about to get.  When the spec's last client goes
+    // away, nobody wants the messages any more.
+    wait_any_t interruptor(lock.get_drain_signal(), spec_lock.get_drain_signal());
+    try {
+        while (!info->queue.empty()) {
+            msg_t msg(std::move(info->queue.front()));
+            info->queue.pop_front();
+
+            boost::optional<msg_t> spec_msg;
+            if (const msg_t::change_t *change = boost::get<msg_t::change_t>(&msg.op)) {
+                try {
+                    spec_msg = apply_spec(&interruptor, info, *change);
+                } catch (const interrupted_exc_t &) {
+                    if (spec_lock.get_drain_signal()->is_pulsed()) {
+                        throw;
+                    }
+                }
+            } else {
+                spec_msg = std::move(msg);
+            }
+
+            if (spec_msg) {
+                rwlock_in_line_t spot(&clients_lock, access_t::read);
+                wait_interruptible(spot.read_signal(), spec_lock.get_drain_signal());
+                for (auto it = clients.begin(); it != clients.end(); ++it) {
+                    if (it->second.spec_key != info->key) {
+                        continue;
+                    }
+                    uint64_t stamp;
+                    {
+                        ASSERT_NO_CORO_WAITING;
+                        stamp = it->second.stamp++;
+                    }
+                    send(manager, it->first, stamped_msg_t(uuid, stamp, *spec_msg));
+                }
+            }
+
+            info->num_sent += 1;
+            for (auto it = info->sent_waiters.begin();
+                 it != info->sent_waiters.end() && it->first <= info->num_sent;) {
+                it->second->pulse();
+                info->sent_waiters.erase(it++);
+            }
+        }
+    } catch (const interrupted_exc_t &) {
+        // The spec's last client is gone, and the spec is about to be destroyed.
+    }
+    info->sending = false;
+}
+
+boost::optional<msg_t> server_t::apply_spec(signal_t *interruptor,
+                                            spec_info_t *info,
+                                            const msg_t::change_t &change) {
+    env_t env(ctx, interruptor, info->spec.optargs, profile_bool_t::DONT_PROFILE);
+    groups_t groups;
+    groups[counted_t<const datum_t>()] = datums_t{change_val(change)};
+    try {
+        for (auto it = info->ops.begin(); it != info->ops.end(); ++it) {
+            (**it)(&env, &groups, counted_t<const datum_t>());
+        }
+    } catch (const exc_t &e) {
+        return msg_t(msg_t::spec_error_t(e));
+    } catch (const datum_exc_t &e) {
+        return msg_t(msg_t::spec_error_t(exc_t(e, NULL)));
+    }
+
+    // A spec is only made of `map`s and `filter`s, so there's at most one value.
+    auto it = groups.find(counted_t<const datum_t>());
+    if (it == groups.end() || it->second.empty()) {
+        return boost::none;
+    }
+    r_sanity_check(it->second.size() == 1);
+    return msg_t(msg_t::spec_change_t(std::move(it->second[0])));
+}
+
 void server_t::send_all(msg_t msg) {
     auto_drainer_t::lock_t lock(&drainer);
     send_all_with_lock(lock, std::move(msg));
@@ -125,14 +284,40 @@ server_t::addr_t server_t::get_stop_addr() {
 
 uint64_t server_t::get_stamp(const client_t::addr_t &addr) {
     auto_drainer_t::lock_t lock(&drainer);
-    rwlock_in_line_t spot(&clients_lock, access_t::read);
-    spot.read_signal()->wait_lazily_unordered();
-    auto it = clients.find(addr);
-    if (it == clients.end()) {
-        // The client was removed, so no future messages are coming.
-        return std::numeric_limits<uint64_t>::max();
-    } else {
-        return it->second.stamp;
+    for (;;) {
+        rwlock_in_line_t spot(&clients_lock, access_t::read);
+        spot.read_signal()->wait_lazily_unordered();
+        auto it = clients.find(addr);
+        if (it == clients.end()) {
+            // The client was removed, so no future messages are coming.
+            return std::numeric_limits<uint64_t>::max();
+        }
+        if (it->second.spec_key.empty()) {
+            return it->second.stamp;
+        }
+
+        // The messages that were sent before now only get their stamps once they
+        // are through the spec, so we have to wait for them.
+        auto spec_it = specs.find(it->second.spec_key);
+        guarantee(spec_it != specs.end());
+        spec_info_t *info = spec_it->second.get();
+        if (info->num_sent == info->num_queued
+            || lock.get_drain_signal()->is_pulsed()) {
+            return it->second.stamp;
+        }
+        // Keeps `info` alive while we don't hold `clients_lock`, which we can't
+        // hold while we wait, since `send_spec_msgs` needs it too.
+        auto_drainer_t::lock_t spec_lock(&info->drainer);
+        cond_t sent;
+        auto waiter = info->sent_waiters.insert(
+            std::make_pair(info->num_queued, &sent));
+        spot.reset();
+        wait_any_t waiter_done(
+            &sent, spec_lock.get_drain_signal(), lock.get_drain_signal());
+        waiter_done.wait_lazily_unordered();
+        if (!sent.is_pulsed()) {
+            info->sent_waiters.erase(waiter);
+        }
     }
 }
 
@@ -143,6 +328,8 @@ uuid_u server_t::get_uuid() {
 msg_t::msg_t(msg_t &&msg) : op(std::move(msg.op)) { }
 msg_t::msg_t(stop_t &&_op) : op(std::move(_op)) { }
 msg_t::msg_t(change_t &&_op) : op(std::move(_op)) { }
+msg_t::msg_t(spec_change_t &&_op) : op(std::move(_op)) { }
+msg_t::msg_t(spec_error_t &&_op) : op(std::move(_op)) { }
 
 msg_t::change_t::change_t() { }
 msg_t::change_t::change_t(counted_t<const datum_t> _old_val,
@@ -150,9 +337,21 @@ msg_t::change_t::change_t(counted_t<const datum_t> _old_val,
     : old_val(std::move(_old_val)), new_val(std::move(_new_val)) { }
 msg_t::change_t::~change_t() { }
 
-RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(msg_t, op);
+msg_t::spec_change_t::spec_change_t() { }
+msg_t::spec_change_t::spec_change_t(counted_t<const datum_t> _val)
+    : val(std::move(_val)) { }
+msg_t::spec_change_t::~spec_change_t() { }
+
+// Serialization format changed in 1.14.  We only support the latest version,
+// since this is a cluster-only type.
+RDB_IMPL_SERIALIZABLE_1(msg_t, op);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t);
 RDB_IMPL_ME_SERIALIZABLE_2_SINCE_v1_13(msg_t::change_t, empty_ok(old_val), empty_ok(new_val));
 RDB_IMPL_SERIALIZABLE_0_SINCE_v1_13(msg_t::stop_t);
+RDB_IMPL_ME_SERIALIZABLE_1(msg_t::spec_change_t, val);
+INSTANTIATE_SERIALIZABLE_SELF_FOR_CLUSTER(msg_t::spec_change_t);
+RDB_IMPL_SERIALIZABLE_1(msg_t::spec_error_t, exc);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t::spec_error_t);
 
 enum class detach_t { NO, YES };
 
@@ -165,9 +364,13 @@ public:
     std::vector<counted_t<const datum_t> >
     get_els(batcher_t *batcher, const signal_t *interruptor);
     void add_el(const uuid_u &uuid, uint64_t stamp, counted_t<const datum_t> d);
+    // Fails the subscription with `e`, unless the message it came in predates us.
+    void add_exc(const uuid_u &uuid, uint64_t stamp, const exc_t &e);
     void start(std::map<uuid_u, uint64_t> &&_start_stamps);
     void stop(const std::string &msg, detach_t should_detach);
 private:
+    // Whether we should see a message from the server `uuid` with stamp `stamp`.
+    bool wants(const uuid_u &uuid, uint64_t stamp) const;
     void maybe_signal_cond() THROWS_NOTHING;
     // If an error occurs, we're detached and `exc` is set to an exception to rethrow.
     std::exception_ptr exc;
@@ -196,6 +399,7 @@ public:
            mailbox_manager_t *manager,
            base_namespace_repo_t *ns_repo,
            uuid_u uuid,
+           const spec_t &spec,
            signal_t *interruptor);
     ~feed_t();
     void add_sub(subscription_t *sub) THROWS_NOTHING;
@@ -212,6 +416,8 @@ private:
 
     client_t *client;
     uuid_u uuid;
+    // Our key in `client`'s map of feeds.
+    client_t::feed_key_t key;
     mailbox_manager_t *manager;
     mailbox_t<void(stamped_msg_t)> mailbox;
     std::vector<server_t::addr_t> stop_addrs;
@@ -248,18 +454,28 @@ public:
     msg_visitor_t(feed_t *_feed, uuid_u _server_uuid, uint64_t _stamp)
         : feed(_feed), server_uuid(_server_uuid), stamp(_stamp) { }
     void operator()(const msg_t::change_t &change) const {
-        auto null = make_counted<const datum_t>(datum_t::R_NULL);
-        std::map<std::string, counted_t<const datum_t> > obj{
-            {"new_val", change.new_val.has() ? change.new_val : null},
-            {"old_val", change.old_val.has() ? change.old_val : null}
-        };
-        auto d = make_counted<const datum_t>(std::move(obj));
         feed->each_sub(
             std::bind(&subscription_t::add_el,
                       ph::_1,
                       std::cref(server_uuid),
                       stamp,
-                      d));
+                      change_val(change)));
+    }
+    void operator()(const msg_t::spec_change_t &change) const {
+        feed->each_sub(
+            std::bind(&subscription_t::add_el,
+                      ph::_1,
+                      std::cref(server_uuid),
+                      stamp,
+                      change.val));
+    }
+    void operator()(const msg_t::spec_error_t &error) const {
+        feed->each_sub(
+            std::bind(&subscription_t::add_exc,
+                      ph::_1,
+                      std::cref(server_uuid),
+                      stamp,
+                      std::cref(error.exc)));
     }
     void operator()(const msg_t::stop_t &) const {
         const char *msg = "Changefeed aborted (table unavailable).";
@@ -271,12 +487,30 @@ private:
     uint64_t stamp;
 };
 
+// Whether a server can apply `tv` for us.  (We don't want servers to evaluate
+// functions that could e.g. read from other tables.)
+class spec_transform_visitor_t : public boost::static_visitor<bool> {
+public:
+    bool operator()(const map_wire_func_t &f) const {
+        return f.compile_wire_func()->is_deterministic();
+    }
+    bool operator()(const filter_wire_func_t &f) const {
+        return f.filter_func.compile_wire_func()->is_deterministic()
+            && (!f.default_filter_val
+                || f.default_filter_val->compile_wire_func()->is_deterministic());
+    }
+    template<class T>
+    bool operator()(const T &) const {
+        return false;
+    }
+};
+
 class stream_t : public eager_datum_stream_t {
 public:
-    template<class... Args>
-    stream_t(scoped_ptr_t<subscription_t> &&_sub, Args... args)
-        : eager_datum_stream_t(std::forward<Args...>(args...)),
-          sub(std::move(_sub)) { }
+    stream_t(client_t *_client,
+             counted_t<table_t> _tbl,
+             const protob_t<const Backtrace> &bt)
+        : eager_datum_stream_t(bt), client(_client), tbl(std::move(_tbl)) { }
     virtual bool is_array() { return false; }
     virtual bool is_exhausted() const { return false; }
     virtual bool is_cfeed() const { return true; }
@@ -287,10 +521,33 @@ public:
                base_exc_t::GENERIC,
                "Cannot call a terminal (`reduce`, `count`, etc.) on an "
                "infinite stream (such as a changefeed).");
+        if (!sub.has()) {
+            if (!spec.empty()) {
+                spec.optargs = env->global_optargs.get_all_optargs();
+            }
+            sub = client->subscribe(tbl, spec, env);
+        }
         batcher_t batcher = bs.to_batcher();
         return sub->get_els(&batcher, env->interruptor);
     }
 private:
+    virtual void add_transformation(transform_variant_t &&tv,
+                                    const protob_t<const Backtrace> &bt) {
+        // Until we subscribe, a prefix of `map`s and `filter`s can be left to the
+        // servers.
+        if (!sub.has() && !ops_to_do()
+            && boost::apply_visitor(spec_transform_visitor_t(), tv)) {
+            spec.transforms.push_back(std::move(tv));
+            update_bt(bt);
+        } else {
+            eager_datum_stream_t::add_transformation(std::move(tv), bt);
+        }
+    }
+
+    client_t *const client;
+    const counted_t<table_t> tbl;
+    spec_t spec;
+    // Empty until the first read.
     scoped_ptr_t<subscription_t> sub;
 };
 
@@ -360,22 +617,35 @@ subscription_t::get_els(batcher_t *batcher, const signal_t *interruptor) {
     return std::move(v);
 }
 
-void subscription_t::add_el(
-    const uuid_u &uuid, uint64_t stamp, counted_t<const datum_t> d) {
-    assert_thread();
+bool subscription_t::wants(const uuid_u &uuid, uint64_t stamp) const {
     // If we don't have start timestamps, we haven't started, and if we have
     // exc, we've stopped.
     if (start_stamps.size() != 0 && !exc) {
         auto it = start_stamps.find(uuid);
         guarantee(it != start_stamps.end());
-        if (stamp >= it->second) {
-            els.push_back(d);
-            if (els.size() > array_size_limit()) {
-                skipped += els.size();
-                els.clear();
-            }
-            maybe_signal_cond();
+        return stamp >= it->second;
+    }
+    return false;
+}
+
+void subscription_t::add_el(
+    const uuid_u &uuid, uint64_t stamp, counted_t<const datum_t> d) {
+    assert_thread();
+    if (wants(uuid, stamp)) {
+        els.push_back(d);
+        if (els.size() > array_size_limit()) {
+            skipped += els.size();
+            els.clear();
         }
+        maybe_signal_cond();
+    }
+}
+
+void subscription_t::add_exc(const uuid_u &uuid, uint64_t stamp, const exc_t &e) {
+    assert_thread();
+    if (wants(uuid, stamp)) {
+        exc = std::make_exception_ptr(e);
+        maybe_signal_cond();
     }
 }
 
@@ -427,7 +697,7 @@ void feed_t::del_sub(subscription_t *sub) THROWS_NOTHING {
     if (num_subs == 0) {
         // It's possible that by the time we get the lock to remove the feed,
         // another subscriber might have already found the feed and subscribed.
-        client->maybe_remove_feed(uuid);
+        client->maybe_remove_feed(key);
     }
 }
 
@@ -512,9 +782,11 @@ feed_t::feed_t(client_t *_client,
                mailbox_manager_t *_manager,
                base_namespace_repo_t *ns_repo,
                uuid_u _uuid,
+               const spec_t &spec,
                signal_t *interruptor)
     : client(_client),
       uuid(_uuid),
+      key(uuid, spec.key()),
       manager(_manager),
       mailbox(manager, std::bind(&feed_t::mailbox_cb, this, ph::_1)),
       subs(get_num_threads()),
@@ -522,7 +794,7 @@ feed_t::feed_t(client_t *_client,
       detached(false) {
     base_namespace_repo_t::access_t access(ns_repo, uuid, interruptor);
     namespace_interface_t *nif = access.get_namespace_if();
-    read_t read(changefeed_subscribe_t(mailbox.get_address()),
+    read_t read(changefeed_subscribe_t(mailbox.get_address(), spec),
                 profile_bool_t::DONT_PROFILE);
     read_response_t read_resp;
     nif->read(read, &read_resp, order_token_t::ignore, interruptor);
@@ -575,7 +847,7 @@ void feed_t::constructor_cb() {
     wait_any_t wait_any(&any_disconnect, lock.get_drain_signal());
     wait_any.wait_lazily_unordered();
     if (!detached) {
-        scoped_ptr_t<feed_t> self = client->detach_feed(uuid);
+        scoped_ptr_t<feed_t> self = client->detach_feed(key);
         detached = true;
         if (self.has()) {
             const char *msg = "Disconnected from peer.";
@@ -603,9 +875,16 @@ client_t::client_t(mailbox_manager_t *_manager)
 client_t::~client_t() { }
 
 counted_t<datum_stream_t>
-client_t::new_feed(const counted_t<table_t> &tbl, env_t *env) {
+client_t::new_feed(const counted_t<table_t> &tbl, env_t *) {
+    return make_counted<stream_t>(this, tbl, tbl->backtrace());
+}
+
+scoped_ptr_t<subscription_t> client_t::subscribe(const counted_t<table_t> &tbl,
+                                                 const spec_t &spec,
+                                                 env_t *env) {
     try {
         uuid_u uuid = tbl->get_uuid();
+        feed_key_t key(uuid, spec.key());
         scoped_ptr_t<subscription_t> sub;
         addr_t addr;
         {
@@ -615,12 +894,12 @@ client_t::new_feed(const counted_t<table_t> &tbl, env_t *env) {
             auto_drainer_t::lock_t lock(&drainer);
             rwlock_in_line_t spot(&feeds_lock, access_t::write);
             spot.read_signal()->wait_lazily_unordered();
-            auto feed_it = feeds.find(uuid);
+            auto feed_it = feeds.find(key);
             if (feed_it == feeds.end()) {
                 spot.write_signal()->wait_lazily_unordered();
                 auto val = make_scoped<feed_t>(
-                        this, manager, env->ns_repo(), uuid, &interruptor);
-                feed_it = feeds.insert(std::make_pair(uuid, std::move(val))).first;
+                        this, manager, env->ns_repo(), uuid, spec, &interruptor);
+                feed_it = feeds.insert(std::make_pair(key, std::move(val))).first;
             }
 
             // We need to do this while holding `feeds_lock` to make sure the
@@ -638,7 +917,7 @@ client_t::new_feed(const counted_t<table_t> &tbl, env_t *env) {
         auto resp = boost::get<changefeed_stamp_response_t>(&read_resp.response);
         guarantee(resp != NULL);
         sub->start(std::move(resp->stamps));
-        return make_counted<stream_t>(std::move(sub), tbl->backtrace());
+        return sub;
     } catch (const cannot_perform_query_exc_t &e) {
         rfail_datum(ql::base_exc_t::GENERIC,
                     "cannot subscribe to table `%s`: %s",
@@ -646,13 +925,13 @@ client_t::new_feed(const counted_t<table_t> &tbl, env_t *env) {
     }
 }
 
-void client_t::maybe_remove_feed(const uuid_u &uuid) {
+void client_t::maybe_remove_feed(const feed_key_t &key) {
     assert_thread();
     scoped_ptr_t<feed_t> destroy;
     auto_drainer_t::lock_t lock(&drainer);
     rwlock_in_line_t spot(&feeds_lock, access_t::write);
     spot.write_signal()->wait_lazily_unordered();
-    auto feed_it = feeds.find(uuid);
+    auto feed_it = feeds.find(key);
     // The feed might have disappeared because it may have been detached while
     // we held the lock, in which case we don't need to do anything.  The feed
     // might also have gotten a new subscriber, in which case we don't want to
@@ -665,7 +944,7 @@ void client_t::maybe_remove_feed(const uuid_u &uuid) {
     }
 }
 
-scoped_ptr_t<feed_t> client_t::detach_feed(const uuid_u &uuid) {
+scoped_ptr_t<feed_t> client_t::detach_feed(const feed_key_t &key) {
     assert_thread();
     scoped_ptr_t<feed_t> ret;
     auto_drainer_t::lock_t lock(&drainer);
@@ -673,7 +952,7 @@ scoped_ptr_t<feed_t> client_t::detach_feed(const uuid_u &uuid) {
     spot.write_signal()->wait_lazily_unordered();
     // The feed might have been removed in `maybe_remove_feed`, in which case
     // there's nothing to detach.
-    auto feed_it = feeds.find(uuid);
+    auto feed_it = feeds.find(key);
     if (feed_it != feeds.end()) {
         ret.swap(feed_it->second);
         feeds.erase(feed_it);
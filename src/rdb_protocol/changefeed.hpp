@@ -4,8 +4,12 @@
 #include <deque>
 #include <exception>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "errors.hpp"
+#include <boost/optional.hpp>
 #include <boost/variant.hpp>
 
 #include "concurrency/rwlock.hpp"
@@ -15,11 +19,14 @@
 #include "repli_timestamp.hpp"
 #include "rpc/connectivity/connectivity.hpp"
 #include "rpc/mailbox/typed.hpp"
+#include "rdb_protocol/error.hpp"
+#include "rdb_protocol/shards.hpp"
 #include "rpc/serialize_macros.hpp"
 
 class auto_drainer_t;
 class base_namespace_repo_t;
 class mailbox_manager_t;
+class rdb_context_t;
 struct rdb_modification_report_t;
 
 namespace ql {
@@ -34,6 +41,29 @@ class table_t;
 
 namespace changefeed {
 
+// The transformations that a subscriber applies to the changes right after
+// `changes()`.  A `server_t` applies them before sending a change to the
+// subscriber, so that changes the subscriber would drop anyway never cross the
+// network, and the ones it keeps only carry the fields it wants.  Only `map`s
+// (which is what `pluck` on a stream turns into) and `filter`s with deterministic
+// functions go into a spec.
+struct spec_t {
+    spec_t() { }
+
+    bool empty() const { return transforms.empty(); }
+    // Specs with the same key are interchangeable.  The empty spec's key is "".
+    std::string key() const;
+
+    std::vector<transform_variant_t> transforms;
+    // The global optargs of the subscribing query, which the transformations are
+    // evaluated with.
+    std::map<std::string, wire_func_t> optargs;
+
+    RDB_DECLARE_ME_SERIALIZABLE;
+};
+
+RDB_SERIALIZE_OUTSIDE(spec_t);
+
 struct msg_t {
     struct change_t {
         change_t();
@@ -45,11 +75,28 @@ struct msg_t {
     };
     struct stop_t {
     };
+    // What's left of a change after the `server_t` applied a client's `spec_t` to
+    // it.  (Changes that the spec filters out aren't sent at all.)
+    struct spec_change_t {
+        spec_change_t();
+        explicit spec_change_t(counted_t<const datum_t> _val);
+        ~spec_change_t();
+        counted_t<const datum_t> val;
+        RDB_DECLARE_ME_SERIALIZABLE;
+    };
+    // Sent instead of a `spec_change_t` if applying the spec to a change failed.
+    struct spec_error_t {
+        spec_error_t() { }
+        explicit spec_error_t(const exc_t &_exc) : exc(_exc) { }
+        exc_t exc;
+    };
 
     msg_t() { }
     msg_t(msg_t &&msg);
     explicit msg_t(stop_t &&op);
     explicit msg_t(change_t &&op);
+    explicit msg_t(spec_change_t &&op);
+    explicit msg_t(spec_error_t &&op);
 
     // We need to define the copy constructor.  GCC 4.4 doesn't let use use `=
     // default`, and SRH is uncomfortable violating the rule of 3, so we define
@@ -62,11 +109,13 @@ struct msg_t {
     }
 
     // Starts with STOP to avoid doing work for default initialization.
-    boost::variant<stop_t, change_t> op;
+    boost::variant<stop_t, change_t, spec_change_t, spec_error_t> op;
 };
 
 RDB_SERIALIZE_OUTSIDE(msg_t::change_t);
 RDB_DECLARE_SERIALIZABLE(msg_t::stop_t);
+RDB_SERIALIZE_OUTSIDE(msg_t::spec_change_t);
+RDB_DECLARE_SERIALIZABLE(msg_t::spec_error_t);
 RDB_DECLARE_SERIALIZABLE(msg_t);
 
 class feed_t;
@@ -74,27 +123,35 @@ struct stamped_msg_t;
 
 typedef mailbox_addr_t<void(stamped_msg_t)> client_addr_t;
 
+class subscription_t;
+
 // The `client_t` exists on the machine handling the changefeed query, in the
 // `rdb_context_t`.  When a query subscribes to the changes on a table, it
 // should call `new_feed`.  The `client_t` will give it back a stream of rows.
-// The `client_t` does this by maintaining an internal map from table UUIDs to
-// `feed_t`s.  (It does this so that there is at most one `feed_t` per <table,
-// client> pair, to prevent redundant cluster messages.)  The actual logic for
+// The stream subscribes when it's first read, so that the transformations
+// applied to it before then can go into its `spec_t`.  The `client_t`
+// maintains an internal map from table UUIDs and spec keys to `feed_t`s.  (It
+// does this so that there is at most one `feed_t` per <table, spec, client>
+// triple, to prevent redundant cluster messages.)  The actual logic for
 // subscribing to a changefeed server and distributing writes to streams can be
 // found in the `feed_t` class.
 class client_t : public home_thread_mixin_t {
 public:
     typedef client_addr_t addr_t;
+    typedef std::pair<uuid_u, std::string> feed_key_t;
     explicit client_t(mailbox_manager_t *_manager);
     ~client_t();
-    // Throws QL exceptions.
     counted_t<datum_stream_t> new_feed(const counted_t<table_t> &tbl, env_t *env);
-    void maybe_remove_feed(const uuid_u &uuid);
-    scoped_ptr_t<feed_t> detach_feed(const uuid_u &uuid);
+    // Throws QL exceptions.
+    scoped_ptr_t<subscription_t> subscribe(const counted_t<table_t> &tbl,
+                                           const spec_t &spec,
+                                           env_t *env);
+    void maybe_remove_feed(const feed_key_t &key);
+    scoped_ptr_t<feed_t> detach_feed(const feed_key_t &key);
 private:
     friend class subscription_t;
     mailbox_manager_t *const manager;
-    std::map<uuid_u, scoped_ptr_t<feed_t> > feeds;
+    std::map<feed_key_t, scoped_ptr_t<feed_t> > feeds;
     // This lock manages access to the `feeds` map.  The `feeds` map needs to be
     // read whenever `new_feed` is called, and needs to be written to whenever
     // `new_feed` is called with a table not already in the `feeds` map, or
@@ -114,20 +171,53 @@ typedef mailbox_addr_t<void(client_addr_t)> server_addr_t;
 
 // There is one `server_t` per `store_t`, and it is used to send changes that
 // occur on that `store_t` to any subscribed `feed_t`s contained in a
-// `client_t`.
+// `client_t`.  Each change is run through each distinct `spec_t` once, no
+// matter how many clients share that spec.  That happens in a coroutine per spec
+// rather than in `send_all`, which runs on the write path.
 class server_t {
 public:
     typedef server_addr_t addr_t;
-    explicit server_t(mailbox_manager_t *_manager);
+    server_t(mailbox_manager_t *_manager, rdb_context_t *_ctx);
     ~server_t();
-    void add_client(const client_t::addr_t &addr);
+    void add_client(const client_t::addr_t &addr, const spec_t &spec);
     void send_all(msg_t msg);
     void stop_all();
     addr_t get_stop_addr();
     uint64_t get_stamp(const client_t::addr_t &addr);
     uuid_u get_uuid();
 private:
+    struct spec_info_t {
+        spec_info_t(const std::string &_key, const spec_t &_spec);
+        const std::string key;
+        spec_t spec;
+        std::vector<scoped_ptr_t<op_t> > ops;
+        size_t num_clients;
+        // The messages for the clients with this spec that `send_spec_msgs` hasn't
+        // gotten to yet, in the order they were sent.  The clients' stamps are
+        // only assigned once a change has made it through the spec, so that the
+        // ones it filters out don't leave gaps.
+        std::deque<msg_t> queue;
+        // Whether `send_spec_msgs` is running for this spec.
+        bool sending;
+        // How many messages have been put into and taken out of `queue`.
+        uint64_t num_queued;
+        uint64_t num_sent;
+        // `get_stamp` waits on these until `num_sent` reaches the key.
+        std::multimap<uint64_t, cond_t *> sent_waiters;
+        // Destroyed first, so that `send_spec_msgs` is done before the rest goes.
+        auto_drainer_t drainer;
+    };
+
     void send_all_with_lock(const auto_drainer_t::lock_t &lock, msg_t msg);
+    // Sends the messages in `info->queue` until it's empty.
+    void send_spec_msgs(spec_info_t *info,
+                        auto_drainer_t::lock_t lock,
+                        auto_drainer_t::lock_t spec_lock);
+    // Returns the message to send to the clients with `info`'s spec, or nothing
+    // if the spec filters the change out.
+    boost::optional<msg_t> apply_spec(signal_t *interruptor,
+                                      spec_info_t *info,
+                                      const msg_t::change_t &change);
     void stop_mailbox_cb(client_t::addr_t addr);
     void add_client_cb(signal_t *stopped, client_t::addr_t addr);
 
@@ -136,14 +226,20 @@ private:
     // from before their own creation timestamp on a per-server basis).
     const uuid_u uuid;
     mailbox_manager_t *const manager;
+    rdb_context_t *const ctx;
 
     struct client_info_t {
         scoped_ptr_t<cond_t> cond;
         uint64_t stamp;
+        std::string spec_key;
     };
     std::map<client_t::addr_t, client_info_t> clients;
+    // The specs of the clients with non-empty specs, by key.  Also protected by
+    // `clients_lock`.
+    std::map<std::string, scoped_ptr_t<spec_info_t> > specs;
     // Controls access to `clients`.  A `server_t` needs to read `clients` when:
     // * `send_all` is called
+    // * `send_spec_msgs` sends a message
     // * `get_stamp` is called
     // And needs to write to clients when:
     // * `add_client` is called
@@ -88,9 +88,17 @@ rdb_context_t::rdb_context_t()
       ns_repo(NULL), reql_admin_interface(NULL),
       manager(NULL),
       changefeed_client(NULL),
+      io_backender(NULL),
+      base_path(""),
       ql_stats_membership(
           &get_global_perfmon_collection(), &ql_stats_collection, "query_language"),
       ql_ops_running_membership(&ql_stats_collection, &ql_ops_running, "ops_running"),
+      ql_prefetch_hits_membership(
+          &ql_stats_collection, &ql_prefetch_hits, "cursor_prefetch_hits"),
+      ql_prefetch_wasted_membership(
+          &ql_stats_collection, &ql_prefetch_wasted, "cursor_prefetch_wasted"),
+      ql_query_latency(secs_to_ticks(1)),
+      ql_query_latency_membership(&ql_stats_collection, &ql_query_latency, "query_latency"),
       reql_http_proxy()
 { }
 
@@ -102,9 +110,17 @@ rdb_context_t::rdb_context_t(
       ns_repo(_ns_repo), reql_admin_interface(_reql_admin_interface),
       manager(NULL),
       changefeed_client(NULL),
+      io_backender(NULL),
+      base_path(""),
       ql_stats_membership(
           &get_global_perfmon_collection(), &ql_stats_collection, "query_language"),
       ql_ops_running_membership(&ql_stats_collection, &ql_ops_running, "ops_running"),
+      ql_prefetch_hits_membership(
+          &ql_stats_collection, &ql_prefetch_hits, "cursor_prefetch_hits"),
+      ql_prefetch_wasted_membership(
+          &ql_stats_collection, &ql_prefetch_wasted, "cursor_prefetch_wasted"),
+      ql_query_latency(secs_to_ticks(1)),
+      ql_query_latency_membership(&ql_stats_collection, &ql_query_latency, "query_latency"),
       reql_http_proxy()
 { }
 
@@ -116,7 +132,9 @@ rdb_context_t::rdb_context_t(
         boost::shared_ptr< semilattice_readwrite_view_t<auth_semilattice_metadata_t> >
             _auth_metadata,
         perfmon_collection_t *_global_stats,
-        const std::string &_reql_http_proxy)
+        const std::string &_reql_http_proxy,
+        io_backender_t *_io_backender,
+        const base_path_t &_base_path)
     : extproc_pool(_extproc_pool),
       ns_repo(_ns_repo), reql_admin_interface(_reql_admin_interface),
       auth_metadata(_auth_metadata),
@@ -124,8 +142,16 @@ rdb_context_t::rdb_context_t(
       changefeed_client(manager
                         ? make_scoped<ql::changefeed::client_t>(manager)
                         : scoped_ptr_t<ql::changefeed::client_t>()),
+      io_backender(_io_backender),
+      base_path(_base_path),
       ql_stats_membership(_global_stats, &ql_stats_collection, "query_language"),
       ql_ops_running_membership(&ql_stats_collection, &ql_ops_running, "ops_running"),
+      ql_prefetch_hits_membership(
+          &ql_stats_collection, &ql_prefetch_hits, "cursor_prefetch_hits"),
+      ql_prefetch_wasted_membership(
+          &ql_stats_collection, &ql_prefetch_wasted, "cursor_prefetch_wasted"),
+      ql_query_latency(secs_to_ticks(1)),
+      ql_query_latency_membership(&ql_stats_collection, &ql_query_latency, "query_latency"),
       reql_http_proxy(_reql_http_proxy)
 { }
 
@@ -13,9 +13,11 @@
 #include "containers/scoped.hpp"
 #include "perfmon/perfmon.hpp"
 #include "rdb_protocol/changefeed.hpp"
+#include "utils.hpp"
 
 class auth_semilattice_metadata_t;
 class extproc_pool_t;
+class io_backender_t;
 class name_string_t;
 class namespace_interface_t;
 template <class> class semilattice_readwrite_view_t;
@@ -52,7 +54,7 @@ public:
             counted_t<const ql::db_t> *db_out, std::string *error_out) = 0;
     virtual bool table_create(const name_string_t &name, counted_t<const ql::db_t> db,
             const boost::optional<name_string_t> &primary_dc, bool hard_durability,
-            const std::string &primary_key,
+            const std::string &primary_key, const boost::optional<int32_t> &cpu_shards,
             signal_t *interruptor, uuid_u *namespace_id_out, std::string *error_out) = 0;
     virtual bool table_drop(const name_string_t &name, counted_t<const ql::db_t> db,
             signal_t *interruptor, std::string *error_out) = 0;
@@ -137,7 +139,9 @@ public:
                     semilattice_readwrite_view_t<
                         auth_semilattice_metadata_t> > _auth_metadata,
                   perfmon_collection_t *_global_stats,
-                  const std::string &_reql_http_proxy);
+                  const std::string &_reql_http_proxy,
+                  io_backender_t *_io_backender,
+                  const base_path_t &_base_path);
 
     ~rdb_context_t();
 
@@ -151,10 +155,25 @@ public:
     mailbox_manager_t *manager;
     scoped_ptr_t<ql::changefeed::client_t> changefeed_client;
 
+    // Used for queries that need to spill data to disk, like large unindexed
+    // `orderBy`s.  `io_backender` is `NULL` if we can't do that (e.g. on proxies).
+    io_backender_t *io_backender;
+    base_path_t base_path;
+
     perfmon_collection_t ql_stats_collection;
     perfmon_membership_t ql_stats_membership;
     perfmon_counter_t ql_ops_running;
     perfmon_membership_t ql_ops_running_membership;
+    // CONTINUEs that found their batch already computed by read-ahead, and batches
+    // computed by read-ahead that were thrown away because the cursor was closed.
+    perfmon_counter_t ql_prefetch_hits;
+    perfmon_membership_t ql_prefetch_hits_membership;
+    perfmon_counter_t ql_prefetch_wasted;
+    perfmon_membership_t ql_prefetch_wasted_membership;
+    // How long queries take to run, from the moment the server has parsed them to
+    // the moment the response is ready.
+    perfmon_latency_histogram_t ql_query_latency;
+    perfmon_membership_t ql_query_latency_membership;
 
     const std::string reql_http_proxy;
 
@@ -5,6 +5,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 
@@ -28,6 +29,78 @@ const std::set<std::string> datum_t::_allowed_pts = std::set<std::string>();
 
 const char* const datum_t::reql_type_string = "$reql_type$";
 
+bool field_key_less(const datum_object_t::value_type &field, const std::string &key) {
+    return field.first < key;
+}
+
+bool field_less(const datum_object_t::value_type &a,
+                const datum_object_t::value_type &b) {
+    return a.first < b.first;
+}
+
+datum_object_t::datum_object_t(std::map<std::string, counted_t<const datum_t> > &&map) {
+    fields_.reserve(map.size());
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        fields_.push_back(value_type(std::move(const_cast<std::string &>(it->first)),
+                                     std::move(it->second)));
+    }
+    map.clear();
+}
+
+bool datum_object_t::assign_unsorted(std::vector<value_type> &&fields,
+                                     std::string *duplicate_key_out) {
+    fields_ = std::move(fields);
+    std::sort(fields_.begin(), fields_.end(), field_less);
+    for (size_t i = 1; i < fields_.size(); ++i) {
+        if (fields_[i - 1].first == fields_[i].first) {
+            *duplicate_key_out = fields_[i].first;
+            fields_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool datum_object_t::append(std::string &&key, counted_t<const datum_t> &&val) {
+    if (!fields_.empty() && !(fields_.back().first < key)) {
+        return false;
+    }
+    fields_.push_back(value_type(std::move(key), std::move(val)));
+    return true;
+}
+
+bool datum_object_t::add(const std::string &key, counted_t<const datum_t> val,
+                         clobber_bool_t clobber_bool) {
+    auto it = lower_bound(key);
+    if (it != fields_.end() && it->first == key) {
+        if (clobber_bool == CLOBBER) {
+            it->second = std::move(val);
+        }
+        return true;
+    }
+    fields_.insert(it, value_type(key, std::move(val)));
+    return false;
+}
+
+bool datum_object_t::erase(const std::string &key) {
+    auto it = lower_bound(key);
+    if (it != fields_.end() && it->first == key) {
+        fields_.erase(it);
+        return true;
+    }
+    return false;
+}
+
+datum_object_t::const_iterator datum_object_t::find(const std::string &key) const {
+    auto it = std::lower_bound(fields_.begin(), fields_.end(), key, field_key_less);
+    return it != fields_.end() && it->first == key ? it : fields_.end();
+}
+
+std::vector<datum_object_t::value_type>::iterator
+datum_object_t::lower_bound(const std::string &key) {
+    return std::lower_bound(fields_.begin(), fields_.end(), key, field_key_less);
+}
+
 datum_t::datum_t(type_t _type, bool _bool) : type(_type), r_bool(_bool) {
     r_sanity_check(_type == R_BOOL);
 }
@@ -60,15 +133,21 @@ datum_t::datum_t(std::vector<counted_t<const datum_t> > &&_array)
 
 datum_t::datum_t(std::map<std::string, counted_t<const datum_t> > &&_object)
     : type(R_OBJECT),
-      r_object(new std::map<std::string, counted_t<const datum_t> >(
-                   std::move(_object))) {
+      r_object(new datum_object_t(std::move(_object))) {
+    maybe_sanitize_ptype();
+}
+
+datum_t::datum_t(datum_object_t &&_object)
+    : type(R_OBJECT),
+      r_object(new datum_object_t(std::move(_object))) {
     maybe_sanitize_ptype();
 }
 
 datum_t::datum_t(grouped_data_t &&gd)
     : type(R_OBJECT),
-      r_object(new std::map<std::string, counted_t<const datum_t> >()) {
-    (*r_object)[reql_type_string] = make_counted<const datum_t>("GROUPED_DATA");
+      r_object(new datum_object_t()) {
+    r_object->add(reql_type_string, make_counted<const datum_t>("GROUPED_DATA"),
+                  CLOBBER);
     std::vector<counted_t<const datum_t> > v;
     v.reserve(gd.size());
     for (auto kv = gd.begin(); kv != gd.end(); ++kv) {
@@ -76,7 +155,7 @@ datum_t::datum_t(grouped_data_t &&gd)
                         std::vector<counted_t<const datum_t> >{
                             std::move(kv->first), std::move(kv->second)}));
     }
-    (*r_object)["data"] = make_counted<const datum_t>(std::move(v));
+    r_object->add("data", make_counted<const datum_t>(std::move(v)), CLOBBER);
     // We don't sanitize the ptype because this is a fake ptype that should only
     // be used for serialization.
 }
@@ -94,7 +173,7 @@ datum_t::datum_t(datum_t::type_t _type) : type(_type) {
         r_array = new std::vector<counted_t<const datum_t> >();
     } break;
     case R_OBJECT: {
-        r_object = new std::map<std::string, counted_t<const datum_t> >();
+        r_object = new datum_object_t();
     } break;
     case UNINITIALIZED: // fallthru
     default: unreachable();
@@ -135,7 +214,7 @@ void datum_t::init_array() {
 
 void datum_t::init_object() {
     type = R_OBJECT;
-    r_object = new std::map<std::string, counted_t<const datum_t> >();
+    r_object = new datum_object_t();
 }
 
 void datum_t::init_json(cJSON *json) {
@@ -172,12 +251,20 @@ void datum_t::init_json(cJSON *json) {
     } break;
     case cJSON_Object: {
         init_object();
+        // We sort the fields once at the end, rather than inserting them one by
+        // one.
+        std::vector<datum_object_t::value_type> fields;
         json_object_iterator_t it(json);
         while (cJSON *item = it.next()) {
-            bool conflict = add(item->string, make_counted<datum_t>(item));
-            rcheck(!conflict, base_exc_t::GENERIC,
-                   strprintf("Duplicate key `%s` in JSON.", item->string));
+            std::string key(item->string);
+            check_str_validity(key);
+            fields.push_back(datum_object_t::value_type(
+                                 std::move(key), make_counted<datum_t>(item)));
         }
+        std::string duplicate_key;
+        rcheck(r_object->assign_unsorted(std::move(fields), &duplicate_key),
+               base_exc_t::GENERIC,
+               strprintf("Duplicate key `%s` in JSON.", duplicate_key.c_str()));
         maybe_sanitize_ptype();
     } break;
     default: unreachable();
@@ -216,7 +303,7 @@ datum_t::datum_t(const scoped_cJSON_t &json) {
 datum_t::type_t datum_t::get_type() const { return type; }
 
 bool datum_t::is_ptype() const {
-    return type == R_OBJECT && std_contains(*r_object, reql_type_string);
+    return type == R_OBJECT && r_object->count(reql_type_string) != 0;
 }
 
 bool datum_t::is_ptype(const std::string &reql_type) const {
@@ -362,6 +449,177 @@ void datum_t::array_to_str_key(std::string *str_out) const {
     }
 }
 
+// The type tags of the binary secondary key encoding.  They sort like the types do
+// in `datum_t::cmp`, with times last, since they are the only pseudotype that can
+// be a key.  The end of an array sorts before all of them, so that an array sorts
+// before the arrays it is a prefix of.
+static const char BINARY_SKEY_ARRAY_END = '\x00';
+static const char BINARY_SKEY_ARRAY = 'A';
+static const char BINARY_SKEY_BOOL = 'B';
+static const char BINARY_SKEY_NUM = 'N';
+static const char BINARY_SKEY_STR = 'S';
+static const char BINARY_SKEY_TIME = 'T';
+
+// Null bytes in strings are escaped as "\0\xFF", and strings end with "\0\0".  So
+// the end of a string sorts before any character.
+static const char BINARY_SKEY_STR_ESCAPE = '\xFF';
+
+// Numbers are mangled like in `num_to_str_key` and written big-endian.
+static void append_binary_skey_num(double d, std::string *str_out) {
+    // 0.0 and -0.0 are equal, so they need to be encoded the same way.
+    if (d == 0) {
+        d = 0;
+    }
+    uint64_t u;
+    static_assert(sizeof(d) == sizeof(u), "Doubles are the wrong size.");
+    memcpy(&u, &d, sizeof(u));
+    u = (u & (1ULL << 63)) ? ~u : (u ^ (1ULL << 63));
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        str_out->push_back(static_cast<char>((u >> shift) & 0xFF));
+    }
+}
+
+static bool parse_binary_skey_num(const char **pos, const char *end, double *d_out) {
+    if (end - *pos < 8) {
+        return false;
+    }
+    uint64_t u = 0;
+    for (int i = 0; i < 8; ++i, ++*pos) {
+        u = (u << 8) | static_cast<uint8_t>(**pos);
+    }
+    u = (u & (1ULL << 63)) ? (u ^ (1ULL << 63)) : ~u;
+    memcpy(d_out, &u, sizeof(u));
+    return true;
+}
+
+// Parses the datum starting at `*pos` and moves `*pos` past it.  Returns false if
+// the key ends before the datum does, i.e. if the key was truncated, or if the
+// datum contains a time.
+static bool parse_binary_skey(const char **pos, const char *end,
+                              counted_t<const datum_t> *out) {
+    if (*pos == end) {
+        return false;
+    }
+    const char tag = **pos;
+    ++*pos;
+    switch (tag) {
+    case BINARY_SKEY_ARRAY: {
+        std::vector<counted_t<const datum_t> > items;
+        for (;;) {
+            if (*pos == end) {
+                return false;
+            }
+            if (**pos == BINARY_SKEY_ARRAY_END) {
+                ++*pos;
+                break;
+            }
+            counted_t<const datum_t> item;
+            if (!parse_binary_skey(pos, end, &item)) {
+                return false;
+            }
+            items.push_back(std::move(item));
+        }
+        *out = make_counted<const datum_t>(std::move(items));
+        return true;
+    }
+    case BINARY_SKEY_BOOL: {
+        if (*pos == end) {
+            return false;
+        }
+        const bool b = **pos != 0;
+        ++*pos;
+        *out = make_counted<const datum_t>(datum_t::R_BOOL, b);
+        return true;
+    }
+    case BINARY_SKEY_NUM: {
+        double d;
+        if (!parse_binary_skey_num(pos, end, &d)) {
+            return false;
+        }
+        *out = make_counted<const datum_t>(d);
+        return true;
+    }
+    case BINARY_SKEY_STR: {
+        std::string str;
+        for (;;) {
+            if (end - *pos < 2) {
+                return false;
+            }
+            if ((*pos)[0] != '\0') {
+                str.push_back(**pos);
+                ++*pos;
+            } else if ((*pos)[1] == BINARY_SKEY_STR_ESCAPE) {
+                str.push_back('\0');
+                *pos += 2;
+            } else {
+                *pos += 2;
+                break;
+            }
+        }
+        *out = make_counted<const datum_t>(std::move(str));
+        return true;
+    }
+    case BINARY_SKEY_TIME: // fallthru
+    default:
+        return false;
+    }
+}
+
+void datum_t::to_binary_skey(std::string *str_out) const {
+    switch (get_type()) {
+    case R_ARRAY: {
+        str_out->push_back(BINARY_SKEY_ARRAY);
+        for (size_t i = 0; i < size(); ++i) {
+            counted_t<const datum_t> item = get(i, NOTHROW);
+            r_sanity_check(item.has());
+            item->to_binary_skey(str_out);
+        }
+        str_out->push_back(BINARY_SKEY_ARRAY_END);
+    } break;
+    case R_BOOL: {
+        str_out->push_back(BINARY_SKEY_BOOL);
+        str_out->push_back(as_bool() ? '\x01' : '\x00');
+    } break;
+    case R_NUM: {
+        str_out->push_back(BINARY_SKEY_NUM);
+        append_binary_skey_num(as_num(), str_out);
+    } break;
+    case R_STR: {
+        str_out->push_back(BINARY_SKEY_STR);
+        const wire_string_t &str = as_str();
+        for (size_t i = 0; i < str.size(); ++i) {
+            str_out->push_back(str.data()[i]);
+            if (str.data()[i] == '\0') {
+                str_out->push_back(BINARY_SKEY_STR_ESCAPE);
+            }
+        }
+        str_out->append(2, '\0');
+    } break;
+    case R_OBJECT:
+        if (is_ptype()) {
+            if (get_reql_type() == pseudo::time_string) {
+                // Times compare by their epoch time only, so that's all we keep.
+                str_out->push_back(BINARY_SKEY_TIME);
+                append_binary_skey_num(
+                    pseudo::time_to_epoch_time(counted_from_this()), str_out);
+                break;
+            }
+            rfail(base_exc_t::GENERIC,
+                  "Cannot use psuedotype %s as a primary or secondary key value .",
+                  get_type_name().c_str());
+        }
+        // fallthru
+    case R_NULL:
+        type_error(strprintf(
+            "Secondary keys must be a number, string, bool, or array "
+            "(got %s of type %s).", print().c_str(), get_type_name().c_str()));
+        break;
+    case UNINITIALIZED: // fallthru
+    default:
+        unreachable();
+    }
+}
+
 int datum_t::pseudo_cmp(const datum_t &rhs) const {
     r_sanity_check(is_ptype());
     if (get_reql_type() == pseudo::time_string) {
@@ -422,7 +680,7 @@ counted_t<const datum_t> datum_t::drop_literals(bool *encountered_literal_out) c
     scoped_ptr_t<datum_ptr_t> copied_result;
 
     if (get_type() == R_OBJECT) {
-        const std::map<std::string, counted_t<const datum_t> > &obj = as_object();
+        const datum_object_t &obj = as_object();
         for (auto it = obj.begin(); it != obj.end(); ++it) {
             bool encountered_literal;
             counted_t<const datum_t> val =
@@ -556,7 +814,8 @@ std::string datum_t::mangle_secondary(const std::string &secondary,
     return res;
 }
 
-std::string datum_t::print_secondary(const store_key_t &primary_key,
+std::string datum_t::print_secondary(skey_version_t skey_version,
+                                     const store_key_t &primary_key,
                                      boost::optional<uint64_t> tag_num) const {
     std::string secondary_key_string;
     std::string primary_key_string = key_to_unescaped_str(primary_key);
@@ -568,7 +827,9 @@ std::string datum_t::print_secondary(const store_key_t &primary_key,
               key_to_debug_str(primary_key).c_str());
     }
 
-    if (type == R_NUM) {
+    if (skey_version == skey_version_t::BINARY) {
+        to_binary_skey(&secondary_key_string);
+    } else if (type == R_NUM) {
         num_to_str_key(&secondary_key_string);
     } else if (type == R_STR) {
         str_to_str_key(&secondary_key_string);
@@ -651,14 +912,29 @@ boost::optional<uint64_t> datum_t::extract_tag(const store_key_t &key) {
     return extract_tag(key_to_unescaped_str(key));
 }
 
+counted_t<const datum_t> datum_t::decode_secondary(const store_key_t &key) {
+    components_t components;
+    parse_secondary(key_to_unescaped_str(key), &components);
+    const char *pos = components.secondary.data();
+    const char *const end = pos + components.secondary.size();
+    counted_t<const datum_t> res;
+    // Anything after the datum would mean the key wasn't printed by us.
+    if (!parse_binary_skey(&pos, end, &res) || pos != end) {
+        return counted_t<const datum_t>();
+    }
+    return res;
+}
+
 // This function returns a store_key_t suitable for searching by a
 // secondary-index.  This is needed because secondary indexes may be truncated,
 // but the amount truncated depends on the length of the primary key.  Since we
 // do not know how much was truncated, we have to truncate the maximum amount,
 // then return all matches and filter them out later.
-store_key_t datum_t::truncated_secondary() const {
+store_key_t datum_t::truncated_secondary(skey_version_t skey_version) const {
     std::string s;
-    if (type == R_NUM) {
+    if (skey_version == skey_version_t::BINARY) {
+        to_binary_skey(&s);
+    } else if (type == R_NUM) {
         num_to_str_key(&s);
     } else if (type == R_STR) {
         str_to_str_key(&s);
@@ -828,8 +1104,7 @@ counted_t<const datum_t> datum_t::get(size_t index, throw_bool_t throw_bool) con
 
 counted_t<const datum_t> datum_t::get(const std::string &key,
                                       throw_bool_t throw_bool) const {
-    std::map<std::string, counted_t<const datum_t> >::const_iterator it
-        = as_object().find(key);
+    datum_object_t::const_iterator it = as_object().find(key);
     if (it != as_object().end()) return it->second;
     if (throw_bool == THROW) {
         rfail(base_exc_t::NON_EXISTENCE,
@@ -838,7 +1113,7 @@ counted_t<const datum_t> datum_t::get(const std::string &key,
     return counted_t<const datum_t>();
 }
 
-const std::map<std::string, counted_t<const datum_t> > &datum_t::as_object() const {
+const datum_object_t &datum_t::as_object() const {
     check_type(R_OBJECT);
     return *r_object;
 }
@@ -858,7 +1133,7 @@ cJSON *datum_t::as_json_raw() const {
     } break;
     case R_OBJECT: {
         scoped_cJSON_t obj(cJSON_CreateObject());
-        for (std::map<std::string, counted_t<const datum_t> >::const_iterator
+        for (datum_object_t::const_iterator
                  it = r_object->begin(); it != r_object->end(); ++it) {
             obj.AddItemToObject(it->first.c_str(), it->second->as_json_raw());
         }
@@ -906,9 +1181,7 @@ MUST_USE bool datum_t::add(const std::string &key, counted_t<const datum_t> val,
     check_type(R_OBJECT);
     check_str_validity(key);
     r_sanity_check(val.has());
-    bool key_in_obj = r_object->count(key) > 0;
-    if (!key_in_obj || (clobber_bool == CLOBBER)) (*r_object)[key] = val;
-    return key_in_obj;
+    return r_object->add(key, val, clobber_bool);
 }
 
 MUST_USE bool datum_t::delete_field(const std::string &key) {
@@ -919,7 +1192,7 @@ counted_t<const datum_t> datum_t::merge(counted_t<const datum_t> rhs) const {
     if (get_type() != R_OBJECT || rhs->get_type() != R_OBJECT) { return rhs; }
 
     datum_ptr_t d(as_object());
-    const std::map<std::string, counted_t<const datum_t> > &rhs_obj = rhs->as_object();
+    const datum_object_t &rhs_obj = rhs->as_object();
     for (auto it = rhs_obj.begin(); it != rhs_obj.end(); ++it) {
         counted_t<const datum_t> sub_lhs = d->get(it->first, NOTHROW);
         bool is_literal = it->second->is_ptype(pseudo::literal_string);
@@ -952,7 +1225,7 @@ counted_t<const datum_t> datum_t::merge(counted_t<const datum_t> rhs) const {
 counted_t<const datum_t> datum_t::merge(counted_t<const datum_t> rhs,
                                         merge_resoluter_t f) const {
     datum_ptr_t d(as_object());
-    const std::map<std::string, counted_t<const datum_t> > &rhs_obj = rhs->as_object();
+    const datum_object_t &rhs_obj = rhs->as_object();
     for (auto it = rhs_obj.begin(); it != rhs_obj.end(); ++it) {
         if (counted_t<const datum_t> left = get(it->first, NOTHROW)) {
             bool b = d.add(it->first, f(it->first, left, it->second), CLOBBER);
@@ -1007,8 +1280,8 @@ int datum_t::cmp(const datum_t &rhs) const {
             }
             return pseudo_cmp(rhs);
         } else {
-            const std::map<std::string, counted_t<const datum_t> > &obj = as_object();
-            const std::map<std::string, counted_t<const datum_t> > &rhs_obj
+            const datum_object_t &obj = as_object();
+            const datum_object_t &rhs_obj
                 = rhs.as_object();
             auto it = obj.begin();
             auto it2 = rhs_obj.begin();
@@ -1089,15 +1362,19 @@ void datum_t::init_from_pb(const Datum *d) {
     } break;
     case Datum::R_OBJECT: {
         init_object();
+        std::vector<datum_object_t::value_type> fields;
+        fields.reserve(d->r_object_size());
         for (int i = 0; i < d->r_object_size(); ++i) {
             const Datum_AssocPair *ap = &d->r_object(i);
             const std::string &key = ap->key();
             check_str_validity(key);
-            rcheck(r_object->count(key) == 0,
-                   base_exc_t::GENERIC,
-                   strprintf("Duplicate key %s in object.", key.c_str()));
-            (*r_object)[key] = make_counted<datum_t>(&ap->val());
+            fields.push_back(datum_object_t::value_type(
+                                 key, make_counted<datum_t>(&ap->val())));
         }
+        std::string duplicate_key;
+        rcheck(r_object->assign_unsorted(std::move(fields), &duplicate_key),
+               base_exc_t::GENERIC,
+               strprintf("Duplicate key %s in object.", duplicate_key.c_str()));
         std::set<std::string> allowed_ptypes = { pseudo::literal_string };
         maybe_sanitize_ptype(allowed_ptypes);
     } break;
@@ -61,8 +61,77 @@ enum clobber_bool_t { NOCLOBBER = 0, CLOBBER = 1};
 
 enum class use_json_t { NO = 0, YES = 1 };
 
+// How the secondary part of secondary index keys is encoded.  Every sindex
+// remembers the version its keys were written with.
+enum class skey_version_t {
+    // The same strings as primary keys.  Their order doesn't always match the
+    // order of the data, and they can't be turned back into data.
+    PRINTED = 0,
+    // An encoding whose bytes compare like the data do, and that ends in a way
+    // that shows whether the key was truncated.  Keys that weren't truncated can
+    // be decoded again.
+    BINARY = 1,
+    LATEST = BINARY
+};
+
+ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(skey_version_t, int8_t,
+                                      skey_version_t::PRINTED,
+                                      skey_version_t::BINARY);
+
 class grouped_data_t;
 
+// The fields of an object datum, sorted by key.  They live in a single vector
+// instead of a `std::map`, so an object costs one allocation rather than one per
+// field, and scanning it doesn't chase pointers all over the heap.  Lookups are
+// binary searches.  The read-only interface is a subset of `std::map`'s, so code
+// that iterates over `datum_t::as_object()` doesn't care.
+class datum_object_t {
+public:
+    typedef std::string key_type;
+    typedef std::pair<std::string, counted_t<const datum_t> > value_type;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+    typedef std::vector<value_type>::const_reverse_iterator const_reverse_iterator;
+
+    datum_object_t() { }
+    explicit datum_object_t(std::map<std::string, counted_t<const datum_t> > &&map);
+
+    // Replaces the fields with `fields`, which may be in any order.  Returns false
+    // and sets `*duplicate_key_out` if two of them have the same key.
+    MUST_USE bool assign_unsorted(std::vector<value_type> &&fields,
+                                  std::string *duplicate_key_out);
+
+    // Adds a field whose key is greater than all the keys in the object.  Returns
+    // false (and doesn't add it) if it isn't.
+    MUST_USE bool append(std::string &&key, counted_t<const datum_t> &&val);
+
+    // Sets the field `key` if it's missing (or if `clobber_bool` is `CLOBBER`).
+    // Returns true if it was already there.
+    bool add(const std::string &key, counted_t<const datum_t> val,
+             clobber_bool_t clobber_bool);
+
+    // Returns true if the field was there.
+    bool erase(const std::string &key);
+
+    void reserve(size_t n) { fields_.reserve(n); }
+    size_t capacity() const { return fields_.capacity(); }
+
+    const_iterator begin() const { return fields_.begin(); }
+    const_iterator end() const { return fields_.end(); }
+    const_reverse_iterator rbegin() const { return fields_.rbegin(); }
+    const_reverse_iterator rend() const { return fields_.rend(); }
+    size_t size() const { return fields_.size(); }
+    bool empty() const { return fields_.empty(); }
+
+    const_iterator find(const std::string &key) const;
+    size_t count(const std::string &key) const { return find(key) != end() ? 1 : 0; }
+
+private:
+    std::vector<value_type>::iterator lower_bound(const std::string &key);
+
+    std::vector<value_type> fields_;
+};
+
 // A `datum_t` is basically a JSON value, although we may extend it later.
 class datum_t : public slow_atomic_countable_t<datum_t> {
 public:
@@ -88,6 +157,7 @@ public:
     explicit datum_t(const char *cstr);
     explicit datum_t(std::vector<counted_t<const datum_t> > &&_array);
     explicit datum_t(std::map<std::string, counted_t<const datum_t> > &&object);
+    explicit datum_t(datum_object_t &&object);
 
     // This should only be used to send responses to the client.
     explicit datum_t(grouped_data_t &&gd);
@@ -114,7 +184,8 @@ public:
     std::string print_primary() const;
     static std::string mangle_secondary(const std::string &secondary,
             const std::string &primary, const std::string &tag);
-    std::string print_secondary(const store_key_t &key,
+    std::string print_secondary(skey_version_t skey_version,
+            const store_key_t &key,
             boost::optional<uint64_t> tag_num = boost::optional<uint64_t>()) const;
     /* An inverse to print_secondary. Returns the primary key. */
     static std::string extract_primary(const std::string &secondary_and_primary);
@@ -123,7 +194,11 @@ public:
     static boost::optional<uint64_t> extract_tag(
         const std::string &secondary_and_primary);
     static boost::optional<uint64_t> extract_tag(const store_key_t &key);
-    store_key_t truncated_secondary() const;
+    store_key_t truncated_secondary(skey_version_t skey_version) const;
+    /* Returns the secondary value of a key printed with `skey_version_t::BINARY`,
+     * or an empty pointer if it was truncated.  Also returns an empty pointer if
+     * it contains a time, since we only encode the epoch time of times. */
+    static counted_t<const datum_t> decode_secondary(const store_key_t &key);
     void check_type(type_t desired, const char *msg = NULL) const;
     void type_error(const std::string &msg) const NORETURN;
 
@@ -138,7 +213,7 @@ public:
     // Access an element of an array.
     counted_t<const datum_t> get(size_t index, throw_bool_t throw_bool = THROW) const;
     // Use of `get` is preferred to `as_object` when possible.
-    const std::map<std::string, counted_t<const datum_t> > &as_object() const;
+    const datum_object_t &as_object() const;
 
     // Access an element of an object.
     counted_t<const datum_t> get(const std::string &key,
@@ -217,6 +292,8 @@ private:
     void str_to_str_key(std::string *str_out) const;
     void bool_to_str_key(std::string *str_out) const;
     void array_to_str_key(std::string *str_out) const;
+    // Appends the `skey_version_t::BINARY` encoding of the datum.
+    void to_binary_skey(std::string *str_out) const;
 
     int pseudo_cmp(const datum_t &rhs) const;
     static const std::set<std::string> _allowed_pts;
@@ -233,7 +310,7 @@ private:
         double r_num;
         wire_string_t *r_str;
         std::vector<counted_t<const datum_t> > *r_array;
-        std::map<std::string, counted_t<const datum_t> > *r_object;
+        datum_object_t *r_object;
     };
 
 public:
@@ -1,6 +1,8 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
 #include "rdb_protocol/datum_stream.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 
 #include "rdb_protocol/batching.hpp"
@@ -451,7 +453,10 @@ void sindex_readgen_t::sindex_sort(std::vector<rget_item_t> *vec) const {
     if (vec->size() == 0) {
         return;
     }
-    if (sorting != sorting_t::UNORDERED) {
+    // The shards' results get merged by key, so the items are already sorted unless
+    // the sindex has printed keys, or some of the keys were truncated.
+    if (sorting != sorting_t::UNORDERED
+        && !std::is_sorted(vec->begin(), vec->end(), sindex_compare_t(sorting))) {
         std::stable_sort(vec->begin(), vec->end(), sindex_compare_t(sorting));
     }
 }
@@ -515,7 +520,11 @@ boost::optional<read_t> sindex_readgen_t::sindex_sort_read(
 }
 
 key_range_t sindex_readgen_t::original_keyrange() const {
-    return original_datum_range.to_sindex_keyrange();
+    // Only the store knows how the sindex encodes its keys, so it restricts the
+    // range to `original_datum_range` itself.  We still encode the bounds here,
+    // to report bad ones before reading anything.
+    original_datum_range.to_sindex_keyrange(skey_version_t::LATEST);
+    return key_range_t::universe();
 }
 
 std::string sindex_readgen_t::sindex_name() const {
@@ -915,6 +924,140 @@ zip_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
     return v;
 }
 
+// EQ_JOIN_DATUM_STREAM_T
+eq_join_datum_stream_t::eq_join_datum_stream_t(counted_t<datum_stream_t> _src,
+                                               counted_t<func_t> _key_func,
+                                               counted_t<table_t> _table,
+                                               const std::string &_index)
+    : wrapper_datum_stream_t(_src), key_func(_key_func), table(_table),
+      index(_index) {
+    guarantee(key_func.has() && table.has());
+}
+
+struct counted_datum_less_t {
+    bool operator()(const counted_t<const datum_t> &a,
+                    const counted_t<const datum_t> &b) const {
+        return *a < *b;
+    }
+};
+
+static counted_t<const datum_t> make_join_row(counted_t<const datum_t> left,
+                                              counted_t<const datum_t> right) {
+    std::map<std::string, counted_t<const datum_t> > pair;
+    pair["left"] = std::move(left);
+    pair["right"] = std::move(right);
+    return make_counted<const datum_t>(std::move(pair));
+}
+
+std::vector<counted_t<const datum_t> >
+eq_join_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    std::vector<counted_t<const datum_t> > ret;
+    // An empty batch means that we're done, so we keep going until some of the
+    // source rows have a match.
+    while (ret.size() == 0) {
+        std::vector<counted_t<const datum_t> > rows = source->next_batch(env, batchspec);
+        if (rows.size() == 0) {
+            break;
+        }
+
+        std::vector<counted_t<const datum_t> > keys(rows.size());
+        {
+            profile::sampler_t sampler("Computing join keys eagerly.", env->trace);
+            for (size_t i = 0; i < rows.size(); ++i) {
+                // Null rows, and rows whose key is missing or null, don't join with
+                // anything.
+                if (rows[i]->get_type() != datum_t::R_NULL) {
+                    try {
+                        counted_t<const datum_t> key
+                            = key_func->call(env, rows[i])->as_datum();
+                        if (key->get_type() != datum_t::R_NULL) {
+                            keys[i] = key;
+                        }
+                    } catch (const exc_t &e) {
+                        if (e.get_type() != base_exc_t::NON_EXISTENCE) {
+                            throw;
+                        }
+                    } catch (const datum_exc_t &e) {
+                        if (e.get_type() != base_exc_t::NON_EXISTENCE) {
+                            throw;
+                        }
+                    }
+                }
+                sampler.new_sample();
+            }
+        }
+
+        if (index == table->get_pkey()) {
+            join_primary(env, rows, keys, &ret);
+        } else {
+            join_secondary(env, rows, keys, &ret);
+        }
+    }
+    return ret;
+}
+
+void eq_join_datum_stream_t::join_primary(
+        env_t *env,
+        const std::vector<counted_t<const datum_t> > &rows,
+        const std::vector<counted_t<const datum_t> > &keys,
+        std::vector<counted_t<const datum_t> > *out) {
+    std::vector<counted_t<const datum_t> > lookup_keys;
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        if (it->has()) {
+            lookup_keys.push_back(*it);
+        }
+    }
+    std::vector<counted_t<const datum_t> > matches = table->get_rows(env, lookup_keys);
+
+    auto match = matches.begin();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (keys[i].has()) {
+            r_sanity_check(match != matches.end());
+            if ((*match)->get_type() != datum_t::R_NULL) {
+                out->push_back(make_join_row(rows[i], *match));
+            }
+            ++match;
+        }
+    }
+}
+
+void eq_join_datum_stream_t::join_secondary(
+        env_t *env,
+        const std::vector<counted_t<const datum_t> > &rows,
+        const std::vector<counted_t<const datum_t> > &keys,
+        std::vector<counted_t<const datum_t> > *out) {
+    // Rows in the same batch often share a key, so we only look up each distinct
+    // key once.
+    std::map<counted_t<const datum_t>,
+             std::vector<counted_t<const datum_t> >,
+             counted_datum_less_t> matches;
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        if (it->has() && matches.find(*it) == matches.end()) {
+            std::vector<counted_t<const datum_t> > *key_matches = &matches[*it];
+            counted_t<datum_stream_t> stream
+                = table->get_all(env, *it, index, backtrace());
+            for (;;) {
+                std::vector<counted_t<const datum_t> > batch
+                    = stream->next_batch(env, batchspec_t::all());
+                if (batch.size() == 0) {
+                    break;
+                }
+                std::move(batch.begin(), batch.end(), std::back_inserter(*key_matches));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (keys[i].has()) {
+            const std::vector<counted_t<const datum_t> > &key_matches
+                = matches.find(keys[i])->second;
+            for (auto it = key_matches.begin(); it != key_matches.end(); ++it) {
+                out->push_back(make_join_row(rows[i], *it));
+            }
+        }
+    }
+}
+
 // UNION_DATUM_STREAM_T
 void union_datum_stream_t::add_transformation(transform_variant_t &&tv,
                                               const protob_t<const Backtrace> &bt) {
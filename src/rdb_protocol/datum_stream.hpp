@@ -20,6 +20,7 @@
 namespace ql {
 
 class env_t;
+class table_t;
 
 /* This wraps a namespace_interface_t and makes it automatically handle getting
  * profiling information from them. It acheives this by doing the following in
@@ -82,7 +83,7 @@ public:
     counted_t<val_t> to_array(env_t *env);
 
     // stream -> stream (always eager)
-    counted_t<datum_stream_t> slice(size_t l, size_t r);
+    virtual counted_t<datum_stream_t> slice(size_t l, size_t r);
     counted_t<datum_stream_t> zip();
     counted_t<datum_stream_t> indexes_of(counted_t<func_t> f);
     counted_t<datum_stream_t> ordered_distinct();
@@ -127,14 +128,14 @@ protected:
         : datum_stream_t(bt) { }
     virtual counted_t<const datum_t> as_array(env_t *env);
     bool ops_to_do() { return ops.size() != 0; }
+    virtual void add_transformation(transform_variant_t &&tv,
+                                    const protob_t<const Backtrace> &bt);
 
 private:
     enum class done_t { YES, NO };
 
     virtual bool is_array() = 0;
 
-    virtual void add_transformation(transform_variant_t &&tv,
-                                    const protob_t<const Backtrace> &bt);
     virtual void accumulate(env_t *env, eager_acc_t *acc, const terminal_variant_t &tv);
     virtual void accumulate_all(env_t *env, eager_acc_t *acc);
 
@@ -232,6 +233,35 @@ private:
     next_raw_batch(env_t *env, const batchspec_t &batchspec);
 };
 
+// Pairs up every row of the source with the rows of `table` whose primary key or
+// secondary index `index` equals `key_func` of the row.  We look up the keys of a
+// whole batch of source rows at once, so a join doesn't cost one read per row.
+class eq_join_datum_stream_t : public wrapper_datum_stream_t {
+public:
+    eq_join_datum_stream_t(counted_t<datum_stream_t> src,
+                           counted_t<func_t> key_func,
+                           counted_t<table_t> table,
+                           const std::string &index);
+private:
+    virtual std::vector<counted_t<const datum_t> >
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    // Append the joined rows for `rows` to `out`, in order.  `keys[i]` is the join
+    // key of `rows[i]`, or empty if the row doesn't have one.
+    void join_primary(env_t *env,
+                      const std::vector<counted_t<const datum_t> > &rows,
+                      const std::vector<counted_t<const datum_t> > &keys,
+                      std::vector<counted_t<const datum_t> > *out);
+    void join_secondary(env_t *env,
+                        const std::vector<counted_t<const datum_t> > &rows,
+                        const std::vector<counted_t<const datum_t> > &keys,
+                        std::vector<counted_t<const datum_t> > *out);
+
+    counted_t<func_t> key_func;
+    counted_t<table_t> table;
+    std::string index;
+};
+
 class indexed_sort_datum_stream_t : public wrapper_datum_stream_t {
 public:
     indexed_sort_datum_stream_t(
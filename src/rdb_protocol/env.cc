@@ -122,6 +122,19 @@ std::string env_t::get_reql_http_proxy() {
     return rdb_ctx->reql_http_proxy;
 }
 
+io_backender_t *env_t::get_io_backender() {
+    return rdb_ctx != NULL ? rdb_ctx->io_backender : NULL;
+}
+
+const base_path_t &env_t::get_base_path() {
+    r_sanity_check(rdb_ctx != NULL);
+    return rdb_ctx->base_path;
+}
+
+rdb_context_t *env_t::get_rdb_ctx() {
+    return rdb_ctx;
+}
+
 extproc_pool_t *env_t::get_extproc_pool() {
     assert_thread();
     r_sanity_check(rdb_ctx != NULL);
@@ -17,6 +17,7 @@
 #include "rdb_protocol/val.hpp"
 
 class extproc_pool_t;
+class io_backender_t;
 
 namespace ql {
 class datum_t;
@@ -76,6 +77,15 @@ public:
 
     std::string get_reql_http_proxy();
 
+    // Where queries can write temporary files.  `get_io_backender` returns `NULL`
+    // if they can't.
+    io_backender_t *get_io_backender();
+    const base_path_t &get_base_path();
+
+    // Returns `NULL` if we don't have a context.  Range reads use it to make
+    // environments for the same query on other threads.
+    rdb_context_t *get_rdb_ctx();
+
     // This is a callback used in unittests to control things during a query
     class eval_callback_t {
     public:
@@ -0,0 +1,351 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include "rdb_protocol/external_sort.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "containers/uuid.hpp"
+#include "rdb_protocol/batching.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/profile.hpp"
+
+namespace ql {
+
+static void sort_in_memory(env_t *env, profile::sampler_t *sampler,
+                           const datum_lt_t &lt,
+                           std::vector<counted_t<const datum_t> > *rows) {
+    std::stable_sort(rows->begin(), rows->end(),
+                     [&](const counted_t<const datum_t> &l,
+                         const counted_t<const datum_t> &r) {
+                         return lt(env, sampler, l, r);
+                     });
+}
+
+// Returns the first `limit` rows of `source` in sorted order.  We keep them in a
+// heap whose top is the row that sorts last.  Every row remembers its position in
+// `source`, and equal rows are ordered by it, so that the result is the same as
+// that of a stable sort.
+static std::vector<counted_t<const datum_t> > sort_top_k(
+        env_t *env,
+        counted_t<datum_stream_t> source,
+        const datum_lt_t &lt,
+        size_t limit) {
+    if (limit == 0) {
+        return std::vector<counted_t<const datum_t> >();
+    }
+
+    typedef std::pair<counted_t<const datum_t>, uint64_t> indexed_row_t;
+    std::vector<indexed_row_t> heap;
+
+    profile::sampler_t sampler("Keeping the first rows in a heap.", env->trace);
+    auto heap_lt = [&](const indexed_row_t &l, const indexed_row_t &r) {
+        if (lt(env, &sampler, l.first, r.first)) {
+            return true;
+        } else if (lt(env, &sampler, r.first, l.first)) {
+            return false;
+        }
+        return l.second < r.second;
+    };
+
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+    uint64_t index = 0;
+    for (;;) {
+        std::vector<counted_t<const datum_t> > data = source->next_batch(env, batchspec);
+        if (data.size() == 0) {
+            break;
+        }
+        for (auto it = data.begin(); it != data.end(); ++it, ++index) {
+            if (heap.size() < limit) {
+                heap.push_back(std::make_pair(std::move(*it), index));
+                std::push_heap(heap.begin(), heap.end(), heap_lt);
+            } else if (lt(env, &sampler, *it, heap.front().first)) {
+                // The new row came after all of the rows in the heap, so it only
+                // displaces the top if it sorts strictly before it.
+                std::pop_heap(heap.begin(), heap.end(), heap_lt);
+                heap.back() = std::make_pair(std::move(*it), index);
+                std::push_heap(heap.begin(), heap.end(), heap_lt);
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), heap_lt);
+    std::vector<counted_t<const datum_t> > ret;
+    ret.reserve(heap.size());
+    for (auto it = heap.begin(); it != heap.end(); ++it) {
+        ret.push_back(std::move(it->first));
+    }
+    return ret;
+}
+
+counted_t<datum_stream_t> sort_datum_stream(env_t *env,
+                                            counted_t<datum_stream_t> source,
+                                            const datum_lt_t &lt,
+                                            const protob_t<const Backtrace> &bt,
+                                            size_t limit) {
+    if (limit <= array_size_limit()) {
+        return make_counted<array_datum_stream_t>(
+            make_counted<const datum_t>(sort_top_k(env, source, lt, limit)), bt);
+    }
+
+    // Proxies have no io backender, so they can't spill runs to disk and keep
+    // to the row limit alone.
+    const bool can_spill = env->get_io_backender() != NULL;
+    const size_t memory_limit = sort_memory_limit(env);
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+
+    std::vector<counted_t<const datum_t> > rows;
+    size_t rows_size = 0;
+    counted_t<external_sort_datum_stream_t> external;
+    for (;;) {
+        std::vector<counted_t<const datum_t> > data = source->next_batch(env, batchspec);
+        if (data.size() == 0) {
+            break;
+        }
+        for (auto it = data.begin(); it != data.end(); ++it) {
+            rows.push_back(std::move(*it));
+            if (!can_spill) {
+                rcheck_src(bt.get(), base_exc_t::GENERIC,
+                           rows.size() <= array_size_limit(),
+                           strprintf("Array over size limit %zu.",
+                                     array_size_limit()).c_str());
+                continue;
+            }
+            rows_size += serialized_size<cluster_version_t::CLUSTER>(rows.back());
+            if (rows.size() > array_size_limit() || rows_size > memory_limit) {
+                if (!external.has()) {
+                    external = make_counted<external_sort_datum_stream_t>(env, lt, bt);
+                }
+                external->add_run(env, &rows);
+                rows_size = 0;
+            }
+        }
+    }
+
+    if (external.has()) {
+        if (!rows.empty()) {
+            external->add_run(env, &rows);
+        }
+        external->finish(env);
+        return external;
+    }
+
+    profile::sampler_t sampler("Sorting in-memory.", env->trace);
+    sort_in_memory(env, &sampler, lt, &rows);
+    return make_counted<array_datum_stream_t>(
+        make_counted<const datum_t>(std::move(rows)), bt);
+}
+
+deferred_sort_datum_stream_t::deferred_sort_datum_stream_t(
+        counted_t<datum_stream_t> _source,
+        const datum_lt_t &_lt,
+        const protob_t<const Backtrace> &bt)
+    : eager_datum_stream_t(bt),
+      source(std::move(_source)),
+      lt(_lt),
+      limit(std::numeric_limits<size_t>::max()) { }
+
+counted_t<datum_stream_t> deferred_sort_datum_stream_t::slice(size_t l, size_t r) {
+    // Transformations may drop or add rows, so the slice only tells us how many
+    // sorted rows are needed if there aren't any.
+    if (!sorted.has() && !ops_to_do() && !is_grouped()) {
+        limit = std::min(limit, r);
+    }
+    return eager_datum_stream_t::slice(l, r);
+}
+
+bool deferred_sort_datum_stream_t::is_exhausted() const {
+    return (sorted.has() ? sorted->is_exhausted() : source->is_exhausted())
+        && batch_cache_exhausted();
+}
+
+counted_t<const datum_t> deferred_sort_datum_stream_t::as_array(env_t *env) {
+    if (!sorted.has()) {
+        sort(env);
+    }
+    return eager_datum_stream_t::as_array(env);
+}
+
+std::vector<counted_t<const datum_t> >
+deferred_sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    if (!sorted.has()) {
+        sort(env);
+    }
+    return sorted->next_batch(env, batchspec);
+}
+
+void deferred_sort_datum_stream_t::sort(env_t *env) {
+    r_sanity_check(!sorted.has());
+    sorted = sort_datum_stream(env, source, lt, backtrace(), limit);
+    source.reset();
+}
+
+external_sort_datum_stream_t::external_sort_datum_stream_t(
+        env_t *env,
+        const datum_lt_t &_lt,
+        const protob_t<const Backtrace> &bt)
+    : eager_datum_stream_t(bt),
+      io_backender(env->get_io_backender()),
+      base_path(env->get_base_path()),
+      lt(_lt),
+      finished(false) {
+    guarantee(io_backender != NULL);
+}
+
+scoped_ptr_t<external_sort_datum_stream_t::run_t>
+external_sort_datum_stream_t::new_run(env_t *env, size_t level) {
+    profile::starter_t starter("Creating a sorted run on disk.", env->trace);
+    scoped_ptr_t<run_t> run(new run_t);
+    run->level = level;
+    run->queue.init(new run_queue_t(
+        io_backender,
+        serializer_filepath_t(base_path, "sort_" + uuid_to_str(generate_uuid())),
+        &queue_stats));
+    return run;
+}
+
+void external_sort_datum_stream_t::add_run(env_t *env,
+                                           std::vector<counted_t<const datum_t> > *rows) {
+    guarantee(!finished);
+    {
+        profile::sampler_t sampler("Sorting a run in-memory.", env->trace);
+        sort_in_memory(env, &sampler, lt, rows);
+    }
+
+    {
+        scoped_ptr_t<run_t> run = new_run(env, 0);
+        profile::sampler_t sampler("Writing a sorted run to disk.", env->trace);
+        for (auto it = rows->begin(); it != rows->end(); ++it) {
+            run->queue->push(*it);
+            sampler.new_sample();
+        }
+        rows->clear();
+        runs.push_back(std::move(run));
+    }
+
+    // Since levels never increase along `runs`, the last `SORT_MAX_MERGE_FANIN` runs
+    // are all of the same level if the first and the last of them are.  Merging
+    // them may fill up the next level, so we keep going.
+    while (runs.size() >= SORT_MAX_MERGE_FANIN
+           && runs[runs.size() - SORT_MAX_MERGE_FANIN]->level == runs.back()->level) {
+        const size_t level = runs.back()->level;
+        std::vector<scoped_ptr_t<run_t> > to_merge;
+        for (size_t i = runs.size() - SORT_MAX_MERGE_FANIN; i < runs.size(); ++i) {
+            to_merge.push_back(std::move(runs[i]));
+        }
+        runs.resize(runs.size() - SORT_MAX_MERGE_FANIN);
+        runs.push_back(merge_runs(env, &to_merge, level + 1));
+    }
+}
+
+scoped_ptr_t<external_sort_datum_stream_t::run_t>
+external_sort_datum_stream_t::merge_runs(env_t *env,
+                                         std::vector<scoped_ptr_t<run_t> > *to_merge,
+                                         size_t level) {
+    start_merge(to_merge);
+    scoped_ptr_t<run_t> merged = new_run(env, level);
+    profile::sampler_t sampler("Merging sorted runs on disk.", env->trace);
+    for (;;) {
+        counted_t<const datum_t> row = pop_smallest(env, &sampler, to_merge);
+        if (!row.has()) {
+            break;
+        }
+        merged->queue->push(row);
+    }
+    // This closes the merged runs' files.
+    to_merge->clear();
+    return merged;
+}
+
+void external_sort_datum_stream_t::start_merge(
+        std::vector<scoped_ptr_t<run_t> > *to_merge) {
+    for (auto it = to_merge->begin(); it != to_merge->end(); ++it) {
+        rassert(!(*it)->queue->empty());
+        (*it)->queue->pop(&(*it)->head);
+    }
+}
+
+counted_t<const datum_t> external_sort_datum_stream_t::pop_smallest(
+        env_t *env,
+        profile::sampler_t *sampler,
+        std::vector<scoped_ptr_t<run_t> > *to_merge) {
+    run_t *smallest = NULL;
+    for (auto it = to_merge->begin(); it != to_merge->end(); ++it) {
+        if ((*it)->head.has()
+            && (smallest == NULL || lt(env, sampler, (*it)->head, smallest->head))) {
+            smallest = it->get();
+        }
+    }
+    if (smallest == NULL) {
+        return counted_t<const datum_t>();
+    }
+
+    counted_t<const datum_t> ret = std::move(smallest->head);
+    smallest->head.reset();
+    if (!smallest->queue->empty()) {
+        smallest->queue->pop(&smallest->head);
+    }
+    return ret;
+}
+
+void external_sort_datum_stream_t::finish(env_t *env) {
+    guarantee(!finished);
+    finished = true;
+
+    // `add_run` already merged every full level, but there can still be up to
+    // `SORT_MAX_MERGE_FANIN - 1` runs left on each level.  Merge groups of adjacent
+    // runs until few enough are left to merge them all at once.  Keeping the runs in
+    // order is what keeps the sort stable.
+    while (runs.size() > SORT_MAX_MERGE_FANIN) {
+        std::vector<scoped_ptr_t<run_t> > merged_runs;
+        for (size_t i = 0; i < runs.size(); i += SORT_MAX_MERGE_FANIN) {
+            const size_t end = std::min<size_t>(i + SORT_MAX_MERGE_FANIN, runs.size());
+            if (end - i == 1) {
+                merged_runs.push_back(std::move(runs[i]));
+                continue;
+            }
+            std::vector<scoped_ptr_t<run_t> > to_merge;
+            size_t level = 0;
+            for (size_t j = i; j < end; ++j) {
+                level = std::max(level, runs[j]->level);
+                to_merge.push_back(std::move(runs[j]));
+            }
+            merged_runs.push_back(merge_runs(env, &to_merge, level + 1));
+        }
+        runs = std::move(merged_runs);
+    }
+
+    merging = std::move(runs);
+    start_merge(&merging);
+}
+
+bool external_sort_datum_stream_t::is_exhausted() const {
+    if (!finished || !batch_cache_exhausted()) {
+        return false;
+    }
+    for (auto it = merging.begin(); it != merging.end(); ++it) {
+        if ((*it)->head.has()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<counted_t<const datum_t> >
+external_sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    r_sanity_check(finished);
+    std::vector<counted_t<const datum_t> > ret;
+    batcher_t batcher = batchspec.to_batcher();
+    profile::sampler_t sampler("Merging sorted runs.", env->trace);
+    while (!batcher.should_send_batch()) {
+        counted_t<const datum_t> row = pop_smallest(env, &sampler, &merging);
+        if (!row.has()) {
+            break;
+        }
+        batcher.note_el(row);
+        ret.push_back(std::move(row));
+    }
+    return ret;
+}
+
+}  // namespace ql
@@ -0,0 +1,133 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_EXTERNAL_SORT_HPP_
+#define RDB_PROTOCOL_EXTERNAL_SORT_HPP_
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "containers/disk_backed_queue.hpp"
+#include "containers/scoped.hpp"
+#include "perfmon/perfmon.hpp"
+#include "rdb_protocol/datum_stream.hpp"
+
+namespace ql {
+
+typedef std::function<bool(env_t *,  // NOLINT(readability/casting)
+                           profile::sampler_t *,
+                           const counted_t<const datum_t> &,
+                           const counted_t<const datum_t> &)> datum_lt_t;
+
+// Stably sorts `source`, keeping only its first `limit` rows.  If `limit` is no
+// more than `array_size_limit()`, we only ever hold on to that many rows.
+// Otherwise, if the rows don't fit into `sort_memory_limit(env)` bytes, or there
+// are more than `array_size_limit()` of them, the rows get sorted in runs that are
+// written to disk, and the returned stream merges them lazily.  Otherwise we sort
+// in memory and return an array stream, like we always used to.
+counted_t<datum_stream_t> sort_datum_stream(
+    env_t *env,
+    counted_t<datum_stream_t> source,
+    const datum_lt_t &lt,
+    const protob_t<const Backtrace> &bt,
+    size_t limit = std::numeric_limits<size_t>::max());
+
+// What an unindexed `orderBy` returns.  We don't sort `source` until the stream is
+// first read, so that a `limit` or `slice` right after the `orderBy` can tell us
+// how many rows it's going to need.
+class deferred_sort_datum_stream_t : public eager_datum_stream_t {
+public:
+    deferred_sort_datum_stream_t(counted_t<datum_stream_t> source,
+                                 const datum_lt_t &lt,
+                                 const protob_t<const Backtrace> &bt);
+
+    virtual counted_t<datum_stream_t> slice(size_t l, size_t r);
+    virtual bool is_exhausted() const;
+    virtual bool is_cfeed() const { return false; }
+
+private:
+    // We say we're an array until we know better, because that's what an in-memory
+    // sort turns into.
+    virtual bool is_array() { return !sorted.has() || sorted->is_array(); }
+    virtual counted_t<const datum_t> as_array(env_t *env);
+    virtual std::vector<counted_t<const datum_t> >
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    void sort(env_t *env);
+
+    counted_t<datum_stream_t> source;
+    const datum_lt_t lt;
+    // How many of the sorted rows anybody is going to read.
+    size_t limit;
+    // Empty until the first read.
+    counted_t<datum_stream_t> sorted;
+};
+
+class external_sort_datum_stream_t : public eager_datum_stream_t {
+public:
+    external_sort_datum_stream_t(env_t *env,
+                                 const datum_lt_t &lt,
+                                 const protob_t<const Backtrace> &bt);
+
+    // Sorts `rows` and writes them to disk as a new run.  Clears `rows`.  Once
+    // there are `SORT_MAX_MERGE_FANIN` runs of the same level, they get merged into
+    // one run of the next level right away, so that the number of runs (and of the
+    // files and caches that back them) only grows logarithmically with the input.
+    void add_run(env_t *env, std::vector<counted_t<const datum_t> > *rows);
+
+    // Must be called once, after the last `add_run`.
+    void finish(env_t *env);
+
+    virtual bool is_exhausted() const;
+    virtual bool is_cfeed() const { return false; }
+
+private:
+    typedef disk_backed_queue_t<counted_t<const datum_t> > run_queue_t;
+
+    struct run_t {
+        scoped_ptr_t<run_queue_t> queue;
+        // 0 for a run that was sorted in memory, one more than that of the runs it
+        // was merged from otherwise.
+        size_t level;
+        // The smallest row of the run that hasn't been merged yet, or empty if the
+        // run has been merged completely.  Only used while merging.
+        counted_t<const datum_t> head;
+    };
+
+    virtual bool is_array() { return false; }
+    virtual std::vector<counted_t<const datum_t> >
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    scoped_ptr_t<run_t> new_run(env_t *env, size_t level);
+    // Merges `to_merge`, which must be adjacent runs in the order they were
+    // written, into a new run of level `level`.
+    scoped_ptr_t<run_t> merge_runs(env_t *env,
+                                   std::vector<scoped_ptr_t<run_t> > *to_merge,
+                                   size_t level);
+    // Loads the first row of every run in `merging`.
+    void start_merge(std::vector<scoped_ptr_t<run_t> > *merging);
+    // Removes and returns the smallest row among the heads of `merging`, or an
+    // empty pointer if all of the runs are done.  Ties go to the earliest run,
+    // which makes the merge stable.
+    counted_t<const datum_t> pop_smallest(env_t *env,
+                                          profile::sampler_t *sampler,
+                                          std::vector<scoped_ptr_t<run_t> > *merging);
+
+    io_backender_t *const io_backender;
+    const base_path_t base_path;
+    const datum_lt_t lt;
+
+    // The queues register their stats here.  It isn't part of the global perfmon
+    // collection, since it would clutter it with one entry per run.
+    perfmon_collection_t queue_stats;
+
+    // Runs that still need to be merged, in the order they were written.  Their
+    // levels never increase from one run to the next.
+    std::vector<scoped_ptr_t<run_t> > runs;
+    // Once `finish` has been called, the runs we're merging into our output.
+    std::vector<scoped_ptr_t<run_t> > merging;
+    bool finished;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_EXTERNAL_SORT_HPP_
@@ -79,6 +79,64 @@ bool reql_func_t::is_deterministic() const {
     return body->is_deterministic();
 }
 
+static bool is_var(const Term &var, const sym_t &name) {
+    return var.type() == Term::VAR
+        && var.args_size() == 1
+        && var.args(0).type() == Term::DATUM
+        && var.args(0).has_datum()
+        && var.args(0).datum().type() == Datum::R_NUM
+        && var.args(0).datum().r_num() == name.value;
+}
+
+static bool is_string_datum(const Term &term) {
+    return term.type() == Term::DATUM
+        && term.has_datum()
+        && term.datum().type() == Datum::R_STR;
+}
+
+bool reql_func_t::is_simple_selector(std::string *field_out) const {
+    if (arg_names.size() != 1) {
+        return false;
+    }
+    const Term &get_field = *body->get_src();
+    if (get_field.type() != Term::GET_FIELD
+        || get_field.args_size() != 2
+        || get_field.optargs_size() != 0
+        || !is_var(get_field.args(0), arg_names[0])
+        || !is_string_datum(get_field.args(1))) {
+        return false;
+    }
+    *field_out = get_field.args(1).datum().r_str();
+    return true;
+}
+
+bool reql_func_t::is_simple_pluck(std::vector<std::string> *fields_out) const {
+    if (arg_names.size() != 1) {
+        return false;
+    }
+    // `pluck` on a sequence maps a `pluck` with the `_NO_RECURSE_` optarg.
+    const Term &pluck = *body->get_src();
+    if (pluck.type() != Term::PLUCK
+        || pluck.args_size() < 1
+        || !is_var(pluck.args(0), arg_names[0])) {
+        return false;
+    }
+    for (int i = 0; i < pluck.optargs_size(); ++i) {
+        if (pluck.optargs(i).key() != "_NO_RECURSE_") {
+            return false;
+        }
+    }
+    std::vector<std::string> fields;
+    for (int i = 1; i < pluck.args_size(); ++i) {
+        if (!is_string_datum(pluck.args(i))) {
+            return false;
+        }
+        fields.push_back(pluck.args(i).datum().r_str());
+    }
+    *fields_out = std::move(fields);
+    return true;
+}
+
 js_func_t::js_func_t(const std::string &_js_source,
                      uint64_t timeout_ms,
                      protob_t<const Backtrace> backtrace)
@@ -226,7 +284,7 @@ bool filter_match(counted_t<const datum_t> predicate, counted_t<const datum_t> v
     if (predicate->is_ptype(pseudo::literal_string)) {
         return *predicate->get(pseudo::value_key) == *value;
     } else {
-        const std::map<std::string, counted_t<const datum_t> > &obj
+        const datum_object_t &obj
             = predicate->as_object();
         for (auto it = obj.begin(); it != obj.end(); ++it) {
             r_sanity_check(it->second.has());
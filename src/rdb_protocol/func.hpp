@@ -35,6 +35,14 @@ public:
 
     virtual bool is_deterministic() const = 0;
 
+    // Returns true and sets `*field_out` if the function just returns a top-level
+    // field of its only argument, like `r.row('field')` does.
+    virtual bool is_simple_selector(std::string *field_out) const = 0;
+
+    // Returns true and sets `*fields_out` if the function just plucks top-level
+    // fields out of its only argument, like `pluck` on a sequence does.
+    virtual bool is_simple_pluck(std::vector<std::string> *fields_out) const = 0;
+
     // Used by info_term_t.
     virtual std::string print_source() const = 0;
 
@@ -78,6 +86,8 @@ public:
         const std::vector<counted_t<const datum_t> > &args,
         eval_flags_t eval_flags) const;
     bool is_deterministic() const;
+    bool is_simple_selector(std::string *field_out) const;
+    bool is_simple_pluck(std::vector<std::string> *fields_out) const;
 
     std::string print_source() const;
 
@@ -113,6 +123,8 @@ public:
                           eval_flags_t eval_flags) const;
 
     bool is_deterministic() const;
+    bool is_simple_selector(std::string *) const { return false; }
+    bool is_simple_pluck(std::vector<std::string> *) const { return false; }
 
     std::string print_source() const;
 
@@ -3,13 +3,16 @@
 
 #include "containers/archive/buffer_group_stream.hpp"
 #include "containers/archive/versioned.hpp"
+#include "containers/scoped.hpp"
 #include "rdb_protocol/blob_wrapper.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
 
 counted_t<const ql::datum_t> get_data(const rdb_value_t *value, buf_parent_t parent) {
     // TODO: Just use deserialize_from_blob?
-    rdb_blob_wrapper_t blob(parent.cache()->max_block_size(),
+    const max_block_size_t block_size = parent.cache()->max_block_size();
+    rdb_blob_wrapper_t blob(block_size,
                             const_cast<rdb_value_t *>(value)->value_ref(),
-                            blob::btree_maxreflen);
+                            blob::btree_maxreflen(block_size));
 
     counted_t<const ql::datum_t> data;
 
@@ -24,6 +27,52 @@ counted_t<const ql::datum_t> get_data(const rdb_value_t *value, buf_parent_t par
     return data;
 }
 
+// Acquires only the blocks of the blob that `datum_deserialize_field` asks for.
+class blob_region_source_t : public ql::datum_region_source_t {
+public:
+    blob_region_source_t(rdb_blob_wrapper_t *_blob, buf_parent_t _parent)
+        : blob(_blob), parent(_parent) { }
+
+    uint64_t size() {
+        return blob->valuesize();
+    }
+
+    const const_buffer_group_t *expose(uint64_t offset, uint64_t length) {
+        // Release the blocks of the previous region before acquiring new ones.
+        acq_group.reset();
+        buffer_group.init(new buffer_group_t);
+        acq_group.init(new blob_acq_t);
+        blob->expose_region(parent, access_t::read, offset, length,
+                            buffer_group.get(), acq_group.get());
+        return const_view(buffer_group.get());
+    }
+
+private:
+    rdb_blob_wrapper_t *blob;
+    buf_parent_t parent;
+    scoped_ptr_t<buffer_group_t> buffer_group;
+    scoped_ptr_t<blob_acq_t> acq_group;
+
+    DISABLE_COPYING(blob_region_source_t);
+};
+
+counted_t<const ql::datum_t> get_data_field(const rdb_value_t *value,
+                                            buf_parent_t parent,
+                                            const std::string &key) {
+    const max_block_size_t block_size = parent.cache()->max_block_size();
+    rdb_blob_wrapper_t blob(block_size,
+                            const_cast<rdb_value_t *>(value)->value_ref(),
+                            blob::btree_maxreflen(block_size));
+
+    counted_t<const ql::datum_t> field;
+
+    blob_region_source_t source(&blob, parent);
+    archive_result_t res = ql::datum_deserialize_field(&source, key, &field);
+    guarantee_deserialization(res, "rdb value field");
+
+    return field;
+}
+
 const counted_t<const ql::datum_t> &lazy_json_t::get() const {
     guarantee(pointee.has());
     if (!pointee->ptr.has()) {
@@ -34,6 +83,16 @@ const counted_t<const ql::datum_t> &lazy_json_t::get() const {
     return pointee->ptr;
 }
 
+counted_t<const ql::datum_t> lazy_json_t::get_field(const std::string &key) const {
+    guarantee(pointee.has());
+    if (pointee->ptr.has()) {
+        return pointee->ptr->get_type() == ql::datum_t::R_OBJECT
+            ? pointee->ptr->get(key, ql::NOTHROW)
+            : counted_t<const ql::datum_t>();
+    }
+    return get_data_field(pointee->rdb_value, pointee->parent, key);
+}
+
 bool lazy_json_t::references_parent() const {
     return pointee.has() && !pointee->parent.empty();
 }
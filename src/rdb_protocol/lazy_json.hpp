@@ -11,11 +11,11 @@ struct rdb_value_t {
 
 public:
     int inline_size(max_block_size_t bs) const {
-        return blob::ref_size(bs, contents, blob::btree_maxreflen);
+        return blob::ref_size(bs, contents, blob::btree_maxreflen(bs));
     }
 
-    int64_t value_size() const {
-        return blob::value_size(contents, blob::btree_maxreflen);
+    int64_t value_size(max_block_size_t bs) const {
+        return blob::value_size(contents, blob::btree_maxreflen(bs));
     }
 
     const char *value_ref() const {
@@ -30,6 +30,12 @@ public:
 counted_t<const ql::datum_t> get_data(const rdb_value_t *value,
                                       buf_parent_t parent);
 
+// Returns the field `key` of the row stored in `value`, or an empty pointer if it
+// has no such field.  Doesn't load the rest of the row if it can help it.
+counted_t<const ql::datum_t> get_data_field(const rdb_value_t *value,
+                                            buf_parent_t parent,
+                                            const std::string &key);
+
 class lazy_json_pointee_t : public single_threaded_countable_t<lazy_json_pointee_t> {
     lazy_json_pointee_t(const rdb_value_t *_rdb_value, buf_parent_t _parent)
         : rdb_value(_rdb_value), parent(_parent) {
@@ -63,6 +69,9 @@ public:
         : pointee(new lazy_json_pointee_t(rdb_value, parent)) { }
 
     const counted_t<const ql::datum_t> &get() const;
+    // Like `get()->get(key, ql::NOTHROW)`, but if the value hasn't been loaded
+    // yet, only loads the field (and doesn't keep it).
+    counted_t<const ql::datum_t> get_field(const std::string &key) const;
     bool references_parent() const;
     void reset();
 
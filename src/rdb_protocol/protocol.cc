@@ -91,13 +91,13 @@ key_range_t datum_range_t::to_primary_keyrange() const {
             : store_key_t::max());
 }
 
-key_range_t datum_range_t::to_sindex_keyrange() const {
+key_range_t datum_range_t::to_sindex_keyrange(ql::skey_version_t skey_version) const {
     return rdb_protocol::sindex_key_range(
         left_bound.has()
-            ? store_key_t(left_bound->truncated_secondary())
+            ? store_key_t(left_bound->truncated_secondary(skey_version))
             : store_key_t::min(),
         right_bound.has()
-            ? store_key_t(right_bound->truncated_secondary())
+            ? store_key_t(right_bound->truncated_secondary(skey_version))
             : store_key_t::max());
 }
 
@@ -380,6 +380,44 @@ store_key_t sindex_list_region_key() {
     return store_key_t();
 }
 
+// TODO: This entire type is suspect, given the performance for
+// batched_replaces_t.  Is it used in anything other than assertions?
+region_t region_from_keys(const std::vector<store_key_t> &keys) {
+    // It shouldn't be empty, but we let the places that would break use a
+    // guarantee.
+    rassert(!keys.empty());
+    if (keys.empty()) {
+        return hash_region_t<key_range_t>();
+    }
+
+    store_key_t min_key = store_key_t::max();
+    store_key_t max_key = store_key_t::min();
+    uint64_t min_hash_value = HASH_REGION_HASH_SIZE - 1;
+    uint64_t max_hash_value = 0;
+
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        const store_key_t &key = *it;
+        if (key < min_key) {
+            min_key = key;
+        }
+        if (key > max_key) {
+            max_key = key;
+        }
+
+        const uint64_t hash_value = hash_region_hasher(key.contents(), key.size());
+        if (hash_value < min_hash_value) {
+            min_hash_value = hash_value;
+        }
+        if (hash_value > max_hash_value) {
+            max_hash_value = hash_value;
+        }
+    }
+
+    return hash_region_t<key_range_t>(
+        min_hash_value, max_hash_value + 1,
+        key_range_t(key_range_t::closed, min_key, key_range_t::closed, max_key));
+}
+
 /* read_t::get_region implementation */
 struct rdb_r_get_region_visitor : public boost::static_visitor<region_t> {
     region_t operator()(const point_read_t &pr) const {
@@ -409,6 +447,10 @@ struct rdb_r_get_region_visitor : public boost::static_visitor<region_t> {
     region_t operator()(const sindex_status_t &ss) const {
         return ss.region;
     }
+
+    region_t operator()(const point_read_batch_t &prb) const {
+        return region_from_keys(prb.keys);
+    }
 };
 
 region_t read_t::get_region() const THROWS_NOTHING {
@@ -460,8 +502,13 @@ struct rdb_r_shard_visitor_t : public boost::static_visitor<bool> {
     bool operator()(const rget_read_t &rg) const {
         bool do_read = rangey_read(rg);
         if (do_read) {
+            // The shard's part of the hash space tells how many CPU shards the read
+            // gets split into, since their number depends on the table's files.
             auto rg_out = boost::get<rget_read_t>(&read_out->read);
-            rg_out->batchspec = rg_out->batchspec.scale_down(CPU_SHARDING_FACTOR);
+            const uint64_t read_width = rg.region.end - rg.region.beg;
+            const uint64_t shard_width = rg_out->region.end - rg_out->region.beg;
+            rg_out->batchspec = rg_out->batchspec.scale_down(
+                std::max<uint64_t>(read_width / shard_width, 1));
         }
         return do_read;
     }
@@ -478,6 +525,21 @@ struct rdb_r_shard_visitor_t : public boost::static_visitor<bool> {
         return rangey_read(ss);
     }
 
+    bool operator()(const point_read_batch_t &prb) const {
+        std::vector<store_key_t> shard_keys;
+        for (auto it = prb.keys.begin(); it != prb.keys.end(); ++it) {
+            if (region_contains_key(*region, *it)) {
+                shard_keys.push_back(*it);
+            }
+        }
+        if (!shard_keys.empty()) {
+            *read_out = read_t(point_read_batch_t(std::move(shard_keys)), profile);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
     const hash_region_t<key_range_t> *region;
     profile_bool_t profile;
     read_t *read_out;
@@ -539,6 +601,7 @@ public:
     void operator()(const sindex_status_t &rg);
     void operator()(const changefeed_subscribe_t &);
     void operator()(const changefeed_stamp_t &);
+    void operator()(const point_read_batch_t &);
 
 private:
     const profile_bool_t profile;
@@ -587,6 +650,17 @@ void rdb_r_unshard_visitor_t::operator()(const point_read_t &) {
     *response_out = responses[0];
 }
 
+void rdb_r_unshard_visitor_t::operator()(const point_read_batch_t &) {
+    response_out->response = point_read_batch_response_t();
+    auto out = boost::get<point_read_batch_response_t>(&response_out->response);
+    for (size_t i = 0; i < count; ++i) {
+        auto res = boost::get<point_read_batch_response_t>(&responses[i].response);
+        guarantee(res != NULL);
+        // The shards' keys are disjoint, so nothing gets overwritten here.
+        out->data.insert(res->data.begin(), res->data.end());
+    }
+}
+
 void rdb_r_unshard_visitor_t::operator()(const rget_read_t &rg) {
     if (rg.transforms.size() != 0 || rg.terminal) {
         // This asserts that the optargs have been initialized.  (There is always a
@@ -745,44 +819,6 @@ void read_t::unshard(read_response_t *responses, size_t count,
 
 /* write_t::get_region() implementation */
 
-// TODO: This entire type is suspect, given the performance for
-// batched_replaces_t.  Is it used in anything other than assertions?
-region_t region_from_keys(const std::vector<store_key_t> &keys) {
-    // It shouldn't be empty, but we let the places that would break use a
-    // guarantee.
-    rassert(!keys.empty());
-    if (keys.empty()) {
-        return hash_region_t<key_range_t>();
-    }
-
-    store_key_t min_key = store_key_t::max();
-    store_key_t max_key = store_key_t::min();
-    uint64_t min_hash_value = HASH_REGION_HASH_SIZE - 1;
-    uint64_t max_hash_value = 0;
-
-    for (auto it = keys.begin(); it != keys.end(); ++it) {
-        const store_key_t &key = *it;
-        if (key < min_key) {
-            min_key = key;
-        }
-        if (key > max_key) {
-            max_key = key;
-        }
-
-        const uint64_t hash_value = hash_region_hasher(key.contents(), key.size());
-        if (hash_value < min_hash_value) {
-            min_hash_value = hash_value;
-        }
-        if (hash_value > max_hash_value) {
-            max_hash_value = hash_value;
-        }
-    }
-
-    return hash_region_t<key_range_t>(
-        min_hash_value, max_hash_value + 1,
-        key_range_t(key_range_t::closed, min_key, key_range_t::closed, max_key));
-}
-
 struct rdb_w_get_region_visitor : public boost::static_visitor<region_t> {
     region_t operator()(const batched_replace_t &br) const {
         return region_from_keys(br.keys);
@@ -1031,6 +1067,9 @@ RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(
         rdb_protocol::single_sindex_status_t, blocks_total, blocks_processed, ready);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(point_read_response_t, data);
+// This is a cluster-only type, so we only support the latest version.
+RDB_IMPL_SERIALIZABLE_1(point_read_batch_response_t, data);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(point_read_batch_response_t);
 RDB_IMPL_SERIALIZABLE_4_SINCE_v1_13(
         rget_read_response_t, result, key_range, truncated, last_key);
 RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(
@@ -1039,10 +1078,16 @@ RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(sindex_list_response_t, sindexes);
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(sindex_status_response_t, statuses);
 RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(changefeed_subscribe_response_t, server_uuids, addrs);
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(changefeed_stamp_response_t, stamps);
-RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(
+// Serialization format changed in 1.14.  We only support the latest version,
+// since this is a cluster-only type.
+RDB_IMPL_SERIALIZABLE_3(
         read_response_t, response, event_log, n_shards);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(read_response_t);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(point_read_t, key);
+// This is a cluster-only type, so we only support the latest version.
+RDB_IMPL_SERIALIZABLE_1(point_read_batch_t, keys);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(point_read_batch_t);
 RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(
         sindex_rangespec_t, id, region, original_range);
 
@@ -1063,7 +1108,10 @@ RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(
         distribution_read_t, max_depth, result_limit, region);
 RDB_IMPL_SERIALIZABLE_0_SINCE_v1_13(sindex_list_t);
 RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(sindex_status_t, sindexes, region);
-RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(changefeed_subscribe_t, addr, region);
+// Serialization format changed in 1.14.  We only support the latest version,
+// since this is a cluster-only type.
+RDB_IMPL_SERIALIZABLE_3(changefeed_subscribe_t, addr, spec, region);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(changefeed_subscribe_t);
 RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(changefeed_stamp_t, addr, region);
 
 RDB_MAKE_SERIALIZABLE_2(read_t, read, profile);
@@ -1087,7 +1135,13 @@ INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(batched_insert_t);
 
 RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(point_write_t, key, data, overwrite);
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(point_delete_t, key);
-RDB_IMPL_SERIALIZABLE_4_SINCE_v1_13(sindex_create_t, id, mapping, region, multi);
+// Added in 1.14.  Sindex descriptions written by 1.13 don't have it.
+RDB_IMPL_SERIALIZABLE_2(sindex_storage_t, slim, covering);
+INSTANTIATE_SERIALIZABLE_SINCE_v1_14(sindex_storage_t);
+// Serialization format changed in 1.14.  We only support the latest version,
+// since this is a cluster-only type.
+RDB_IMPL_SERIALIZABLE_5(sindex_create_t, id, mapping, region, multi, storage);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(sindex_create_t);
 RDB_IMPL_SERIALIZABLE_2_SINCE_v1_13(sindex_drop_t, id, region);
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_13(sync_t, region);
 
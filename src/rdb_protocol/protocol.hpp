@@ -109,6 +109,10 @@ public:
     bool contains(counted_t<const ql::datum_t> val) const;
     bool is_universe() const;
 
+    // The keys that values in the range have in a sindex with the given key
+    // encoding.  Because of truncation, keys of other values can be in it too.
+    key_range_t to_sindex_keyrange(ql::skey_version_t skey_version) const;
+
     RDB_DECLARE_ME_SERIALIZABLE;
 
 private:
@@ -120,7 +124,6 @@ private:
     friend struct unittest::make_sindex_read_t;
 
     key_range_t to_primary_keyrange() const;
-    key_range_t to_sindex_keyrange() const;
 
     counted_t<const ql::datum_t> left_bound, right_bound;
     key_range_t::bound_t left_bound_type, right_bound_type;
@@ -175,6 +178,20 @@ enum class sindex_multi_bool_t { SINGLE = 0, MULTI = 1};
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(sindex_multi_bool_t, int8_t,
         sindex_multi_bool_t::SINGLE, sindex_multi_bool_t::MULTI);
 
+// How a secondary index stores its entries.  A full index keeps a copy of the row
+// in every entry.  A slim index only keeps the values of its `covering` fields, and
+// reads that need anything else look the rows up in the primary btree.
+struct sindex_storage_t {
+    sindex_storage_t() : slim(false) { }
+    sindex_storage_t(bool _slim, const std::vector<std::string> &_covering)
+        : slim(_slim), covering(_covering) { }
+
+    bool slim;
+    std::vector<std::string> covering;
+};
+
+RDB_DECLARE_SERIALIZABLE(sindex_storage_t);
+
 struct point_read_response_t {
     counted_t<const ql::datum_t> data;
     point_read_response_t() { }
@@ -184,6 +201,14 @@ struct point_read_response_t {
 
 RDB_DECLARE_SERIALIZABLE(point_read_response_t);
 
+struct point_read_batch_response_t {
+    // Only has entries for the keys that are in the table.
+    std::map<store_key_t, counted_t<const ql::datum_t> > data;
+    point_read_batch_response_t() { }
+};
+
+RDB_DECLARE_SERIALIZABLE(point_read_batch_response_t);
+
 struct rget_read_response_t {
     key_range_t key_range;
     ql::result_t result;
@@ -255,7 +280,8 @@ struct read_response_t {
                            changefeed_stamp_response_t,
                            distribution_read_response_t,
                            sindex_list_response_t,
-                           sindex_status_response_t> variant_t;
+                           sindex_status_response_t,
+                           point_read_batch_response_t> variant_t;
     variant_t response;
     profile::event_log_t event_log;
     size_t n_shards;
@@ -277,12 +303,26 @@ public:
 
 RDB_DECLARE_SERIALIZABLE(point_read_t);
 
+// Reads several rows by primary key.  It gets sharded like a `batched_replace_t`,
+// so each shard sees only its own keys and looks them all up at once.
+class point_read_batch_t {
+public:
+    point_read_batch_t() { }
+    explicit point_read_batch_t(std::vector<store_key_t> &&_keys)
+        : keys(std::move(_keys)) { }
+
+    std::vector<store_key_t> keys;
+};
+
+RDB_DECLARE_SERIALIZABLE(point_read_batch_t);
+
 struct sindex_rangespec_t {
     sindex_rangespec_t() { }
     sindex_rangespec_t(const std::string &_id,
                        // This is the region in the sindex keyspace.  It's
                        // sometimes smaller than the datum range below when
-                       // dealing with truncated keys.
+                       // dealing with truncated keys.  The store restricts it
+                       // to the datum range in the sindex's own key encoding.
                        const region_t &_region,
                        const datum_range_t _original_range)
         : id(_id), region(_region), original_range(_original_range) { }
@@ -372,9 +412,11 @@ RDB_DECLARE_SERIALIZABLE(sindex_status_t);
 class changefeed_subscribe_t {
 public:
     changefeed_subscribe_t() { }
-    explicit changefeed_subscribe_t(ql::changefeed::client_t::addr_t _addr)
-        : addr(_addr), region(region_t::universe()) { }
+    changefeed_subscribe_t(ql::changefeed::client_t::addr_t _addr,
+                           ql::changefeed::spec_t _spec)
+        : addr(_addr), spec(std::move(_spec)), region(region_t::universe()) { }
     ql::changefeed::client_t::addr_t addr;
+    ql::changefeed::spec_t spec;
     region_t region;
 };
 
@@ -398,7 +440,8 @@ struct read_t {
                            changefeed_stamp_t,
                            distribution_read_t,
                            sindex_list_t,
-                           sindex_status_t> variant_t;
+                           sindex_status_t,
+                           point_read_batch_t> variant_t;
     variant_t read;
     profile_bool_t profile;
 
@@ -418,8 +461,13 @@ struct read_t {
     read_t(T &&_read, profile_bool_t _profile)
         : read(std::forward<T>(_read)), profile(_profile) { }
 
-    // Only use snapshotting if we're doing a range get.
-    bool use_snapshot() const THROWS_NOTHING { return boost::get<rget_read_t>(&read); }
+    // Only use snapshotting if we're doing a range get, or a batch of point gets,
+    // which would otherwise keep writers off the primary btree's root until it had
+    // looked up every key.
+    bool use_snapshot() const THROWS_NOTHING {
+        return boost::get<rget_read_t>(&read)
+            || boost::get<point_read_batch_t>(&read);
+    }
 
     // Returns true if this read should be sent to every replica.
     bool all_read() const THROWS_NOTHING { return boost::get<sindex_status_t>(&read); }
@@ -578,14 +626,17 @@ class sindex_create_t {
 public:
     sindex_create_t() { }
     sindex_create_t(const std::string &_id, const ql::map_wire_func_t &_mapping,
-                    sindex_multi_bool_t _multi)
-        : id(_id), mapping(_mapping), region(region_t::universe()), multi(_multi)
+                    sindex_multi_bool_t _multi,
+                    const sindex_storage_t &_storage = sindex_storage_t())
+        : id(_id), mapping(_mapping), region(region_t::universe()), multi(_multi),
+          storage(_storage)
     { }
 
     std::string id;
     ql::map_wire_func_t mapping;
     region_t region;
     sindex_multi_bool_t multi;
+    sindex_storage_t storage;
 };
 
 RDB_DECLARE_SERIALIZABLE(sindex_create_t);
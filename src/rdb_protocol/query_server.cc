@@ -62,6 +62,7 @@ bool rdb_query_server_t::run_query(const ql::protob_t<Query> &query,
          noreply->as_bool());
     try {
         scoped_ops_running_stat_t stat(&rdb_ctx->ql_ops_running);
+        block_pm_latency latency(&rdb_ctx->ql_query_latency);
         guarantee(rdb_ctx->reql_admin_interface);
         // `ql::run` will set the status code
         ql::run(query,
@@ -1,11 +1,14 @@
 #include "rdb_protocol/serialize_datum.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <string>
 #include <vector>
 
 #include "containers/archive/stl_types.hpp"
 #include "containers/archive/versioned.hpp"
+#include "containers/buffer_group.hpp"
+#include "containers/scoped.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/error.hpp"
 
@@ -21,11 +24,18 @@ enum class datum_serialized_type_t {
     R_STR = 6,
     INT_NEGATIVE = 7,
     INT_POSITIVE = 8,
+    R_OBJECT_INDEXED = 9,
 };
 
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(datum_serialized_type_t, int8_t,
                                       datum_serialized_type_t::R_ARRAY,
-                                      datum_serialized_type_t::INT_POSITIVE);
+                                      datum_serialized_type_t::R_OBJECT_INDEXED);
+
+// An R_OBJECT_INDEXED object is serialized as the number of fields N, then N uint32
+// offsets, then the N key/value pairs, sorted by key.  The offsets are relative to
+// the first key/value pair.  Small objects don't get an offset table, because
+// scanning them is cheap anyway.
+static const size_t DATUM_INDEXED_MIN_FIELDS = 4;
 
 void datum_serialize(write_message_t *wm, datum_serialized_type_t type) {
     serialize<cluster_version_t::LATEST_OVERALL>(wm, type);
@@ -41,10 +51,11 @@ MUST_USE archive_result_t datum_deserialize(read_stream_t *s,
 // serialization has changed from cluster version to cluster version.
 
 // Keep in sync with datum_serialize.
-size_t datum_serialized_size(const std::vector<counted_t<const datum_t> > &v) {
+size_t datum_serialized_size(const std::vector<counted_t<const datum_t> > &v,
+                             datum_serialization_format_t format) {
     size_t ret = varint_uint64_serialized_size(v.size());
     for (auto it = v.begin(), e = v.end(); it != e; ++it) {
-        ret += datum_serialized_size(*it);
+        ret += datum_serialized_size(*it, format);
     }
     return ret;
 }
@@ -52,10 +63,11 @@ size_t datum_serialized_size(const std::vector<counted_t<const datum_t> > &v) {
 
 // Keep in sync with datum_serialized_size.
 void datum_serialize(write_message_t *wm,
-                     const std::vector<counted_t<const datum_t> > &v) {
+                     const std::vector<counted_t<const datum_t> > &v,
+                     datum_serialization_format_t format) {
     serialize_varint_uint64(wm, v.size());
     for (auto it = v.begin(), e = v.end(); it != e; ++it) {
-        datum_serialize(wm, *it);
+        datum_serialize(wm, *it, format);
     }
 }
 
@@ -91,63 +103,121 @@ MUST_USE archive_result_t datum_deserialize(read_stream_t *s, std::string *out)
 }
 
 
+bool has_offset_table(const datum_object_t &m,
+                      datum_serialization_format_t format) {
+    return format == datum_serialization_format_t::INDEXED
+        && m.size() >= DATUM_INDEXED_MIN_FIELDS;
+}
+
 size_t datum_serialized_size(
-        const std::map<std::string, counted_t<const datum_t> > &m) {
+        const datum_object_t &m,
+        datum_serialization_format_t format) {
     size_t ret = varint_uint64_serialized_size(m.size());
+    if (has_offset_table(m, format)) {
+        ret += m.size() * serialize_universal_size_t<uint32_t>::value;
+    }
     for (auto it = m.begin(), e = m.end(); it != e; ++it) {
         ret += datum_serialized_size(it->first);
-        ret += datum_serialized_size(it->second);
+        ret += datum_serialized_size(it->second, format);
     }
     return ret;
 }
 
 void datum_serialize(write_message_t *wm,
-                     const std::map<std::string, counted_t<const datum_t> > &m) {
+                     const datum_object_t &m,
+                     datum_serialization_format_t format) {
     serialize_varint_uint64(wm, m.size());
+    if (has_offset_table(m, format)) {
+        size_t offset = 0;
+        for (auto it = m.begin(), e = m.end(); it != e; ++it) {
+            guarantee(offset <= std::numeric_limits<uint32_t>::max(),
+                      "Object too large to serialize with an offset table.");
+            serialize_universal(wm, static_cast<uint32_t>(offset));
+            offset += datum_serialized_size(it->first);
+            offset += datum_serialized_size(it->second, format);
+        }
+    }
     for (auto it = m.begin(), e = m.end(); it != e; ++it) {
         datum_serialize(wm, it->first);
-        datum_serialize(wm, it->second);
+        datum_serialize(wm, it->second, format);
     }
 }
 
-MUST_USE archive_result_t datum_deserialize(
+// Deserializes the `sz` key/value pairs of an object.
+MUST_USE archive_result_t datum_deserialize_pairs(
         read_stream_t *s,
-        std::map<std::string, counted_t<const datum_t> > *m) {
-    m->clear();
-
-    uint64_t sz;
-    archive_result_t res = deserialize_varint_uint64(s, &sz);
-    if (bad(res)) { return res; }
+        uint64_t sz,
+        datum_object_t *m) {
+    *m = datum_object_t();
 
     if (sz > std::numeric_limits<size_t>::max()) {
         return archive_result_t::RANGE_ERROR;
     }
 
-    // Using position should make this function take linear time, not
-    // sz*log(sz) time.
-    auto position = m->begin();
+    // We don't trust `sz` enough to reserve more than this up front.
+    m->reserve(std::min<uint64_t>(sz, 1024));
 
     for (uint64_t i = 0; i < sz; ++i) {
-        std::pair<std::string, counted_t<const datum_t> > p;
-        res = datum_deserialize(s, &p.first);
+        std::string key;
+        archive_result_t res = datum_deserialize(s, &key);
         if (bad(res)) { return res; }
-        res = datum_deserialize(s, &p.second);
+        counted_t<const datum_t> val;
+        res = datum_deserialize(s, &val);
         if (bad(res)) { return res; }
-        position = m->insert(position, std::move(p));
+        // We always serialize the fields in order, so they can be appended.
+        if (!m->append(std::move(key), std::move(val))) {
+            return archive_result_t::RANGE_ERROR;
+        }
     }
 
     return archive_result_t::SUCCESS;
 }
 
+MUST_USE archive_result_t datum_deserialize(
+        read_stream_t *s,
+        datum_object_t *m) {
+    uint64_t sz;
+    archive_result_t res = deserialize_varint_uint64(s, &sz);
+    if (bad(res)) { return res; }
+
+    return datum_deserialize_pairs(s, sz, m);
+}
+
+// Deserializes an R_OBJECT_INDEXED object.  We don't need the offset table for
+// that.
+MUST_USE archive_result_t datum_deserialize_indexed(
+        read_stream_t *s,
+        datum_object_t *m) {
+    uint64_t sz;
+    archive_result_t res = deserialize_varint_uint64(s, &sz);
+    if (bad(res)) { return res; }
+
+    for (uint64_t i = 0; i < sz; ++i) {
+        uint32_t offset;
+        res = deserialize_universal(s, &offset);
+        if (bad(res)) { return res; }
+    }
+
+    return datum_deserialize_pairs(s, sz, m);
+}
+
 
 
 
 size_t datum_serialized_size(const counted_t<const datum_t> &datum) {
+    return datum_serialized_size(datum, datum_serialization_format_t::PLAIN);
+}
+void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum) {
+    datum_serialize(wm, datum, datum_serialization_format_t::PLAIN);
+}
+
+size_t datum_serialized_size(const counted_t<const datum_t> &datum,
+                             datum_serialization_format_t format) {
     r_sanity_check(datum.has());
     size_t sz = 1; // 1 byte for the type
     switch (datum->get_type()) {
     case datum_t::R_ARRAY: {
-        sz += datum_serialized_size(datum->as_array());
+        sz += datum_serialized_size(datum->as_array(), format);
     } break;
     case datum_t::R_BOOL: {
         sz += serialize_universal_size_t<bool>::value;
@@ -163,7 +233,7 @@ size_t datum_serialized_size(const counted_t<const datum_t> &datum) {
         }
     } break;
     case datum_t::R_OBJECT: {
-        sz += datum_serialized_size(datum->as_object());
+        sz += datum_serialized_size(datum->as_object(), format);
     } break;
     case datum_t::R_STR: {
         sz += datum_serialized_size(datum->as_str());
@@ -174,13 +244,14 @@ size_t datum_serialized_size(const counted_t<const datum_t> &datum) {
     }
     return sz;
 }
-void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum) {
+void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum,
+                     datum_serialization_format_t format) {
     r_sanity_check(datum.has());
     switch (datum->get_type()) {
     case datum_t::R_ARRAY: {
         datum_serialize(wm, datum_serialized_type_t::R_ARRAY);
         const std::vector<counted_t<const datum_t> > &value = datum->as_array();
-        datum_serialize(wm, value);
+        datum_serialize(wm, value, format);
     } break;
     case datum_t::R_BOOL: {
         datum_serialize(wm, datum_serialized_type_t::R_BOOL);
@@ -211,8 +282,11 @@ void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum)
         }
     } break;
     case datum_t::R_OBJECT: {
-        datum_serialize(wm, datum_serialized_type_t::R_OBJECT);
-        datum_serialize(wm, datum->as_object());
+        const datum_object_t &value = datum->as_object();
+        datum_serialize(wm, has_offset_table(value, format)
+                            ? datum_serialized_type_t::R_OBJECT_INDEXED
+                            : datum_serialized_type_t::R_OBJECT);
+        datum_serialize(wm, value, format);
     } break;
     case datum_t::R_STR: {
         datum_serialize(wm, datum_serialized_type_t::R_STR);
@@ -296,7 +370,7 @@ archive_result_t datum_deserialize(read_stream_t *s, counted_t<const datum_t> *d
         }
     } break;
     case datum_serialized_type_t::R_OBJECT: {
-        std::map<std::string, counted_t<const datum_t> > value;
+        datum_object_t value;
         res = datum_deserialize(s, &value);
         if (bad(res)) {
             return res;
@@ -307,6 +381,18 @@ archive_result_t datum_deserialize(read_stream_t *s, counted_t<const datum_t> *d
             return archive_result_t::RANGE_ERROR;
         }
     } break;
+    case datum_serialized_type_t::R_OBJECT_INDEXED: {
+        datum_object_t value;
+        res = datum_deserialize_indexed(s, &value);
+        if (bad(res)) {
+            return res;
+        }
+        try {
+            datum->reset(new datum_t(std::move(value)));
+        } catch (const base_exc_t &) {
+            return archive_result_t::RANGE_ERROR;
+        }
+    } break;
     case datum_serialized_type_t::R_STR: {
         scoped_ptr_t<wire_string_t> value;
         res = datum_deserialize(s, &value);
@@ -327,6 +413,170 @@ archive_result_t datum_deserialize(read_stream_t *s, counted_t<const datum_t> *d
     return archive_result_t::SUCCESS;
 }
 
+// Makes `s` skip the first `n` bytes of its buffer group.
+MUST_USE archive_result_t skip_exactly(buffer_group_read_stream_t *s, int64_t n) {
+    return s->skip(n) == n ? archive_result_t::SUCCESS : archive_result_t::SOCK_EOF;
+}
+
+archive_result_t datum_deserialize_field(datum_region_source_t *source,
+                                         const std::string &key,
+                                         counted_t<const datum_t> *value_out) {
+    const uint64_t total_size = source->size();
+
+    // The type and the number of fields.
+    uint64_t sz;
+    {
+        const uint64_t header_size = std::min<uint64_t>(
+            total_size, 1 + varint_uint64_serialized_size(UINT64_MAX));
+        buffer_group_read_stream_t s(source->expose(0, header_size));
+        datum_serialized_type_t type;
+        archive_result_t res = datum_deserialize(&s, &type);
+        if (bad(res)) {
+            return res;
+        }
+
+        if (type != datum_serialized_type_t::R_OBJECT_INDEXED) {
+            buffer_group_read_stream_t whole(source->expose(0, total_size));
+            counted_t<const datum_t> datum;
+            res = datum_deserialize(&whole, &datum);
+            if (bad(res)) {
+                return res;
+            }
+            if (datum->get_type() == datum_t::R_OBJECT) {
+                *value_out = datum->get(key, NOTHROW);
+            } else {
+                value_out->reset();
+            }
+            return archive_result_t::SUCCESS;
+        }
+
+        res = deserialize_varint_uint64(&s, &sz);
+        if (bad(res)) {
+            return res;
+        }
+    }
+    const uint64_t table_offset = 1 + varint_uint64_serialized_size(sz);
+    if (table_offset > total_size
+        || sz > (total_size - table_offset) / sizeof(uint32_t)) {
+        return archive_result_t::RANGE_ERROR;
+    }
+    const uint64_t pairs_offset = table_offset + sz * sizeof(uint32_t);
+    if (sz == 0) {
+        value_out->reset();
+        return archive_result_t::SUCCESS;
+    }
+
+    // We keep the offset table, because a key/value pair ends where the next one
+    // begins.
+    std::vector<uint32_t> offsets(sz);
+    {
+        buffer_group_read_stream_t s(source->expose(table_offset,
+                                                    sz * sizeof(uint32_t)));
+        for (uint64_t i = 0; i < sz; ++i) {
+            archive_result_t res = deserialize_universal(&s, &offsets[i]);
+            if (bad(res)) {
+                return res;
+            }
+        }
+    }
+
+    // The pairs are sorted by key, so we binary search for `key`.
+    uint64_t begin = 0;
+    uint64_t end = sz;
+    while (begin < end) {
+        const uint64_t i = begin + (end - begin) / 2;
+
+        const uint64_t pair_begin = pairs_offset + offsets[i];
+        const uint64_t pair_end =
+            i + 1 < sz ? pairs_offset + offsets[i + 1] : total_size;
+        if (pair_begin > pair_end || pair_end > total_size) {
+            return archive_result_t::RANGE_ERROR;
+        }
+
+        // The key is its length followed by its bytes.
+        uint64_t key_size;
+        {
+            buffer_group_read_stream_t s(source->expose(
+                pair_begin,
+                std::min<uint64_t>(pair_end - pair_begin,
+                                   varint_uint64_serialized_size(UINT64_MAX))));
+            archive_result_t res = deserialize_varint_uint64(&s, &key_size);
+            if (bad(res)) {
+                return res;
+            }
+        }
+        const uint64_t key_begin = pair_begin + varint_uint64_serialized_size(key_size);
+        if (key_begin > pair_end || key_size > pair_end - key_begin) {
+            return archive_result_t::RANGE_ERROR;
+        }
+        std::string pair_key(key_size, '\0');
+        if (key_size > 0) {
+            buffer_group_read_stream_t s(source->expose(key_begin, key_size));
+            int64_t num_read = force_read(&s, &pair_key[0], key_size);
+            if (num_read != static_cast<int64_t>(key_size)) {
+                return archive_result_t::SOCK_ERROR;
+            }
+        }
+
+        const int cmp = pair_key.compare(key);
+        if (cmp == 0) {
+            const uint64_t value_begin = key_begin + key_size;
+            buffer_group_read_stream_t s(source->expose(value_begin,
+                                                        pair_end - value_begin));
+            return datum_deserialize(&s, value_out);
+        } else if (cmp < 0) {
+            begin = i + 1;
+        } else {
+            end = i;
+        }
+    }
+
+    value_out->reset();
+    return archive_result_t::SUCCESS;
+}
+
+// A `datum_region_source_t` for a datum that's already in memory.
+class buffer_group_region_source_t : public datum_region_source_t {
+public:
+    explicit buffer_group_region_source_t(const const_buffer_group_t *_group)
+        : group(_group) { }
+
+    uint64_t size() {
+        return group->get_size();
+    }
+
+    const const_buffer_group_t *expose(uint64_t offset, uint64_t length) {
+        region.init(new const_buffer_group_t);
+        for (size_t i = 0; i < group->num_buffers() && length > 0; ++i) {
+            const const_buffer_group_t::buffer_t b = group->get_buffer(i);
+            const uint64_t buf_size = static_cast<uint64_t>(b.size);
+            if (offset >= buf_size) {
+                offset -= buf_size;
+                continue;
+            }
+            const uint64_t n = std::min(buf_size - offset, length);
+            region->add_buffer(n, static_cast<const char *>(b.data) + offset);
+            offset = 0;
+            length -= n;
+        }
+        guarantee(length == 0);
+        return region.get();
+    }
+
+private:
+    const const_buffer_group_t *group;
+    scoped_ptr_t<const_buffer_group_t> region;
+
+    DISABLE_COPYING(buffer_group_region_source_t);
+};
+
+archive_result_t datum_deserialize_field(const const_buffer_group_t *group,
+                                         const std::string &key,
+                                         counted_t<const datum_t> *value_out) {
+    buffer_group_region_source_t source(group);
+    return datum_deserialize_field(&source, key, value_out);
+}
+
 
 template <cluster_version_t W>
 void serialize(write_message_t *wm,
@@ -363,7 +613,10 @@ archive_result_t deserialize(read_stream_t *s,
 template archive_result_t deserialize<cluster_version_t::v1_13>(
         read_stream_t *s,
         empty_ok_ref_t<counted_t<const datum_t> > datum);
-template archive_result_t deserialize<cluster_version_t::v1_13_2_is_latest>(
+template archive_result_t deserialize<cluster_version_t::v1_13_2>(
+        read_stream_t *s,
+        empty_ok_ref_t<counted_t<const datum_t> > datum);
+template archive_result_t deserialize<cluster_version_t::v1_14_is_latest>(
         read_stream_t *s,
         empty_ok_ref_t<counted_t<const datum_t> > datum);
 
@@ -5,10 +5,24 @@
 #include "containers/archive/buffer_group_stream.hpp"
 #include "containers/counted.hpp"
 
+class const_buffer_group_t;
+
 namespace ql {
 
 class datum_t;
 
+// The ways in which `datum_serialize` can write objects.  `datum_deserialize`
+// understands all of them.
+enum class datum_serialization_format_t {
+    // A count, followed by the key/value pairs.
+    PLAIN,
+    // Objects with at least `DATUM_INDEXED_MIN_FIELDS` fields get a table of the
+    // offsets of their key/value pairs, which lets `datum_deserialize_field` find a
+    // single field without deserializing the rest of the object.  We use this for
+    // the rows we store on disk.
+    INDEXED
+};
+
 // More stable versions of datum serialization, kept separate from the versioned
 // serialization functions.  Don't change these in a backwards-uncompatible way!  See
 // the FAQ at the end of this file.
@@ -16,6 +30,35 @@ size_t datum_serialized_size(const counted_t<const datum_t> &datum);
 void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum);
 archive_result_t datum_deserialize(read_stream_t *s, counted_t<const datum_t> *datum);
 
+size_t datum_serialized_size(const counted_t<const datum_t> &datum,
+                             datum_serialization_format_t format);
+void datum_serialize(write_message_t *wm, const counted_t<const datum_t> &datum,
+                     datum_serialization_format_t format);
+
+// Gives `datum_deserialize_field` access to a serialized datum one byte range at a
+// time, so that the parts of it that aren't needed don't have to be loaded.
+class datum_region_source_t {
+public:
+    virtual ~datum_region_source_t() { }
+    // The size of the serialized datum.
+    virtual uint64_t size() = 0;
+    // Returns the bytes [offset, offset + length), which must be within `size()`.
+    // The group stays valid until the next call.
+    virtual const const_buffer_group_t *expose(uint64_t offset, uint64_t length) = 0;
+};
+
+// Deserializes the field `key` of the object serialized in `source`.  If the
+// object has an offset table, this only exposes the table, the keys that a binary
+// search visits and the field's value; otherwise it deserializes the whole datum.
+// Sets `*value_out` to an empty pointer if there's no such field, or if the datum
+// isn't an object.
+archive_result_t datum_deserialize_field(datum_region_source_t *source,
+                                         const std::string &key,
+                                         counted_t<const datum_t> *value_out);
+archive_result_t datum_deserialize_field(const const_buffer_group_t *group,
+                                         const std::string &key,
+                                         counted_t<const datum_t> *value_out);
+
 // The versioned serialization functions.
 template <cluster_version_t W>
 size_t serialized_size(const counted_t<const datum_t> &datum) {
@@ -11,7 +11,7 @@ inline void datum_serialize_onto_blob(buf_parent_t parent, blob_t *blob,
     // bunch of virtual function calls that way.  But we do _deserialize_ off an
     // abstract stream type already, so what's the big deal?)
     write_message_t wm;
-    datum_serialize(&wm, value);
+    datum_serialize(&wm, value, ql::datum_serialization_format_t::INDEXED);
     write_onto_blob(parent, blob, wm);
 }
 
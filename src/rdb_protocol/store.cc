@@ -89,7 +89,7 @@ void store_t::help_construct_bring_sindexes_up_to_date() {
 struct rdb_read_visitor_t : public boost::static_visitor<void> {
     void operator()(const changefeed_subscribe_t &s) {
         guarantee(store->changefeed_server.has());
-        store->changefeed_server->add_client(s.addr);
+        store->changefeed_server->add_client(s.addr, s.spec);
         response->response = changefeed_subscribe_response_t();
         auto res = boost::get<changefeed_subscribe_response_t>(&response->response);
         guarantee(res != NULL);
@@ -112,6 +112,13 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         rdb_get(get.key, btree, superblock, res, ql_env.trace.get_or_null());
     }
 
+    void operator()(const point_read_batch_t &get) {
+        response->response = point_read_batch_response_t();
+        point_read_batch_response_t *res =
+            boost::get<point_read_batch_response_t>(&response->response);
+        rdb_get_batch(get.keys, btree, superblock, res, ql_env.trace.get_or_null());
+    }
+
     void operator()(const rget_read_t &rget) {
         if (rget.transforms.size() != 0 || rget.terminal) {
             // This asserts that the optargs have been initialized.  (There is always
@@ -130,6 +137,9 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
                            &ql_env, rget.batchspec, rget.transforms, rget.terminal,
                            rget.sorting, res);
         } else {
+            // We keep the superblock until we know from the sindex description
+            // whether we need the primary btree's root.  Reads are snapshotted,
+            // so this doesn't hold up writes.
             scoped_ptr_t<real_superblock_t> sindex_sb;
             std::vector<char> sindex_mapping_data;
 
@@ -141,7 +151,8 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
                     superblock,
                     &sindex_sb,
                     &sindex_mapping_data,
-                    &sindex_uuid);
+                    &sindex_uuid,
+                    release_superblock_t::KEEP);
                 if (!found) {
                     res->result = ql::exc_t(
                         ql::base_exc_t::GENERIC,
@@ -163,14 +174,28 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
             //  between sindex_start_value and sindex_end_value.
             ql::map_wire_func_t sindex_mapping;
             sindex_multi_bool_t multi_bool;
-            deserialize_sindex_info(sindex_mapping_data, &sindex_mapping, &multi_bool);
+            ql::skey_version_t skey_version;
+            sindex_storage_t storage;
+            deserialize_sindex_info(sindex_mapping_data, &sindex_mapping, &multi_bool,
+                                    &skey_version, &storage);
+
+            // Slim sindexes look rows up in the primary btree, so we hold on to
+            // its root before we let go of the superblock.
+            buf_lock_t primary_root;
+            const block_id_t primary_root_id = superblock->get_root_block_id();
+            if (storage.slim && primary_root_id != NULL_BLOCK_ID) {
+                primary_root = buf_lock_t(superblock->expose_buf(), primary_root_id,
+                                          access_t::read);
+            }
+            superblock->release();
 
             rdb_rget_secondary_slice(
                 store->get_sindex_slice(sindex_uuid),
                 rget.sindex->original_range, rget.sindex->region,
                 sindex_sb.get(), &ql_env, rget.batchspec, rget.transforms,
                 rget.terminal, rget.region.inner, rget.sorting,
-                sindex_mapping, multi_bool, res);
+                sindex_mapping, multi_bool, skey_version, storage,
+                btree, &primary_root, res);
         }
     }
 
@@ -425,7 +450,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
         sindex_create_response_t res;
 
         write_message_t wm;
-        serialize_sindex_info(&wm, c.mapping, c.multi);
+        serialize_sindex_info(&wm, c.mapping, c.multi, c.storage);
 
         vector_stream_t stream;
         stream.reserve(wm.size());
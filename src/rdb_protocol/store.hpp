@@ -218,10 +218,11 @@ public:
     MUST_USE bool acquire_sindex_superblock_for_read(
             const sindex_name_t &name,
             const std::string &table_name,
-            superblock_t *superblock,  // releases this.
+            superblock_t *superblock,  // releases this, unless told to KEEP it.
             scoped_ptr_t<real_superblock_t> *sindex_sb_out,
             std::vector<char> *opaque_definition_out, // Optional, may be NULL
-            uuid_u *sindex_uuid_out)
+            uuid_u *sindex_uuid_out,
+            release_superblock_t release_superblock = release_superblock_t::RELEASE)
         THROWS_ONLY(sindex_not_ready_exc_t);
 
     MUST_USE bool acquire_sindex_superblock_for_write(
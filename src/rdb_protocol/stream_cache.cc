@@ -1,12 +1,27 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/stream_cache.hpp"
 
+#include <algorithm>
+
+#include "arch/runtime/coroutines.hpp"
+#include "concurrency/wait_any.hpp"
 #include "rdb_protocol/env.hpp"
 
 #include "debug.hpp"
 
 namespace ql {
 
+read_ahead_t read_ahead_optarg(const protob_t<Query> &query) {
+    rassert(query.has());
+    counted_t<const datum_t> read_ahead_arg = static_optarg("read_ahead", query);
+    if (read_ahead_arg.has() && read_ahead_arg->get_type() == datum_t::R_BOOL &&
+        read_ahead_arg->as_bool()) {
+        return read_ahead_t::YES;
+    } else {
+        return read_ahead_t::NO;
+    }
+}
+
 bool stream_cache_t::contains(int64_t key) {
     return streams.find(key) != streams.end();
 }
@@ -15,6 +30,7 @@ void stream_cache_t::insert(int64_t key,
                             use_json_t use_json,
                             std::map<std::string, wire_func_t> global_optargs,
                             profile_bool_t profile_requested,
+                            read_ahead_t read_ahead,
                             counted_t<datum_stream_t> val_stream) {
     maybe_evict();
     auto res = streams.insert(
@@ -23,13 +39,19 @@ void stream_cache_t::insert(int64_t key,
                                                 use_json,
                                                 std::move(global_optargs),
                                                 profile_requested,
+                                                read_ahead,
                                                 val_stream)));
     guarantee(res.second);
 }
 
 void stream_cache_t::erase(int64_t key) {
-    size_t num_erased = streams.erase(key);
-    guarantee(num_erased == 1);
+    auto it = streams.find(key);
+    guarantee(it != streams.end());
+    if (it->second->prefetch.has()) {
+        ++rdb_ctx->ql_prefetch_wasted;
+    }
+    // This waits for `do_prefetch` to notice that it's been interrupted.
+    streams.erase(it);
 }
 
 bool stream_cache_t::serve(int64_t key, Response *res, signal_t *interruptor) {
@@ -42,23 +64,38 @@ bool stream_cache_t::serve(int64_t key, Response *res, signal_t *interruptor) {
 
     std::exception_ptr exc;
     try {
-        env_t env(rdb_ctx, interruptor, entry->global_optargs,
-                  entry->profile);
+        if (entry->prefetch.has()) {
+            if (entry->prefetch->done.is_pulsed()) {
+                ++rdb_ctx->ql_prefetch_hits;
+            } else {
+                wait_interruptible(&entry->prefetch->done, interruptor);
+            }
+            scoped_ptr_t<prefetch_t> prefetch(entry->prefetch.release());
+            if (prefetch->exc) {
+                std::rethrow_exception(prefetch->exc);
+            }
+            for (auto d = prefetch->batch.begin(); d != prefetch->batch.end(); ++d) {
+                (*d)->write_to_protobuf(res->add_response(), entry->use_json);
+            }
+        } else {
+            env_t env(rdb_ctx, interruptor, entry->global_optargs,
+                      entry->profile);
 
-        batch_type_t batch_type = entry->has_sent_batch
-                                      ? batch_type_t::NORMAL
-                                      : batch_type_t::NORMAL_FIRST;
-        std::vector<counted_t<const datum_t> > ds
-            = entry->stream->next_batch(
-                &env,
-                batchspec_t::user(batch_type, &env));
-        entry->has_sent_batch = true;
-        for (auto d = ds.begin(); d != ds.end(); ++d) {
-            (*d)->write_to_protobuf(res->add_response(), entry->use_json);
-        }
-        if (env.trace.has()) {
-            env.trace->as_datum()->write_to_protobuf(
-                res->mutable_profile(), entry->use_json);
+            batch_type_t batch_type = entry->has_sent_batch
+                                          ? batch_type_t::NORMAL
+                                          : batch_type_t::NORMAL_FIRST;
+            std::vector<counted_t<const datum_t> > ds
+                = entry->stream->next_batch(
+                    &env,
+                    batchspec_t::user(batch_type, &env));
+            entry->has_sent_batch = true;
+            for (auto d = ds.begin(); d != ds.end(); ++d) {
+                (*d)->write_to_protobuf(res->add_response(), entry->use_json);
+            }
+            if (env.trace.has()) {
+                env.trace->as_datum()->write_to_protobuf(
+                    res->mutable_profile(), entry->use_json);
+            }
         }
     } catch (const std::exception &e) {
         exc = std::current_exception();
@@ -81,6 +118,9 @@ bool stream_cache_t::serve(int64_t key, Response *res, signal_t *interruptor) {
         res->set_type(Response::SUCCESS_SEQUENCE);
     } else {
         res->set_type(cfeed ? Response::SUCCESS_FEED : Response::SUCCESS_PARTIAL);
+        if (!cfeed) {
+            maybe_start_prefetch(entry);
+        }
     }
     return true;
 }
@@ -89,15 +129,81 @@ void stream_cache_t::maybe_evict() {
     // We never evict right now.
 }
 
+void stream_cache_t::maybe_start_prefetch(entry_t *entry) {
+    // We don't read ahead when profiling, because the profile of a batch is sent
+    // along with it, and it should describe the work done for that CONTINUE.
+    if (entry->read_ahead == read_ahead_t::NO
+        || entry->profile == profile_bool_t::PROFILE
+        || entry->prefetch.has()
+        || prefetched_bytes >= CURSOR_PREFETCH_MAX_MEMORY) {
+        return;
+    }
+    // We reserve the memory now rather than when the batch is done, so that the
+    // prefetches that are still running count against the budget too.
+    const size_t reservation = std::min<size_t>(
+        CURSOR_PREFETCH_MAX_MEMORY - prefetched_bytes, CURSOR_PREFETCH_MAX_BATCH_SIZE);
+    entry->prefetch.init(new prefetch_t(this, reservation));
+    coro_t::spawn_sometime(std::bind(&stream_cache_t::do_prefetch,
+                                     this,
+                                     entry,
+                                     entry->prefetch.get(),
+                                     auto_drainer_t::lock_t(&entry->drainer)));
+}
+
+void stream_cache_t::do_prefetch(entry_t *entry,
+                                 prefetch_t *prefetch,
+                                 auto_drainer_t::lock_t keepalive) {
+    try {
+        env_t env(rdb_ctx, keepalive.get_drain_signal(), entry->global_optargs,
+                  entry->profile);
+        // The batcher only stops once a batch has reached its size limit, so the
+        // batch can come out a few rows larger than the reservation.  We count what
+        // it really takes up below.
+        prefetch->batch = entry->stream->next_batch(
+            &env,
+            batchspec_t::user(batch_type_t::NORMAL, &env)
+                .with_max_size(prefetch->batch_bytes));
+        size_t batch_bytes = 0;
+        for (auto d = prefetch->batch.begin(); d != prefetch->batch.end(); ++d) {
+            batch_bytes += datum_serialized_size(*d);
+        }
+        prefetch->set_batch_bytes(batch_bytes);
+    } catch (const std::exception &e) {
+        // `serve` rethrows this when the client asks for the batch.
+        prefetch->exc = std::current_exception();
+        prefetch->set_batch_bytes(0);
+    }
+    prefetch->done.pulse();
+}
+
+stream_cache_t::prefetch_t::prefetch_t(stream_cache_t *_parent,
+                                       size_t reservation)
+    : parent(_parent), batch_bytes(reservation) {
+    parent->prefetched_bytes += batch_bytes;
+}
+
+void stream_cache_t::prefetch_t::set_batch_bytes(size_t new_batch_bytes) {
+    rassert(parent->prefetched_bytes >= batch_bytes);
+    parent->prefetched_bytes = parent->prefetched_bytes - batch_bytes + new_batch_bytes;
+    batch_bytes = new_batch_bytes;
+}
+
+stream_cache_t::prefetch_t::~prefetch_t() {
+    rassert(parent->prefetched_bytes >= batch_bytes);
+    parent->prefetched_bytes -= batch_bytes;
+}
+
 stream_cache_t::entry_t::entry_t(time_t _last_activity,
                                  use_json_t _use_json,
                                  std::map<std::string, wire_func_t> _global_optargs,
                                  profile_bool_t _profile,
+                                 read_ahead_t _read_ahead,
                                  counted_t<datum_stream_t> _stream)
     : last_activity(_last_activity),
       use_json(_use_json),
       global_optargs(std::move(_global_optargs)),
       profile(_profile),
+      read_ahead(_read_ahead),
       stream(_stream),
       max_age(DEFAULT_MAX_AGE),
       has_sent_batch(false) { }
@@ -4,9 +4,13 @@
 
 #include <time.h>
 
+#include <exception>
 #include <map>
 #include <string>
+#include <vector>
 
+#include "concurrency/auto_drainer.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/signal.hpp"
 #include "containers/scoped.hpp"
 #include "rdb_protocol/datum_stream.hpp"
@@ -16,15 +20,26 @@ namespace ql {
 class env_t;
 }
 
+namespace unittest {
+void run_StreamCache_PrefetchMemoryBudget();
+}
+
 namespace ql {
 
 enum class reject_cfeeds_t { NO, YES };
+
+// Whether a cursor computes its next batch in the background as soon as it has
+// sent one, so that the next CONTINUE doesn't have to wait for it.
+enum class read_ahead_t { NO, YES };
+read_ahead_t read_ahead_optarg(const protob_t<Query> &query);
+
 class stream_cache_t {
 public:
     stream_cache_t(rdb_context_t *_rdb_ctx,
                    reject_cfeeds_t _reject_cfeeds)
         : rdb_ctx(_rdb_ctx),
-          reject_cfeeds(_reject_cfeeds) {
+          reject_cfeeds(_reject_cfeeds),
+          prefetched_bytes(0) {
         rassert(rdb_ctx != NULL);
     }
     MUST_USE bool contains(int64_t key);
@@ -32,11 +47,39 @@ public:
                 use_json_t use_json,
                 std::map<std::string, wire_func_t> global_optargs,
                 profile_bool_t profile_requested,
+                read_ahead_t read_ahead,
                 counted_t<datum_stream_t> val_stream);
     void erase(int64_t key);
     MUST_USE bool serve(int64_t key, Response *res, signal_t *interruptor);
 private:
+    friend void unittest::run_StreamCache_PrefetchMemoryBudget();
+
+    struct entry_t;
+
+    // A batch that is being (or has been) computed ahead of the CONTINUE that will
+    // send it.
+    struct prefetch_t {
+        // Counts `reservation` bytes towards `parent->prefetched_bytes` until the
+        // batch has been computed and its real size is known.
+        prefetch_t(stream_cache_t *_parent, size_t reservation);
+        ~prefetch_t();
+        stream_cache_t *const parent;
+        // Pulsed when `batch` or `exc` has been set.
+        cond_t done;
+        std::vector<counted_t<const datum_t> > batch;
+        std::exception_ptr exc;
+        // How much of `parent->prefetched_bytes` is ours: the reservation while the
+        // batch is being computed, the batch's serialized size afterwards.
+        size_t batch_bytes;
+        void set_batch_bytes(size_t new_batch_bytes);
+    private:
+        DISABLE_COPYING(prefetch_t);
+    };
+
     void maybe_evict();
+    void maybe_start_prefetch(entry_t *entry);
+    void do_prefetch(entry_t *entry, prefetch_t *prefetch,
+                     auto_drainer_t::lock_t keepalive);
 
     struct entry_t {
         ~entry_t();
@@ -45,20 +88,29 @@ private:
                 use_json_t use_json,
                 std::map<std::string, wire_func_t> global_optargs,
                 profile_bool_t profile,
+                read_ahead_t read_ahead,
                 counted_t<datum_stream_t> _stream);
         time_t last_activity;
         use_json_t use_json;
         std::map<std::string, wire_func_t> global_optargs;
         profile_bool_t profile;
+        read_ahead_t read_ahead;
         counted_t<datum_stream_t> stream;
         time_t max_age;
         bool has_sent_batch;
+        // Non-empty if the next batch is being or has been computed ahead.
+        scoped_ptr_t<prefetch_t> prefetch;
+        // Destroyed first, so that `prefetch` and `stream` outlive `do_prefetch`.
+        auto_drainer_t drainer;
     private:
         DISABLE_COPYING(entry_t);
     };
 
     rdb_context_t *const rdb_ctx;
     const reject_cfeeds_t reject_cfeeds;
+    // The total size of the prefetched batches, which the entries' `prefetch_t`s
+    // keep up to date.  Declared before `streams` so that it outlives them.
+    size_t prefetched_bytes;
     std::map<int64_t, scoped_ptr_t<entry_t> > streams;
     DISABLE_COPYING(stream_cache_t);
 };
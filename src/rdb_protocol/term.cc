@@ -254,6 +254,7 @@ void run(protob_t<Query> q,
                                          use_json,
                                          env.global_optargs.get_all_optargs(),
                                          profile,
+                                         read_ahead_optarg(q),
                                          seq);
                     bool b = stream_cache->serve(token, res, interruptor);
                     r_sanity_check(b);
@@ -105,7 +105,8 @@ class table_create_term_t : public meta_write_op_t {
 public:
     table_create_term_t(compile_env_t *env, const protob_t<const Term> &term) :
         meta_write_op_t(env, term, argspec_t(1, 2),
-                        optargspec_t({"datacenter", "primary_key", "durability"})) { }
+                        optargspec_t({"datacenter", "primary_key", "durability",
+                                      "cpu_shards"})) { }
 private:
     virtual std::string write_eval_impl(scope_env_t *env, args_t *args, eval_flags_t) const {
 
@@ -123,6 +124,16 @@ private:
             primary_key = v->as_str().to_std();
         }
 
+        boost::optional<int32_t> cpu_shards;
+        if (counted_t<val_t> v = args->optarg(env, "cpu_shards")) {
+            cpu_shards.reset(v->as_int<int32_t>());
+            rcheck(*cpu_shards >= 1 && *cpu_shards <= MAX_CPU_SHARDING_FACTOR,
+                   base_exc_t::GENERIC,
+                   strprintf("Number of CPU shards must be between 1 and %d "
+                             "(got %" PRIi32 ").",
+                             MAX_CPU_SHARDING_FACTOR, *cpu_shards));
+        }
+
         counted_t<const db_t> db;
         name_string_t tbl_name;
         if (args->num_args() == 1) {
@@ -139,7 +150,7 @@ private:
         uuid_u namespace_id;
         std::string error;
         if (!env->env->reql_admin_interface()->table_create(tbl_name, db,
-                primary_dc, hard_durability, primary_key,
+                primary_dc, hard_durability, primary_key, cpu_shards,
                 env->env->interruptor, &namespace_id, &error)) {
             rfail(base_exc_t::GENERIC, "%s", error.c_str());
         }
@@ -338,12 +349,17 @@ private:
                 = make_counted<union_datum_stream_t>(std::move(streams), backtrace());
             return new_val(stream, table);
         } else {
-            datum_ptr_t arr(datum_t::R_ARRAY);
+            std::vector<counted_t<const datum_t> > keys;
+            keys.reserve(args->num_args() - 1);
             for (size_t i = 1; i < args->num_args(); ++i) {
-                counted_t<const datum_t> key = args->arg(env, i)->as_datum();
-                counted_t<const datum_t> row = table->get_row(env->env, key);
-                if (row->get_type() != datum_t::R_NULL) {
-                    arr.add(row);
+                keys.push_back(args->arg(env, i)->as_datum());
+            }
+            std::vector<counted_t<const datum_t> > rows
+                = table->get_rows(env->env, keys);
+            datum_ptr_t arr(datum_t::R_ARRAY);
+            for (auto it = rows.begin(); it != rows.end(); ++it) {
+                if ((*it)->get_type() != datum_t::R_NULL) {
+                    arr.add(*it);
                 }
             }
             counted_t<datum_stream_t> stream
@@ -112,7 +112,7 @@ private:
 void check_url_params(const counted_t<const datum_t> &params,
                       pb_rcheckable_t *val) {
     if (params->get_type() == datum_t::R_OBJECT) {
-        const std::map<std::string, counted_t<const datum_t> > &params_map =
+        const datum_object_t &params_map =
             params->as_object();
         for (auto it = params_map.begin(); it != params_map.end(); ++it) {
             if (it->second->get_type() != datum_t::R_NUM &&
@@ -449,7 +449,7 @@ void http_term_t::get_header(scope_env_t *env,
     if (header.has()) {
         counted_t<const datum_t> datum_header = header->as_datum();
         if (datum_header->get_type() == datum_t::R_OBJECT) {
-            const std::map<std::string, counted_t<const datum_t> > &header_map =
+            const datum_object_t &header_map =
                 datum_header->as_object();
             for (auto it = header_map.begin(); it != header_map.end(); ++it) {
                 std::string str;
@@ -631,7 +631,7 @@ void http_term_t::get_data(
                 // encoding they need when they pass a string
                 data_out->assign(datum_data->as_str().to_std());
             } else if (datum_data->get_type() == datum_t::R_OBJECT) {
-                const std::map<std::string, counted_t<const datum_t> > &form_map =
+                const datum_object_t &form_map =
                     datum_data->as_object();
                 for (auto it = form_map.begin(); it != form_map.end(); ++it) {
                     std::string val_str = print_http_param(it->second,
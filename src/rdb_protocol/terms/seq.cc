@@ -295,6 +295,23 @@ private:
     virtual const char *name() const { return "zip"; }
 };
 
+class eq_join_term_t : public op_term_t {
+public:
+    eq_join_term_t(compile_env_t *env, const protob_t<const Term> &term)
+        : op_term_t(env, term, argspec_t(3), optargspec_t({"index"})) { }
+private:
+    virtual counted_t<val_t> eval_impl(scope_env_t *env, args_t *args, eval_flags_t) const {
+        counted_t<datum_stream_t> stream = args->arg(env, 0)->as_seq(env->env);
+        counted_t<func_t> key_func = args->arg(env, 1)->as_func(GET_FIELD_SHORTCUT);
+        counted_t<table_t> table = args->arg(env, 2)->as_table();
+        counted_t<val_t> index = args->optarg(env, "index");
+        std::string index_str = index ? index->as_str().to_std() : table->get_pkey();
+        return new_val(env->env, make_counted<eq_join_datum_stream_t>(
+                           stream, key_func, table, index_str));
+    }
+    virtual const char *name() const { return "eq_join"; }
+};
+
 counted_t<term_t> make_between_term(
     compile_env_t *env, const protob_t<const Term> &term) {
     return make_counted<between_term_t>(env, term);
@@ -351,5 +368,9 @@ counted_t<term_t> make_zip_term(
     compile_env_t *env, const protob_t<const Term> &term) {
     return make_counted<zip_term_t>(env, term);
 }
+counted_t<term_t> make_eq_join_term(
+    compile_env_t *env, const protob_t<const Term> &term) {
+    return make_counted<eq_join_term_t>(env, term);
+}
 
 } // namespace ql
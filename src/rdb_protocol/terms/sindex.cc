@@ -16,7 +16,7 @@ namespace ql {
 class sindex_create_term_t : public op_term_t {
 public:
     sindex_create_term_t(compile_env_t *env, const protob_t<const Term> &term)
-        : op_term_t(env, term, argspec_t(2, 3), optargspec_t({"multi"})) { }
+        : op_term_t(env, term, argspec_t(2, 3), optargspec_t({"multi", "slim", "covering"})) { }
 
     virtual counted_t<val_t> eval_impl(scope_env_t *env, args_t *args, eval_flags_t) const {
         counted_t<table_t> table = args->arg(env, 0)->as_table();
@@ -51,7 +51,25 @@ public:
              ? sindex_multi_bool_t::MULTI
              : sindex_multi_bool_t::SINGLE);
 
-        bool success = table->sindex_create(env->env, name, index_func, multi);
+        /* A slim index doesn't copy the rows.  Declaring covering fields makes
+           the index slim unless the query says otherwise. */
+        sindex_storage_t storage;
+        counted_t<val_t> covering_val = args->optarg(env, "covering");
+        if (covering_val) {
+            counted_t<const datum_t> covering = covering_val->as_datum();
+            for (size_t i = 0; i < covering->size(); ++i) {
+                storage.covering.push_back(covering->get(i)->as_str().to_std());
+            }
+        }
+        counted_t<val_t> slim_val = args->optarg(env, "slim");
+        storage.slim = slim_val
+            ? slim_val->as_datum()->as_bool()
+            : static_cast<bool>(covering_val);
+        rcheck(storage.slim || storage.covering.empty(), base_exc_t::GENERIC,
+               "Only slim indexes can have covering fields.");
+
+        bool success = table->sindex_create(env->env, name, index_func, multi,
+                                            storage);
         if (success) {
             datum_ptr_t res(datum_t::R_OBJECT);
             UNUSED bool b = res.add("created", make_counted<datum_t>(1.0));
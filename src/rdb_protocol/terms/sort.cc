@@ -4,11 +4,9 @@
 #include <string>
 #include <utility>
 
-#include "errors.hpp"
-#include <boost/bind.hpp>
-
 #include "rdb_protocol/datum_stream.hpp"
 #include "rdb_protocol/error.hpp"
+#include "rdb_protocol/external_sort.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/op.hpp"
@@ -176,24 +174,7 @@ private:
             }
             rcheck(!comparisons.empty(), base_exc_t::GENERIC,
                    "Must specify something to order by.");
-            std::vector<counted_t<const datum_t> > to_sort;
-            batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env->env);
-            for (;;) {
-                std::vector<counted_t<const datum_t> > data
-                    = seq->next_batch(env->env, batchspec);
-                if (data.size() == 0) {
-                    break;
-                }
-                std::move(data.begin(), data.end(), std::back_inserter(to_sort));
-                rcheck(to_sort.size() <= array_size_limit(), base_exc_t::GENERIC,
-                       strprintf("Array over size limit %zu.",
-                                 array_size_limit()).c_str());
-            }
-            profile::sampler_t sampler("Sorting in-memory.", env->env->trace);
-            auto fn = boost::bind(lt_cmp, env->env, &sampler, _1, _2);
-            std::stable_sort(to_sort.begin(), to_sort.end(), fn);
-            seq = make_counted<array_datum_stream_t>(
-                make_counted<const datum_t>(std::move(to_sort)), backtrace());
+            seq = make_counted<deferred_sort_datum_stream_t>(seq, lt_cmp, backtrace());
         }
         return tbl.has() ? new_val(seq, tbl) : new_val(env->env, seq);
     }
@@ -165,8 +165,6 @@ counted_t<term_t> make_inner_join_term(
     compile_env_t *env, const protob_t<const Term> &term);
 counted_t<term_t> make_outer_join_term(
     compile_env_t *env, const protob_t<const Term> &term);
-counted_t<term_t> make_eq_join_term(
-    compile_env_t *env, const protob_t<const Term> &term);
 counted_t<term_t> make_update_term(
     compile_env_t *env, const protob_t<const Term> &term);
 counted_t<term_t> make_delete_term(
@@ -205,6 +203,8 @@ counted_t<term_t> make_union_term(
     compile_env_t *env, const protob_t<const Term> &term);
 counted_t<term_t> make_zip_term(
     compile_env_t *env, const protob_t<const Term> &term);
+counted_t<term_t> make_eq_join_term(
+    compile_env_t *env, const protob_t<const Term> &term);
 
 // sindex.cc
 counted_t<term_t> make_sindex_create_term(
@@ -162,10 +162,11 @@ counted_t<const datum_t> table_t::batched_insert(
 MUST_USE bool table_t::sindex_create(env_t *env,
                                      const std::string &id,
                                      counted_t<func_t> index_func,
-                                     sindex_multi_bool_t multi) {
+                                     sindex_multi_bool_t multi,
+                                     const sindex_storage_t &storage) {
     index_func->assert_deterministic("Index functions must be deterministic.");
     map_wire_func_t wire_func(index_func);
-    write_t write(sindex_create_t(id, wire_func, multi), env->profile());
+    write_t write(sindex_create_t(id, wire_func, multi, storage), env->profile());
 
     write_response_t res;
     try {
@@ -304,6 +305,43 @@ counted_t<const datum_t> table_t::get_row(env_t *env, counted_t<const datum_t> p
     return p_res->data;
 }
 
+std::vector<counted_t<const datum_t> > table_t::get_rows(
+        env_t *env, const std::vector<counted_t<const datum_t> > &pvals) {
+    std::vector<counted_t<const datum_t> > rows;
+    if (pvals.empty()) {
+        return rows;
+    }
+
+    std::vector<store_key_t> keys;
+    keys.reserve(pvals.size());
+    for (auto it = pvals.begin(); it != pvals.end(); ++it) {
+        keys.push_back(store_key_t((*it)->print_primary()));
+    }
+    read_t read(point_read_batch_t(std::vector<store_key_t>(keys)), env->profile());
+    read_response_t res;
+    try {
+        if (use_outdated) {
+            access->get_namespace_if().read_outdated(env, read, &res);
+        } else {
+            access->get_namespace_if().read(env, read, &res, order_token_t::ignore);
+        }
+    } catch (const cannot_perform_query_exc_t &e) {
+        rfail(base_exc_t::GENERIC, "Cannot perform read: %s", e.what());
+    }
+    point_read_batch_response_t *p_res =
+        boost::get<point_read_batch_response_t>(&res.response);
+    r_sanity_check(p_res);
+
+    rows.reserve(keys.size());
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        auto row = p_res->data.find(*it);
+        rows.push_back(row != p_res->data.end()
+                       ? row->second
+                       : make_counted<const datum_t>(datum_t::R_NULL));
+    }
+    return rows;
+}
+
 counted_t<datum_stream_t> table_t::get_all(
         env_t *env,
         counted_t<const datum_t> value,
@@ -31,6 +31,11 @@ public:
                                               const protob_t<const Backtrace> &bt);
     const std::string &get_pkey();
     counted_t<const datum_t> get_row(env_t *env, counted_t<const datum_t> pval);
+    // Returns the rows with the primary keys `pvals`, in the same order, with
+    // `R_NULL` for the ones that don't exist.  Unlike calling `get_row` for each
+    // key, this sends at most one read to each shard.
+    std::vector<counted_t<const datum_t> > get_rows(
+            env_t *env, const std::vector<counted_t<const datum_t> > &pvals);
     counted_t<datum_stream_t> get_all(
             env_t *env,
             counted_t<const datum_t> value,
@@ -63,7 +68,8 @@ public:
 
     MUST_USE bool sindex_create(
         env_t *env, const std::string &name,
-        counted_t<func_t> index_func, sindex_multi_bool_t multi);
+        counted_t<func_t> index_func, sindex_multi_bool_t multi,
+        const sindex_storage_t &storage);
     MUST_USE bool sindex_drop(env_t *env, const std::string &name);
     counted_t<const datum_t> sindex_list(env_t *env);
     counted_t<const datum_t> sindex_status(env_t *env,
@@ -179,7 +179,9 @@ INSTANTIATE_SERIALIZE_SELF_FOR_CLUSTER_AND_DISK(var_scope_t);
 template archive_result_t
 var_scope_t::rdb_deserialize<cluster_version_t::v1_13>(read_stream_t *s);
 template archive_result_t
-var_scope_t::rdb_deserialize<cluster_version_t::v1_13_2_is_latest>(read_stream_t *s);
+var_scope_t::rdb_deserialize<cluster_version_t::v1_13_2>(read_stream_t *s);
+template archive_result_t
+var_scope_t::rdb_deserialize<cluster_version_t::v1_14_is_latest>(read_stream_t *s);
 
 
 }  // namespace ql
@@ -28,10 +28,10 @@
 #define MESSAGE_HANDLER_MAX_BATCH_SIZE           8
 
 // The cluster communication protocol version.
-static_assert(cluster_version_t::CLUSTER == cluster_version_t::v1_13_2_is_latest,
+static_assert(cluster_version_t::CLUSTER == cluster_version_t::v1_14_is_latest,
               "We need to update CLUSTER_VERSION_STRING when we add a new cluster "
               "version.");
-#define CLUSTER_VERSION_STRING "1.13.2"
+#define CLUSTER_VERSION_STRING "1.14"
 
 const std::string connectivity_cluster_t::cluster_proto_header("RethinkDB cluster\n");
 const std::string connectivity_cluster_t::cluster_version_string(CLUSTER_VERSION_STRING);
@@ -148,7 +148,9 @@ connectivity_cluster_t::run_t::run_t(connectivity_cluster_t *p,
                                      int port,
                                      message_handler_t *mh,
                                      int client_port,
-                                     heartbeat_manager_t *_heartbeat_manager)
+                                     heartbeat_manager_t *_heartbeat_manager,
+                                     int _connections_per_peer,
+                                     cluster_compression_t _compression)
         THROWS_ONLY(address_in_use_exc_t, tcp_socket_exc_t) :
     parent(p),
     message_handler(mh),
@@ -161,6 +163,12 @@ connectivity_cluster_t::run_t::run_t(connectivity_cluster_t *p,
     /* The local port to use when connecting to the cluster port of peers */
     cluster_client_port(client_port),
 
+    /* If all our outgoing connections have to come from the same local port,
+    we can only have one connection to each peer. */
+    connections_per_peer(client_port == 0 ? std::max(1, _connections_per_peer) : 1),
+
+    compression(_compression),
+
     /* This sets `parent->current_run` to `this`. It's necessary to do it in the
     constructor of a subfield rather than in the body of the `run_t` constructor
     because `parent->current_run` needs to be set before `connection_to_ourself`
@@ -183,7 +191,8 @@ connectivity_cluster_t::run_t::run_t(connectivity_cluster_t *p,
     `connection_map` on each thread and notifying any listeners that we're now
     connected to ourself. The destructor will remove us from the
     `connection_map` and again notify any listeners. */
-    connection_to_ourself(this, parent->me, NULL, routing_table[parent->me]),
+    connection_to_ourself(this, parent->me, std::vector<tcp_conn_stream_t *>(),
+                          false, routing_table[parent->me]),
 
     listener(new tcp_listener_t(cluster_listener_socket.get(),
                                 std::bind(&connectivity_cluster_t::run_t::on_new_connection,
@@ -217,15 +226,36 @@ void connectivity_cluster_t::run_t::join(const peer_address_t &address) THROWS_N
 
 connectivity_cluster_t::run_t::connection_entry_t::connection_entry_t(run_t *p,
                                                                       peer_id_t id,
-                                                                      tcp_conn_stream_t *c,
+                                                                      const std::vector<tcp_conn_stream_t *> &c,
+                                                                      bool _compressed,
                                                                       const peer_address_t &a) THROWS_NOTHING :
-    conn(c), address(a), session_id(generate_uuid()),
+    conn(c.empty() ? NULL : c[0]), conns(c), compressed(_compressed), address(a),
+    send_queues(c.size()),
+    session_id(generate_uuid()),
     pm_collection(),
     pm_bytes_sent(secs_to_ticks(1), true),
+    pm_messages_per_write(secs_to_ticks(1), true),
+    pm_compression_ratio(secs_to_ticks(1), true),
+    pm_compression_usecs(secs_to_ticks(1), true),
+    pm_decompression_usecs(secs_to_ticks(1), true),
     pm_collection_membership(&p->parent->connectivity_collection, &pm_collection, uuid_to_str(id.get_uuid())),
     pm_bytes_sent_membership(&pm_collection, &pm_bytes_sent, "bytes_sent"),
+    pm_messages_per_write_membership(&pm_collection, &pm_messages_per_write,
+                                     "messages_per_write"),
+    pm_compression_ratio_membership(&pm_collection, &pm_compression_ratio,
+                                    "compression_ratio"),
+    pm_compression_usecs_membership(&pm_collection, &pm_compression_usecs,
+                                    "compression_usecs"),
+    pm_decompression_usecs_membership(&pm_collection, &pm_decompression_usecs,
+                                      "decompression_usecs"),
     parent(p), peer(id),
     entries(new one_per_thread_t<entry_installation_t>(this)) {
+    if (compressed) {
+        for (size_t i = 0; i < send_queues.size(); ++i) {
+            send_queues[i].encoder.init(
+                new cluster_frame_encoder_t(CLUSTER_COMPRESSION_MIN_MESSAGE_SIZE));
+        }
+    }
     if (peer != parent->parent->me && parent->heartbeat_manager != NULL) {
         parent->heartbeat_manager->begin_peer_heartbeat(peer);
     }
@@ -240,8 +270,135 @@ connectivity_cluster_t::run_t::connection_entry_t::~connection_entry_t() THROWS_
     entries.reset();
 
     /* `~entry_installation_t` destroys the `auto_drainer_t`'s in entries,
-    so nothing can be holding the `send_mutex`. */
-    guarantee(!send_mutex.is_locked());
+    so nothing can be writing to any of the connections. */
+    for (size_t i = 0; i < send_queues.size(); ++i) {
+        guarantee(!send_queues[i].writer_active);
+        guarantee(send_queues[i].messages.empty());
+    }
+}
+
+size_t connectivity_cluster_t::run_t::connection_entry_t::stripe_for_traffic_class(
+        traffic_class_t traffic_class) const {
+    guarantee(!conns.empty());
+    /* A traffic class always maps to the same stripe, so its messages stay in
+    order. See the comment on `traffic_class_t` for why nothing depends on the
+    order between classes. */
+    return static_cast<size_t>(traffic_class) % conns.size();
+}
+
+bool connectivity_cluster_t::run_t::connection_entry_t::write_to_stripe(
+        size_t stripe, const char *data, size_t size) {
+    tcp_conn_stream_t *c = conns[stripe];
+    rassert(c->home_thread() == get_thread_id());
+    send_queue_t *queue = &send_queues[stripe];
+
+    send_queue_t::message_t message(data, size);
+    queue->messages.push_back(&message);
+
+    if (queue->writer_active) {
+        /* Someone else is writing to the connection right now. Either our
+        message goes out in one of their batches, or it ends up at the front of
+        the queue when they are done and we write the next batch ourself. */
+        message.wakeup.wait_lazily_unordered();
+        if (message.written) {
+            return message.ok;
+        }
+    }
+
+    /* Our message is at the front of the queue, so it goes out with the batch
+    that we write now. Anything queued after the batch is left for the next
+    sender, so that nobody keeps writing on behalf of others for an unbounded
+    time. */
+    queue->writer_active = true;
+    rassert(queue->messages.front() == &message);
+    std::vector<send_queue_t::message_t *> batch;
+    std::vector<iovec> iov;
+    size_t batch_size = 0;
+    if (queue->encoder.has()) {
+        queue->encoder->clear();
+    }
+    while (!queue->messages.empty()
+           && (batch.empty()
+               || batch_size + queue->messages.front()->size
+                  <= CLUSTER_SEND_MAX_BATCH_SIZE)) {
+        send_queue_t::message_t *m = queue->messages.front();
+        queue->messages.pop_front();
+        batch.push_back(m);
+        batch_size += m->size;
+        if (queue->encoder.has()) {
+            cluster_frame_encoder_t::result_t r =
+                queue->encoder->add_message(m->data, m->size);
+            if (r.compressed) {
+                pm_compression_ratio.record(
+                    static_cast<double>(r.payload_size) / std::max<size_t>(m->size, 1));
+                pm_compression_usecs.record(ticks_to_secs(r.compression_ticks) * 1e6);
+            }
+        } else {
+            iovec v;
+            v.iov_base = const_cast<char *>(m->data);
+            v.iov_len = m->size;
+            iov.push_back(v);
+        }
+    }
+
+    size_t write_size = batch_size;
+    if (queue->encoder.has()) {
+        queue->encoder->get_iovecs(&iov);
+        write_size = 0;
+        for (auto it = iov.begin(); it != iov.end(); ++it) {
+            write_size += it->iov_len;
+        }
+    }
+
+    int64_t res = c->writev(iov.data(), iov.size());
+    const bool ok = (res != -1);
+    if (!ok) {
+        /* Close the other half of the connection to make sure that
+           `connectivity_cluster_t::run_t::handle()` notices that something is
+           up */
+        if (c->is_read_open()) {
+            c->shutdown_read();
+        }
+    } else {
+        guarantee(res == static_cast<int64_t>(write_size));
+    }
+    pm_messages_per_write.record(batch.size());
+
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        (*it)->written = true;
+        (*it)->ok = ok;
+        if (*it != &message) {
+            (*it)->wakeup.pulse();
+        }
+    }
+    guarantee(message.written);
+
+    if (queue->messages.empty()) {
+        queue->writer_active = false;
+    } else {
+        /* Hand the connection over to the sender of the next message. */
+        queue->messages.front()->wakeup.pulse();
+    }
+    return message.ok;
+}
+
+connectivity_cluster_t::run_t::stripe_handoff_t::stripe_handoff_t(
+        peer_id_t _peer, keepalive_tcp_conn_stream_t *first_conn, size_t num_stripes) :
+    peer(_peer), conns(num_stripes, NULL), release_conds(num_stripes, NULL),
+    num_missing(num_stripes - 1) {
+    guarantee(num_stripes > 0);
+    conns[0] = first_conn;
+    if (num_missing == 0) {
+        all_arrived.pulse();
+    }
+}
+
+connectivity_cluster_t::run_t::stripe_handoff_t::~stripe_handoff_t() {
+    for (auto it = release_conds.begin(); it != release_conds.end(); ++it) {
+        if (*it != NULL) {
+            (*it)->pulse();
+        }
+    }
 }
 
 void ping_connection_watcher(peer_id_t peer, peers_list_callback_t *connect_disconnect_cb) THROWS_NOTHING {
@@ -291,7 +448,7 @@ void connectivity_cluster_t::run_t::on_new_connection(const scoped_ptr_t<tcp_con
     nconn->make_overcomplicated(&conn);
     keepalive_tcp_conn_stream_t conn_stream(conn);
 
-    handle(&conn_stream, boost::none, boost::none, lock, NULL);
+    handle(&conn_stream, boost::none, boost::none, boost::none, lock, NULL);
 }
 
 void connectivity_cluster_t::run_t::connect_to_peer(const peer_address_t *address,
@@ -326,7 +483,9 @@ void connectivity_cluster_t::run_t::connect_to_peer(const peer_address_t *addres
             keepalive_tcp_conn_stream_t conn(selected_addr->ip(), selected_addr->port().value(),
                                              drainer_lock.get_drain_signal(), cluster_client_port);
             if (!*successful_join) {
-                handle(&conn, expected_id, boost::optional<peer_address_t>(*address), drainer_lock, successful_join);
+                handle(&conn, expected_id, boost::optional<peer_address_t>(*address),
+                       boost::optional<ip_and_port_t>(*selected_addr),
+                       drainer_lock, successful_join);
             }
         } catch (const tcp_conn_t::connect_failed_exc_t &) {
             /* Ignore */
@@ -631,6 +790,8 @@ void connectivity_cluster_t::run_t::handle(
         keepalive_tcp_conn_stream_t *conn,
         boost::optional<peer_id_t> expected_id,
         boost::optional<peer_address_t> expected_address,
+        /* The address we connected to, if we initiated the connection */
+        boost::optional<ip_and_port_t> connected_address,
         auto_drainer_t::lock_t drainer_lock,
         bool *successful_join) THROWS_NOTHING
 {
@@ -648,25 +809,15 @@ void connectivity_cluster_t::run_t::handle(
     cluster_conn_closing_subscription_t conn_closer_1(conn);
     conn_closer_1.reset(drainer_lock.get_drain_signal());
 
+    // If we end up opening additional connections to the peer, they identify
+    // themselves with this token.
+    const uuid_u our_stripe_token = generate_uuid();
+
     // Each side sends a header followed by its own ID and address, then receives and checks the
     // other side's.
     {
         write_message_t wm;
-        wm.append(cluster_proto_header.c_str(), cluster_proto_header.length());
-        // TODO: Make some serialize_compatible_string function (matching the name of
-        // deserialize_compatible_string).
-        serialize_universal(&wm, static_cast<uint64_t>(cluster_version_string.length()));
-        wm.append(cluster_version_string.data(), cluster_version_string.length());
-
-        // Everything after we send the version string COULD be moved _below_ the
-        // point where we resolve the version string.  That would mean adding another
-        // back and forth to the handshake?
-        serialize_universal(&wm, static_cast<uint64_t>(cluster_arch_bitsize.length()));
-        wm.append(cluster_arch_bitsize.data(), cluster_arch_bitsize.length());
-        serialize_universal(&wm, static_cast<uint64_t>(cluster_build_mode.length()));
-        wm.append(cluster_build_mode.data(), cluster_build_mode.length());
-        serialize_universal(&wm, parent->me);
-        serialize_universal(&wm, routing_table[parent->me].hosts());
+        write_handshake_header(&wm, 0, our_stripe_token);
         if (send_write_message(conn, &wm)) {
             return; // network error.
         }
@@ -744,11 +895,19 @@ void connectivity_cluster_t::run_t::handle(
         }
     }
 
-    // Receive id, host/ports.
+    // Receive id, host/ports, and which of the peer's connections this is.
     peer_id_t other_id;
     std::set<host_and_port_t> other_peer_addr_hosts;
+    int32_t other_stripe_index;
+    uuid_u other_stripe_token;
+    int32_t other_connections_per_peer;
+    int32_t other_compression;
     if (deserialize_universal_and_check(conn, &other_id, peername) ||
-        deserialize_universal_and_check(conn, &other_peer_addr_hosts, peername)) {
+        deserialize_universal_and_check(conn, &other_peer_addr_hosts, peername) ||
+        deserialize_universal_and_check(conn, &other_stripe_index, peername) ||
+        deserialize_universal_and_check(conn, &other_stripe_token, peername) ||
+        deserialize_universal_and_check(conn, &other_connections_per_peer, peername) ||
+        deserialize_universal_and_check(conn, &other_compression, peername)) {
         return;
     }
 
@@ -764,6 +923,16 @@ void connectivity_cluster_t::run_t::handle(
         logERR("received nil peer id from %s, closing connection", peername);
         return;
     }
+    if (other_stripe_index != 0) {
+        if (connected_address) {
+            logERR("received a header for an additional connection on a connection "
+                   "that we opened to %s, closing connection", peername);
+            return;
+        }
+        handle_stripe(conn, other_id, other_stripe_index, other_stripe_token,
+                      peername, &conn_closer_1);
+        return;
+    }
     if (expected_id && other_id != *expected_id) {
         // This is only a problem if we're not using a loopback address
         if (!peer_addr.is_loopback()) {
@@ -786,6 +955,28 @@ void connectivity_cluster_t::run_t::handle(
     // Just saying that we're still on the rpc listener thread.
     parent->assert_thread();
 
+    /* How many connections we'll have to the peer. If the peer is going to open
+    additional connections to us, register ourselves so that the `handle()` calls
+    for them can find us. */
+    const size_t num_stripes = std::max(1, std::min(connections_per_peer,
+                                                    other_connections_per_peer));
+
+    /* Everything after the handshake is compressed if both of us asked for it.
+    Unknown values mean that the peer wants some compression we don't support. */
+    const bool compressed =
+        compression == cluster_compression_t::DEFLATE
+        && other_compression == static_cast<int32_t>(cluster_compression_t::DEFLATE);
+    stripe_handoff_t stripe_handoff(other_id, conn, connected_address ? 1 : num_stripes);
+    map_insertion_sentry_t<uuid_u, stripe_handoff_t *> stripe_handoff_sentry;
+    if (!connected_address && num_stripes > 1) {
+        if (stripe_handoffs.count(other_stripe_token) != 0) {
+            logERR("received a duplicate connection token from %s, closing connection",
+                   peername);
+            return;
+        }
+        stripe_handoff_sentry.reset(&stripe_handoffs, other_stripe_token, &stripe_handoff);
+    }
+
     /* The trickiest case is when there are two or more parallel connections
     that are trying to be established between the same two machines. We can get
     this when e.g. machine A and machine B try to connect to each other at the
@@ -875,6 +1066,37 @@ void connectivity_cluster_t::run_t::handle(
         *successful_join = true;
     }
 
+    /* Set up the additional connections to the peer. The side that opened the
+    first connection opens the others, to the same address; the other side
+    waits for them to arrive. */
+    scoped_array_t<scoped_ptr_t<keepalive_tcp_conn_stream_t> > opened_stripes;
+    std::vector<keepalive_tcp_conn_stream_t *> conns;
+    if (connected_address) {
+        opened_stripes.init(num_stripes - 1);
+        if (!open_stripes(*connected_address, other_id, our_stripe_token, peername,
+                          drainer_lock.get_drain_signal(), &opened_stripes)) {
+            return;
+        }
+        conns.push_back(conn);
+        for (size_t i = 0; i < opened_stripes.size(); ++i) {
+            conns.push_back(opened_stripes[i].get());
+        }
+    } else {
+        signal_timer_t timeout;
+        timeout.start(CLUSTER_STRIPE_CONNECT_TIMEOUT_MS);
+        wait_any_t waiter(&stripe_handoff.all_arrived, &timeout,
+                          drainer_lock.get_drain_signal());
+        waiter.wait_lazily_unordered();
+        if (!stripe_handoff.all_arrived.is_pulsed()) {
+            if (!drainer_lock.get_drain_signal()->is_pulsed()) {
+                logWRN("Timed out waiting for additional cluster connections from %s, "
+                       "closing connection.", peername);
+            }
+            return;
+        }
+        conns = stripe_handoff.conns;
+    }
+
     /* For each peer that our new friend told us about that we don't already
     know about, start a new connection. If the cluster is shutting down, skip
     this step. */
@@ -893,43 +1115,100 @@ void connectivity_cluster_t::run_t::handle(
     }
 
     /* Now that we're about to switch threads, it's not safe to try to close
-    the connection from this thread anymore. This is safe because we won't do
-    anything that permanently blocks before setting up `conn_closer_2`. */
+    the connections from this thread anymore. This is safe because we won't do
+    anything that permanently blocks before setting up `conn_closers`. */
     conn_closer_1.reset();
 
     // We could pick a better way to pick a better thread, our choice
-    // now is hopefully a performance non-problem.
-    threadnum_t chosen_thread = threadnum_t(rng.randint(get_num_threads()));
-
-    cross_thread_signal_t connection_thread_drain_signal(drainer_lock.get_drain_signal(), chosen_thread);
-
-    rethread_tcp_conn_stream_t unregister_conn(conn, INVALID_THREAD);
-    on_thread_t conn_threader(chosen_thread);
-    rethread_tcp_conn_stream_t reregister_conn(conn, get_thread_id());
+    // now is hopefully a performance non-problem. Each additional connection
+    // goes on the next thread over.
+    const int first_thread = rng.randint(get_num_threads());
+    std::vector<threadnum_t> threads;
+    for (size_t i = 0; i < conns.size(); ++i) {
+        threads.push_back(threadnum_t((first_thread + i) % get_num_threads()));
+    }
 
-    // Make sure that if we're ordered to shut down, any pending read
-    // or write gets interrupted.
-    cluster_conn_closing_subscription_t conn_closer_2(conn);
-    conn_closer_2.reset(&connection_thread_drain_signal);
+    scoped_array_t<scoped_ptr_t<cross_thread_signal_t> > drain_signals(conns.size());
+    scoped_array_t<scoped_ptr_t<rethread_tcp_conn_stream_t> > unregister_conns(conns.size());
+    scoped_array_t<scoped_ptr_t<rethread_tcp_conn_stream_t> > reregister_conns(conns.size());
+    scoped_array_t<scoped_ptr_t<cluster_conn_closing_subscription_t> > conn_closers(conns.size());
+    for (size_t i = 0; i < conns.size(); ++i) {
+        drain_signals[i].init(new cross_thread_signal_t(drainer_lock.get_drain_signal(),
+                                                        threads[i]));
+        unregister_conns[i].init(new rethread_tcp_conn_stream_t(conns[i], INVALID_THREAD));
+    }
+    for (size_t i = 0; i < conns.size(); ++i) {
+        on_thread_t conn_threader(threads[i]);
+        reregister_conns[i].init(new rethread_tcp_conn_stream_t(conns[i], get_thread_id()));
+
+        // Make sure that if we're ordered to shut down, any pending read
+        // or write gets interrupted.
+        conn_closers[i].init(new cluster_conn_closing_subscription_t(conns[i]));
+        conn_closers[i]->reset(drain_signals[i].get());
+    }
 
     {
+        on_thread_t conn_threader(threads[0]);
+
         /* `connection_entry_t` is the public interface of this coroutine. Its
         constructor registers it in the `connectivity_cluster_t`'s connection
         map and notifies any connect listeners. */
-        connection_entry_t conn_structure(this, other_id, conn, other_peer_addr);
+        connection_entry_t conn_structure(this, other_id,
+                                          std::vector<tcp_conn_stream_t *>(conns.begin(),
+                                                                           conns.end()),
+                                          compressed, other_peer_addr);
         object_buffer_t<heartbeat_keepalive_t> keepalive;
 
         if (heartbeat_manager != NULL) {
             keepalive.create(conn, heartbeat_manager, other_id);
         }
 
+        /* Read messages off all of the connections until one of them is closed;
+        that takes the others down with it. */
+        pmap(conns.size(), std::bind(&connectivity_cluster_t::run_t::handle_stripe_messages,
+                                     this, ph::_1, &conn_structure, &conns, &threads,
+                                     other_id, resolved_version));
+
+        /* The `conn_structure` destructor removes us from the connection map
+        and notifies any disconnect listeners. */
+    }
+
+    // Undo the rethreading on each connection's thread, in reverse order of setup
+    for (size_t i = 0; i < conns.size(); ++i) {
+        on_thread_t conn_threader(threads[i]);
+        conn_closers[i].reset();
+        reregister_conns[i].reset();
+    }
+}
+
+void connectivity_cluster_t::run_t::handle_stripe_messages(
+        int stripe,
+        connection_entry_t *conn_structure,
+        const std::vector<keepalive_tcp_conn_stream_t *> *conns,
+        const std::vector<threadnum_t> *threads,
+        peer_id_t other_id,
+        cluster_version_t cluster_version) THROWS_NOTHING {
+    keepalive_tcp_conn_stream_t *conn = (*conns)[stripe];
+    {
+        on_thread_t conn_threader((*threads)[stripe]);
+
+        /* On a compressed connection, messages have to be read through a decoder */
+        scoped_ptr_t<cluster_frame_decoder_stream_t> decoder;
+        read_stream_t *stream = conn;
+        if (conn_structure->compressed) {
+            decoder.init(new cluster_frame_decoder_stream_t(
+                conn, &conn_structure->pm_decompression_usecs));
+            stream = decoder.get();
+        }
+
         /* Main message-handling loop: read messages off the connection until
         it's closed, which may be due to network events, or the other end
-        shutting down, or us shutting down. */
+        shutting down, or us shutting down, or one of the other connections to
+        the same peer going down. */
         try {
             int messages_handled_since_yield = 0;
             while (true) {
-                message_handler->on_message(other_id, resolved_version, conn); // might raise fake_archive_exc_t
+                message_handler->on_message(other_id, cluster_version, stream); // might raise fake_archive_exc_t
 
                 ++messages_handled_since_yield;
                 if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
@@ -944,13 +1223,161 @@ void connectivity_cluster_t::run_t::handle(
             called. */
         }
 
-        if(conn->is_read_open()) {
+        if (conn->is_read_open()) {
             logWRN("Received invalid data on a cluster connection. Disconnecting.");
         }
+    }
 
-        /* The `conn_structure` destructor removes us from the connection map
-        and notifies any disconnect listeners. */
+    /* The connections to a peer live and die together. Messages of different
+    traffic classes can depend on each other, so we must not keep using some of
+    them after losing the others. */
+    for (size_t i = 0; i < conns->size(); ++i) {
+        if (i != static_cast<size_t>(stripe)) {
+            on_thread_t conn_threader((*threads)[i]);
+            if ((*conns)[i]->is_read_open()) {
+                (*conns)[i]->shutdown_read();
+            }
+            if ((*conns)[i]->is_write_open()) {
+                (*conns)[i]->shutdown_write();
+            }
+        }
+    }
+}
+
+void connectivity_cluster_t::run_t::write_handshake_header(write_message_t *wm,
+                                                           int32_t stripe_index,
+                                                           const uuid_u &stripe_token) {
+    parent->assert_thread();
+    wm->append(cluster_proto_header.c_str(), cluster_proto_header.length());
+    // TODO: Make some serialize_compatible_string function (matching the name of
+    // deserialize_compatible_string).
+    serialize_universal(wm, static_cast<uint64_t>(cluster_version_string.length()));
+    wm->append(cluster_version_string.data(), cluster_version_string.length());
+
+    // Everything after we send the version string COULD be moved _below_ the
+    // point where we resolve the version string.  That would mean adding another
+    // back and forth to the handshake?
+    serialize_universal(wm, static_cast<uint64_t>(cluster_arch_bitsize.length()));
+    wm->append(cluster_arch_bitsize.data(), cluster_arch_bitsize.length());
+    serialize_universal(wm, static_cast<uint64_t>(cluster_build_mode.length()));
+    wm->append(cluster_build_mode.data(), cluster_build_mode.length());
+    serialize_universal(wm, parent->me);
+    serialize_universal(wm, routing_table[parent->me].hosts());
+    serialize_universal(wm, stripe_index);
+    serialize_universal(wm, stripe_token);
+    serialize_universal(wm, static_cast<int32_t>(connections_per_peer));
+    serialize_universal(wm, static_cast<int32_t>(compression));
+}
+
+bool connectivity_cluster_t::run_t::open_stripes(
+        const ip_and_port_t &address,
+        peer_id_t other_id,
+        const uuid_u &stripe_token,
+        const char *peername,
+        signal_t *interruptor,
+        scoped_array_t<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *stripes_out)
+        THROWS_NOTHING {
+    parent->assert_thread();
+    for (size_t i = 0; i < stripes_out->size(); ++i) {
+        try {
+            (*stripes_out)[i].init(new keepalive_tcp_conn_stream_t(
+                address.ip(), address.port().value(), interruptor, cluster_client_port));
+        } catch (const tcp_conn_t::connect_failed_exc_t &) {
+            logWRN("Could not open an additional cluster connection to %s, closing "
+                   "connection.", peername);
+            return false;
+        } catch (const interrupted_exc_t &) {
+            return false;
+        }
+        keepalive_tcp_conn_stream_t *stripe = (*stripes_out)[i].get();
+
+        cluster_conn_closing_subscription_t stripe_closer(stripe);
+        stripe_closer.reset(interruptor);
+
+        {
+            write_message_t wm;
+            write_handshake_header(&wm, i + 1, stripe_token);
+            if (send_write_message(stripe, &wm)) {
+                return false; // network error.
+            }
+        }
+
+        /* The peer answers with the same header it sent on the first connection.
+        We have already checked everything in it, except that it's really the
+        same peer answering. */
+        scoped_array_t<char> header(cluster_proto_header.length());
+        if (force_read(stripe, header.data(), header.size())
+                != static_cast<int64_t>(header.size())) {
+            return false; // network error.
+        }
+        if (memcmp(cluster_proto_header.data(), header.data(), header.size()) != 0) {
+            logWRN("Received invalid clustering header from %s, closing connection.",
+                   peername);
+            return false;
+        }
+        std::string remote_version_string, remote_arch_bitsize, remote_build_mode;
+        peer_id_t remote_id;
+        std::set<host_and_port_t> remote_hosts;
+        int32_t remote_stripe_index;
+        uuid_u remote_stripe_token;
+        int32_t remote_connections_per_peer;
+        int32_t remote_compression;
+        if (!deserialize_compatible_string(stripe, &remote_version_string, peername) ||
+            !deserialize_compatible_string(stripe, &remote_arch_bitsize, peername) ||
+            !deserialize_compatible_string(stripe, &remote_build_mode, peername) ||
+            deserialize_universal_and_check(stripe, &remote_id, peername) ||
+            deserialize_universal_and_check(stripe, &remote_hosts, peername) ||
+            deserialize_universal_and_check(stripe, &remote_stripe_index, peername) ||
+            deserialize_universal_and_check(stripe, &remote_stripe_token, peername) ||
+            deserialize_universal_and_check(stripe, &remote_connections_per_peer,
+                                            peername) ||
+            deserialize_universal_and_check(stripe, &remote_compression, peername)) {
+            return false;
+        }
+        if (remote_id != other_id) {
+            logERR("received inconsistent routing information (wrong ID) from %s on an "
+                   "additional connection, closing connection", peername);
+            return false;
+        }
     }
+    return true;
+}
+
+void connectivity_cluster_t::run_t::handle_stripe(
+        keepalive_tcp_conn_stream_t *conn,
+        peer_id_t other_id,
+        int32_t stripe_index,
+        const uuid_u &stripe_token,
+        const char *peername,
+        signal_t::subscription_t *conn_closer) THROWS_NOTHING {
+    parent->assert_thread();
+
+    auto it = stripe_handoffs.find(stripe_token);
+    if (it == stripe_handoffs.end()
+        || it->second->peer != other_id
+        || stripe_index < 0
+        || static_cast<size_t>(stripe_index) >= it->second->conns.size()
+        || it->second->conns[stripe_index] != NULL) {
+        logWRN("Received an unexpected additional cluster connection from %s, closing "
+               "connection.", peername);
+        return;
+    }
+    stripe_handoff_t *handoff = it->second;
+
+    /* From here on, the `handle()` call for the peer's first connection is
+    responsible for closing `conn` when we shut down. */
+    conn_closer->reset();
+
+    cond_t released;
+    handoff->conns[stripe_index] = conn;
+    handoff->release_conds[stripe_index] = &released;
+    --handoff->num_missing;
+    if (handoff->num_missing == 0) {
+        handoff->all_arrived.pulse();
+    }
+
+    // `conn` is owned by our caller, so we must not return until it's unused.
+    released.wait_lazily_unordered();
 }
 
 connectivity_cluster_t::connectivity_cluster_t() THROWS_NOTHING :
@@ -979,6 +1406,10 @@ std::set<peer_id_t> connectivity_cluster_t::get_peers_list() THROWS_NOTHING {
     return peers;
 }
 
+bool connectivity_cluster_t::get_peer_connected(peer_id_t peer) THROWS_NOTHING {
+    return thread_info.get()->connection_map.count(peer) == 1;
+}
+
 uuid_u connectivity_cluster_t::get_connection_session_id(peer_id_t peer) THROWS_NOTHING {
     std::map<peer_id_t, std::pair<run_t::connection_entry_t *, auto_drainer_t::lock_t> > *connection_map =
         &thread_info.get()->connection_map;
@@ -1070,26 +1501,16 @@ void connectivity_cluster_t::send_message(peer_id_t dest, send_message_write_cal
                                                        std::move(buffer_data));
     } else {
         guarantee(dest != me);
-        on_thread_t threader(conn_structure->conn->home_thread());
 
-        /* Acquire the send-mutex so we don't collide with other things trying
-        to send on the same connection. */
-        mutex_t::acq_t acq(&conn_structure->send_mutex);
+        /* Pick the connection for the message's traffic class */
+        const size_t stripe =
+            conn_structure->stripe_for_traffic_class(callback->get_traffic_class());
+        on_thread_t threader(conn_structure->conns[stripe]->home_thread());
 
-        {
-            int64_t res = conn_structure->conn->write(buffer.vector().data(),
-                                                      buffer.vector().size());
-            if (res == -1) {
-                /* Close the other half of the connection to make sure that
-                   `connectivity_cluster_t::run_t::handle()` notices that something is
-                   up */
-                if (conn_structure->conn->is_read_open()) {
-                    conn_structure->conn->shutdown_read();
-                }
-            } else {
-                guarantee(res == static_cast<int64_t>(buffer.vector().size()));
-            }
-        }
+        /* Queue the message up behind any others for the same connection, so we
+        don't collide with other things trying to send on it. */
+        conn_structure->write_to_stripe(stripe, buffer.vector().data(),
+                                        buffer.vector().size());
     }
 
     conn_structure->pm_bytes_sent.record(bytes_sent);
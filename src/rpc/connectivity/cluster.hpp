@@ -2,6 +2,7 @@
 #ifndef RPC_CONNECTIVITY_CLUSTER_HPP_
 #define RPC_CONNECTIVITY_CLUSTER_HPP_
 
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
@@ -10,11 +11,14 @@
 
 #include "arch/types.hpp"
 #include "concurrency/auto_drainer.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/one_per_thread.hpp"
+#include "config/args.hpp"
 #include "containers/archive/tcp_conn_stream.hpp"
 #include "containers/map_sentries.hpp"
 #include "containers/uuid.hpp"
 #include "perfmon/perfmon.hpp"
+#include "rpc/connectivity/compression.hpp"
 #include "rpc/connectivity/connectivity.hpp"
 #include "rpc/connectivity/messages.hpp"
 #include "utils.hpp"
@@ -74,7 +78,9 @@ public:
               int port,
               message_handler_t *message_handler,
               int client_port,
-              heartbeat_manager_t *_heartbeat_manager)
+              heartbeat_manager_t *_heartbeat_manager,
+              int connections_per_peer = CLUSTER_CONNECTIONS_PER_PEER,
+              cluster_compression_t compression = cluster_compression_t::NONE)
             THROWS_ONLY(address_in_use_exc_t, tcp_socket_exc_t);
 
         ~run_t();
@@ -94,26 +100,84 @@ public:
         public:
             /* The constructor registers us in every thread's `connection_map`;
             the destructor deregisters us. Both also notify all subscribers. */
-            connection_entry_t(run_t *, peer_id_t, tcp_conn_stream_t *,
+            connection_entry_t(run_t *, peer_id_t,
+                               const std::vector<tcp_conn_stream_t *> &,
+                               bool compressed,
                                const peer_address_t &peer) THROWS_NOTHING;
             ~connection_entry_t() THROWS_NOTHING;
 
-            /* NULL for our "connection" to ourself */
+            /* Returns the index in `conns` of the connection that messages of
+            the given traffic class are sent over. */
+            size_t stripe_for_traffic_class(traffic_class_t traffic_class) const;
+
+            /* Writes a message to `conns[stripe]`; must be called on that
+            connection's thread. Blocks until the message has been written. If
+            other messages are queued up for the connection at that point, the
+            caller writes them too, in a single batch. Returns false if there
+            was a network error. */
+            bool write_to_stripe(size_t stripe, const char *data, size_t size);
+
+            /* NULL for our "connection" to ourself. Otherwise this is the
+            connection that the handshake took place on; it's the same as
+            `conns[0]`. */
             tcp_conn_stream_t *conn;
 
+            /* All the connections to the peer ("stripes"), each homed on its own
+            thread. Empty for our connection to ourself. */
+            std::vector<tcp_conn_stream_t *> conns;
+
+            /* Whether the traffic on `conns` is framed and compressed (see
+            "rpc/connectivity/compression.hpp"). */
+            const bool compressed;
+
             /* `connection_t` contains the addresses so that we can call
             `get_peers_list()` on any thread. Otherwise, we would have to go
             cross-thread to access the routing table. */
             peer_address_t address;
 
-            /* Unused for our connection to ourself */
-            mutex_t send_mutex;
+            /* Messages waiting to be written to one of `conns`. While a batch is
+            being written, further messages accumulate in `messages`. */
+            class send_queue_t {
+            public:
+                struct message_t {
+                    message_t(const char *_data, size_t _size) :
+                        data(_data), size(_size), written(false), ok(false) { }
+                    const char *data;
+                    size_t size;
+                    bool written;
+                    bool ok;
+                    /* Pulsed when the message has been written by someone else,
+                    or when it's at the front of the queue and its sender has to
+                    take over writing. */
+                    cond_t wakeup;
+                };
+
+                send_queue_t() : writer_active(false) { }
+
+                std::deque<message_t *> messages;
+                bool writer_active;
+
+                /* `NULL` unless the connection is compressed */
+                scoped_ptr_t<cluster_frame_encoder_t> encoder;
+            private:
+                DISABLE_COPYING(send_queue_t);
+            };
+
+            /* `send_queues[i]` holds the messages for `conns[i]`. */
+            scoped_array_t<send_queue_t> send_queues;
 
             uuid_u session_id;
 
             perfmon_collection_t pm_collection;
             perfmon_sampler_t pm_bytes_sent;
-            perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership;
+            perfmon_sampler_t pm_messages_per_write;
+            /* Only updated if the connections are compressed. The ratio is that of
+            compressed to uncompressed size for each message that we compressed. */
+            perfmon_sampler_t pm_compression_ratio;
+            perfmon_sampler_t pm_compression_usecs, pm_decompression_usecs;
+            perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership,
+                pm_messages_per_write_membership, pm_compression_ratio_membership,
+                pm_compression_usecs_membership, pm_decompression_usecs_membership;
 
         private:
             /* We only hold this information so we can deregister ourself */
@@ -135,6 +199,28 @@ public:
             scoped_ptr_t<one_per_thread_t<entry_installation_t> > entries;
         };
 
+        /* When we accept a connection from a peer that wants more than one
+        connection, the peer opens the additional connections after the handshake
+        on the first one has succeeded. The `handle()` call for the first
+        connection puts a `stripe_handoff_t` into `stripe_handoffs`, and the
+        `handle()` calls for the additional connections hand their connections
+        over to it and then wait until it releases them again. */
+        class stripe_handoff_t {
+        public:
+            stripe_handoff_t(peer_id_t peer, keepalive_tcp_conn_stream_t *first_conn,
+                             size_t num_stripes);
+            /* Releases all the connections that were handed over to us */
+            ~stripe_handoff_t();
+
+            const peer_id_t peer;
+            std::vector<keepalive_tcp_conn_stream_t *> conns;
+            std::vector<cond_t *> release_conds;
+            size_t num_missing;
+            cond_t all_arrived;
+        private:
+            DISABLE_COPYING(stripe_handoff_t);
+        };
+
         /* Sets a variable to a value in its constructor; sets it to NULL in its
         destructor. This is kind of silly. The reason we need it is that we need
         the variable to be set before the constructors for some other fields of
@@ -192,9 +278,48 @@ public:
         void handle(keepalive_tcp_conn_stream_t *c,
             boost::optional<peer_id_t> expected_id,
             boost::optional<peer_address_t> expected_address,
+            boost::optional<ip_and_port_t> connected_address,
             auto_drainer_t::lock_t,
             bool *successful_join) THROWS_NOTHING;
 
+        /* Writes the handshake header that each side sends at the start of every
+        connection. A `stripe_index` of zero means that this is the first
+        connection to the peer; the peer should then open any additional
+        connections with `stripe_token`. */
+        void write_handshake_header(write_message_t *wm,
+                                    int32_t stripe_index,
+                                    const uuid_u &stripe_token);
+
+        /* Opens the additional connections to a peer that we connected to at
+        `address`. Returns false if any of them failed. */
+        bool open_stripes(const ip_and_port_t &address,
+                          peer_id_t other_id,
+                          const uuid_u &stripe_token,
+                          const char *peername,
+                          signal_t *interruptor,
+                          scoped_array_t<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *stripes_out)
+            THROWS_NOTHING;
+
+        /* Called by `handle()` for an additional connection that a peer opened
+        to us. Hands the connection over to the `handle()` call for the peer's
+        first connection and blocks until it's done with it. */
+        void handle_stripe(keepalive_tcp_conn_stream_t *conn,
+                           peer_id_t other_id,
+                           int32_t stripe_index,
+                           const uuid_u &stripe_token,
+                           const char *peername,
+                           signal_t::subscription_t *conn_closer) THROWS_NOTHING;
+
+        /* Reads messages from one of the connections to a peer until it's
+        closed; then closes all of the other connections to the peer too. Run
+        for each stripe in parallel by `handle()`. */
+        void handle_stripe_messages(int stripe,
+                                    connection_entry_t *conn_structure,
+                                    const std::vector<keepalive_tcp_conn_stream_t *> *conns,
+                                    const std::vector<threadnum_t> *threads,
+                                    peer_id_t other_id,
+                                    cluster_version_t cluster_version) THROWS_NOTHING;
+
         connectivity_cluster_t *parent;
 
         message_handler_t *message_handler;
@@ -224,6 +349,18 @@ public:
         int cluster_listener_port;
         int cluster_client_port;
 
+        /* How many connections we want to each peer. We use the smaller of our
+        and the peer's preference. */
+        int connections_per_peer;
+
+        /* The compression we offer to peers. A connection is compressed if both
+        ends offer it. */
+        cluster_compression_t compression;
+
+        /* Keyed by the stripe token of the peer's first connection. Only
+        accessed on the home thread. */
+        std::map<uuid_u, stripe_handoff_t *> stripe_handoffs;
+
         variable_setter_t register_us_with_parent;
 
         map_insertion_sentry_t<peer_id_t, peer_address_t> routing_table_entry_for_ourself;
@@ -246,6 +383,7 @@ public:
     /* `connectivity_service_t` public methods: */
     peer_id_t get_me() THROWS_NOTHING;
     std::set<peer_id_t> get_peers_list() THROWS_NOTHING;
+    bool get_peer_connected(peer_id_t peer) THROWS_NOTHING;
     uuid_u get_connection_session_id(peer_id_t) THROWS_NOTHING;
 
     /* `message_service_t` public methods: */
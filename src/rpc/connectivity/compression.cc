@@ -0,0 +1,240 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include "rpc/connectivity/compression.hpp"
+
+#include <string.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+
+#include "perfmon/perfmon.hpp"
+
+// We feed zlib at most this many bytes at a time, because its buffer sizes are
+// `uInt`s.
+static const size_t ZLIB_MAX_CHUNK_SIZE = 1 << 30;
+
+// The smallest output buffer we hand to zlib.
+static const size_t ZLIB_MIN_OUTPUT_SIZE = 4096;
+
+cluster_frame_encoder_t::cluster_frame_encoder_t(size_t _min_compressed_size) :
+    min_compressed_size(_min_compressed_size) {
+    zstream.init(new z_stream);
+    memset(zstream.get(), 0, sizeof(z_stream));
+    zstream->zalloc = Z_NULL;
+    zstream->zfree = Z_NULL;
+    zstream->opaque = Z_NULL;
+    // Cluster traffic is latency-sensitive, so we favor speed over ratio.
+    int zres = deflateInit(zstream.get(), Z_BEST_SPEED);
+    guarantee(zres == Z_OK, "deflateInit failed (%d)", zres);
+}
+
+cluster_frame_encoder_t::~cluster_frame_encoder_t() {
+    deflateEnd(zstream.get());
+}
+
+cluster_frame_encoder_t::result_t cluster_frame_encoder_t::add_message(
+        const char *data, size_t size) {
+    result_t result;
+    result.compression_ticks = 0;
+
+    if (size < min_compressed_size) {
+        size_t offset = 0;
+        do {
+            size_t chunk = std::min<size_t>(size - offset,
+                                            CLUSTER_FRAME_MAX_PAYLOAD_SIZE);
+            add_header(false, chunk);
+            piece_t piece;
+            piece.external = data + offset;
+            piece.offset = 0;
+            piece.size = chunk;
+            pieces.push_back(piece);
+            offset += chunk;
+        } while (offset < size);
+        result.compressed = false;
+        result.payload_size = size;
+        return result;
+    }
+
+    const ticks_t start_ticks = get_ticks();
+
+    /* Compress the message into the end of `buffer`... */
+    const size_t start_offset = buffer.size();
+    size_t in_offset = 0;
+    do {
+        const size_t in_chunk = std::min(size - in_offset, ZLIB_MAX_CHUNK_SIZE);
+        const bool last = (in_offset + in_chunk == size);
+        const size_t out_step = std::max(in_chunk / 2, ZLIB_MIN_OUTPUT_SIZE);
+        zstream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data + in_offset));
+        zstream->avail_in = in_chunk;
+        do {
+            const size_t used = buffer.size();
+            buffer.resize(used + out_step);
+            zstream->next_out = reinterpret_cast<Bytef *>(buffer.data() + used);
+            zstream->avail_out = out_step;
+            int zres = deflate(zstream.get(), last ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+            guarantee(zres == Z_OK || zres == Z_BUF_ERROR, "deflate failed (%d)", zres);
+            buffer.resize(used + out_step - zstream->avail_out);
+        } while (zstream->avail_out == 0);
+        rassert(zstream->avail_in == 0);
+        in_offset += in_chunk;
+    } while (in_offset < size);
+    const size_t end_offset = buffer.size();
+
+    /* ... and then put it into frames. The headers go after the compressed data in
+    `buffer`, but the pieces are in the right order. */
+    size_t offset = start_offset;
+    do {
+        size_t chunk = std::min<size_t>(end_offset - offset,
+                                        CLUSTER_FRAME_MAX_PAYLOAD_SIZE);
+        add_header(true, chunk);
+        add_buffer_piece(offset, chunk);
+        offset += chunk;
+    } while (offset < end_offset);
+
+    result.compressed = true;
+    result.payload_size = end_offset - start_offset;
+    result.compression_ticks = get_ticks() - start_ticks;
+    return result;
+}
+
+void cluster_frame_encoder_t::get_iovecs(std::vector<iovec> *iov_out) const {
+    for (auto it = pieces.begin(); it != pieces.end(); ++it) {
+        iovec v;
+        v.iov_base = const_cast<char *>(it->external != NULL
+                                        ? it->external
+                                        : buffer.data() + it->offset);
+        v.iov_len = it->size;
+        iov_out->push_back(v);
+    }
+}
+
+void cluster_frame_encoder_t::clear() {
+    buffer.clear();
+    pieces.clear();
+}
+
+void cluster_frame_encoder_t::add_header(bool compressed, size_t payload_size) {
+    rassert(payload_size <= CLUSTER_FRAME_MAX_PAYLOAD_SIZE);
+    const uint32_t header = static_cast<uint32_t>(payload_size)
+        | (compressed ? CLUSTER_FRAME_COMPRESSED_BIT : 0);
+    const size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(header));
+    for (size_t i = 0; i < sizeof(header); ++i) {
+        buffer[offset + i] = static_cast<char>((header >> (8 * i)) & 0xff);
+    }
+    add_buffer_piece(offset, sizeof(header));
+}
+
+void cluster_frame_encoder_t::add_buffer_piece(size_t offset, size_t size) {
+    piece_t piece;
+    piece.external = NULL;
+    piece.offset = offset;
+    piece.size = size;
+    pieces.push_back(piece);
+}
+
+cluster_frame_decoder_stream_t::cluster_frame_decoder_stream_t(
+        read_stream_t *_inner, perfmon_sampler_t *_decompression_usecs) :
+    inner(_inner),
+    decompression_usecs(_decompression_usecs),
+    raw_remaining(0),
+    decompressed_offset(0) {
+    zstream.init(new z_stream);
+    memset(zstream.get(), 0, sizeof(z_stream));
+    zstream->zalloc = Z_NULL;
+    zstream->zfree = Z_NULL;
+    zstream->opaque = Z_NULL;
+    zstream->next_in = Z_NULL;
+    zstream->avail_in = 0;
+    int zres = inflateInit(zstream.get());
+    guarantee(zres == Z_OK, "inflateInit failed (%d)", zres);
+}
+
+cluster_frame_decoder_stream_t::~cluster_frame_decoder_stream_t() {
+    inflateEnd(zstream.get());
+}
+
+int64_t cluster_frame_decoder_stream_t::read(void *p, int64_t n) {
+    rassert(n >= 0);
+    while (true) {
+        if (decompressed_offset < decompressed.size()) {
+            const size_t chunk = std::min<size_t>(n,
+                decompressed.size() - decompressed_offset);
+            memcpy(p, decompressed.data() + decompressed_offset, chunk);
+            decompressed_offset += chunk;
+            return chunk;
+        }
+        if (raw_remaining > 0) {
+            int64_t res = inner->read(p, std::min<int64_t>(n, raw_remaining));
+            if (res <= 0) {
+                // The connection ended in the middle of a frame.
+                return -1;
+            }
+            raw_remaining -= res;
+            return res;
+        }
+        int64_t res = next_frame();
+        if (res <= 0) {
+            return res;
+        }
+    }
+}
+
+int64_t cluster_frame_decoder_stream_t::next_frame() {
+    unsigned char header_bytes[sizeof(uint32_t)];
+    int64_t res = force_read(inner, header_bytes, sizeof(header_bytes));
+    if (res == 0) {
+        return 0;
+    } else if (res != static_cast<int64_t>(sizeof(header_bytes))) {
+        return -1;
+    }
+    uint32_t header = 0;
+    for (size_t i = 0; i < sizeof(header_bytes); ++i) {
+        header |= static_cast<uint32_t>(header_bytes[i]) << (8 * i);
+    }
+    const uint32_t payload_size = header & CLUSTER_FRAME_MAX_PAYLOAD_SIZE;
+
+    if ((header & CLUSTER_FRAME_COMPRESSED_BIT) == 0) {
+        raw_remaining = payload_size;
+        return 1;
+    }
+
+    compressed.resize(payload_size);
+    if (force_read(inner, compressed.data(), payload_size)
+            != static_cast<int64_t>(payload_size)) {
+        return -1;
+    }
+
+    const ticks_t start_ticks = get_ticks();
+    decompressed.clear();
+    decompressed_offset = 0;
+    const size_t out_step = std::max<size_t>(
+        std::min<size_t>(static_cast<size_t>(payload_size) * 4, ZLIB_MAX_CHUNK_SIZE),
+        ZLIB_MIN_OUTPUT_SIZE);
+    zstream->next_in = reinterpret_cast<Bytef *>(compressed.data());
+    zstream->avail_in = payload_size;
+    do {
+        const size_t used = decompressed.size();
+        decompressed.resize(used + out_step);
+        zstream->next_out = reinterpret_cast<Bytef *>(decompressed.data() + used);
+        zstream->avail_out = out_step;
+        int zres = inflate(zstream.get(), Z_SYNC_FLUSH);
+        decompressed.resize(used + out_step - zstream->avail_out);
+        if (zres == Z_BUF_ERROR && zstream->avail_out != 0) {
+            // zlib couldn't make any progress. That's fine once it has consumed all
+            // of the input, but otherwise the input must be garbage.
+            if (zstream->avail_in != 0) {
+                return -1;
+            }
+            break;
+        } else if (zres != Z_OK && zres != Z_BUF_ERROR) {
+            // Corrupt data, or the peer ended the deflate stream.
+            return -1;
+        }
+    } while (zstream->avail_in > 0 || zstream->avail_out == 0);
+
+    if (decompression_usecs != NULL) {
+        decompression_usecs->record(ticks_to_secs(get_ticks() - start_ticks) * 1e6);
+    }
+    return 1;
+}
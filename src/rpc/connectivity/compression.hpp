@@ -0,0 +1,122 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#ifndef RPC_CONNECTIVITY_COMPRESSION_HPP_
+#define RPC_CONNECTIVITY_COMPRESSION_HPP_
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+#include "containers/archive/archive.hpp"
+#include "containers/scoped.hpp"
+#include "perfmon/types.hpp"
+#include "time.hpp"
+
+// From zlib.h, which we keep out of this header.
+struct z_stream_s;
+
+/* Cluster connections can compress the traffic that follows the handshake, if both
+ends offer it in their handshake headers. Everything is then sent as a sequence of
+frames. A frame starts with a four-byte little-endian header; its high bit is set
+if the payload is compressed, and the remaining bits are the payload's length.
+
+The compressed payloads on a connection are consecutive pieces of a single deflate
+stream, which is flushed at the end of every message. So the receiver can always
+decode a message as soon as it has arrived, and messages later on the connection
+benefit from the dictionary built up by earlier ones. Messages that are too small
+to be worth compressing go out in uncompressed frames, and don't touch the deflate
+stream at all. */
+
+enum class cluster_compression_t {
+    NONE = 0,
+    DEFLATE = 1
+};
+
+static const uint32_t CLUSTER_FRAME_COMPRESSED_BIT = 0x80000000u;
+static const uint32_t CLUSTER_FRAME_MAX_PAYLOAD_SIZE = 0x7fffffffu;
+
+/* Splits outgoing messages up into frames, compressing the ones that are at least
+`min_compressed_size` bytes long. Not thread-safe; each connection needs its own. */
+class cluster_frame_encoder_t {
+public:
+    explicit cluster_frame_encoder_t(size_t min_compressed_size);
+    ~cluster_frame_encoder_t();
+
+    /* What `add_message()` did with a message. */
+    struct result_t {
+        bool compressed;
+        size_t payload_size;
+        ticks_t compression_ticks;
+    };
+
+    /* Appends the frames for a message to the current batch. Uncompressed payloads
+    are not copied, so `data` must remain valid until the batch has been written. */
+    result_t add_message(const char *data, size_t size);
+
+    /* Appends to `iov_out` the buffers that make up the current batch. They remain
+    valid until the next call to `clear()` or `add_message()`. */
+    void get_iovecs(std::vector<iovec> *iov_out) const;
+
+    /* Starts a new batch. */
+    void clear();
+
+private:
+    /* A piece of the batch is either a range of `buffer` (for frame headers and
+    compressed data) or a range of an uncompressed message. We store offsets into
+    `buffer` rather than pointers, because `buffer` moves when it grows. */
+    struct piece_t {
+        const char *external;
+        size_t offset;
+        size_t size;
+    };
+
+    void add_header(bool compressed, size_t payload_size);
+    void add_buffer_piece(size_t offset, size_t size);
+
+    const size_t min_compressed_size;
+    scoped_ptr_t<z_stream_s> zstream;
+
+    std::vector<char> buffer;
+    std::vector<piece_t> pieces;
+
+    DISABLE_COPYING(cluster_frame_encoder_t);
+};
+
+/* Reads the frames produced by a `cluster_frame_encoder_t` off `inner` and presents
+the original byte stream. Returns -1 from `read()` if it encounters data that it
+can't decode. If `decompression_usecs` is not `NULL`, records the time spent
+decompressing each compressed frame in it. */
+class cluster_frame_decoder_stream_t : public read_stream_t {
+public:
+    cluster_frame_decoder_stream_t(read_stream_t *inner,
+                                   perfmon_sampler_t *decompression_usecs);
+    ~cluster_frame_decoder_stream_t();
+
+    MUST_USE int64_t read(void *p, int64_t n);
+
+private:
+    /* Reads the next frame's header and, if it's compressed, decompresses its
+    payload into `decompressed`. Returns -1 on error, 0 on end of file and 1
+    otherwise. */
+    int64_t next_frame();
+
+    read_stream_t *const inner;
+    perfmon_sampler_t *const decompression_usecs;
+    scoped_ptr_t<z_stream_s> zstream;
+
+    /* Bytes of the current uncompressed frame's payload that haven't been read
+    yet. */
+    uint32_t raw_remaining;
+
+    /* Scratch space for the current compressed frame's payload. */
+    std::vector<char> compressed;
+
+    /* `decompressed` from `decompressed_offset` on holds the decompressed bytes
+    that haven't been read yet. */
+    std::vector<char> decompressed;
+    size_t decompressed_offset;
+
+    DISABLE_COPYING(cluster_frame_decoder_stream_t);
+};
+
+#endif  // RPC_CONNECTIVITY_COMPRESSION_HPP_
@@ -45,10 +45,44 @@ no further messages are delivered. This gives a natural way to make sure that no
 messages are still being delivered at the time that the `application_t`
 destructor is called. */
 
+/* Every message has a traffic class. When there are several connections to a
+peer, each traffic class is sent over its own connection (as far as the number of
+connections allows), so that a burst of bulk backfill data doesn't delay small,
+latency-sensitive query messages, and neither of them delays heartbeats or
+directory updates. Messages within one traffic class stay in order; messages in
+different traffic classes may be reordered relative to each other.
+
+Nothing may rely on the relative order of two classes:
+ - Heartbeats, directory, semilattice and auth messages are all `CONTROL`, so
+   they stay in order with respect to each other. Semilattice syncs are
+   requested and answered over the semilattice channel itself.
+ - Mailbox messages only depend on other mailbox messages; the directory and
+   semilattice metadata only announce mailbox addresses, and a mailbox exists
+   before its address is published. A message to a mailbox that is gone is
+   dropped, however it got there.
+ - A backfill's end point, chunks and completion all go out as `BACKFILL`, the
+   chunks are ordered by a FIFO enforcer, and the backfillee waits on promises
+   for the `QUERY`-class allocation registration and end point, so it doesn't
+   care about their order. Listeners order streamed writes against the backfill
+   by timestamp, not by arrival. */
+enum class traffic_class_t {
+    // Heartbeats, directory, semilattice and auth metadata
+    CONTROL = 0,
+    // Ordinary mailbox messages
+    QUERY,
+    // Bulk data transfers, i.e. backfills
+    BACKFILL
+};
+
+const int NUM_TRAFFIC_CLASSES = 3;
+
 class send_message_write_callback_t {
 public:
     virtual ~send_message_write_callback_t() { }
     virtual void write(cluster_version_t cluster_version, write_stream_t *stream) = 0;
+    virtual traffic_class_t get_traffic_class() const {
+        return traffic_class_t::QUERY;
+    }
 };
 
 class message_service_t  {
@@ -57,9 +57,11 @@ message_multiplexer_t::client_t::run_t::~run_t() {
 
 message_multiplexer_t::client_t::client_t(message_multiplexer_t *p,
                                           tag_t t,
-                                          int max_outstanding) :
+                                          int max_outstanding,
+                                          traffic_class_t tc) :
     parent(p),
     tag(t),
+    traffic_class(tc),
     run(NULL),
     outstanding_writes_semaphores(max_outstanding)
 {
@@ -80,8 +82,10 @@ connectivity_service_t *message_multiplexer_t::client_t::get_connectivity_servic
 
 class tagged_message_writer_t : public send_message_write_callback_t {
 public:
-    tagged_message_writer_t(message_multiplexer_t::tag_t _tag, send_message_write_callback_t *_subwriter) :
-        tag(_tag), subwriter(_subwriter) { }
+    tagged_message_writer_t(message_multiplexer_t::tag_t _tag,
+                            traffic_class_t _traffic_class,
+                            send_message_write_callback_t *_subwriter) :
+        tag(_tag), traffic_class(_traffic_class), subwriter(_subwriter) { }
     virtual ~tagged_message_writer_t() { }
 
     void write(cluster_version_t cluster_version, write_stream_t *os) {
@@ -98,13 +102,20 @@ public:
         subwriter->write(cluster_version, os);
     }
 
+    traffic_class_t get_traffic_class() const {
+        return traffic_class == traffic_class_t::QUERY
+            ? subwriter->get_traffic_class()
+            : traffic_class;
+    }
+
 private:
     message_multiplexer_t::tag_t tag;
+    traffic_class_t traffic_class;
     send_message_write_callback_t *subwriter;
 };
 
 void message_multiplexer_t::client_t::send_message(peer_id_t dest, send_message_write_callback_t *callback) {
-    tagged_message_writer_t writer(tag, callback);
+    tagged_message_writer_t writer(tag, traffic_class, callback);
     {
         semaphore_acq_t outstanding_write_acq (outstanding_writes_semaphores.get());
         parent->message_service->send_message(dest, &writer);
@@ -55,8 +55,13 @@ public:
             client_t *const parent;
             message_handler_t *const message_handler;
         };
+        /* Messages sent through a client with a `traffic_class` of `QUERY` keep
+        whatever traffic class their writer asks for (so a mailbox message can
+        be marked as `BACKFILL`). For any other `traffic_class`, all of the
+        client's messages are sent with that class. */
         client_t(message_multiplexer_t *, tag_t tag,
-                 int max_outstanding = DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD);
+                 int max_outstanding = DEFAULT_MAX_OUTSTANDING_WRITES_PER_THREAD,
+                 traffic_class_t traffic_class = traffic_class_t::QUERY);
         ~client_t();
         connectivity_service_t *get_connectivity_service();
         void send_message(peer_id_t, send_message_write_callback_t *callback);
@@ -65,6 +70,7 @@ public:
         friend class message_multiplexer_t;
         message_multiplexer_t *const parent;
         const tag_t tag;
+        const traffic_class_t traffic_class;
         run_t *run;
         one_per_thread_t<static_semaphore_t> outstanding_writes_semaphores;
     };
@@ -16,15 +16,24 @@
 const int raw_mailbox_t::address_t::ANY_THREAD = -1;
 
 raw_mailbox_t::address_t::address_t() :
-    peer(peer_id_t()), thread(ANY_THREAD), mailbox_id(0) { }
+    peer(peer_id_t()), thread(ANY_THREAD), mailbox_id(0),
+    traffic_class(traffic_class_t::QUERY) { }
 
 raw_mailbox_t::address_t::address_t(const address_t &a) :
-    peer(a.peer), thread(a.thread), mailbox_id(a.mailbox_id) { }
+    peer(a.peer), thread(a.thread), mailbox_id(a.mailbox_id),
+    traffic_class(a.traffic_class) { }
 
 bool raw_mailbox_t::address_t::is_nil() const {
     return peer.is_nil();
 }
 
+raw_mailbox_t::address_t raw_mailbox_t::address_t::with_traffic_class(
+        traffic_class_t tc) const {
+    address_t a(*this);
+    a.traffic_class = tc;
+    return a;
+}
+
 peer_id_t raw_mailbox_t::address_t::get_peer() const {
     guarantee(!is_nil(), "A nil address has no peer");
     return peer;
@@ -56,8 +65,10 @@ raw_mailbox_t::address_t raw_mailbox_t::get_address() const {
 
 class raw_mailbox_writer_t : public send_message_write_callback_t {
 public:
-    raw_mailbox_writer_t(int32_t _dest_thread, raw_mailbox_t::id_t _dest_mailbox_id, mailbox_write_callback_t *_subwriter) :
-        dest_thread(_dest_thread), dest_mailbox_id(_dest_mailbox_id), subwriter(_subwriter) { }
+    raw_mailbox_writer_t(int32_t _dest_thread, raw_mailbox_t::id_t _dest_mailbox_id,
+                         traffic_class_t _traffic_class, mailbox_write_callback_t *_subwriter) :
+        dest_thread(_dest_thread), dest_mailbox_id(_dest_mailbox_id),
+        traffic_class(_traffic_class), subwriter(_subwriter) { }
     virtual ~raw_mailbox_writer_t() { }
 
     void write(cluster_version_t cluster_version, write_stream_t *stream) {
@@ -84,21 +95,55 @@ public:
         res = send_write_message(stream, &wm);
         if (res) { throw fake_archive_exc_t(); }
     }
+    traffic_class_t get_traffic_class() const {
+        return traffic_class;
+    }
 private:
     int32_t dest_thread;
     raw_mailbox_t::id_t dest_mailbox_id;
+    traffic_class_t traffic_class;
     mailbox_write_callback_t *subwriter;
 };
 
 void send(mailbox_manager_t *src, raw_mailbox_t::address_t dest, mailbox_write_callback_t *callback) {
     guarantee(src);
     guarantee(!dest.is_nil());
-    raw_mailbox_writer_t writer(dest.thread, dest.mailbox_id, callback);
+    raw_mailbox_writer_t writer(dest.thread, dest.mailbox_id, dest.traffic_class, callback);
     src->message_service->send_message(dest.peer, &writer);
 }
 
-mailbox_manager_t::mailbox_manager_t(message_service_t *ms) :
-    message_service(ms)
+bool is_local_mailbox(mailbox_manager_t *src, const raw_mailbox_t::address_t &dest) {
+    guarantee(src);
+    return dest.get_peer() == src->get_connectivity_service()->get_me();
+}
+
+void send_local(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
+                scoped_ptr_t<mailbox_local_message_t> &&message) {
+    guarantee(is_local_mailbox(src, dest));
+    guarantee(message.has());
+    // `connectivity_cluster_t::send_message()` drops messages to peers that it has
+    // no connection entry for, and we only have one for ourself while a `run_t`
+    // exists.
+    if (!src->get_connectivity_service()->get_peer_connected(dest.peer)) {
+        return;
+    }
+    int32_t dest_thread = dest.thread;
+    if (dest_thread == raw_mailbox_t::address_t::ANY_THREAD) {
+        dest_thread = get_thread_id().threadnum;
+    }
+
+    // `local_delivery_coroutine()` takes ownership of the message.
+    coro_t::spawn_now_dangerously(std::bind(&mailbox_manager_t::local_delivery_coroutine,
+                                            src, threadnum_t(dest_thread),
+                                            dest.mailbox_id, message.release()));
+}
+
+mailbox_manager_t::mailbox_manager_t(message_service_t *ms,
+                                     perfmon_collection_t *parent_perfmon_collection) :
+    message_service(ms),
+    pm_message_latency(secs_to_ticks(1)),
+    pm_message_latency_membership(parent_perfmon_collection,
+                                  &pm_message_latency, "mailbox_message_latency")
     { }
 
 mailbox_manager_t::mailbox_table_t::mailbox_table_t() {
@@ -217,6 +262,7 @@ void mailbox_manager_t::mailbox_read_coroutine(peer_id_t source_peer,
                                                std::vector<char> *stream_data,
                                                int64_t stream_data_offset,
                                                force_yield_t force_yield) {
+    const ticks_t start_ticks = get_ticks();
 
     // Construct a new stream to use
     vector_read_stream_t stream(std::move(*stream_data), stream_data_offset);
@@ -236,6 +282,7 @@ void mailbox_manager_t::mailbox_read_coroutine(peer_id_t source_peer,
             raw_mailbox_t *mbox = mailbox_tables.get()->find_mailbox(dest_mailbox_id);
             if (mbox != NULL) {
                 mbox->callback->read(cluster_version, &stream);
+                pm_message_latency.record(get_ticks() - start_ticks);
             }
         } catch (const fake_archive_exc_t &e) {
             // Set a flag and handle the exception later.
@@ -250,6 +297,30 @@ void mailbox_manager_t::mailbox_read_coroutine(peer_id_t source_peer,
     }
 }
 
+void mailbox_manager_t::local_delivery_coroutine(threadnum_t dest_thread,
+                                                 raw_mailbox_t::id_t dest_mailbox_id,
+                                                 mailbox_local_message_t *message) {
+    scoped_ptr_t<mailbox_local_message_t> local_message(message);
+    const ticks_t start_ticks = get_ticks();
+
+    on_thread_t rethreader(dest_thread);
+    if (rethreader.home_thread() == get_thread_id()) {
+        // Yield to avoid problems with reentrancy, just like `on_local_message()`
+        // does.
+        coro_t::yield();
+    }
+
+    raw_mailbox_t *mbox = mailbox_tables.get()->find_mailbox(dest_mailbox_id);
+    if (mbox != NULL) {
+        local_message->deliver(mbox->callback);
+        pm_message_latency.record(get_ticks() - start_ticks);
+    }
+
+    // Destroy the message's arguments on the destination thread, where they
+    // were used.
+    local_message.reset();
+}
+
 raw_mailbox_t::id_t mailbox_manager_t::generate_mailbox_id() {
     raw_mailbox_t::id_t id = ++mailbox_tables.get()->next_mailbox_id;
     return id;
@@ -3,11 +3,19 @@
 #define RPC_MAILBOX_MAILBOX_HPP_
 
 #include <map>
+#include <set>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "errors.hpp"
+#include <boost/optional.hpp>
+
 #include "containers/archive/archive.hpp"
 #include "containers/archive/vector_stream.hpp"
+#include "containers/scoped.hpp"
+#include "perfmon/perfmon.hpp"
 #include "rpc/connectivity/cluster.hpp"
 #include "rpc/semilattice/joins/macros.hpp"
 
@@ -34,6 +42,18 @@ public:
                       read_stream_t *stream) = 0;
 };
 
+/* A message for a mailbox on the local peer. Rather than being serialized, it holds
+on to the message's arguments and hands them directly to the mailbox. */
+class mailbox_local_message_t {
+public:
+    virtual ~mailbox_local_message_t() { }
+
+    // Called on the mailbox's thread. `callback` is the mailbox's read callback,
+    // which is guaranteed to belong to a mailbox of the type that the message was
+    // sent to.
+    virtual void deliver(mailbox_read_callback_t *callback) = 0;
+};
+
 struct raw_mailbox_t : public home_thread_mixin_t {
 public:
     struct address_t;
@@ -43,6 +63,8 @@ private:
     friend class mailbox_manager_t;
     friend class raw_mailbox_writer_t;
     friend void send(mailbox_manager_t *, address_t, mailbox_write_callback_t *);
+    friend void send_local(mailbox_manager_t *, address_t,
+                           scoped_ptr_t<mailbox_local_message_t> &&);
 
     mailbox_manager_t *manager;
 
@@ -72,6 +94,12 @@ public:
         /* Tests if the address is nil */
         bool is_nil() const;
 
+        /* Returns a copy of the address whose messages will be sent with the
+        given traffic class. The traffic class is a property of the sender's
+        copy of the address only; it isn't serialized and doesn't take part
+        in comparisons. */
+        address_t with_traffic_class(traffic_class_t traffic_class) const;
+
         /* Returns the peer on which the mailbox lives. If the address is nil,
         fails. */
         peer_id_t get_peer() const;
@@ -85,6 +113,8 @@ public:
 
     private:
         friend void send(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+        friend void send_local(mailbox_manager_t *, raw_mailbox_t::address_t,
+                               scoped_ptr_t<mailbox_local_message_t> &&);
         friend struct raw_mailbox_t;
         friend class mailbox_manager_t;
 
@@ -97,6 +127,9 @@ public:
 
         /* The ID of the mailbox */
         id_t mailbox_id;
+
+        /* The traffic class for messages sent to this address */
+        traffic_class_t traffic_class;
     };
 
     raw_mailbox_t(mailbox_manager_t *, mailbox_read_callback_t *callback);
@@ -107,6 +140,40 @@ public:
 
 RDB_SERIALIZE_OUTSIDE(raw_mailbox_t::address_t);
 
+/* `mailbox_local_safe_t<T>::value` says whether a message argument of type `T`
+can be handed to a mailbox on this peer as it is, instead of being serialized.
+The mailbox may be on another thread, so copies of `T` must not share any state
+that isn't thread-safe.  Types are opted in one by one; a message that has an
+argument of any other type always gets serialized. */
+template <class T>
+struct mailbox_local_safe_t
+    : public std::integral_constant<bool,
+                                    std::is_arithmetic<T>::value
+                                    || std::is_enum<T>::value> { };
+
+template <> struct mailbox_local_safe_t<std::string> : public std::true_type { };
+template <> struct mailbox_local_safe_t<uuid_u> : public std::true_type { };
+template <> struct mailbox_local_safe_t<peer_id_t> : public std::true_type { };
+template <>
+struct mailbox_local_safe_t<raw_mailbox_t::address_t> : public std::true_type { };
+
+template <class T>
+struct mailbox_local_safe_t<std::vector<T> > : public mailbox_local_safe_t<T> { };
+template <class T>
+struct mailbox_local_safe_t<std::set<T> > : public mailbox_local_safe_t<T> { };
+template <class T>
+struct mailbox_local_safe_t<boost::optional<T> > : public mailbox_local_safe_t<T> { };
+template <class K, class V>
+struct mailbox_local_safe_t<std::map<K, V> >
+    : public std::integral_constant<bool,
+                                    mailbox_local_safe_t<K>::value
+                                    && mailbox_local_safe_t<V>::value> { };
+template <class A, class B>
+struct mailbox_local_safe_t<std::pair<A, B> >
+    : public std::integral_constant<bool,
+                                    mailbox_local_safe_t<A>::value
+                                    && mailbox_local_safe_t<B>::value> { };
+
 /* `send()` sends a message to a mailbox. `send()` can block and must be called
 in a coroutine. If the mailbox does not exist or the peer is inaccessible, `send()`
 will silently fail. */
@@ -115,6 +182,22 @@ void send(mailbox_manager_t *src,
           raw_mailbox_t::address_t dest,
           mailbox_write_callback_t *callback);
 
+/* Returns true if `dest` is a mailbox on the same peer as `src`, so that a message
+to it can be sent with `send_local()` instead of `send()`. */
+bool is_local_mailbox(mailbox_manager_t *src,
+                      const raw_mailbox_t::address_t &dest);
+
+/* `send_local()` is the same-process counterpart of `send()`. It skips
+serialization, and moves `message` to the thread of the destination mailbox.
+Like `send()`, it drops the message if the connectivity layer doesn't consider us
+connected to ourself.  Messages are delivered with the same ordering and yielding
+behavior as local messages that go through `send()`. Because no copy is made
+through serialization, the typed `send()` only uses it for messages whose
+arguments are all `mailbox_local_safe_t`. */
+void send_local(mailbox_manager_t *src,
+                raw_mailbox_t::address_t dest,
+                scoped_ptr_t<mailbox_local_message_t> &&message);
+
 /* `mailbox_manager_t` uses a `message_service_t` to provide mailbox capability.
 Usually you will split a `message_service_t` into several sub-services using
 `message_multiplexer_t` and put a `mailbox_manager_t` on only one of them,
@@ -123,7 +206,8 @@ mailbox addresses back and forth between nodes. */
 
 class mailbox_manager_t : public message_handler_t {
 public:
-    explicit mailbox_manager_t(message_service_t *);
+    mailbox_manager_t(message_service_t *,
+                      perfmon_collection_t *parent_perfmon_collection);
 
     /* Returns the connectivity service of the underlying message service. */
     connectivity_service_t *get_connectivity_service() {
@@ -133,9 +217,17 @@ public:
 private:
     friend struct raw_mailbox_t;
     friend void send(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+    friend void send_local(mailbox_manager_t *, raw_mailbox_t::address_t,
+                           scoped_ptr_t<mailbox_local_message_t> &&);
 
     message_service_t *message_service;
 
+    // How long it takes from the moment a message arrives (or is sent, if it's
+    // local) to the moment its mailbox's callback returns.  Mailbox RPCs run their
+    // handlers right in the callback.
+    perfmon_latency_histogram_t pm_message_latency;
+    perfmon_membership_t pm_message_latency_membership;
+
     struct mailbox_table_t {
         mailbox_table_t();
         ~mailbox_table_t();
@@ -169,6 +261,9 @@ private:
                                 std::vector<char> *stream_data,
                                 int64_t stream_data_offset,
                                 force_yield_t force_yield);
+    void local_delivery_coroutine(threadnum_t dest_thread,
+                                  raw_mailbox_t::id_t dest_mailbox_id,
+                                  mailbox_local_message_t *message);
 };
 
 #endif /* RPC_MAILBOX_MAILBOX_HPP_ */
@@ -22,6 +22,11 @@ public:
     }
     bool is_nil() const { return addr.is_nil(); }
     peer_id_t get_peer() const { return addr.get_peer(); }
+    mailbox_addr_t<T> with_traffic_class(traffic_class_t traffic_class) const {
+        mailbox_addr_t<T> a;
+        a.addr = addr.with_traffic_class(traffic_class);
+        return a;
+    }
 
     friend class mailbox_t<T>;
 
@@ -78,6 +83,9 @@ private:
 
 RDB_SERIALIZE_TEMPLATED_OUTSIDE(mailbox_addr_t);
 
+template <class T>
+struct mailbox_local_safe_t<mailbox_addr_t<T> > : public std::true_type { };
+
 template<>
 class mailbox_t< void() > {
     class write_impl_t : public mailbox_write_callback_t {
@@ -88,6 +96,8 @@ class mailbox_t< void() > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void() > *_parent) : parent(_parent) { }
@@ -96,9 +106,19 @@ class mailbox_t< void() > {
             parent->fun();
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void() > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t() { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun();
+        }
+    };
+
     read_impl_t reader;
 
 public:
@@ -125,6 +145,11 @@ private:
 inline
 void send(mailbox_manager_t *src,
            mailbox_t< void() >::address_t dest) {
+    if (is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new mailbox_t< void() >::local_message_impl_t()));
+        return;
+    }
     mailbox_t< void() >::write_impl_t writer;
     send(src, dest.addr, &writer);
 }
@@ -145,6 +170,8 @@ class mailbox_t< void(arg0_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t) > *_parent) : parent(_parent) { }
@@ -156,9 +183,23 @@ class mailbox_t< void(arg0_t) > {
             parent->fun(std::move(arg0));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        explicit local_message_impl_t(const arg0_t &_arg0) :
+            arg0(_arg0)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0));
+        }
+    private:
+        arg0_t arg0;
+    };
+
     read_impl_t reader;
 
 public:
@@ -187,6 +228,12 @@ private:
 template<class arg0_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t) >::address_t dest, const arg0_t &arg0) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t) >::local_message_impl_t(arg0)));
+        return;
+    }
     typename mailbox_t< void(arg0_t) >::write_impl_t writer(arg0);
     send(src, dest.addr, &writer);
 }
@@ -209,6 +256,8 @@ class mailbox_t< void(arg0_t, arg1_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t) > *_parent) : parent(_parent) { }
@@ -223,9 +272,24 @@ class mailbox_t< void(arg0_t, arg1_t) > {
             parent->fun(std::move(arg0), std::move(arg1));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1) :
+            arg0(_arg0), arg1(_arg1)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+    };
+
     read_impl_t reader;
 
 public:
@@ -254,6 +318,13 @@ private:
 template<class arg0_t, class arg1_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t) >::local_message_impl_t(arg0, arg1)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t) >::write_impl_t writer(arg0, arg1);
     send(src, dest.addr, &writer);
 }
@@ -278,6 +349,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t) > *_parent) : parent(_parent) { }
@@ -295,9 +368,25 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t) > {
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+    };
+
     read_impl_t reader;
 
 public:
@@ -326,6 +415,14 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t) >::local_message_impl_t(arg0, arg1, arg2)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t) >::write_impl_t writer(arg0, arg1, arg2);
     send(src, dest.addr, &writer);
 }
@@ -352,6 +449,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) > *_parent) : parent(_parent) { }
@@ -372,9 +471,26 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) > {
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+    };
+
     read_impl_t reader;
 
 public:
@@ -403,6 +519,15 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) >::local_message_impl_t(arg0, arg1, arg2, arg3)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t) >::write_impl_t writer(arg0, arg1, arg2, arg3);
     send(src, dest.addr, &writer);
 }
@@ -431,6 +556,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) > *_parent) : parent(_parent) { }
@@ -454,9 +581,27 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) > {
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+    };
+
     read_impl_t reader;
 
 public:
@@ -485,6 +630,16 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4);
     send(src, dest.addr, &writer);
 }
@@ -515,6 +670,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) > {
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) > *_parent) : parent(_parent) { }
@@ -541,9 +698,28 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) > {
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+    };
+
     read_impl_t reader;
 
 public:
@@ -572,6 +748,17 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5);
     send(src, dest.addr, &writer);
 }
@@ -604,6 +791,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) >
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) > *_parent) : parent(_parent) { }
@@ -633,9 +822,29 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) >
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+    };
+
     read_impl_t reader;
 
 public:
@@ -664,6 +873,18 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6);
     send(src, dest.addr, &writer);
 }
@@ -698,6 +919,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t) > *_parent) : parent(_parent) { }
@@ -730,9 +953,30 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+    };
+
     read_impl_t reader;
 
 public:
@@ -761,6 +1005,19 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7);
     send(src, dest.addr, &writer);
 }
@@ -797,6 +1054,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t) > *_parent) : parent(_parent) { }
@@ -832,9 +1091,31 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+    };
+
     read_impl_t reader;
 
 public:
@@ -863,6 +1144,20 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8);
     send(src, dest.addr, &writer);
 }
@@ -901,6 +1196,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t) > *_parent) : parent(_parent) { }
@@ -939,9 +1236,32 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8, const arg9_t &_arg9) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8), arg9(_arg9)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+        arg9_t arg9;
+    };
+
     read_impl_t reader;
 
 public:
@@ -970,6 +1290,21 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t, class arg9_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8, const arg9_t &arg9) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        mailbox_local_safe_t<arg9_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
     send(src, dest.addr, &writer);
 }
@@ -1010,6 +1345,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t) > *_parent) : parent(_parent) { }
@@ -1051,9 +1388,33 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8, const arg9_t &_arg9, const arg10_t &_arg10) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8), arg9(_arg9), arg10(_arg10)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+        arg9_t arg9;
+        arg10_t arg10;
+    };
+
     read_impl_t reader;
 
 public:
@@ -1082,6 +1443,22 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t, class arg9_t, class arg10_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8, const arg9_t &arg9, const arg10_t &arg10) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        mailbox_local_safe_t<arg9_t>::value &&
+        mailbox_local_safe_t<arg10_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10);
     send(src, dest.addr, &writer);
 }
@@ -1124,6 +1501,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t) > *_parent) : parent(_parent) { }
@@ -1168,9 +1547,34 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8, const arg9_t &_arg9, const arg10_t &_arg10, const arg11_t &_arg11) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8), arg9(_arg9), arg10(_arg10), arg11(_arg11)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+        arg9_t arg9;
+        arg10_t arg10;
+        arg11_t arg11;
+    };
+
     read_impl_t reader;
 
 public:
@@ -1199,6 +1603,23 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t, class arg9_t, class arg10_t, class arg11_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8, const arg9_t &arg9, const arg10_t &arg10, const arg11_t &arg11) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        mailbox_local_safe_t<arg9_t>::value &&
+        mailbox_local_safe_t<arg10_t>::value &&
+        mailbox_local_safe_t<arg11_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11);
     send(src, dest.addr, &writer);
 }
@@ -1243,6 +1664,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t) > *_parent) : parent(_parent) { }
@@ -1290,9 +1713,35 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11), std::move(arg12));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8, const arg9_t &_arg9, const arg10_t &_arg10, const arg11_t &_arg11, const arg12_t &_arg12) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8), arg9(_arg9), arg10(_arg10), arg11(_arg11), arg12(_arg12)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11), std::move(arg12));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+        arg9_t arg9;
+        arg10_t arg10;
+        arg11_t arg11;
+        arg12_t arg12;
+    };
+
     read_impl_t reader;
 
 public:
@@ -1321,6 +1770,24 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t, class arg9_t, class arg10_t, class arg11_t, class arg12_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8, const arg9_t &arg9, const arg10_t &arg10, const arg11_t &arg11, const arg12_t &arg12) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        mailbox_local_safe_t<arg9_t>::value &&
+        mailbox_local_safe_t<arg10_t>::value &&
+        mailbox_local_safe_t<arg11_t>::value &&
+        mailbox_local_safe_t<arg12_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11, arg12)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11, arg12);
     send(src, dest.addr, &writer);
 }
@@ -1367,6 +1834,8 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
         }
     };
 
+    class local_message_impl_t;
+
     class read_impl_t : public mailbox_read_callback_t {
     public:
         explicit read_impl_t(mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t, arg13_t) > *_parent) : parent(_parent) { }
@@ -1417,9 +1886,36 @@ class mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, ar
             parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11), std::move(arg12), std::move(arg13));
         }
     private:
+        friend class local_message_impl_t;
         mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t, arg13_t) > *parent;
     };
 
+    class local_message_impl_t : public mailbox_local_message_t {
+    public:
+        local_message_impl_t(const arg0_t &_arg0, const arg1_t &_arg1, const arg2_t &_arg2, const arg3_t &_arg3, const arg4_t &_arg4, const arg5_t &_arg5, const arg6_t &_arg6, const arg7_t &_arg7, const arg8_t &_arg8, const arg9_t &_arg9, const arg10_t &_arg10, const arg11_t &_arg11, const arg12_t &_arg12, const arg13_t &_arg13) :
+            arg0(_arg0), arg1(_arg1), arg2(_arg2), arg3(_arg3), arg4(_arg4), arg5(_arg5), arg6(_arg6), arg7(_arg7), arg8(_arg8), arg9(_arg9), arg10(_arg10), arg11(_arg11), arg12(_arg12), arg13(_arg13)
+        { }
+        void deliver(mailbox_read_callback_t *callback) {
+            read_impl_t *reader = static_cast<read_impl_t *>(callback);
+            reader->parent->fun(std::move(arg0), std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7), std::move(arg8), std::move(arg9), std::move(arg10), std::move(arg11), std::move(arg12), std::move(arg13));
+        }
+    private:
+        arg0_t arg0;
+        arg1_t arg1;
+        arg2_t arg2;
+        arg3_t arg3;
+        arg4_t arg4;
+        arg5_t arg5;
+        arg6_t arg6;
+        arg7_t arg7;
+        arg8_t arg8;
+        arg9_t arg9;
+        arg10_t arg10;
+        arg11_t arg11;
+        arg12_t arg12;
+        arg13_t arg13;
+    };
+
     read_impl_t reader;
 
 public:
@@ -1448,6 +1944,25 @@ private:
 template<class arg0_t, class arg1_t, class arg2_t, class arg3_t, class arg4_t, class arg5_t, class arg6_t, class arg7_t, class arg8_t, class arg9_t, class arg10_t, class arg11_t, class arg12_t, class arg13_t>
 void send(mailbox_manager_t *src,
           typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t, arg13_t) >::address_t dest, const arg0_t &arg0, const arg1_t &arg1, const arg2_t &arg2, const arg3_t &arg3, const arg4_t &arg4, const arg5_t &arg5, const arg6_t &arg6, const arg7_t &arg7, const arg8_t &arg8, const arg9_t &arg9, const arg10_t &arg10, const arg11_t &arg11, const arg12_t &arg12, const arg13_t &arg13) {
+    if (mailbox_local_safe_t<arg0_t>::value &&
+        mailbox_local_safe_t<arg1_t>::value &&
+        mailbox_local_safe_t<arg2_t>::value &&
+        mailbox_local_safe_t<arg3_t>::value &&
+        mailbox_local_safe_t<arg4_t>::value &&
+        mailbox_local_safe_t<arg5_t>::value &&
+        mailbox_local_safe_t<arg6_t>::value &&
+        mailbox_local_safe_t<arg7_t>::value &&
+        mailbox_local_safe_t<arg8_t>::value &&
+        mailbox_local_safe_t<arg9_t>::value &&
+        mailbox_local_safe_t<arg10_t>::value &&
+        mailbox_local_safe_t<arg11_t>::value &&
+        mailbox_local_safe_t<arg12_t>::value &&
+        mailbox_local_safe_t<arg13_t>::value &&
+        is_local_mailbox(src, dest.addr)) {
+        send_local(src, dest.addr, scoped_ptr_t<mailbox_local_message_t>(
+            new typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t, arg13_t) >::local_message_impl_t(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11, arg12, arg13)));
+        return;
+    }
     typename mailbox_t< void(arg0_t, arg1_t, arg2_t, arg3_t, arg4_t, arg5_t, arg6_t, arg7_t, arg8_t, arg9_t, arg10_t, arg11_t, arg12_t, arg13_t) >::write_impl_t writer(arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11, arg12, arg13);
     send(src, dest.addr, &writer);
 }
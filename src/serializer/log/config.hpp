@@ -9,12 +9,29 @@
 #include "serializer/types.hpp"
 #include "rpc/serialize_macros.hpp"
 
+/* How the data block GC picks the next extent to collect. */
+enum class gc_policy_t {
+    // The extent with the most garbage, which is the cheapest one to collect.
+    greedy,
+    // The extent with the best ratio of benefit, the free space it yields weighted
+    // by the age of its data, to cost, the live data that has to be read and
+    // rewritten.  This is the cost-benefit policy of the LFS cleaner.  It prefers
+    // collecting extents of cold data a little earlier, so that their remaining live
+    // blocks don't get copied as often.
+    cost_benefit
+};
+
+const char *gc_policy_name(gc_policy_t policy);
+MUST_USE bool parse_gc_policy_name(const std::string &name, gc_policy_t *policy_out);
+
 /* Configuration for the serializer that can change from run to run */
 
 struct log_serializer_dynamic_config_t {
     log_serializer_dynamic_config_t() {
         read_ahead = true;
         io_batch_factor = DEFAULT_IO_BATCH_FACTOR;
+        index_snapshot = false;
+        gc_policy = gc_policy_t::greedy;
     }
 
     /* The (minimal) batch size of i/o requests being taken from a single i/o account.
@@ -24,6 +41,13 @@ struct log_serializer_dynamic_config_t {
 
     /* Enable reading more data than requested to let the cache warmup more quickly esp. on rotational drives */
     bool read_ahead;
+
+    /* Write a snapshot of the index to a file next to the database file when shutting
+    down cleanly, so that the next start doesn't have to read the whole LBA.  See
+    serializer/log/lba/index_snapshot.hpp. */
+    bool index_snapshot;
+
+    gc_policy_t gc_policy;
 };
 
 /* This is equivalent to log_serializer_static_config_t below, but is an on-disk
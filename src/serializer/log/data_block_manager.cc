@@ -2,14 +2,18 @@
 #include "serializer/log/data_block_manager.hpp"
 
 #include <inttypes.h>
+#include <limits.h>
 #include <sys/uio.h>
 
+#include <algorithm>
 #include <functional>
 
 #include "arch/arch.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/mutex.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "concurrency/pmap.hpp"
 #include "errors.hpp"
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
@@ -19,6 +23,9 @@
 // Max amount of bytes which can be read ahead in one i/o transaction (if enabled)
 const int64_t APPROXIMATE_READ_AHEAD_SIZE = 32 * DEFAULT_BTREE_BLOCK_SIZE;
 
+// Max amount of bytes which can be read in one coalesced readv of adjacent blocks
+const int64_t MAX_COALESCED_READ_SIZE = APPROXIMATE_READ_AHEAD_SIZE;
+
 /*****************
  * GC Parameters *
  *****************/
@@ -36,7 +43,7 @@ const size_t MAX_CONCURRENT_GCS = 32;
 // doesn't grow indefinitely.
 const int GC_IO_PRIORITY_NICE = 8;
 // 4 times the priority of all caches combined
-const int GC_IO_PRIORITY_HIGH = (4 * CACHE_WRITES_IO_PRIORITY * CPU_SHARDING_FACTOR);
+const int GC_IO_PRIORITY_HIGH = (4 * CACHE_WRITES_IO_PRIORITY);
 
 // The ratio at which we start GCing.
 const double GC_START_RATIO = 0.15;
@@ -70,6 +77,7 @@ public:
         : parent(_parent),
           extent_ref(parent->extent_manager->gen_extent()),
           timestamp(current_microtime()),
+          gc_score(0),
           was_written(false),
           state(state_active),
           garbage_bytes_stat(_parent->static_config->extent_size()),
@@ -84,6 +92,7 @@ public:
         : parent(_parent),
           extent_ref(parent->extent_manager->reserve_extent(_offset)),
           timestamp(current_microtime()),
+          gc_score(0),
           was_written(false),
           state(state_reconstructing),
           garbage_bytes_stat(_parent->static_config->extent_size()),
@@ -192,6 +201,32 @@ public:
 
     bool all_garbage() const { return num_live_blocks() == 0; }
 
+    // Recomputes `gc_score`.  Must be called whenever our garbage changes while
+    // we're in `gc_pq`, before updating our entry there.
+    void update_gc_score() {
+        switch (parent->gc_policy) {
+        case gc_policy_t::greedy:
+            gc_score = garbage_bytes();
+            break;
+        case gc_policy_t::cost_benefit: {
+            // The LFS cleaner's (1 - u) * age / (1 + u), where u is the fraction of
+            // the extent that's live.  We use the time we started writing to the
+            // extent as the age of its data.  For extents that we found when
+            // starting up, that's the time we started up.  The age is measured at
+            // `parent->gc_score_time` rather than now, like that of all the other
+            // extents in `gc_pq`.
+            const double extent_size = parent->static_config->extent_size();
+            const double live = (extent_size - garbage_bytes()) / extent_size;
+            const double age = parent->gc_score_time > timestamp
+                ? parent->gc_score_time - timestamp
+                : 0;
+            gc_score = (1.0 - live) * age / (1.0 + live);
+        } break;
+        default:
+            unreachable();
+        }
+    }
+
     uint32_t garbage_bytes() const {
         rassert(compute_garbage_bytes() == garbage_bytes_stat);
         return garbage_bytes_stat;
@@ -242,6 +277,14 @@ public:
 
         uint32_t relative_offset = offset - extent_ref.offset();
 
+        if (state == state_reconstructing) {
+            // The LBA hands us the blocks in block id order, not in offset order, so
+            // we only sort them once in `finish_reconstructing()`.
+            block_infos.push_back(block_info_t{relative_offset, block_size, false, true});
+            update_stats(NULL, &block_infos.back());
+            return;
+        }
+
         auto it = find_lower_bound_iter(relative_offset);
         if (it == block_infos.end()) {
             block_infos.push_back(block_info_t{relative_offset, block_size, false, true});
@@ -282,6 +325,22 @@ public:
         return b;
     }
 
+    // Sorts the blocks that `mark_live_indexwise_with_offset` collected while we were
+    // reconstructing.  This only touches our `block_infos`, so different entries may
+    // do it on different threads at the same time.
+    void finish_reconstructing() {
+        guarantee(state == state_reconstructing);
+        std::sort(block_infos.begin(), block_infos.end(),
+                  [](const block_info_t &l, const block_info_t &r) {
+                      return l.relative_offset < r.relative_offset;
+                  });
+        for (size_t i = 1; i < block_infos.size(); ++i) {
+            guarantee(block_infos[i].relative_offset
+                      >= block_infos[i - 1].relative_offset
+                         + aligned_value(block_infos[i - 1].block_size));
+        }
+    }
+
     void make_active() {
         guarantee(state == state_reconstructing);
         state = state_active;
@@ -368,14 +427,20 @@ public:
     // The PQ entry pointing to us.
     priority_queue_t<gc_entry_t *, gc_entry_less_t>::entry_t *our_pq_entry;
 
+    // The extent with the highest score gets collected first, see
+    // `update_gc_score()`.  Under the cost-benefit policy, the scores get
+    // recomputed with the current time whenever a GC round starts, see
+    // `rescore_gc_pq()`.
+    double gc_score;
+
     // True iff the extent has been written to after starting up the serializer.
     bool was_written;
 
     enum state_t {
         // It has been, or is being, reconstructed from data on disk.
         state_reconstructing,
-        // We are currently putting things on this extent. It is equal to
-        // last_data_extent.
+        // We are currently putting things on this extent. It is one of the
+        // parent's `active_extents`.
         state_active,
         // Not active, but not a GC candidate yet. It is in young_extent_queue.
         state_young,
@@ -403,9 +468,14 @@ private:
 data_block_manager_t::data_block_manager_t(
         extent_manager_t *em, log_serializer_t *_serializer,
         const log_serializer_on_disk_static_config_t *_static_config,
+        gc_policy_t _gc_policy,
         log_serializer_stats_t *_stats)
     : stats(_stats), shutdown_callback(NULL), state(state_unstarted),
-      static_config(_static_config), extent_manager(em), serializer(_serializer),
+      static_config(_static_config), gc_policy(_gc_policy),
+      gc_score_time(current_microtime()),
+      extent_manager(em), serializer(_serializer),
+      pending_reads_flush_scheduled(false),
+      reads_in_flight(0),
       gc_stats(stats)
 {
     rassert(static_config != NULL);
@@ -415,6 +485,8 @@ data_block_manager_t::data_block_manager_t(
 
 data_block_manager_t::~data_block_manager_t() {
     guarantee(state == state_unstarted || state == state_shut_down);
+    guarantee(pending_reads.empty());
+    guarantee(reads_in_flight == 0);
 }
 
 void data_block_manager_t::prepare_initial_metablock(data_block_manager::metablock_mixin_t *mb) {
@@ -445,6 +517,23 @@ void data_block_manager_t::mark_live(int64_t offset, block_size_t ser_block_size
 
 void data_block_manager_t::end_reconstruct() {
     guarantee(state == state_unstarted);
+
+    std::vector<gc_entry_t *> extents;
+    for (gc_entry_t *entry = reconstructed_extents.head();
+         entry != NULL;
+         entry = reconstructed_extents.next(entry)) {
+        extents.push_back(entry);
+    }
+
+    // Nobody else looks at the entries before `start_existing`, so we sort them on
+    // all of the DB threads.
+    const int num_threads = std::max(get_num_db_threads(), 1);
+    pmap(num_threads, [&](int thread) {
+        on_thread_t th((threadnum_t(thread)));
+        for (size_t i = thread; i < extents.size(); i += num_threads) {
+            extents[i]->finish_reconstructing();
+        }
+    });
 }
 
 void data_block_manager_t::start_existing(file_t *file,
@@ -454,8 +543,10 @@ void data_block_manager_t::start_existing(file_t *file,
     gc_io_account_nice.init(new file_account_t(file, GC_IO_PRIORITY_NICE));
     gc_io_account_high.init(new file_account_t(file, GC_IO_PRIORITY_HIGH));
 
-    /* Reconstruct the active data block extents from the metablock. */
+    /* Reconstruct the active data block extent of user writes from the
+    metablock. */
     const int64_t offset = last_metablock->active_extent;
+    gc_entry_t *&active_extent = active_extents[static_cast<int>(write_stream_t::user)];
 
     if (offset != NULL_OFFSET) {
         /* It is (perhaps) possible to have an active data block extent with no
@@ -477,6 +568,7 @@ void data_block_manager_t::start_existing(file_t *file,
     } else {
         active_extent = NULL;
     }
+    active_extents[static_cast<int>(write_stream_t::gc)] = NULL;
 
     /* Convert any extents that we found live blocks in, but that are not active
     extents, into old extents */
@@ -486,6 +578,7 @@ void data_block_manager_t::start_existing(file_t *file,
         guarantee(entry->state == gc_entry_t::state_reconstructing);
         entry->state = gc_entry_t::state_old;
 
+        entry->update_gc_score();
         entry->our_pq_entry = gc_pq.push(entry);
 
         gc_stats.old_total_block_bytes += static_config->extent_size();
@@ -707,8 +800,8 @@ buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
     } else {
         if (divides(DEVICE_BLOCK_SIZE, off_in)) {
             buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
-            co_read(dbfile, off_in, ret.aligned_block_size(),
-                    ret.ser_buffer(), io_account);
+            coalesced_read(off_in, ret.aligned_block_size(),
+                           reinterpret_cast<char *>(ret.ser_buffer()), io_account);
             // Blocks are written DEVICE_BLOCK_SIZE-aligned -- so the block on disk
             // should have been written with zero padding.
             ret.assert_padding_zero();
@@ -732,14 +825,122 @@ buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
     }
 }
 
+void data_block_manager_t::coalesced_read(int64_t offset, uint32_t aligned_size,
+                                          char *buf, file_account_t *io_account) {
+    cond_t done;
+    pending_read_t read;
+    read.offset = offset;
+    read.aligned_size = aligned_size;
+    read.buf = buf;
+    read.io_account = io_account;
+    read.done = &done;
+    pending_reads.push_back(read);
+
+    if (reads_in_flight == 0 && !pending_reads_flush_scheduled) {
+        // There's nothing else to wait for, so waiting would only add latency.
+        send_pending_reads();
+    } else if (!pending_reads_flush_scheduled) {
+        // Other coroutines that run before the flush (for example the rest of a
+        // batch of page loads started by a backfill or a range scan) get to add
+        // their reads to the same batch.
+        pending_reads_flush_scheduled = true;
+        coro_t::spawn_later_ordered(std::bind(&data_block_manager_t::flush_pending_reads,
+                                              this));
+    }
+
+    done.wait();
+}
+
+void data_block_manager_t::flush_pending_reads() {
+    guarantee(pending_reads_flush_scheduled);
+    pending_reads_flush_scheduled = false;
+    send_pending_reads();
+}
+
+void data_block_manager_t::send_pending_reads() {
+    std::vector<pending_read_t> reads;
+    reads.swap(pending_reads);
+    // Reads from different accounts are never merged, so that each one keeps
+    // its priority.
+    std::sort(reads.begin(), reads.end(),
+              [](const pending_read_t &x, const pending_read_t &y) {
+                  return x.io_account < y.io_account
+                      || (x.io_account == y.io_account && x.offset < y.offset);
+              });
+
+    struct coalesced_read_cb_t : public iocallback_t {
+        void on_io_complete() {
+            --parent->reads_in_flight;
+            for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+                (*it)->pulse();
+            }
+            delete this;
+        }
+        data_block_manager_t *parent;
+        std::vector<cond_t *> waiters;
+    };
+
+    size_t i = 0;
+    while (i < reads.size()) {
+        const uint64_t extent_id = static_config->extent_index(reads[i].offset);
+        int64_t run_size = reads[i].aligned_size;
+        size_t j = i + 1;
+        while (j < reads.size()
+               && j - i < IOV_MAX
+               && reads[j].io_account == reads[i].io_account
+               && reads[j].offset == reads[j - 1].offset + reads[j - 1].aligned_size
+               && static_config->extent_index(reads[j].offset) == extent_id
+               && run_size + reads[j].aligned_size <= MAX_COALESCED_READ_SIZE) {
+            run_size += reads[j].aligned_size;
+            ++j;
+        }
+
+        coalesced_read_cb_t *cb = new coalesced_read_cb_t;
+        cb->parent = this;
+        ++reads_in_flight;
+        cb->waiters.reserve(j - i);
+        for (size_t k = i; k < j; ++k) {
+            cb->waiters.push_back(reads[k].done);
+        }
+
+        if (j - i == 1) {
+            dbfile->read_async(reads[i].offset, reads[i].aligned_size, reads[i].buf,
+                               reads[i].io_account, cb);
+        } else {
+            scoped_array_t<iovec> iovecs(j - i);
+            for (size_t k = i; k < j; ++k) {
+                iovecs[k - i].iov_base = reads[k].buf;
+                iovecs[k - i].iov_len = reads[k].aligned_size;
+            }
+            dbfile->readv_async(reads[i].offset, run_size, std::move(iovecs),
+                                reads[i].io_account, cb);
+        }
+
+        i = j;
+    }
+}
+
 std::vector<counted_t<ls_block_token_pointee_t> >
 data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
+                                  write_stream_t stream,
                                   file_account_t *io_account,
                                   iocallback_t *cb) {
     // These tokens are grouped by extent.  You can do a contiguous write in each
     // extent.
     std::vector<std::vector<counted_t<ls_block_token_pointee_t> > > token_groups
-        = gimme_some_new_offsets(writes);
+        = gimme_some_new_offsets(writes, stream);
+
+    int64_t bytes_written = 0;
+    for (auto it = writes.begin(); it != writes.end(); ++it) {
+        bytes_written += gc_entry_t::aligned_value(it->block_size);
+    }
+    if (stream == write_stream_t::gc) {
+        stats->pm_serializer_gc_bytes_written += bytes_written;
+        stats->pm_serializer_write_amplification.record_gc_write(bytes_written);
+    } else {
+        stats->pm_serializer_data_bytes_written += bytes_written;
+        stats->pm_serializer_write_amplification.record_user_write(bytes_written);
+    }
 
     for (auto it = writes.begin(); it != writes.end(); ++it) {
         it->buf->ser_header.block_id = it->block_id;
@@ -749,6 +950,9 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
         virtual void on_io_complete() {
             --ops_remaining;
             if (ops_remaining == 0) {
+                if (latency != NULL) {
+                    latency->record(get_ticks() - start_ticks);
+                }
                 iocallback_t *local_cb = cb;
                 delete this;
                 local_cb->on_io_complete();
@@ -757,6 +961,9 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
 
         size_t ops_remaining;
         iocallback_t *cb;
+        // `NULL` for the GC's writes, whose latency nobody waits for.
+        perfmon_latency_histogram_t *latency;
+        ticks_t start_ticks;
     };
 
     intermediate_cb_t *const intermediate_cb = new intermediate_cb_t;
@@ -764,6 +971,10 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
     // intermediate_cb->on_io_complete later.
     intermediate_cb->ops_remaining = token_groups.size() + 1;
     intermediate_cb->cb = cb;
+    intermediate_cb->latency = stream == write_stream_t::gc
+        ? NULL
+        : &stats->pm_serializer_block_write_latency;
+    intermediate_cb->start_ticks = get_ticks();
 
     size_t write_number = 0;
     for (size_t i = 0; i < token_groups.size(); ++i) {
@@ -877,6 +1088,7 @@ void data_block_manager_t::check_and_handle_empty_extent(uint64_t extent_id) {
         destroy_entry(entry);
 
     } else if (entry->state == gc_entry_t::state_old) {
+        entry->update_gc_score();
         entry->our_pq_entry->update();
     }
 }
@@ -993,6 +1205,10 @@ void data_block_manager_t::start_gc() {
     }
 
     const size_t goal_num_active_gcs = compute_gc_concurrency();
+    if (active_gcs.empty() && goal_num_active_gcs > 0) {
+        // A new round of GC is starting.  The extents have aged since the last one.
+        rescore_gc_pq();
+    }
     while (active_gcs.size() < goal_num_active_gcs) {
         gc_state_t *new_gc_state = new gc_state_t();
         active_gcs.push_back(new_gc_state);
@@ -1096,6 +1312,8 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
                     current_interval_end = end;
                 } else {
                     if (current_interval_end > current_interval_begin) {
+                        stats->pm_serializer_gc_bytes_read
+                            += current_interval_end - current_interval_begin;
                         read_cb.refcount++;
                         dbfile->read_async(
                                 extent_offset + current_interval_begin,
@@ -1113,6 +1331,8 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
 
         guarantee(current_interval_begin < current_interval_end);
 
+        stats->pm_serializer_gc_bytes_read
+            += current_interval_end - current_interval_begin;
         read_cb.refcount++;
         dbfile->read_async(
                 extent_offset + current_interval_begin,
@@ -1218,8 +1438,8 @@ void data_block_manager_t::write_gcs(const std::vector<gc_write_t> &writes,
                                                   writes[i].buf->ser_header.block_id));
         }
 
-        new_block_tokens = many_writes(the_writes, choose_gc_io_account(),
-                                       &block_write_cond);
+        new_block_tokens = many_writes(the_writes, write_stream_t::gc,
+                                       choose_gc_io_account(), &block_write_cond);
 
         guarantee(new_block_tokens.size() == writes.size());
     }
@@ -1289,6 +1509,8 @@ void data_block_manager_t::write_gcs(const std::vector<gc_write_t> &writes,
 void data_block_manager_t::prepare_metablock(data_block_manager::metablock_mixin_t *metablock) {
     guarantee(state == state_ready || state == state_shutting_down);
 
+    const gc_entry_t *active_extent
+        = active_extents[static_cast<int>(write_stream_t::user)];
     if (active_extent != NULL) {
         metablock->active_extent = active_extent->extent_ref.offset();
     } else {
@@ -1317,10 +1539,12 @@ void data_block_manager_t::actually_shutdown() {
 
     guarantee(reconstructed_extents.head() == NULL);
 
-    if (active_extent != NULL) {
-        UNUSED int64_t extent = active_extent->extent_ref.release();
-        delete active_extent;
-        active_extent = NULL;
+    for (int i = 0; i < NUM_WRITE_STREAMS; ++i) {
+        if (active_extents[i] != NULL) {
+            UNUSED int64_t extent = active_extents[i]->extent_ref.release();
+            delete active_extents[i];
+            active_extents[i] = NULL;
+        }
     }
 
     while (gc_entry_t *entry = young_extent_queue.head()) {
@@ -1341,9 +1565,12 @@ void data_block_manager_t::actually_shutdown() {
 }
 
 std::vector<std::vector<counted_t<ls_block_token_pointee_t> > >
-data_block_manager_t::gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes) {
+data_block_manager_t::gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes,
+                                             write_stream_t stream) {
     ASSERT_NO_CORO_WAITING;
 
+    gc_entry_t *&active_extent = active_extents[static_cast<int>(stream)];
+
     // Start a new extent if necessary.
     if (active_extent == NULL) {
         active_extent = new gc_entry_t(this);
@@ -1427,6 +1654,7 @@ void data_block_manager_t::remove_last_unyoung_entry() {
     guarantee(entry->state == gc_entry_t::state_young);
     entry->state = gc_entry_t::state_old;
 
+    entry->update_gc_score();
     entry->our_pq_entry = gc_pq.push(entry);
 
     gc_stats.old_total_block_bytes += static_config->extent_size();
@@ -1442,6 +1670,23 @@ bool data_block_manager_t::should_we_keep_gcing() const {
     return garbage_ratio() > GC_STOP_RATIO;
 }
 
+void data_block_manager_t::rescore_gc_pq() {
+    ASSERT_NO_CORO_WAITING;
+    if (gc_policy != gc_policy_t::cost_benefit) {
+        return;
+    }
+    gc_score_time = current_microtime();
+    std::vector<gc_entry_t *> old_entries;
+    old_entries.reserve(gc_pq.size());
+    while (!gc_pq.empty()) {
+        old_entries.push_back(gc_pq.pop());
+    }
+    for (auto it = old_entries.begin(); it != old_entries.end(); ++it) {
+        (*it)->update_gc_score();
+        (*it)->our_pq_entry = gc_pq.push(*it);
+    }
+}
+
 bool data_block_manager_t::should_terminate_one_gc_thread() const {
     const size_t goal_num_active_gcs = compute_gc_concurrency();
     return active_gcs.size() > goal_num_active_gcs;
@@ -1455,7 +1700,26 @@ bool data_block_manager_t::do_we_want_to_start_gcing() const {
 }
 
 bool gc_entry_less_t::operator()(const gc_entry_t *x, const gc_entry_t *y) {
-    return x->garbage_bytes() < y->garbage_bytes();
+    return x->gc_score < y->gc_score;
+}
+
+const char *gc_policy_name(gc_policy_t policy) {
+    switch (policy) {
+    case gc_policy_t::greedy: return "greedy";
+    case gc_policy_t::cost_benefit: return "cost-benefit";
+    default: unreachable();
+    }
+}
+
+bool parse_gc_policy_name(const std::string &name, gc_policy_t *policy_out) {
+    if (name == "greedy") {
+        *policy_out = gc_policy_t::greedy;
+    } else if (name == "cost-benefit") {
+        *policy_out = gc_policy_t::cost_benefit;
+    } else {
+        return false;
+    }
+    return true;
 }
 
 /****************
@@ -14,8 +14,10 @@
 #include "serializer/log/config.hpp"
 #include "serializer/log/extent_manager.hpp"
 #include "serializer/types.hpp"
+#include "time.hpp"
 
 class buf_ptr_t;
+class cond_t;
 class log_serializer_t;
 class data_block_manager_t;
 class gc_entry_t;
@@ -34,8 +36,20 @@ class data_block_manager_t {
     friend class dbm_read_ahead_t;
 
 public:
+    // Blocks that the GC moves have already outlived the rest of their extent, so
+    // they are likely to stay around, while blocks that the serializer's users write
+    // are likely to be overwritten soon.  Each kind of write goes to its own active
+    // extent, so that the GC doesn't copy the same cold blocks again every time an
+    // extent of hot blocks mostly turns into garbage.
+    enum class write_stream_t {
+        user = 0,
+        gc = 1
+    };
+    static const int NUM_WRITE_STREAMS = 2;
+
     data_block_manager_t(extent_manager_t *em, log_serializer_t *serializer,
                          const log_serializer_on_disk_static_config_t *static_config,
+                         gc_policy_t gc_policy,
                          log_serializer_stats_t *parent);
     ~data_block_manager_t();
 
@@ -53,7 +67,8 @@ public:
     /* mark a buffer as garbage */
     void mark_garbage(int64_t offset, extent_transaction_t *txn);  // Takes a real int64_t.
 
-    /* r{start,end}_reconstruct functions for safety */
+    /* r{start,end}_reconstruct functions for safety. end_reconstruct() must be
+    called in a coroutine, since it spreads its work over the DB threads. */
     void start_reconstruct();
     void mark_live(int64_t offset, block_size_t block_size);
     void end_reconstruct();
@@ -78,11 +93,13 @@ public:
 
     std::vector<counted_t<ls_block_token_pointee_t> >
     many_writes(const std::vector<buf_write_info_t> &writes,
+                write_stream_t stream,
                 file_account_t *io_account,
                 iocallback_t *cb);
 
     std::vector<std::vector<counted_t<ls_block_token_pointee_t> > >
-    gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes);
+    gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes,
+                           write_stream_t stream);
 
 
 private:
@@ -132,6 +149,11 @@ private:
     // Tells if we should keep gc'ing.
     bool should_we_keep_gcing() const;
 
+    // Recomputes the score of every extent in `gc_pq` as of now, and reorders it.
+    // Only does anything under the cost-benefit policy, where scores depend on the
+    // time.
+    void rescore_gc_pq();
+
     // Checks the size of active_gcs and determines whether at least one
     // GC thread should terminate.
     bool should_terminate_one_gc_thread() const;
@@ -147,6 +169,27 @@ private:
 
     bool should_perform_read_ahead(int64_t offset);
 
+    // A block read that has been requested by `read()` but not yet sent to disk.
+    struct pending_read_t {
+        int64_t offset;
+        uint32_t aligned_size;
+        char *buf;
+        file_account_t *io_account;
+        cond_t *done;
+    };
+
+    // Reads a block and waits for the read to complete.  If none of our reads are
+    // on their way to disk, the read goes to disk right away.  Otherwise it waits
+    // for one pass through the event loop, and reads queued in that pass get
+    // merged by `flush_pending_reads()`.
+    void coalesced_read(int64_t offset, uint32_t aligned_size, char *buf,
+                        file_account_t *io_account);
+
+    void flush_pending_reads();
+    // Sends all pending reads to disk, issuing a single readv for every run of
+    // physically contiguous blocks within an extent.
+    void send_pending_reads();
+
     log_serializer_stats_t *const stats;
 
     // This is permitted to destroy the data_block_manager.
@@ -163,10 +206,25 @@ private:
 
     const log_serializer_on_disk_static_config_t* const static_config;
 
+    // How `gc_pq` is ordered.
+    const gc_policy_t gc_policy;
+
+    // The time as of which the cost-benefit scores in `gc_pq` are computed.  All of
+    // them use the same time, so that their order stays consistent until the next
+    // `rescore_gc_pq()`.
+    microtime_t gc_score_time;
+
     extent_manager_t *const extent_manager;
     log_serializer_t *const serializer;
 
     file_t *dbfile;
+
+    std::vector<pending_read_t> pending_reads;
+    bool pending_reads_flush_scheduled;
+    // How many reads or readvs that `send_pending_reads()` started haven't
+    // completed yet.
+    int reads_in_flight;
+
     scoped_ptr_t<file_account_t> gc_io_account_nice;
     scoped_ptr_t<file_account_t> gc_io_account_high;
 
@@ -177,8 +235,10 @@ private:
     /* Contains every extent in the gc_entry_t::state_reconstructing state */
     intrusive_list_t<gc_entry_t> reconstructed_extents;
 
-    /* Contains the extent in the gc_entry_t::state_active state. */
-    gc_entry_t *active_extent;
+    /* Contains the extents in the gc_entry_t::state_active state, indexed by
+    write_stream_t.  Only the user stream's active extent is in the metablock; when
+    we restart, the GC stream's one becomes an old extent like any other. */
+    gc_entry_t *active_extents[NUM_WRITE_STREAMS];
 
     /* Contains every extent in the gc_entry_t::state_young state */
     intrusive_list_t<gc_entry_t> young_extent_queue;
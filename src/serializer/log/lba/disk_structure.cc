@@ -1,6 +1,9 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "serializer/log/lba/disk_structure.hpp"
 
+#include <functional>
+
+#include "arch/runtime/coroutines.hpp"
 #include "containers/scoped.hpp"
 #include "math.hpp"
 
@@ -195,6 +198,7 @@ struct reader_t
 {
     lba_disk_structure_t *ds;   // The disk structure we are reading from
     in_memory_index_t *index;   // The in-memory-index we are reading into
+    threadnum_t parse_thread;   // The thread we parse the extents on
     lba_disk_structure_t::read_callback_t *rcb;   // Who to call back when we finish
 
     /* extent_reader_t takes care of reading a single extent. */
@@ -241,7 +245,15 @@ struct reader_t
             if (have_read) done();
         }
         void done() {
-            extent->read_step_2(&read_info, parent->index);
+            coro_t::spawn_sometime(std::bind(&extent_reader_t::parse, this));
+        }
+        void parse() {
+            {
+                // The other shards' readers parse on other threads at the same time.
+                // Every shard only fills its own part of the index, so that's fine.
+                on_thread_t th(parent->parse_thread);
+                extent->read_step_2(&read_info, parent->index);
+            }
             parent->active_readers--;
             parent->start_more_readers();
             if (index == static_cast<int>(parent->readers.size()) - 1) {
@@ -260,8 +272,9 @@ struct reader_t
     // reading process so that we stay under LBA_READ_BUFFER_SIZE.
     int active_readers;
 
-    reader_t(lba_disk_structure_t *_ds, in_memory_index_t *_index, lba_disk_structure_t::read_callback_t *cb)
-        : ds(_ds), index(_index), rcb(cb)
+    reader_t(lba_disk_structure_t *_ds, in_memory_index_t *_index,
+             threadnum_t _parse_thread, lba_disk_structure_t::read_callback_t *cb)
+        : ds(_ds), index(_index), parse_thread(_parse_thread), rcb(cb)
     {
         for (lba_disk_extent_t *e = ds->extents_in_superblock.head();
              e != NULL; e = ds->extents_in_superblock.next(e)) {
@@ -295,8 +308,9 @@ struct reader_t
     }
 };
 
-void lba_disk_structure_t::read(in_memory_index_t *index, read_callback_t *cb) {
-    new reader_t(this, index, cb);
+void lba_disk_structure_t::read(in_memory_index_t *index, threadnum_t parse_thread,
+                                read_callback_t *cb) {
+    new reader_t(this, index, parse_thread, cb);
 }
 
 void lba_disk_structure_t::prepare_metablock(lba_shard_metablock_t *mb_out) {
@@ -5,6 +5,7 @@
 #include <set>
 
 #include "arch/types.hpp"
+#include "threading.hpp"
 #include "serializer/log/extent_manager.hpp"
 #include "serializer/log/lba/disk_format.hpp"
 #include "serializer/log/lba/disk_extent.hpp"
@@ -54,12 +55,13 @@ public:
                          file_account_t *io_account, extent_transaction_t *txn);
 
     // If you call read(), then the in_memory_index_t will be populated and then the read_callback_t
-    // will be called when it is done.
+    // will be called when it is done.  The extents get parsed into the index on
+    // `parse_thread`, one after the other, while the next ones are being read.
     struct read_callback_t {
         virtual void on_lba_extents_read() = 0;
         virtual ~read_callback_t() {}
     };
-    void read(in_memory_index_t *index, read_callback_t *cb);
+    void read(in_memory_index_t *index, threadnum_t parse_thread, read_callback_t *cb);
 
     void prepare_metablock(lba_shard_metablock_t *mb_out);
 
@@ -3,25 +3,31 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+
 #include "serializer/log/lba/disk_format.hpp"
 
-in_memory_index_t::in_memory_index_t() : end_block_id_(0) { }
+in_memory_index_t::in_memory_index_t() {
+    for (int i = 0; i < LBA_SHARD_FACTOR; ++i) {
+        end_block_id_[i] = 0;
+    }
+}
 
 block_id_t in_memory_index_t::end_block_id() {
-    return end_block_id_;
+    return *std::max_element(end_block_id_, end_block_id_ + LBA_SHARD_FACTOR);
 }
 
 index_block_info_t in_memory_index_t::get_block_info(block_id_t id) {
-    return infos_.get(id);
+    return infos_[id % LBA_SHARD_FACTOR].get(id / LBA_SHARD_FACTOR);
 }
 
 void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
                                        flagged_off64_t offset, uint32_t ser_block_size) {
-    if (id >= end_block_id_) {
-        end_block_id_ = id + 1;
+    const int shard = id % LBA_SHARD_FACTOR;
+    if (id >= end_block_id_[shard]) {
+        end_block_id_[shard] = id + 1;
     }
 
     index_block_info_t info(offset, recency, ser_block_size);
-    infos_.set(id, info);
+    infos_[shard].set(id / LBA_SHARD_FACTOR, info);
 }
-
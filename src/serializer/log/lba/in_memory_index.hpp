@@ -34,9 +34,13 @@ struct index_block_info_t {
 
 
 
+// The index is split into the same `LBA_SHARD_FACTOR` shards as the LBA, by
+// `block_id % LBA_SHARD_FACTOR`.  Since every LBA shard only contains entries of its
+// own block ids, the shards can be filled concurrently from different threads while
+// the LBA gets loaded.
 class in_memory_index_t {
-    two_level_array_t<index_block_info_t> infos_;
-    block_id_t end_block_id_;
+    two_level_array_t<index_block_info_t> infos_[LBA_SHARD_FACTOR];
+    block_id_t end_block_id_[LBA_SHARD_FACTOR];
 
 public:
     in_memory_index_t();
@@ -0,0 +1,276 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include "serializer/log/lba/index_snapshot.hpp"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "errors.hpp"
+#include <boost/crc.hpp>
+
+#include "arch/io/disk.hpp"
+#include "arch/io/io_utils.hpp"
+#include "arch/runtime/thread_pool.hpp"
+#include "logger.hpp"
+
+static const char INDEX_SNAPSHOT_MAGIC[8] = {'r', 'd', 'b', 'i', 'n', 'd', 'e', 'x'};
+static const uint32_t INDEX_SNAPSHOT_FORMAT_VERSION = 1;
+
+// We read and write the entries in chunks of about this size.
+static const size_t INDEX_SNAPSHOT_IO_CHUNK_SIZE = 1024 * 1024;
+
+struct index_snapshot_header_t {
+    char magic[sizeof(INDEX_SNAPSHOT_MAGIC)];
+    uint32_t format_version;
+    uint32_t lba_crc;
+    int64_t metablock_version;
+    uint64_t end_block_id;
+    uint64_t num_entries;
+} __attribute__((__packed__));
+
+// The entries are followed by a CRC of the header and all of the entries.
+struct index_snapshot_entry_t {
+    uint64_t block_id;
+    index_block_info_t info;
+} __attribute__((__packed__));
+
+index_snapshot_stamp_t make_index_snapshot_stamp(int64_t metablock_version,
+                                                 const lba_metablock_mixin_t &lba_part) {
+    boost::crc_32_type crc_computer;
+    crc_computer.process_bytes(&lba_part, sizeof(lba_part));
+    index_snapshot_stamp_t stamp;
+    stamp.metablock_version = metablock_version;
+    stamp.lba_crc = crc_computer.checksum();
+    return stamp;
+}
+
+static bool write_fully(fd_t fd, const char *buf, size_t size) {
+    while (size > 0) {
+        ssize_t res;
+        do {
+            res = ::write(fd, buf, size);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            return false;
+        }
+        buf += res;
+        size -= res;
+    }
+    return true;
+}
+
+static bool read_fully(fd_t fd, char *buf, size_t size) {
+    while (size > 0) {
+        ssize_t res;
+        do {
+            res = ::read(fd, buf, size);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res <= 0) {
+            return false;
+        }
+        buf += res;
+        size -= res;
+    }
+    return true;
+}
+
+static bool is_default_info(const index_block_info_t &info) {
+    return info == index_block_info_t();
+}
+
+static void save_index_snapshot_blocking(const std::string &path,
+                                         const index_snapshot_stamp_t &stamp,
+                                         in_memory_index_t *index,
+                                         int *errsv_out) {
+    *errsv_out = 0;
+    const std::string temporary_path = path + ".tmp";
+
+    const block_id_t end_block_id = index->end_block_id();
+    index_snapshot_header_t header;
+    memcpy(header.magic, INDEX_SNAPSHOT_MAGIC, sizeof(INDEX_SNAPSHOT_MAGIC));
+    header.format_version = INDEX_SNAPSHOT_FORMAT_VERSION;
+    header.lba_crc = stamp.lba_crc;
+    header.metablock_version = stamp.metablock_version;
+    header.end_block_id = end_block_id;
+    header.num_entries = 0;
+    for (block_id_t id = 0; id < end_block_id; ++id) {
+        if (!is_default_info(index->get_block_info(id))) {
+            ++header.num_entries;
+        }
+    }
+
+    scoped_fd_t fd;
+    {
+        int res;
+        do {
+            res = ::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            *errsv_out = get_errno();
+            return;
+        }
+        fd.reset(res);
+    }
+
+    boost::crc_32_type crc_computer;
+    std::string buffer;
+    buffer.reserve(INDEX_SNAPSHOT_IO_CHUNK_SIZE + sizeof(index_snapshot_entry_t));
+    buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (block_id_t id = 0; id < end_block_id; ++id) {
+        index_snapshot_entry_t entry;
+        entry.info = index->get_block_info(id);
+        if (is_default_info(entry.info)) {
+            continue;
+        }
+        entry.block_id = id;
+        buffer.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        if (buffer.size() >= INDEX_SNAPSHOT_IO_CHUNK_SIZE) {
+            crc_computer.process_bytes(buffer.data(), buffer.size());
+            if (!write_fully(fd.get(), buffer.data(), buffer.size())) {
+                *errsv_out = get_errno();
+                return;
+            }
+            buffer.clear();
+        }
+    }
+    crc_computer.process_bytes(buffer.data(), buffer.size());
+    const uint32_t crc = crc_computer.checksum();
+    buffer.append(reinterpret_cast<const char *>(&crc), sizeof(crc));
+
+    if (!write_fully(fd.get(), buffer.data(), buffer.size())
+        || ::fsync(fd.get()) != 0) {
+        *errsv_out = get_errno();
+        return;
+    }
+    fd.reset();
+
+    if (::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        *errsv_out = get_errno();
+        return;
+    }
+    warn_fsync_parent_directory(path.c_str());
+}
+
+bool save_index_snapshot(const std::string &path,
+                         const index_snapshot_stamp_t &stamp,
+                         in_memory_index_t *index) {
+    int errsv;
+    thread_pool_t::run_in_blocker_pool(
+        [&]() { save_index_snapshot_blocking(path, stamp, index, &errsv); });
+    if (errsv != 0) {
+        logWRN("Could not write the index snapshot %s (%s).  The next start will "
+               "read the whole LBA instead.",
+               path.c_str(), errno_string(errsv).c_str());
+        ::unlink((path + ".tmp").c_str());
+        return false;
+    }
+    return true;
+}
+
+// Checks everything about the snapshot before we touch the index, so that a bad
+// snapshot leaves the index empty.  The second pass is served from the page cache.
+static bool load_index_snapshot_blocking(const std::string &path,
+                                         const index_snapshot_stamp_t &stamp,
+                                         in_memory_index_t *index) {
+    scoped_fd_t fd;
+    {
+        int res;
+        do {
+            res = ::open(path.c_str(), O_RDONLY);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            return false;
+        }
+        fd.reset(res);
+    }
+
+    index_snapshot_header_t header;
+    if (!read_fully(fd.get(), reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header.magic, INDEX_SNAPSHOT_MAGIC, sizeof(INDEX_SNAPSHOT_MAGIC)) != 0
+        || header.format_version != INDEX_SNAPSHOT_FORMAT_VERSION
+        || header.metablock_version != stamp.metablock_version
+        || header.lba_crc != stamp.lba_crc) {
+        return false;
+    }
+
+    struct stat64 file_stat;
+    if (fstat64(fd.get(), &file_stat) != 0) {
+        return false;
+    }
+    const uint64_t entries_size = static_cast<uint64_t>(file_stat.st_size)
+        - sizeof(header) - sizeof(uint32_t);
+    if (static_cast<uint64_t>(file_stat.st_size) < sizeof(header) + sizeof(uint32_t)
+        || header.num_entries != entries_size / sizeof(index_snapshot_entry_t)
+        || entries_size % sizeof(index_snapshot_entry_t) != 0) {
+        return false;
+    }
+
+    boost::crc_32_type crc_computer;
+    crc_computer.process_bytes(&header, sizeof(header));
+    std::string buffer(INDEX_SNAPSHOT_IO_CHUNK_SIZE / sizeof(index_snapshot_entry_t)
+                       * sizeof(index_snapshot_entry_t), '\0');
+    for (uint64_t done = 0; done < entries_size;) {
+        const size_t chunk = std::min<uint64_t>(buffer.size(), entries_size - done);
+        if (!read_fully(fd.get(), &buffer[0], chunk)) {
+            return false;
+        }
+        crc_computer.process_bytes(buffer.data(), chunk);
+        done += chunk;
+    }
+    uint32_t crc;
+    if (!read_fully(fd.get(), reinterpret_cast<char *>(&crc), sizeof(crc))
+        || crc != crc_computer.checksum()) {
+        return false;
+    }
+
+    if (::lseek64(fd.get(), sizeof(header), SEEK_SET) == -1) {
+        return false;
+    }
+    for (uint64_t done = 0; done < entries_size;) {
+        const size_t chunk = std::min<uint64_t>(buffer.size(), entries_size - done);
+        // We have already read all of this once, so this shouldn't fail.
+        guarantee(read_fully(fd.get(), &buffer[0], chunk),
+                  "Could not read the index snapshot %s a second time.", path.c_str());
+        for (size_t i = 0; i < chunk; i += sizeof(index_snapshot_entry_t)) {
+            index_snapshot_entry_t entry;
+            memcpy(&entry, buffer.data() + i, sizeof(entry));
+            guarantee(entry.block_id < header.end_block_id,
+                      "Index snapshot %s has an entry past its end.", path.c_str());
+            index->set_block_info(entry.block_id, entry.info.recency,
+                                  entry.info.offset, entry.info.ser_block_size);
+        }
+        done += chunk;
+    }
+
+    // The index also remembers the highest deleted block ids.  Their entries are
+    // the default ones, which is what we set here.
+    if (header.end_block_id > index->end_block_id()) {
+        const index_block_info_t info;
+        index->set_block_info(header.end_block_id - 1, info.recency, info.offset,
+                              info.ser_block_size);
+    }
+    return true;
+}
+
+bool load_index_snapshot(const std::string &path,
+                         const index_snapshot_stamp_t &stamp,
+                         in_memory_index_t *index) {
+    rassert(index->end_block_id() == 0);
+    bool res;
+    thread_pool_t::run_in_blocker_pool(
+        [&]() { res = load_index_snapshot_blocking(path, stamp, index); });
+    return res;
+}
+
+void remove_index_snapshot(const std::string &path) {
+    const int res = ::unlink(path.c_str());
+    guarantee_err(res == 0 || get_errno() == ENOENT,
+                  "unlink failed for file %s", path.c_str());
+}
@@ -0,0 +1,49 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_LBA_INDEX_SNAPSHOT_HPP_
+#define SERIALIZER_LOG_LBA_INDEX_SNAPSHOT_HPP_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "serializer/log/lba/disk_format.hpp"
+#include "serializer/log/lba/in_memory_index.hpp"
+
+/* An index snapshot is a copy of the `in_memory_index_t` in a sequential file next
+to the serializer file.  We write one when the serializer shuts down cleanly, so
+that the next start can load it in one sequential read instead of reading and
+parsing every LBA extent.
+
+A snapshot is only valid for the exact metablock it was taken at.  Its stamp
+contains the version of that metablock and a checksum of the metablock's LBA part,
+which determines the contents of the LBA.  Any write to the serializer writes a new
+metablock and so invalidates the snapshot. */
+
+struct index_snapshot_stamp_t {
+    int64_t metablock_version;
+    uint32_t lba_crc;
+};
+
+index_snapshot_stamp_t make_index_snapshot_stamp(int64_t metablock_version,
+                                                 const lba_metablock_mixin_t &lba_part);
+
+// These block, and must be called in a coroutine.  The index must not change
+// while they run.
+
+// Writes the snapshot to a temporary file first and then renames it into place, so
+// that there never is a partially written snapshot at `path`.  Returns false and
+// logs a warning if the snapshot couldn't be written.
+bool save_index_snapshot(const std::string &path,
+                         const index_snapshot_stamp_t &stamp,
+                         in_memory_index_t *index);
+
+// Returns false, leaving `index` unchanged, if there is no snapshot at `path`, or
+// if it's corrupted or doesn't have the given stamp.  `index` must be empty.
+bool load_index_snapshot(const std::string &path,
+                         const index_snapshot_stamp_t &stamp,
+                         in_memory_index_t *index);
+
+// Removes the snapshot at `path`, if there is one.
+void remove_index_snapshot(const std::string &path);
+
+#endif  // SERIALIZER_LOG_LBA_INDEX_SNAPSHOT_HPP_
@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "serializer/log/lba/lba_list.hpp"
 
+#include <algorithm>
+
 #include "utils.hpp"
 #include "serializer/log/lba/disk_format.hpp"
 #include "arch/arch.hpp"
@@ -13,7 +15,8 @@
 lba_list_t::lba_list_t(extent_manager_t *em,
         const lba_list_t::write_metablock_fun_t &_write_metablock_fun)
     : gc_drainer(new auto_drainer_t), write_metablock_fun(_write_metablock_fun),
-      extent_manager(em), state(state_unstarted), inline_lba_entries_count(0)
+      extent_manager(em), state(state_unstarted), index_from_snapshot(false),
+      inline_lba_entries_count(0)
 {
     for (int i = 0; i < LBA_SHARD_FACTOR; i++) {
         gc_active[i] = false;
@@ -85,9 +88,20 @@ public:
         rassert(cbs_out > 0);
         cbs_out--;
         if (cbs_out == 0) {
+            if (owner->index_from_snapshot) {
+                // The index already is as the LBA extents would make it.
+                finish();
+                return;
+            }
+            // Every shard parses its extents on its own thread, starting with the
+            // one after ours, so that loading a large LBA isn't bound by one core.
+            const int num_threads = std::max(get_num_db_threads(), 1);
+            const int our_thread = get_thread_id().threadnum;
             cbs_out = LBA_SHARD_FACTOR;
             for (int i = 0; i < LBA_SHARD_FACTOR; i++) {
-                owner->disk_structures[i]->read(&owner->in_memory_index, this);
+                const threadnum_t parse_thread((our_thread + 1 + i) % num_threads);
+                owner->disk_structures[i]->read(&owner->in_memory_index, parse_thread,
+                                                this);
             }
         }
     }
@@ -97,21 +111,25 @@ public:
         cbs_out--;
         if (cbs_out == 0) {
             // All LBA entries from the LBA extents have been read.
-            // Now we can load the (more recent) inlined entries from
-            // the metablock into the index:
-            for (int32_t i = 0; i < owner->inline_lba_entries_count; ++i) {
-                lba_entry_t *e = &owner->inline_lba_entries[i];
-                owner->in_memory_index.set_block_info(
-                        e->block_id,
-                        e->recency,
-                        e->offset,
-                        e->ser_block_size);
-            }
+            finish();
+        }
+    }
 
-            owner->state = lba_list_t::state_ready;
-            if (callback) callback->on_lba_ready();
-            delete this;
+    void finish() {
+        // Now we can load the (more recent) inlined entries from
+        // the metablock into the index:
+        for (int32_t i = 0; i < owner->inline_lba_entries_count; ++i) {
+            lba_entry_t *e = &owner->inline_lba_entries[i];
+            owner->in_memory_index.set_block_info(
+                    e->block_id,
+                    e->recency,
+                    e->offset,
+                    e->ser_block_size);
         }
+
+        owner->state = lba_list_t::state_ready;
+        if (callback) callback->on_lba_ready();
+        delete this;
     }
 };
 
@@ -131,6 +149,21 @@ bool lba_list_t::start_existing(file_t *file, metablock_mixin_t *last_metablock,
     }
 }
 
+bool lba_list_t::load_index_snapshot(const std::string &path,
+                                     const index_snapshot_stamp_t &stamp) {
+    guarantee(state == state_unstarted);
+    guarantee(!index_from_snapshot);
+    index_from_snapshot = ::load_index_snapshot(path, stamp, &in_memory_index);
+    return index_from_snapshot;
+}
+
+void lba_list_t::save_index_snapshot(const std::string &path,
+                                     const index_snapshot_stamp_t &stamp) {
+    guarantee(state == state_gc_shutting_down);
+    guarantee(!is_any_gc_active());
+    UNUSED bool res = ::save_index_snapshot(path, stamp, &in_memory_index);
+}
+
 block_id_t lba_list_t::end_block_id() {
     rassert(state == state_ready || state == state_gc_shutting_down);
 
@@ -3,6 +3,7 @@
 #define SERIALIZER_LOG_LBA_LBA_LIST_HPP_
 
 #include <functional>
+#include <string>
 
 #include "concurrency/signal.hpp"
 #include "concurrency/auto_drainer.hpp"
@@ -12,6 +13,7 @@
 #include "serializer/log/lba/disk_format.hpp"
 #include "serializer/log/lba/in_memory_index.hpp"
 #include "serializer/log/lba/disk_structure.hpp"
+#include "serializer/log/lba/index_snapshot.hpp"
 
 class lba_start_fsm_t;
 class lba_syncer_t;
@@ -40,6 +42,18 @@ public:
     bool start_existing(file_t *dbfile, metablock_mixin_t *last_metablock,
                         ready_callback_t *cb);
 
+    // Fills the index from the snapshot at `path`, if it has the given stamp, so
+    // that `start_existing()` only has to load the LBA superblocks.  Must be called
+    // before `start_existing()`, in a coroutine.  Returns false if there was no
+    // usable snapshot.
+    bool load_index_snapshot(const std::string &path,
+                             const index_snapshot_stamp_t &stamp);
+    // Must be called between `shutdown_gc()` and `shutdown()`, in a coroutine.
+    void save_index_snapshot(const std::string &path,
+                             const index_snapshot_stamp_t &stamp);
+    // Whether the index came from a snapshot rather than from the LBA.
+    bool index_loaded_from_snapshot() const { return index_from_snapshot; }
+
     index_block_info_t get_block_info(block_id_t block);
 
     // These return individual fields of get_block_info.
@@ -104,6 +118,8 @@ private:
     scoped_ptr_t<file_account_t> gc_io_account;
 
     in_memory_index_t in_memory_index;
+    // Set if `in_memory_index` was loaded from a snapshot.
+    bool index_from_snapshot;
 
     // This is a set of inlined LBA entries which are written directly into the
     // metablock. When the array gets full, all inlined LBA entries are moved
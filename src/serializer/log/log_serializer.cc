@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <functional>
+#include <string>
 
 #include "arch/io/disk.hpp"
 #include "arch/runtime/runtime.hpp"
@@ -17,6 +18,7 @@
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
 #include "serializer/log/data_block_manager.hpp"
+#include "serializer/log/lba/index_snapshot.hpp"
 
 filepath_file_opener_t::filepath_file_opener_t(const serializer_filepath_t &filepath,
                                                io_backender_t *backender)
@@ -30,6 +32,10 @@ std::string filepath_file_opener_t::file_name() const {
     return filepath_.permanent_path();
 }
 
+std::string filepath_file_opener_t::index_snapshot_file_name() const {
+    return filepath_.permanent_path() + ".index";
+}
+
 std::string filepath_file_opener_t::temporary_file_name() const {
     return filepath_.temporary_path();
 }
@@ -116,6 +122,43 @@ void filepath_file_opener_t::open_semantic_checking_file(scoped_ptr_t<semantic_c
 
 
 
+perfmon_write_amplification_t::perfmon_write_amplification_t()
+    : thread_data(new cache_line_padded_t<write_amplification_bytes_t>[MAX_THREADS]) { }
+
+perfmon_write_amplification_t::~perfmon_write_amplification_t() {
+    delete[] thread_data;
+}
+
+void perfmon_write_amplification_t::record_user_write(int64_t bytes) {
+    thread_data[get_thread_id().threadnum].value.user_bytes += bytes;
+}
+
+void perfmon_write_amplification_t::record_gc_write(int64_t bytes) {
+    thread_data[get_thread_id().threadnum].value.gc_bytes += bytes;
+}
+
+void perfmon_write_amplification_t::get_thread_stat(write_amplification_bytes_t *stat) {
+    *stat = thread_data[get_thread_id().threadnum].value;
+}
+
+write_amplification_bytes_t perfmon_write_amplification_t::combine_stats(
+        const write_amplification_bytes_t *data) {
+    write_amplification_bytes_t combined;
+    for (int i = 0; i < get_num_threads(); ++i) {
+        combined.user_bytes += data[i].user_bytes;
+        combined.gc_bytes += data[i].gc_bytes;
+    }
+    return combined;
+}
+
+scoped_ptr_t<perfmon_result_t> perfmon_write_amplification_t::output_stat(
+        const write_amplification_bytes_t &stat) {
+    const double amplification = stat.user_bytes == 0
+        ? 0.0
+        : static_cast<double>(stat.user_bytes + stat.gc_bytes) / stat.user_bytes;
+    return make_scoped<perfmon_result_t>(strprintf("%.3f", amplification));
+}
+
 log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
     : serializer_collection(),
       pm_serializer_block_reads(secs_to_ticks(1)),
@@ -123,6 +166,8 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_block_writes(),
       pm_serializer_index_writes(secs_to_ticks(1)),
       pm_serializer_index_writes_size(secs_to_ticks(1), false),
+      pm_serializer_block_read_latency(secs_to_ticks(1)),
+      pm_serializer_block_write_latency(secs_to_ticks(1)),
       pm_extents_in_use(),
       pm_bytes_in_use(),
       pm_serializer_lba_extents(),
@@ -131,6 +176,10 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_data_extents_gced(),
       pm_serializer_old_garbage_block_bytes(),
       pm_serializer_old_total_block_bytes(),
+      pm_serializer_data_bytes_written(),
+      pm_serializer_gc_bytes_read(),
+      pm_serializer_gc_bytes_written(),
+      pm_serializer_write_amplification(),
       pm_serializer_lba_gcs(),
       parent_collection_membership(parent, &serializer_collection, "serializer"),
       stats_membership(&serializer_collection,
@@ -139,6 +188,8 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_block_writes, "serializer_block_writes",
           &pm_serializer_index_writes, "serializer_index_writes",
           &pm_serializer_index_writes_size, "serializer_index_writes_size",
+          &pm_serializer_block_read_latency, "serializer_block_read_latency",
+          &pm_serializer_block_write_latency, "serializer_block_write_latency",
           &pm_extents_in_use, "serializer_extents_in_use",
           &pm_bytes_in_use, "serializer_bytes_in_use",
           &pm_serializer_lba_extents, "serializer_lba_extents",
@@ -147,6 +198,10 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_data_extents_gced, "serializer_data_extents_gced",
           &pm_serializer_old_garbage_block_bytes, "serializer_old_garbage_block_bytes",
           &pm_serializer_old_total_block_bytes, "serializer_old_total_block_bytes",
+          &pm_serializer_data_bytes_written, "serializer_data_bytes_written",
+          &pm_serializer_gc_bytes_read, "serializer_gc_bytes_read",
+          &pm_serializer_gc_bytes_written, "serializer_gc_bytes_written",
+          &pm_serializer_write_amplification, "serializer_write_amplification",
           &pm_serializer_lba_gcs, "serializer_lba_gcs")
 { }
 
@@ -169,6 +224,9 @@ void log_serializer_t::create(serializer_file_opener_t *file_opener, static_conf
     mb_manager_t::create(file.get(), static_config.extent_size(), &metablock);
 }
 
+// Serializers that take at least this long to start log how long each phase took.
+static const time_t STARTUP_LOG_THRESHOLD_SECS = 1;
+
 /* The process of starting up the serializer is handled by the ls_start_*_fsm_t. This is not
 necessary, because there is only ever one startup process for each serializer; the serializer could
 handle its own startup process. It is done this way to make it clear which parts of the serializer
@@ -177,11 +235,11 @@ are involved in startup and which parts are not. */
 struct ls_start_existing_fsm_t :
     public static_header_read_callback_t,
     public mb_manager_t::metablock_read_callback_t,
-    public lba_list_t::ready_callback_t,
-    public thread_message_t
+    public lba_list_t::ready_callback_t
 {
     explicit ls_start_existing_fsm_t(log_serializer_t *serializer)
-        : ser(serializer), start_existing_state(state_start) {
+        : ser(serializer), start_existing_state(state_start),
+          index_snapshot_checked(false), index_from_snapshot(false) {
     }
 
     ~ls_start_existing_fsm_t() {
@@ -193,6 +251,12 @@ struct ls_start_existing_fsm_t :
         rassert(ser->state == log_serializer_t::state_unstarted);
         ser->state = log_serializer_t::state_starting_up;
 
+        start_ticks = get_ticks();
+        file_name = file_opener->file_name();
+        if (ser->dynamic_config.index_snapshot) {
+            ser->index_snapshot_path = file_opener->index_snapshot_file_name();
+        }
+
         scoped_ptr_t<file_t> dbfile;
         file_opener->open_serializer_file_existing(&dbfile);
         ser->dbfile = dbfile.release();
@@ -245,7 +309,9 @@ struct ls_start_existing_fsm_t :
                               ser, ph::_1, ph::_2));
             ser->data_block_manager
                 = new data_block_manager_t(ser->extent_manager, ser,
-                                           &ser->static_config, ser->stats.get());
+                                           &ser->static_config,
+                                           ser->dynamic_config.gc_policy,
+                                           ser->stats.get());
 
             // STATE E
             if (ser->metablock_manager->start_existing(ser->dbfile, &metablock_found, &metablock_buffer, this)) {
@@ -261,6 +327,16 @@ struct ls_start_existing_fsm_t :
         if (start_existing_state == state_start_lba) {
             // STATE G
             guarantee(metablock_found, "Could not find any valid metablock.");
+            metablock_ticks = get_ticks();
+
+            if (!ser->index_snapshot_path.empty() && !index_snapshot_checked) {
+                // Reading the snapshot blocks, so it happens in a coroutine, which
+                // comes back here.
+                index_snapshot_checked = true;
+                coro_t::spawn_sometime(std::bind(
+                    &ls_start_existing_fsm_t::load_index_snapshot, this));
+                return false;
+            }
 
             // STATE H
             if (ser->lba_index->start_existing(ser->dbfile, &metablock_buffer.lba_index_part, this)) {
@@ -275,32 +351,12 @@ struct ls_start_existing_fsm_t :
         }
 
         if (start_existing_state == state_reconstruct) {
-            ser->data_block_manager->start_reconstruct();
+            lba_ticks = get_ticks();
+            // The reconstruction yields and uses other threads, so it runs in a
+            // coroutine of its own.
             start_existing_state = state_reconstruct_ongoing;
-            num_blocks_reconstructed = 0;
-            // Fall through into state_reconstruct_ongoing
-        }
-
-        if (start_existing_state == state_reconstruct_ongoing) {
-            int batch = 0;
-            for (; num_blocks_reconstructed < ser->lba_index->end_block_id(); num_blocks_reconstructed++) {
-                flagged_off64_t offset = ser->lba_index->get_block_offset(num_blocks_reconstructed);
-                if (offset.has_value()) {
-                    ser->data_block_manager->mark_live(offset.get_value(),
-                        ser->lba_index->get_block_size(num_blocks_reconstructed));
-                }
-                ++batch;
-                if (batch >= LBA_RECONSTRUCTION_BATCH_SIZE) {
-                    call_later_on_this_thread(this);
-                    return false;
-                }
-            }
-            ser->data_block_manager->end_reconstruct();
-            ser->data_block_manager->start_existing(ser->dbfile, &metablock_buffer.data_block_manager_part);
-
-            ser->extent_manager->start_existing(&metablock_buffer.extent_manager_part);
-
-            start_existing_state = state_finish;
+            coro_t::spawn_sometime(std::bind(&ls_start_existing_fsm_t::reconstruct, this));
+            return false;
         }
 
         if (start_existing_state == state_finish) {
@@ -308,6 +364,18 @@ struct ls_start_existing_fsm_t :
             rassert(ser->state == log_serializer_t::state_starting_up);
             ser->state = log_serializer_t::state_ready;
 
+            const ticks_t end_ticks = get_ticks();
+            if (end_ticks - start_ticks >= secs_to_ticks(STARTUP_LOG_THRESHOLD_SECS)) {
+                logINF("Loaded %s in %.2fs (metablock %.2fs, LBA %.2fs%s, "
+                       "extent reconstruction %.2fs).\n",
+                       file_name.c_str(),
+                       ticks_to_secs(end_ticks - start_ticks),
+                       ticks_to_secs(metablock_ticks - start_ticks),
+                       ticks_to_secs(lba_ticks - metablock_ticks),
+                       index_from_snapshot ? " from the index snapshot" : "",
+                       ticks_to_secs(end_ticks - lba_ticks));
+            }
+
             if (to_signal_when_done) to_signal_when_done->pulse();
 
             delete this;
@@ -339,9 +407,38 @@ struct ls_start_existing_fsm_t :
         next_starting_up_step();
     }
 
-    void on_thread_switch() {
-        // Continue a previously started LBA reconstruction
+    void load_index_snapshot() {
+        rassert(start_existing_state == state_start_lba);
+        const index_snapshot_stamp_t stamp = make_index_snapshot_stamp(
+            ser->metablock_manager->latest_version(), metablock_buffer.lba_index_part);
+        index_from_snapshot
+            = ser->lba_index->load_index_snapshot(ser->index_snapshot_path, stamp);
+        // The snapshot stops being valid with our first write.  We remove it right
+        // away, so that nobody could load it after a crash.
+        remove_index_snapshot(ser->index_snapshot_path);
+        next_starting_up_step();
+    }
+
+    void reconstruct() {
         rassert(start_existing_state == state_reconstruct_ongoing);
+        ser->data_block_manager->start_reconstruct();
+        const block_id_t end_block_id = ser->lba_index->end_block_id();
+        for (block_id_t block_id = 0; block_id < end_block_id; ++block_id) {
+            flagged_off64_t offset = ser->lba_index->get_block_offset(block_id);
+            if (offset.has_value()) {
+                ser->data_block_manager->mark_live(offset.get_value(),
+                    ser->lba_index->get_block_size(block_id));
+            }
+            if ((block_id + 1) % LBA_RECONSTRUCTION_BATCH_SIZE == 0) {
+                coro_t::yield();
+            }
+        }
+        ser->data_block_manager->end_reconstruct();
+        ser->data_block_manager->start_existing(ser->dbfile, &metablock_buffer.data_block_manager_part);
+
+        ser->extent_manager->start_existing(&metablock_buffer.extent_manager_part);
+
+        start_existing_state = state_finish;
         next_starting_up_step();
     }
 
@@ -362,9 +459,14 @@ struct ls_start_existing_fsm_t :
         state_done
     } start_existing_state;
 
-    // When in state_reconstruct_ongoing, we keep track of how many blocks we
-    // already have reconstructed.
-    block_id_t num_blocks_reconstructed;
+    // For the startup time breakdown in the log.
+    std::string file_name;
+    ticks_t start_ticks;
+    ticks_t metablock_ticks;
+    ticks_t lba_ticks;
+
+    bool index_snapshot_checked;
+    bool index_from_snapshot;
 
     bool metablock_found;
     log_serializer_t::metablock_t metablock_buffer;
@@ -420,6 +522,7 @@ buf_ptr_t log_serializer_t::block_read(const counted_t<ls_block_token_pointee_t>
 
     ticks_t pm_time;
     stats->pm_serializer_block_reads.begin(&pm_time);
+    block_pm_latency latency(&stats->pm_serializer_block_read_latency);
 
     buf_ptr_t ret = data_block_manager->read(token->offset_, token->block_size(),
                                            io_account);
@@ -618,7 +721,9 @@ log_serializer_t::block_writes(const std::vector<buf_write_info_t> &write_infos,
     stats->pm_serializer_block_writes += write_infos.size();
 
     std::vector<counted_t<ls_block_token_pointee_t> > result
-        = data_block_manager->many_writes(write_infos, io_account, cb);
+        = data_block_manager->many_writes(write_infos,
+                                          data_block_manager_t::write_stream_t::user,
+                                          io_account, cb);
     guarantee(result.size() == write_infos.size());
     return result;
 }
@@ -819,6 +924,16 @@ bool log_serializer_t::next_shutdown_step() {
     rassert(expecting_no_more_tokens);
 
     if (shutdown_state == shutdown_waiting_on_block_tokens) {
+        shutdown_state = shutdown_writing_index_snapshot;
+        if (!index_snapshot_path.empty()) {
+            coro_t::spawn_sometime(std::bind(
+                &log_serializer_t::write_index_snapshot_and_continue_shutdown, this));
+            shutdown_in_one_shot = false;
+            return false;
+        }
+    }
+
+    if (shutdown_state == shutdown_writing_index_snapshot) {
         lba_index->shutdown();
         metablock_manager->shutdown();
         extent_manager->shutdown();
@@ -862,6 +977,18 @@ bool log_serializer_t::next_shutdown_step() {
     return true; // make compiler happy
 }
 
+void log_serializer_t::write_index_snapshot_and_continue_shutdown() {
+    // All index writes have finished, so the index matches the last metablock we
+    // wrote.
+    lba_list_t::metablock_mixin_t lba_part;
+    bzero(&lba_part, sizeof(lba_part));
+    lba_index->prepare_metablock(&lba_part);
+    lba_index->save_index_snapshot(
+        index_snapshot_path,
+        make_index_snapshot_stamp(metablock_manager->latest_version(), lba_part));
+    next_shutdown_step();
+}
+
 void log_serializer_t::delete_dbfile_and_continue_shutdown() {
     rassert(dbfile != NULL);
     delete dbfile;
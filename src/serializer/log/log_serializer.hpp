@@ -64,6 +64,9 @@ public:
     // The path of the final position of the file.
     std::string file_name() const;
 
+    // file_name() with ".index" appended.
+    std::string index_snapshot_file_name() const;
+
     void open_serializer_file_create_temporary(scoped_ptr_t<file_t> *file_out);
     void move_serializer_file_to_permanent_location();
     void open_serializer_file_existing(scoped_ptr_t<file_t> *file_out);
@@ -147,6 +150,11 @@ public:
     bool get_delete_bit(block_id_t id);
     counted_t<ls_block_token_pointee_t> index_read(block_id_t block_id);
 
+    // Whether startup took the index from the index snapshot rather than the LBA.
+    bool index_loaded_from_snapshot() const {
+        return lba_index->index_loaded_from_snapshot();
+    }
+
     buf_ptr_t block_read(const counted_t<ls_block_token_pointee_t> &token,
                        file_account_t *io_account);
 
@@ -187,6 +195,7 @@ private:
     bool shutdown(cond_t *cb);
     bool next_shutdown_step();
 
+    void write_index_snapshot_and_continue_shutdown();
     void delete_dbfile_and_continue_shutdown();
 
     virtual void on_datablock_manager_shutdown();
@@ -236,6 +245,7 @@ private:
         shutdown_waiting_on_serializer,
         shutdown_waiting_on_datablock_manager,
         shutdown_waiting_on_block_tokens,
+        shutdown_writing_index_snapshot,
         shutdown_waiting_on_dbfile_destruction,
     } shutdown_state;
     bool shutdown_in_one_shot;
@@ -249,6 +259,8 @@ private:
     } state;
 
     file_t *dbfile;
+    // Empty unless `dynamic_config.index_snapshot` is set.
+    std::string index_snapshot_path;
 
     extent_manager_t *extent_manager;
     mb_manager_t *metablock_manager;
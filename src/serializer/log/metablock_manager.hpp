@@ -102,6 +102,9 @@ public:
 
     void shutdown();
 
+    // The version of the metablock that we last found or wrote.
+    metablock_version_t latest_version() const { return next_version_number - 1; }
+
     void read_next_metablock();
 
 private:
@@ -4,6 +4,33 @@
 
 #include "perfmon/perfmon.hpp"
 
+struct write_amplification_bytes_t {
+    write_amplification_bytes_t() : user_bytes(0), gc_bytes(0) { }
+    int64_t user_bytes;
+    int64_t gc_bytes;
+};
+
+/* Outputs the write amplification of the data block GC, that is, how many bytes we
+write for every byte of data that the serializer's users write, or 0 if they haven't
+written anything yet. */
+class perfmon_write_amplification_t
+    : public perfmon_perthread_t<write_amplification_bytes_t> {
+public:
+    perfmon_write_amplification_t();
+    ~perfmon_write_amplification_t();
+    void record_user_write(int64_t bytes);
+    void record_gc_write(int64_t bytes);
+
+private:
+    void get_thread_stat(write_amplification_bytes_t *);
+    write_amplification_bytes_t combine_stats(const write_amplification_bytes_t *);
+    scoped_ptr_t<perfmon_result_t> output_stat(const write_amplification_bytes_t &);
+
+    cache_line_padded_t<write_amplification_bytes_t> *thread_data;
+
+    DISABLE_COPYING(perfmon_write_amplification_t);
+};
+
 struct log_serializer_stats_t {
     perfmon_collection_t serializer_collection;
     explicit log_serializer_stats_t(perfmon_collection_t *perfmon_collection);
@@ -13,6 +40,10 @@ struct log_serializer_stats_t {
     perfmon_counter_t pm_serializer_block_writes;
     perfmon_duration_sampler_t pm_serializer_index_writes;
     perfmon_sampler_t pm_serializer_index_writes_size;
+    /* How long block reads take, and how long it takes for a batch of block writes
+    of the serializer's users to reach the disk. */
+    perfmon_latency_histogram_t pm_serializer_block_read_latency;
+    perfmon_latency_histogram_t pm_serializer_block_write_latency;
 
     /* used in serializer/log/extent_manager.cc */
     perfmon_counter_t pm_extents_in_use;
@@ -27,6 +58,12 @@ struct log_serializer_stats_t {
     perfmon_counter_t pm_serializer_data_extents_gced;
     perfmon_counter_t pm_serializer_old_garbage_block_bytes;
     perfmon_counter_t pm_serializer_old_total_block_bytes;
+    /* Bytes of data blocks that the serializer's users wrote, and that the data
+    block GC read and rewrote. */
+    perfmon_counter_t pm_serializer_data_bytes_written;
+    perfmon_counter_t pm_serializer_gc_bytes_read;
+    perfmon_counter_t pm_serializer_gc_bytes_written;
+    perfmon_write_amplification_t pm_serializer_write_amplification;
 
     /* used in serializer/log/lba/lba_list.cc */
     perfmon_counter_t pm_serializer_lba_gcs;
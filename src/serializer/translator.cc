@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "serializer/translator.hpp"
 
+#include <algorithm>
+
 #include "errors.hpp"
 #include <boost/bind.hpp>
 
@@ -221,7 +223,8 @@ translator_serializer_t::translator_serializer_t(serializer_t *_inner, int _mod_
 }
 
 file_account_t *translator_serializer_t::make_io_account(int priority, int outstanding_requests_limit) {
-    return inner->make_io_account(priority, outstanding_requests_limit);
+    return inner->make_io_account(std::max(1, priority / mod_count),
+                                  outstanding_requests_limit);
 }
 
 void translator_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
@@ -110,7 +110,9 @@ public:
     are greater than or equal to 'min' and such that ((id - min) % mod_count) == mod_id. */
     translator_serializer_t(serializer_t *inner, int mod_count, int mod_id, config_block_id_t cfgid);
 
-    /* Allocates a new io account for the underlying file */
+    /* Allocates a new io account for the underlying file.  The file is shared by
+    `mod_count` translator serializers, so the account gets their share of
+    `priority`. */
     file_account_t *make_io_account(int priority, int outstanding_requests_limit);
 
     void index_write(new_mutex_in_line_t *mutex_acq,
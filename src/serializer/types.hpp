@@ -169,6 +169,10 @@ public:
     // real files, this should be the filepath.
     virtual std::string file_name() const = 0;
 
+    // Where the serializer may keep a snapshot of its index between runs, or an
+    // empty string if it may not keep one.
+    virtual std::string index_snapshot_file_name() const { return std::string(); }
+
     virtual void open_serializer_file_create_temporary(scoped_ptr_t<file_t> *file_out) = 0;
     virtual void move_serializer_file_to_permanent_location() = 0;
     virtual void open_serializer_file_existing(scoped_ptr_t<file_t> *file_out) = 0;
@@ -2,6 +2,7 @@
 #include "buffer_cache/alt/alt.hpp"
 #include "buffer_cache/alt/blob.hpp"
 #include "buffer_cache/alt/cache_balancer.hpp"
+#include "config/args.hpp"
 #include "containers/buffer_group.hpp"
 #include "containers/scoped.hpp"
 #include "math.hpp"
@@ -269,7 +270,7 @@ void combinations_test(cache_t *cache) {
 
 void run_tests(cache_t *cache) {
     // The tests above hard-code constants related to these numbers.
-    EXPECT_EQ(251, blob::btree_maxreflen);
+    EXPECT_EQ(251, blob::btree_maxreflen(cache->max_block_size()));
     EXPECT_EQ(4u, sizeof(block_magic_t));
     const int size_sans_magic = expected_cache_block_size - sizeof(block_magic_t);
     EXPECT_EQ(size_sans_magic, blob::stepsize(cache->max_block_size(), 1));
@@ -297,4 +298,19 @@ TPTEST(BlobTest, all_tests) {
     run_tests(&cache);
 }
 
+TEST(BlobTest, BtreeMaxreflen) {
+    EXPECT_EQ(251, blob::btree_maxreflen(
+                  max_block_size_t::unsafe_make(DEFAULT_BTREE_BLOCK_SIZE)));
+
+    // Tables with 16KB blocks keep values of a few kilobytes inline.
+    const int maxreflen_16k
+        = blob::btree_maxreflen(max_block_size_t::unsafe_make(16 * KILOBYTE));
+    EXPECT_TRUE(blob::size_would_be_small(3 * KILOBYTE, maxreflen_16k));
+    EXPECT_FALSE(blob::size_would_be_small(8 * KILOBYTE, maxreflen_16k));
+
+    // The small size field of a ref has at most 16 bits.
+    EXPECT_GE(UINT16_MAX, blob::btree_maxreflen(
+                  max_block_size_t::unsafe_make(MAX_BTREE_BLOCK_SIZE)));
+}
+
 }  // namespace unittest
@@ -21,7 +21,7 @@ public:
         heartbeat_manager(&heartbeat_manager_client),
         heartbeat_manager_client_run(&heartbeat_manager_client, &heartbeat_manager),
         mailbox_manager_client(&message_multiplexer, 'M'),
-        mailbox_manager(&mailbox_manager_client),
+        mailbox_manager(&mailbox_manager_client, &mailbox_manager_perfmon_collection),
         mailbox_manager_client_run(&mailbox_manager_client, &mailbox_manager),
         echo_writer(&mailbox_manager, initial),
         directory_manager_client(&message_multiplexer, 'D'),
@@ -44,6 +44,7 @@ public:
     heartbeat_manager_t heartbeat_manager;
     message_multiplexer_t::client_t::run_t heartbeat_manager_client_run;
     message_multiplexer_t::client_t mailbox_manager_client;
+    perfmon_collection_t mailbox_manager_perfmon_collection;
     mailbox_manager_t mailbox_manager;
     message_multiplexer_t::client_t::run_t mailbox_manager_client_run;
     directory_echo_writer_t<metadata_t> echo_writer;
@@ -218,7 +218,7 @@ inline std::string mc_key_gen() {
 class simple_mailbox_cluster_t {
 public:
     simple_mailbox_cluster_t() :
-        mailbox_manager(&connectivity_cluster),
+        mailbox_manager(&connectivity_cluster, &mailbox_manager_perfmon_collection),
         connectivity_cluster_run(&connectivity_cluster,
                                  get_unittest_addresses(),
                                  peer_address_t(),
@@ -235,6 +235,7 @@ public:
     }
 private:
     connectivity_cluster_t connectivity_cluster;
+    perfmon_collection_t mailbox_manager_perfmon_collection;
     mailbox_manager_t mailbox_manager;
     connectivity_cluster_t::run_t connectivity_cluster_run;
 };
@@ -1,6 +1,14 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "containers/archive/buffer_group_stream.hpp"
 #include "containers/archive/string_stream.hpp"
+#include "containers/buffer_group.hpp"
+#include "containers/scoped.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "unittest/gtest.hpp"
 
@@ -64,6 +72,249 @@ TEST(DatumTest, NumericSerialization) {
     test_datum_serialization(make_counted<ql::datum_t>(std::move(vec)));
 }
 
+counted_t<const ql::datum_t> make_test_object(size_t num_fields, int depth) {
+    std::map<std::string, counted_t<const ql::datum_t> > fields;
+    for (size_t i = 0; i < num_fields; ++i) {
+        fields[strprintf("field%zu", i)] = depth == 0
+            ? make_counted<const ql::datum_t>(static_cast<double>(i))
+            : make_test_object(num_fields, depth - 1);
+    }
+    return make_counted<const ql::datum_t>(std::move(fields));
+}
+
+TEST(DatumTest, ObjectFields) {
+    counted_t<const ql::datum_t> one = make_counted<const ql::datum_t>(1.0);
+    counted_t<const ql::datum_t> two = make_counted<const ql::datum_t>(2.0);
+
+    ql::datum_object_t obj;
+    ASSERT_FALSE(obj.add("b", one, ql::NOCLOBBER));
+    ASSERT_FALSE(obj.add("a", one, ql::NOCLOBBER));
+    ASSERT_FALSE(obj.add("c", one, ql::NOCLOBBER));
+    ASSERT_TRUE(obj.add("b", two, ql::NOCLOBBER));
+    ASSERT_EQ(one, obj.find("b")->second);
+    ASSERT_TRUE(obj.add("b", two, ql::CLOBBER));
+    ASSERT_EQ(two, obj.find("b")->second);
+
+    std::string keys;
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        keys += it->first;
+    }
+    ASSERT_EQ("abc", keys);
+
+    ASSERT_TRUE(obj.erase("a"));
+    ASSERT_FALSE(obj.erase("a"));
+    ASSERT_EQ(0u, obj.count("a"));
+    ASSERT_TRUE(obj.find("a") == obj.end());
+    ASSERT_EQ(2u, obj.size());
+
+    ASSERT_FALSE(obj.append("a", counted_t<const ql::datum_t>(one)));
+    ASSERT_TRUE(obj.append("d", counted_t<const ql::datum_t>(one)));
+    ASSERT_EQ(3u, obj.size());
+
+    std::vector<ql::datum_object_t::value_type> fields;
+    fields.push_back(ql::datum_object_t::value_type("y", one));
+    fields.push_back(ql::datum_object_t::value_type("x", two));
+    std::string duplicate_key;
+    ASSERT_TRUE(obj.assign_unsorted(std::move(fields), &duplicate_key));
+    ASSERT_EQ("x", obj.begin()->first);
+    ASSERT_EQ(2u, obj.size());
+
+    fields.clear();
+    fields.push_back(ql::datum_object_t::value_type("y", one));
+    fields.push_back(ql::datum_object_t::value_type("y", two));
+    ASSERT_FALSE(obj.assign_unsorted(std::move(fields), &duplicate_key));
+    ASSERT_EQ("y", duplicate_key);
+}
+
+struct allocation_count_t {
+    allocation_count_t() : allocations(0), bytes(0) { }
+    size_t allocations;
+    size_t bytes;
+};
+
+// Counts what a container allocates for itself.  (The strings in it use their own
+// allocator.)
+template <class T>
+class counting_allocator_t : public std::allocator<T> {
+public:
+    template <class U>
+    struct rebind {
+        typedef counting_allocator_t<U> other;
+    };
+
+    explicit counting_allocator_t(allocation_count_t *_count) : count(_count) { }
+    template <class U>
+    counting_allocator_t(const counting_allocator_t<U> &other)  // NOLINT(runtime/explicit)
+        : std::allocator<T>(other), count(other.count) { }
+
+    T *allocate(size_t n, const void * = NULL) {
+        ++count->allocations;
+        count->bytes += n * sizeof(T);
+        return std::allocator<T>::allocate(n);
+    }
+    void deallocate(T *p, size_t n) {
+        std::allocator<T>::deallocate(p, n);
+    }
+
+    allocation_count_t *count;
+};
+
+// Compares what an object's fields take as a `datum_object_t` with what they took
+// in the `std::map` that `datum_t` used to use.  Both hold the same strings.
+TEST(DatumTest, ObjectRepresentationFootprint) {
+    const size_t num_fields = 50;
+    counted_t<const ql::datum_t> value = make_counted<const ql::datum_t>(1.0);
+
+    typedef counting_allocator_t<std::pair<const std::string,
+                                           counted_t<const ql::datum_t> > >
+        map_allocator_t;
+    typedef std::map<std::string, counted_t<const ql::datum_t>,
+                     std::less<std::string>, map_allocator_t> old_map_t;
+    allocation_count_t map_count;
+    const map_allocator_t map_allocator(&map_count);
+    old_map_t old_map(std::less<std::string>(), map_allocator);
+    std::map<std::string, counted_t<const ql::datum_t> > map;
+    for (size_t i = 0; i < num_fields; ++i) {
+        std::string key = strprintf("some_field_%zu", i);
+        old_map[key] = value;
+        map[key] = value;
+    }
+    // Every field is a node of its own.
+    ASSERT_EQ(num_fields, map_count.allocations);
+
+    // A `datum_object_t` allocates whenever its capacity changes, so we count its
+    // allocations by watching the capacity while we build it field by field.
+    allocation_count_t object_count;
+    ql::datum_object_t object;
+    size_t capacity = object.capacity();
+    auto note_capacity = [&]() {
+        if (object.capacity() != capacity) {
+            capacity = object.capacity();
+            ++object_count.allocations;
+        }
+    };
+    object.reserve(num_fields);
+    note_capacity();
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        ASSERT_TRUE(object.append(std::string(it->first),
+                                  counted_t<const ql::datum_t>(it->second)));
+        note_capacity();
+    }
+    object_count.bytes = object.capacity() * sizeof(ql::datum_object_t::value_type);
+    EXPECT_EQ(1u, object_count.allocations);
+    EXPECT_EQ(num_fields * sizeof(ql::datum_object_t::value_type), object_count.bytes);
+
+    // Converting a map doesn't overallocate either.
+    ql::datum_object_t converted(std::move(map));
+    EXPECT_EQ(num_fields, converted.size());
+    EXPECT_EQ(num_fields, converted.capacity());
+
+    // A map node carries its tree links on top of the field.
+    EXPECT_LT(object_count.allocations, map_count.allocations);
+    EXPECT_LT(object_count.bytes, map_count.bytes);
+    EXPECT_GE(map_count.bytes - object_count.bytes, num_fields * 3 * sizeof(void *));
+}
+
+TEST(DatumTest, IndexedObjectSerialization) {
+    for (size_t num_fields = 0; num_fields < 10; ++num_fields) {
+        counted_t<const ql::datum_t> datum = make_test_object(num_fields, 2);
+
+        write_message_t wm;
+        ql::datum_serialize(&wm, datum, ql::datum_serialization_format_t::INDEXED);
+        ASSERT_EQ(ql::datum_serialized_size(
+                      datum, ql::datum_serialization_format_t::INDEXED),
+                  wm.size());
+        string_stream_t write_stream;
+        ASSERT_EQ(0, send_write_message(&write_stream, &wm));
+        const std::string serialized = write_stream.str();
+
+        // Split the serialized datum up like a blob would be.
+        const_buffer_group_t group;
+        for (size_t offset = 0; offset < serialized.size(); offset += 7) {
+            group.add_buffer(std::min<size_t>(7, serialized.size() - offset),
+                             serialized.data() + offset);
+        }
+
+        buffer_group_read_stream_t read_stream(&group);
+        counted_t<const ql::datum_t> deserialized_datum;
+        ASSERT_EQ(archive_result_t::SUCCESS,
+                  ql::datum_deserialize(&read_stream, &deserialized_datum));
+        ASSERT_TRUE(read_stream.entire_stream_consumed());
+        ASSERT_EQ(datum, deserialized_datum);
+
+        for (size_t i = 0; i < num_fields; ++i) {
+            const std::string key = strprintf("field%zu", i);
+            counted_t<const ql::datum_t> field;
+            ASSERT_EQ(archive_result_t::SUCCESS,
+                      ql::datum_deserialize_field(&group, key, &field));
+            ASSERT_TRUE(field.has());
+            ASSERT_EQ(datum->get(key), field);
+        }
+
+        counted_t<const ql::datum_t> missing;
+        ASSERT_EQ(archive_result_t::SUCCESS,
+                  ql::datum_deserialize_field(&group, "nonexistent", &missing));
+        ASSERT_FALSE(missing.has());
+    }
+}
+
+// A `datum_region_source_t` over a string that counts the bytes it hands out.
+class counting_region_source_t : public ql::datum_region_source_t {
+public:
+    explicit counting_region_source_t(const std::string &_data)
+        : data(_data), bytes_exposed(0) { }
+
+    uint64_t size() {
+        return data.size();
+    }
+
+    const const_buffer_group_t *expose(uint64_t offset, uint64_t length) {
+        EXPECT_LE(offset + length, data.size());
+        bytes_exposed += length;
+        group.init(new const_buffer_group_t);
+        group->add_buffer(length, data.data() + offset);
+        return group.get();
+    }
+
+    const std::string data;
+    uint64_t bytes_exposed;
+
+private:
+    scoped_ptr_t<const_buffer_group_t> group;
+};
+
+TEST(DatumTest, IndexedObjectFieldReadsOnlyItsRange) {
+    std::map<std::string, counted_t<const ql::datum_t> > fields;
+    for (size_t i = 0; i < 8; ++i) {
+        fields[strprintf("big%zu", i)]
+            = make_counted<const ql::datum_t>(std::string(1000, 'x'));
+    }
+    fields["small"] = make_counted<const ql::datum_t>(1.0);
+    counted_t<const ql::datum_t> datum
+        = make_counted<const ql::datum_t>(std::move(fields));
+
+    write_message_t wm;
+    ql::datum_serialize(&wm, datum, ql::datum_serialization_format_t::INDEXED);
+    string_stream_t write_stream;
+    ASSERT_EQ(0, send_write_message(&write_stream, &wm));
+
+    counting_region_source_t source(write_stream.str());
+    counted_t<const ql::datum_t> field;
+    ASSERT_EQ(archive_result_t::SUCCESS,
+              ql::datum_deserialize_field(&source, "small", &field));
+    ASSERT_TRUE(field.has());
+    ASSERT_EQ(1.0, field->as_num());
+    // The table, a few keys and the small value, but none of the big values.
+    EXPECT_LT(source.bytes_exposed, 1000u);
+
+    counting_region_source_t missing_source(write_stream.str());
+    counted_t<const ql::datum_t> missing;
+    ASSERT_EQ(archive_result_t::SUCCESS,
+              ql::datum_deserialize_field(&missing_source, "nonexistent", &missing));
+    ASSERT_FALSE(missing.has());
+    EXPECT_LT(missing_source.bytes_exposed, 1000u);
+}
+
 
 
 }  // namespace unittest
@@ -18,9 +18,11 @@ serializer_filepath_t dbq_serializer_path() {
     return manual_serializer_filepath(DBQ_TEST_PATH, std::string(DBQ_TEST_PATH) + ".create");
 }
 
-void run_many_ints_test() {
+void run_many_ints_test(io_backend_t io_backend) {
     static const int NUM_ELTS_IN_QUEUE = 1000;
-    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired,
+                                DEFAULT_MAX_CONCURRENT_IO_REQUESTS,
+                                io_backend);
 
     const serializer_filepath_t serializer_path = dbq_serializer_path();
 
@@ -42,7 +44,12 @@ void run_many_ints_test() {
 }
 
 TEST(DiskBackedQueue, ManyInts) {
-    unittest::run_in_thread_pool(&run_many_ints_test, 2);
+    unittest::run_in_thread_pool(std::bind(&run_many_ints_test, io_backend_t::pool), 2);
+}
+
+// Falls back to the pool backend if the kernel doesn't support io_uring.
+TEST(DiskBackedQueue, ManyIntsUring) {
+    unittest::run_in_thread_pool(std::bind(&run_many_ints_test, io_backend_t::uring), 2);
 }
 
 void run_big_values_test() {
@@ -10,9 +10,11 @@
 
 namespace unittest {
 
-mock_file_t::mock_file_t(mode_t mode, std::vector<char> *data) : mode_(mode), data_(data) {
+mock_file_t::mock_file_t(mode_t mode, std::vector<char> *data, mock_file_stats_t *stats)
+    : mode_(mode), data_(data), stats_(stats) {
     guarantee(mode != 0);
     guarantee(data_ != NULL);
+    guarantee(stats_ != NULL);
 }
 mock_file_t::~mock_file_t() { }
 
@@ -33,6 +35,7 @@ void mock_file_t::set_file_size_at_least(int64_t size) {
 void mock_file_t::read_async(int64_t offset, size_t length, void *buf,
                              UNUSED file_account_t *account, linux_iocallback_t *cb) {
     guarantee(mode_ & mode_read);
+    ++stats_->reads;
     verify_aligned_file_access(data_->size(), offset, length, buf);
     guarantee(!(offset < 0
                 || static_cast<uint64_t>(offset) > SIZE_MAX - length
@@ -71,6 +74,20 @@ void mock_file_t::writev_async(int64_t offset, size_t length, scoped_array_t<iov
     write_async(offset, length, buf.get(), account, cb, NO_DATASYNCS);
 }
 
+void mock_file_t::readv_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
+                              UNUSED file_account_t *account, linux_iocallback_t *cb) {
+    guarantee(mode_ & mode_read);
+    ++stats_->readvs;
+    guarantee(!(offset < 0
+                || static_cast<uint64_t>(offset) > SIZE_MAX - length
+                || offset + length > data_->size()));
+
+    iovec sourcevec[1] = { { data_->data() + offset, length } };
+    fill_bufs_from_source(bufs.data(), bufs.size(), sourcevec, 1, 0);
+
+    coro_t::spawn_sometime(std::bind(&linux_iocallback_t::on_io_complete, cb));
+}
+
 bool mock_file_t::coop_lock_and_check() {
     // We don't actually implement the locking behavior.
     return true;
@@ -99,7 +116,7 @@ std::string mock_file_opener_t::file_name() const {
 
 void mock_file_opener_t::open_serializer_file_create_temporary(scoped_ptr_t<file_t> *file_out) {
     ASSERT_EQ(no_file, file_existence_state_);
-    file_out->init(new mock_file_t(mock_file_t::mode_rw, &file_));
+    file_out->init(new mock_file_t(mock_file_t::mode_rw, &file_, &stats_));
     file_existence_state_ = temporary_file;
 }
 
@@ -110,7 +127,7 @@ void mock_file_opener_t::move_serializer_file_to_permanent_location() {
 
 void mock_file_opener_t::open_serializer_file_existing(scoped_ptr_t<file_t> *file_out) {
     ASSERT_TRUE(file_existence_state_ == temporary_file || file_existence_state_ == permanent_file);
-    file_out->init(new mock_file_t(mock_file_t::mode_rw, &file_));
+    file_out->init(new mock_file_t(mock_file_t::mode_rw, &file_, &stats_));
 }
 
 void mock_file_opener_t::unlink_serializer_file() {
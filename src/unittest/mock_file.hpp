@@ -12,12 +12,19 @@
 
 namespace unittest {
 
+// How many reads the mock files of a `mock_file_opener_t` have been asked for.
+struct mock_file_stats_t {
+    mock_file_stats_t() : reads(0), readvs(0) { }
+    int reads;
+    int readvs;
+};
+
 class mock_file_t : public file_t {
 public:
     // That mode_rw == (mode_read | mode_write) is no accident.
     enum mode_t { mode_read = 1, mode_write = 2, mode_rw = 3 };
 
-    mock_file_t(mode_t mode, std::vector<char> *data);
+    mock_file_t(mode_t mode, std::vector<char> *data, mock_file_stats_t *stats);
     ~mock_file_t();
 
     int64_t get_file_size();
@@ -31,6 +38,8 @@ public:
                      wrap_in_datasyncs_t wrap_in_datasyncs);
     void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                       file_account_t *account, linux_iocallback_t *cb);
+    void readv_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
+                     file_account_t *account, linux_iocallback_t *cb);
 
     void *create_account(UNUSED int priority, UNUSED int outstanding_requests_limit) {
         // We don't care about accounts.  Return an arbitrary non-null pointer.
@@ -46,6 +55,7 @@ public:
 private:
     mode_t mode_;
     std::vector<char> *data_;
+    mock_file_stats_t *stats_;
 
     DISABLE_COPYING(mock_file_t);
 };
@@ -80,10 +90,13 @@ public:
     void open_semantic_checking_file(scoped_ptr_t<semantic_checking_file_t> *file_out);
 #endif
 
+    const mock_file_stats_t &stats() const { return stats_; }
+
 private:
     enum existence_state_t { no_file, temporary_file, permanent_file, unlinked_file };
     existence_state_t file_existence_state_;
     std::vector<char> file_;
+    mock_file_stats_t stats_;
 #ifdef SEMANTIC_SERIALIZER_CHECK
     std::vector<char> semantic_checking_file_;
 #endif
@@ -317,8 +317,11 @@ TPTEST(PageTest, WriteWaitForFlush, 4) {
 
 class bigger_test_t {
 public:
-    explicit bigger_test_t(uint64_t _memory_limit)
-        : memory_limit(_memory_limit), mock(), c(NULL),
+    explicit bigger_test_t(
+            uint64_t _memory_limit,
+            eviction_policy_kind_t _eviction_policy = eviction_policy_kind_t::sample)
+        : memory_limit(_memory_limit), eviction_policy(_eviction_policy),
+          mock(), c(NULL),
           txn1_ptr(NULL), txn2_ptr(NULL) {
         for (size_t i = 0; i < b_len; ++i) {
             b[i] = NULL_BLOCK_ID;
@@ -327,7 +330,7 @@ public:
 
     void run() {
         {
-            dummy_cache_balancer_t balancer(memory_limit);
+            dummy_cache_balancer_t balancer(memory_limit, eviction_policy);
             test_cache_t cache(mock.ser.get(), &balancer, mock.throttler.get());
             auto_drainer_t drain;
             c = &cache;
@@ -373,7 +376,7 @@ public:
         c = NULL;
 
         {
-            dummy_cache_balancer_t balancer(memory_limit);
+            dummy_cache_balancer_t balancer(memory_limit, eviction_policy);
             test_cache_t cache(mock.ser.get(), &balancer, mock.throttler.get());
             auto_drainer_t drain;
             c = &cache;
@@ -385,7 +388,7 @@ public:
         c = NULL;
 
         {
-            dummy_cache_balancer_t balancer(memory_limit);
+            dummy_cache_balancer_t balancer(memory_limit, eviction_policy);
             test_cache_t cache(mock.ser.get(), &balancer, mock.throttler.get());
             c = &cache;
             auto txn = make_scoped<test_txn_t>(c);
@@ -1132,6 +1135,7 @@ private:
     }
 
     const uint64_t memory_limit;
+    const eviction_policy_kind_t eviction_policy;
 
     mock_ser_t mock;
     test_cache_t *c;
@@ -1182,4 +1186,14 @@ TPTEST(PageTest, BiggerTestNoMemory, 4) {
     test.run();
 }
 
+TPTEST(PageTest, BiggerTestTightMemoryTwoQueue, 4) {
+    bigger_test_t test(8192, eviction_policy_kind_t::two_queue);
+    test.run();
+}
+
+TPTEST(PageTest, BiggerTestNoMemoryTwoQueue, 4) {
+    bigger_test_t test(0, eviction_policy_kind_t::two_queue);
+    test.run();
+}
+
 }  // namespace unittest
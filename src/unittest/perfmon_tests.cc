@@ -57,4 +57,55 @@ TEST(PerfmonTest, StddevComputation) {
     }
 }
 
+TEST(PerfmonTest, LatencyHistogramPercentiles) {
+    {
+        latency_histogram_t histogram;
+        EXPECT_EQ(0u, histogram.count());
+        EXPECT_EQ(0u, histogram.percentile(0.99));
+    }
+
+    {
+        // Small latencies get a bucket each.
+        latency_histogram_t histogram;
+        for (ticks_t i = 0; i < 64; ++i) {
+            histogram.record(i);
+        }
+        EXPECT_EQ(64u, histogram.count());
+        EXPECT_EQ(31u, histogram.percentile(0.5));
+        EXPECT_EQ(63u, histogram.percentile(1.0));
+    }
+
+    {
+        // Larger ones are rounded up to the end of their bucket, by at most a
+        // thirty-second of their value.
+        latency_histogram_t histogram;
+        const ticks_t n = 100000;
+        for (ticks_t i = 1; i <= n; ++i) {
+            histogram.record(i);
+        }
+        EXPECT_EQ(n, histogram.count());
+        EXPECT_EQ(n, histogram.max());
+        const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+        for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); ++i) {
+            const double expected = quantiles[i] * n;
+            EXPECT_LE(expected, histogram.percentile(quantiles[i]));
+            EXPECT_GE(expected * (1 + 1.0 / 32), histogram.percentile(quantiles[i]));
+        }
+        EXPECT_EQ(n, histogram.percentile(1.0));
+    }
+
+    {
+        // Latencies past the last bucket still report their exact maximum, and
+        // merging histograms keeps everything.
+        latency_histogram_t a, b;
+        a.record(10);
+        b.record(secs_to_ticks(1000));
+        a.aggregate(b);
+        EXPECT_EQ(2u, a.count());
+        EXPECT_EQ(secs_to_ticks(1000), a.max());
+        EXPECT_EQ(10u, a.percentile(0.5));
+        EXPECT_EQ(secs_to_ticks(1000), a.percentile(1.0));
+    }
+}
+
 }  // namespace unittest
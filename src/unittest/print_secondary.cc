@@ -24,3 +24,77 @@ TEST(PrintSecondary, Mangle) {
                 "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb");
 }
 };
+
+namespace unittest {
+
+std::string binary_secondary(counted_t<const ql::datum_t> d) {
+    return ql::datum_t::extract_secondary(
+        d->print_secondary(ql::skey_version_t::BINARY, store_key_t("pk")));
+}
+
+TEST(PrintSecondary, BinaryOrder) {
+    std::vector<counted_t<const ql::datum_t> > data;
+    data.push_back(make_counted<const ql::datum_t>(
+        std::vector<counted_t<const ql::datum_t> >()));
+    data.push_back(make_counted<const ql::datum_t>(
+        std::vector<counted_t<const ql::datum_t> >{
+            make_counted<const ql::datum_t>(1.0)}));
+    data.push_back(make_counted<const ql::datum_t>(
+        std::vector<counted_t<const ql::datum_t> >{
+            make_counted<const ql::datum_t>(1.0),
+            make_counted<const ql::datum_t>(1.0)}));
+    data.push_back(make_counted<const ql::datum_t>(
+        std::vector<counted_t<const ql::datum_t> >{
+            make_counted<const ql::datum_t>(2.0)}));
+    data.push_back(make_counted<const ql::datum_t>(ql::datum_t::R_BOOL, false));
+    data.push_back(make_counted<const ql::datum_t>(ql::datum_t::R_BOOL, true));
+    data.push_back(make_counted<const ql::datum_t>(-1e100));
+    data.push_back(make_counted<const ql::datum_t>(-1.5));
+    data.push_back(make_counted<const ql::datum_t>(0.0));
+    data.push_back(make_counted<const ql::datum_t>(1.5));
+    data.push_back(make_counted<const ql::datum_t>(1e100));
+    data.push_back(make_counted<const ql::datum_t>(""));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a")));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a\0", 2)));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a\0b", 3)));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a\x01", 2)));
+    data.push_back(make_counted<const ql::datum_t>(std::string("ab")));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a\xff", 2)));
+
+    for (size_t i = 0; i + 1 < data.size(); ++i) {
+        ASSERT_LT(*data[i], *data[i + 1]);
+        ASSERT_LT(binary_secondary(data[i]), binary_secondary(data[i + 1]));
+    }
+    ASSERT_EQ(binary_secondary(make_counted<const ql::datum_t>(0.0)),
+              binary_secondary(make_counted<const ql::datum_t>(-0.0)));
+}
+
+TEST(PrintSecondary, BinaryDecode) {
+    std::vector<counted_t<const ql::datum_t> > data;
+    data.push_back(make_counted<const ql::datum_t>(-3.25));
+    data.push_back(make_counted<const ql::datum_t>(std::string("a\0\xff", 3)));
+    data.push_back(make_counted<const ql::datum_t>(
+        std::vector<counted_t<const ql::datum_t> >{
+            make_counted<const ql::datum_t>(ql::datum_t::R_BOOL, true),
+            make_counted<const ql::datum_t>(
+                std::vector<counted_t<const ql::datum_t> >()),
+            make_counted<const ql::datum_t>("x")}));
+
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        store_key_t key((*it)->print_secondary(ql::skey_version_t::BINARY,
+                                               store_key_t("pk"), 3));
+        counted_t<const ql::datum_t> decoded = ql::datum_t::decode_secondary(key);
+        ASSERT_TRUE(decoded.has());
+        ASSERT_EQ(**it, *decoded);
+    }
+
+    // Truncated keys don't decode.
+    counted_t<const ql::datum_t> long_str = make_counted<const ql::datum_t>(
+        std::string(ql::datum_t::max_trunc_size(), 'a'));
+    store_key_t key(long_str->print_secondary(ql::skey_version_t::BINARY,
+                                              store_key_t("pk")));
+    ASSERT_TRUE(ql::datum_t::key_is_truncated(key));
+    ASSERT_FALSE(ql::datum_t::decode_secondary(key).has());
+}
+
+}  // namespace unittest
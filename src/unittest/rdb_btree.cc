@@ -96,7 +96,7 @@ sindex_name_t create_sindex(store_t *store) {
     sindex_multi_bool_t multi_bool = sindex_multi_bool_t::SINGLE;
 
     write_message_t wm;
-    serialize_sindex_info(&wm, m, multi_bool);
+    serialize_sindex_info(&wm, m, multi_bool, sindex_storage_t());
 
     vector_stream_t stream;
     stream.reserve(wm.size());
@@ -220,9 +220,8 @@ void _check_keys_are_present(store_t *store,
         ql::env_t dummy_env(&dummy_interruptor);
         rdb_rget_slice(
             store->get_sindex_slice(sindex_uuid),
-            rdb_protocol::sindex_key_range(
-                store_key_t(make_counted<const ql::datum_t>(ii)->print_primary()),
-                store_key_t(make_counted<const ql::datum_t>(ii)->print_primary())),
+            datum_range_t(make_counted<const ql::datum_t>(ii)).to_sindex_keyrange(
+                ql::skey_version_t::LATEST),
             sindex_sb.get(),
             &dummy_env, // env_t
             ql::batchspec_t::user(ql::batch_type_t::NORMAL,
@@ -292,9 +291,8 @@ void _check_keys_are_NOT_present(store_t *store,
         ql::env_t dummy_env(&dummy_interruptor);
         rdb_rget_slice(
             store->get_sindex_slice(sindex_uuid),
-            rdb_protocol::sindex_key_range(
-                store_key_t(make_counted<const ql::datum_t>(ii)->print_primary()),
-                store_key_t(make_counted<const ql::datum_t>(ii)->print_primary())),
+            datum_range_t(make_counted<const ql::datum_t>(ii)).to_sindex_keyrange(
+                ql::skey_version_t::LATEST),
             sindex_sb.get(),
             &dummy_env, // env_t
             ql::batchspec_t::user(ql::batch_type_t::NORMAL,
@@ -364,6 +362,52 @@ TPTEST(RDBBtree, SindexPostConstruct) {
     check_keys_are_present(&store, sindex_name);
 }
 
+std::vector<char> write_message_to_vector(write_message_t *wm) {
+    vector_stream_t stream;
+    stream.reserve(wm->size());
+    int res = send_write_message(&stream, wm);
+    guarantee(res == 0);
+    return stream.vector();
+}
+
+TPTEST(RDBBtree, SindexInfoVersions) {
+    ql::sym_t one(1);
+    ql::protob_t<const Term> mapping = ql::r::var(one)["sid"].release_counted();
+    ql::map_wire_func_t m(mapping, make_vector(one), get_backtrace(mapping));
+
+    ql::map_wire_func_t mapping_out;
+    sindex_multi_bool_t multi_out;
+    ql::skey_version_t skey_version_out;
+    sindex_storage_t storage_out;
+
+    {
+        // 1.13 wrote the mapping and the multi flag in the same format as we do,
+        // but nothing after them.
+        write_message_t wm;
+        serialize_cluster_version(&wm, cluster_version_t::v1_13);
+        serialize<cluster_version_t::LATEST_DISK>(&wm, m);
+        serialize<cluster_version_t::LATEST_DISK>(&wm, sindex_multi_bool_t::MULTI);
+        deserialize_sindex_info(write_message_to_vector(&wm), &mapping_out,
+                                &multi_out, &skey_version_out, &storage_out);
+        EXPECT_EQ(sindex_multi_bool_t::MULTI, multi_out);
+        EXPECT_EQ(ql::skey_version_t::PRINTED, skey_version_out);
+        EXPECT_FALSE(storage_out.slim);
+        EXPECT_TRUE(storage_out.covering.empty());
+    }
+
+    {
+        write_message_t wm;
+        serialize_sindex_info(&wm, m, sindex_multi_bool_t::SINGLE,
+                              sindex_storage_t(true, make_vector(std::string("a"))));
+        deserialize_sindex_info(write_message_to_vector(&wm), &mapping_out,
+                                &multi_out, &skey_version_out, &storage_out);
+        EXPECT_EQ(sindex_multi_bool_t::SINGLE, multi_out);
+        EXPECT_EQ(ql::skey_version_t::LATEST, skey_version_out);
+        EXPECT_TRUE(storage_out.slim);
+        EXPECT_EQ(make_vector(std::string("a")), storage_out.covering);
+    }
+}
+
 TPTEST(RDBBtree, SindexEraseRange) {
     recreate_temporary_directory(base_path_t("."));
     temp_file_t temp_file;
@@ -104,6 +104,19 @@ void mock_namespace_interface_t::read_visitor_t::operator()(const point_read_t &
     }
 }
 
+void mock_namespace_interface_t::read_visitor_t::operator()(const point_read_batch_t &get) {
+    response->response = point_read_batch_response_t();
+    point_read_batch_response_t &res
+        = boost::get<point_read_batch_response_t>(response->response);
+
+    for (auto it = get.keys.begin(); it != get.keys.end(); ++it) {
+        if (data->find(*it) != data->end()) {
+            res.data[*it]
+                = make_counted<ql::datum_t>(scoped_cJSON_t(data->at(*it)->DeepCopy()));
+        }
+    }
+}
+
 void NORETURN mock_namespace_interface_t::read_visitor_t::operator()(const changefeed_subscribe_t &) {
     throw cannot_perform_query_exc_t("unimplemented");
 }
@@ -287,7 +300,7 @@ bool mock_reql_admin_interface_t::table_create(UNUSED const name_string_t &name,
         UNUSED counted_t<const ql::db_t> db,
         UNUSED const boost::optional<name_string_t> &primary_dc,
         UNUSED bool hard_durability, UNUSED const std::string &primary_key,
-        UNUSED signal_t *interruptor, UNUSED uuid_u *namespace_id_out,
+        UNUSED const boost::optional<int32_t> &cpu_shards, UNUSED signal_t *interruptor, UNUSED uuid_u *namespace_id_out,
         std::string *error_out) {
     *error_out = "mock_reql_admin_interface_t doesn't support mutation";
     return false;
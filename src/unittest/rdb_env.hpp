@@ -68,6 +68,7 @@ private:
 
     struct read_visitor_t : public boost::static_visitor<void> {
         void operator()(const point_read_t &get);
+        void operator()(const point_read_batch_t &get);
         void NORETURN operator()(const changefeed_subscribe_t &);
         void NORETURN operator()(const changefeed_stamp_t &);
         void NORETURN operator()(UNUSED const rget_read_t &rget);
@@ -148,7 +149,7 @@ public:
 
     bool table_create(const name_string_t &name, counted_t<const ql::db_t> db,
             const boost::optional<name_string_t> &primary_dc, bool hard_durability,
-            const std::string &primary_key,
+            const std::string &primary_key, const boost::optional<int32_t> &cpu_shards,
             signal_t *interruptor, uuid_u *namespace_id_out, std::string *error_out);
     bool table_drop(const name_string_t &name, counted_t<const ql::db_t> db,
             signal_t *interruptor, std::string *error_out);
@@ -180,6 +180,52 @@ TEST(RDBProtocol, OvershardedGetSet) {
     run_in_thread_pool_with_namespace_interface(&run_get_set_test, true);
 }
 
+/* `GetBatch` tests that a batched point read finds the rows on every shard and
+leaves out the keys that don't exist */
+void run_get_batch_test(namespace_interface_t *nsi, order_source_t *osource) {
+    const int num_rows = 50;
+    for (int i = 0; i < num_rows; ++i) {
+        write_t write(
+                point_write_t(store_key_t(strprintf("key%d", i)),
+                    make_counted<ql::datum_t>(static_cast<double>(i))),
+                DURABILITY_REQUIREMENT_DEFAULT,
+                profile_bool_t::PROFILE);
+        write_response_t response;
+
+        cond_t interruptor;
+        nsi->write(write, &response, osource->check_in("unittest::run_get_batch_test(rdb_protocol.cc-A)"), &interruptor);
+    }
+
+    std::vector<store_key_t> keys;
+    for (int i = 0; i < num_rows; i += 2) {
+        keys.push_back(store_key_t(strprintf("key%d", i)));
+        keys.push_back(store_key_t(strprintf("missing%d", i)));
+    }
+    read_t read(point_read_batch_t(std::move(keys)), profile_bool_t::PROFILE);
+    read_response_t response;
+
+    cond_t interruptor;
+    nsi->read(read, &response, osource->check_in("unittest::run_get_batch_test(rdb_protocol.cc-B)"), &interruptor);
+
+    point_read_batch_response_t *res
+        = boost::get<point_read_batch_response_t>(&response.response);
+    ASSERT_TRUE(res != NULL);
+    ASSERT_EQ(static_cast<size_t>(num_rows / 2), res->data.size());
+    for (int i = 0; i < num_rows; i += 2) {
+        auto it = res->data.find(store_key_t(strprintf("key%d", i)));
+        ASSERT_TRUE(it != res->data.end());
+        ASSERT_EQ(ql::datum_t(static_cast<double>(i)), *it->second);
+    }
+}
+
+TEST(RDBProtocol, GetBatch) {
+    run_in_thread_pool_with_namespace_interface(&run_get_batch_test, false);
+}
+
+TEST(RDBProtocol, OvershardedGetBatch) {
+    run_in_thread_pool_with_namespace_interface(&run_get_batch_test, true);
+}
+
 std::string create_sindex(namespace_interface_t *nsi,
                           order_source_t *osource) {
     std::string id = uuid_to_str(generate_uuid());
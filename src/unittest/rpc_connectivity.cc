@@ -5,6 +5,7 @@
 #include "arch/timing.hpp"
 #include "containers/scoped.hpp"
 #include "containers/archive/socket_stream.hpp"
+#include "containers/archive/vector_stream.hpp"
 #include "unittest/unittest_utils.hpp"
 #include "rpc/connectivity/cluster.hpp"
 #include "rpc/connectivity/multiplexer.hpp"
@@ -22,10 +23,12 @@ public:
         service(s),
         sequence_number(0)
         { }
-    void send(int message, peer_id_t peer) {
+    void send(int message, peer_id_t peer,
+              traffic_class_t traffic_class = traffic_class_t::QUERY) {
         class writer_t : public send_message_write_callback_t {
         public:
-            explicit writer_t(int _data) : data(_data) { }
+            writer_t(int _data, traffic_class_t _traffic_class) :
+                data(_data), traffic_class(_traffic_class) { }
             virtual ~writer_t() { }
             void write(cluster_version_t, write_stream_t *stream) {
                 write_message_t wm;
@@ -33,8 +36,12 @@ public:
                 int res = send_write_message(stream, &wm);
                 if (res) { throw fake_archive_exc_t(); }
             }
+            traffic_class_t get_traffic_class() const {
+                return traffic_class;
+            }
             int32_t data;
-        } writer(message);
+            traffic_class_t traffic_class;
+        } writer(message, traffic_class);
         service->send_message(peer, &writer);
     }
     void expect(int message, peer_id_t peer) {
@@ -185,6 +192,36 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, Ordering, 3) {
     }
 }
 
+/* `TrafficClasses` tests that messages of every traffic class arrive when there
+are several connections between two peers, and that messages of the same class
+stay in order. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, TrafficClasses, 3) {
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1), a2(&c2);
+    connectivity_cluster_t::run_t cr1(&c1, get_unittest_addresses(), peer_address_t(), ANY_PORT, &a1, 0, NULL, NUM_TRAFFIC_CLASSES);
+    connectivity_cluster_t::run_t cr2(&c2, get_unittest_addresses(), peer_address_t(), ANY_PORT, &a2, 0, NULL, NUM_TRAFFIC_CLASSES);
+
+    cr1.join(c2.get_peer_address(c2.get_me()));
+
+    let_stuff_happen();
+
+    const traffic_class_t classes[] = { traffic_class_t::CONTROL,
+                                        traffic_class_t::QUERY,
+                                        traffic_class_t::BACKFILL };
+    for (int i = 0; i < 30; i++) {
+        a1.send(i, c2.get_me(), classes[i % NUM_TRAFFIC_CLASSES]);
+        a2.send(i, c1.get_me(), classes[i % NUM_TRAFFIC_CLASSES]);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i + NUM_TRAFFIC_CLASSES < 30; i++) {
+        a1.expect_order(i, i + NUM_TRAFFIC_CLASSES);
+        a2.expect_order(i, i + NUM_TRAFFIC_CLASSES);
+    }
+}
+
 /* `GetPeersList` confirms that the behavior of `cluster_t::get_peers_list()` is
 correct. */
 
@@ -289,7 +326,8 @@ struct watcher_t : private peers_list_callback_t {
         properly. We must use `coro_t::spawn_now_dangerously()` because `send_message()`
         may block. */
         coro_t::spawn_now_dangerously(
-                std::bind(&recording_test_application_t::send, application, 89765, p));
+                std::bind(&recording_test_application_t::send, application, 89765, p,
+                          traffic_class_t::QUERY));
     }
 
     void on_disconnect(peer_id_t p) {
@@ -493,6 +531,81 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, BinaryData, 3) {
     EXPECT_TRUE(a2.got_spectrum);
 }
 
+/* `CompressionMismatch` checks that a node that compresses its cluster traffic can
+still talk to one that doesn't. */
+TPTEST_MULTITHREAD(RPCConnectivityTest, CompressionMismatch, 3) {
+    connectivity_cluster_t c1, c2;
+    binary_test_application_t a1(&c1), a2(&c2);
+    connectivity_cluster_t::run_t cr1(&c1, get_unittest_addresses(), peer_address_t(),
+                                      ANY_PORT, &a1, 0, NULL,
+                                      CLUSTER_CONNECTIONS_PER_PEER,
+                                      cluster_compression_t::DEFLATE);
+    connectivity_cluster_t::run_t cr2(&c2, get_unittest_addresses(), peer_address_t(),
+                                      ANY_PORT, &a2, 0, NULL,
+                                      CLUSTER_CONNECTIONS_PER_PEER,
+                                      cluster_compression_t::NONE);
+    cr1.join(c2.get_peer_address(c2.get_me()));
+
+    let_stuff_happen();
+
+    a1.send_spectrum(c2.get_me());
+
+    let_stuff_happen();
+
+    EXPECT_TRUE(a2.got_spectrum);
+}
+
+/* `CompressionFrames` runs a mix of small, large and empty messages through a
+`cluster_frame_encoder_t` and checks that `cluster_frame_decoder_stream_t` gets the
+same bytes back out, no matter how the reads are sized. */
+TEST(RPCConnectivityTest, CompressionFrames) {
+    std::vector<std::string> messages;
+    messages.push_back("short");
+    messages.push_back(std::string(100000, 'x'));
+    messages.push_back("");
+    std::string json;
+    for (int i = 0; i < 2000; ++i) {
+        json += strprintf("{\"id\":%d,\"name\":\"row\"}", i);
+    }
+    messages.push_back(json);
+    messages.push_back("also short");
+
+    cluster_frame_encoder_t encoder(64);
+    std::vector<char> wire;
+    size_t total_size = 0;
+    for (auto it = messages.begin(); it != messages.end(); ++it) {
+        cluster_frame_encoder_t::result_t r = encoder.add_message(it->data(), it->size());
+        EXPECT_EQ(it->size() >= 64, r.compressed);
+        if (r.compressed) {
+            EXPECT_LT(r.payload_size, it->size());
+        }
+        total_size += it->size();
+    }
+    std::vector<iovec> iov;
+    encoder.get_iovecs(&iov);
+    for (auto it = iov.begin(); it != iov.end(); ++it) {
+        const char *base = static_cast<const char *>(it->iov_base);
+        wire.insert(wire.end(), base, base + it->iov_len);
+    }
+    EXPECT_LT(wire.size(), total_size);
+
+    vector_read_stream_t inner(std::move(wire));
+    cluster_frame_decoder_stream_t decoder(&inner, NULL);
+    for (auto it = messages.begin(); it != messages.end(); ++it) {
+        std::string out;
+        while (out.size() < it->size()) {
+            char buf[777];
+            int64_t res = decoder.read(buf, std::min<size_t>(sizeof(buf),
+                                                             it->size() - out.size()));
+            ASSERT_GT(res, 0);
+            out.append(buf, res);
+        }
+        EXPECT_EQ(*it, out);
+    }
+    char c;
+    EXPECT_EQ(0, decoder.read(&c, 1));
+}
+
 /* `PeerIDSemantics` makes sure that `peer_id_t::is_nil()` works as expected. */
 TPTEST_MULTITHREAD(RPCConnectivityTest, PeerIDSemantics, 3) {
     peer_id_t nil_peer;
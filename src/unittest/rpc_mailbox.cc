@@ -66,7 +66,7 @@ void send(mailbox_manager_t *c, raw_mailbox_t::address_t dest, int message) {
 /* `MailboxStartStop` creates and destroys some mailboxes. */
 TPTEST(RPCMailboxTest, MailboxStartStop, 2) {
     connectivity_cluster_t c;
-    mailbox_manager_t m(&c);
+    mailbox_manager_t m(&c, &get_global_perfmon_collection());
     connectivity_cluster_t::run_t r(&c, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m, 0, NULL);
 
     /* Make sure we can create a mailbox */
@@ -80,7 +80,8 @@ TPTEST(RPCMailboxTest, MailboxStartStop, 2) {
 /* `MailboxMessage` sends messages to some mailboxes */
 TPTEST_MULTITHREAD(RPCMailboxTest, MailboxMessage, 3) {
     connectivity_cluster_t c1, c2;
-    mailbox_manager_t m1(&c1), m2(&c2);
+    perfmon_collection_t p1, p2;
+    mailbox_manager_t m1(&c1, &p1), m2(&c2, &p2);
     connectivity_cluster_t::run_t r1(&c1, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m1, 0, NULL);
     connectivity_cluster_t::run_t r2(&c2, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m2, 0, NULL);
     r1.join(c2.get_peer_address(c2.get_me()));
@@ -105,7 +106,8 @@ TPTEST_MULTITHREAD(RPCMailboxTest, MailboxMessage, 3) {
 for the message to be silently ignored. */
 TPTEST_MULTITHREAD(RPCMailboxTest, DeadMailbox, 3) {
     connectivity_cluster_t c1, c2;
-    mailbox_manager_t m1(&c1), m2(&c2);
+    perfmon_collection_t p1, p2;
+    mailbox_manager_t m1(&c1, &p1), m2(&c2, &p2);
     connectivity_cluster_t::run_t r1(&c1, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m1, 0, NULL);
     connectivity_cluster_t::run_t r2(&c2, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m2, 0, NULL);
 
@@ -128,7 +130,7 @@ TPTEST_MULTITHREAD(RPCMailboxTest, MailboxAddressSemantics, 3) {
     EXPECT_TRUE(nil_addr.is_nil());
 
     connectivity_cluster_t c;
-    mailbox_manager_t m(&c);
+    mailbox_manager_t m(&c, &get_global_perfmon_collection());
     connectivity_cluster_t::run_t r(&c, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m, 0, NULL);
 
     dummy_mailbox_t mbox(&m);
@@ -145,7 +147,7 @@ void string_push_back(std::vector<std::string> *v, const std::string &pushee) {
 
 TPTEST_MULTITHREAD(RPCMailboxTest, TypedMailbox, 3) {
     connectivity_cluster_t c;
-    mailbox_manager_t m(&c);
+    mailbox_manager_t m(&c, &get_global_perfmon_collection());
     connectivity_cluster_t::run_t r(&c, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m, 0, NULL);
 
     std::vector<std::string> inbox;
@@ -167,4 +169,88 @@ TPTEST_MULTITHREAD(RPCMailboxTest, TypedMailbox, 3) {
     }
 }
 
+/* `TypedMailboxLocalDelivery` makes sure that messages to a `mailbox_t<>` on
+another thread of the same peer, which skip serialization, arrive intact, in
+order, and on the mailbox's thread. */
+
+void string_push_back_on_thread(std::vector<std::string> *v, threadnum_t thread,
+                                const std::string &pushee) {
+    EXPECT_EQ(thread.threadnum, get_thread_id().threadnum);
+    v->push_back(pushee);
+}
+
+TPTEST_MULTITHREAD(RPCMailboxTest, TypedMailboxLocalDelivery, 3) {
+    connectivity_cluster_t c;
+    mailbox_manager_t m(&c, &get_global_perfmon_collection());
+    connectivity_cluster_t::run_t r(&c, get_unittest_addresses(), peer_address_t(), ANY_PORT, &m, 0, NULL);
+
+    std::vector<std::string> inbox;
+    scoped_ptr_t<mailbox_t<void(std::string)> > mbox;
+    mailbox_addr_t<void(std::string)> addr;
+    {
+        on_thread_t thread_switcher(threadnum_t(1));
+        mbox.init(new mailbox_t<void(std::string)>(&m,
+            std::bind(&string_push_back_on_thread, &inbox, threadnum_t(1), ph::_1)));
+        addr = mbox->get_address();
+    }
+
+    EXPECT_EQ(c.get_me(), addr.get_peer());
+
+    send(&m, addr, std::string("foo"));
+    send(&m, addr, std::string("bar"));
+    send(&m, addr, std::string("baz"));
+
+    let_stuff_happen();
+
+    {
+        on_thread_t thread_switcher(threadnum_t(1));
+        EXPECT_EQ(3u, inbox.size());
+        if (inbox.size() == 3) {
+            EXPECT_EQ(inbox[0], "foo");
+            EXPECT_EQ(inbox[1], "bar");
+            EXPECT_EQ(inbox[2], "baz");
+        }
+        mbox.reset();
+    }
+}
+
+/* `TypedMailboxLocalDropWithoutRun` makes sure that, like messages that go through
+the connectivity layer, local messages are dropped while we have no `run_t`. */
+
+TPTEST_MULTITHREAD(RPCMailboxTest, TypedMailboxLocalDropWithoutRun, 2) {
+    connectivity_cluster_t c;
+    mailbox_manager_t m(&c, &get_global_perfmon_collection());
+
+    std::vector<std::string> inbox;
+    scoped_ptr_t<mailbox_t<void(std::string)> > mbox;
+    mailbox_addr_t<void(std::string)> addr;
+    {
+        on_thread_t thread_switcher(threadnum_t(1));
+        mbox.init(new mailbox_t<void(std::string)>(&m,
+            std::bind(&string_push_back_on_thread, &inbox, threadnum_t(1), ph::_1)));
+        addr = mbox->get_address();
+    }
+
+    send(&m, addr, std::string("foo"));
+
+    let_stuff_happen();
+
+    {
+        on_thread_t thread_switcher(threadnum_t(1));
+        EXPECT_EQ(0u, inbox.size());
+        mbox.reset();
+    }
+}
+
+/* Only value types are allowed to skip serialization. */
+
+TEST(RPCMailboxTest, LocalSafeTypes) {
+    EXPECT_TRUE(mailbox_local_safe_t<int>::value);
+    EXPECT_TRUE(mailbox_local_safe_t<std::string>::value);
+    EXPECT_TRUE((mailbox_local_safe_t<std::map<std::string, std::vector<uuid_u> > >::value));
+    EXPECT_TRUE(mailbox_local_safe_t<mailbox_addr_t<void(int)> >::value);
+    EXPECT_FALSE(mailbox_local_safe_t<std::vector<scoped_ptr_t<int> > >::value);
+    EXPECT_FALSE((mailbox_local_safe_t<std::pair<int, std::shared_ptr<int> > >::value));
+}
+
 }   /* namespace unittest */
@@ -1,9 +1,18 @@
+#include <stdio.h>
+#include <string.h>
+
 #include <functional>
+#include <string>
+#include <vector>
 
+#include "arch/runtime/coroutines.hpp"
 #include "arch/runtime/starter.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "serializer/buf_ptr.hpp"
 #include "serializer/config.hpp"
+#include "serializer/log/lba/index_snapshot.hpp"
+#include "serializer/log/log_serializer.hpp"
 #include "unittest/mock_file.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/unittest_utils.hpp"
@@ -90,5 +99,223 @@ TEST(SerializerTest, AddDeleteRepeatedlyWithIndex) {
     run_in_thread_pool(std::bind(run_AddDeleteRepeatedly, true), 4);
 }
 
+// Reads of adjacent blocks that are started together should reach the file as
+// fewer, vectored reads, and return the right data.
+TPTEST(SerializerTest, CoalescesAdjacentReads) {
+    static const int NUM_BLOCKS = 8;
+
+    mock_file_opener_t file_opener;
+    standard_serializer_t::create(&file_opener, standard_serializer_t::static_config_t());
+    standard_serializer_t ser(standard_serializer_t::dynamic_config_t(),
+                              &file_opener,
+                              &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+    // One write, so that the blocks end up next to each other in one extent.
+    std::vector<buf_ptr_t> bufs;
+    std::vector<buf_write_info_t> infos;
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+        memset(bufs[i].cache_data(), 'a' + i, ser.max_block_size().value());
+        infos.push_back(buf_write_info_t(bufs[i].ser_buffer(), bufs[i].block_size(), i));
+    }
+    struct : public iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } cb;
+    std::vector<counted_t<standard_block_token_t> > tokens
+        = ser.block_writes(infos, account.get(), &cb);
+    cb.wait();
+
+    const mock_file_stats_t stats_before = file_opener.stats();
+    std::vector<buf_ptr_t> read_bufs(NUM_BLOCKS);
+    {
+        auto_drainer_t drainer;
+        for (int i = 0; i < NUM_BLOCKS; ++i) {
+            auto_drainer_t::lock_t lock(&drainer);
+            coro_t::spawn_sometime([&, i, lock]() {
+                    read_bufs[i] = ser.block_read(tokens[i], account.get());
+                });
+        }
+    }
+    const int reads = file_opener.stats().reads - stats_before.reads;
+    const int readvs = file_opener.stats().readvs - stats_before.readvs;
+
+    // The first read goes to disk on its own, the others wait for it and get
+    // merged.
+    EXPECT_LE(1, readvs);
+    EXPECT_GT(NUM_BLOCKS, reads + readvs);
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        EXPECT_EQ(0, memcmp(bufs[i].cache_data(), read_bufs[i].cache_data(),
+                            ser.max_block_size().value()));
+    }
+}
+
+TPTEST(SerializerTest, IndexSnapshotRoundTrip) {
+    temp_file_t temp_file;
+    const std::string path = temp_file.name().permanent_path();
+
+    in_memory_index_t index;
+    for (block_id_t id = 0; id < 1000; id += 3) {
+        index.set_block_info(id, repli_timestamp_t::distant_past,
+                             flagged_off64_t::make(id * 4096), 4096);
+    }
+    // A deleted block at the end, which only shows in end_block_id().
+    index.set_block_info(1234, repli_timestamp_t::invalid,
+                         flagged_off64_t::unused(), 0);
+
+    index_snapshot_stamp_t stamp;
+    stamp.metablock_version = 17;
+    stamp.lba_crc = 0x1234;
+    ASSERT_TRUE(save_index_snapshot(path, stamp, &index));
+
+    index_snapshot_stamp_t other_stamp = stamp;
+    ++other_stamp.metablock_version;
+    in_memory_index_t not_loaded;
+    ASSERT_FALSE(load_index_snapshot(path, other_stamp, &not_loaded));
+    ASSERT_EQ(0u, not_loaded.end_block_id());
+
+    in_memory_index_t loaded;
+    ASSERT_TRUE(load_index_snapshot(path, stamp, &loaded));
+    ASSERT_EQ(index.end_block_id(), loaded.end_block_id());
+    for (block_id_t id = 0; id < index.end_block_id(); ++id) {
+        ASSERT_TRUE(index.get_block_info(id) == loaded.get_block_info(id));
+    }
+
+    remove_index_snapshot(path);
+    in_memory_index_t removed;
+    ASSERT_FALSE(load_index_snapshot(path, stamp, &removed));
+}
+
+// A mock file whose serializer keeps an index snapshot in a real file.
+class snapshot_mock_file_opener_t : public mock_file_opener_t {
+public:
+    explicit snapshot_mock_file_opener_t(const std::string &snapshot_path)
+        : snapshot_path_(snapshot_path) { }
+    std::string index_snapshot_file_name() const { return snapshot_path_; }
+private:
+    std::string snapshot_path_;
+};
+
+log_serializer_t::dynamic_config_t index_snapshot_config() {
+    log_serializer_t::dynamic_config_t config;
+    config.index_snapshot = true;
+    return config;
+}
+
+// Writes blocks `0` to `num_blocks - 1`, all filled with `fill`.
+void write_filled_blocks(log_serializer_t *ser, int num_blocks, char fill) {
+    scoped_ptr_t<file_account_t> account(ser->make_io_account(1));
+    std::vector<buf_ptr_t> bufs;
+    std::vector<buf_write_info_t> infos;
+    for (int i = 0; i < num_blocks; ++i) {
+        bufs.push_back(buf_ptr_t::alloc_zeroed(ser->max_block_size()));
+        memset(bufs[i].cache_data(), fill, ser->max_block_size().value());
+        infos.push_back(buf_write_info_t(bufs[i].ser_buffer(), bufs[i].block_size(), i));
+    }
+    struct : public iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } cb;
+    std::vector<counted_t<ls_block_token_pointee_t> > tokens
+        = ser->block_writes(infos, account.get(), &cb);
+    cb.wait();
+
+    std::vector<index_write_op_t> write_ops;
+    for (int i = 0; i < num_blocks; ++i) {
+        write_ops.push_back(index_write_op_t(i, tokens[i],
+                                             repli_timestamp_t::distant_past));
+    }
+    new_mutex_in_line_t dummy_acq;
+    ser->index_write(&dummy_acq, write_ops, account.get());
+}
+
+void check_filled_blocks(log_serializer_t *ser, int num_blocks, char fill) {
+    scoped_ptr_t<file_account_t> account(ser->make_io_account(1));
+    ASSERT_EQ(static_cast<block_id_t>(num_blocks), ser->max_block_id());
+    std::vector<char> expected(ser->max_block_size().value(), fill);
+    for (int i = 0; i < num_blocks; ++i) {
+        counted_t<ls_block_token_pointee_t> token = ser->index_read(i);
+        ASSERT_TRUE(token.has());
+        buf_ptr_t buf = ser->block_read(token, account.get());
+        EXPECT_EQ(0, memcmp(expected.data(), buf.cache_data(), expected.size()));
+    }
+}
+
+std::vector<char> read_whole_file(const std::string &path) {
+    std::vector<char> ret;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file != NULL) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+            ret.insert(ret.end(), buf, buf + n);
+        }
+        fclose(file);
+    }
+    return ret;
+}
+
+void write_whole_file(const std::string &path, const std::vector<char> &contents) {
+    FILE *file = fopen(path.c_str(), "wb");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(contents.size(), fwrite(contents.data(), 1, contents.size(), file));
+    ASSERT_EQ(0, fclose(file));
+}
+
+// The index snapshot written by a clean shutdown gets loaded by the next start, and
+// one that doesn't match the metablock any more is ignored in favor of the LBA.
+TPTEST(SerializerTest, IndexSnapshotRestart) {
+    static const int NUM_BLOCKS = 64;
+
+    temp_file_t temp_file;
+    const std::string snapshot_path = temp_file.name().permanent_path();
+    snapshot_mock_file_opener_t file_opener(snapshot_path);
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+
+    {
+        log_serializer_t ser(index_snapshot_config(), &file_opener,
+                             &get_global_perfmon_collection());
+        write_filled_blocks(&ser, NUM_BLOCKS, 'a');
+    }
+    const std::vector<char> first_snapshot = read_whole_file(snapshot_path);
+    ASSERT_FALSE(first_snapshot.empty());
+
+    // A clean shutdown followed by a restart.
+    {
+        log_serializer_t ser(index_snapshot_config(), &file_opener,
+                             &get_global_perfmon_collection());
+        EXPECT_TRUE(ser.index_loaded_from_snapshot());
+        // Our writes are about to make the snapshot stale, so it's gone.
+        EXPECT_TRUE(read_whole_file(snapshot_path).empty());
+        check_filled_blocks(&ser, NUM_BLOCKS, 'a');
+        write_filled_blocks(&ser, NUM_BLOCKS, 'b');
+    }
+
+    // Put the snapshot from the first run back.  Its stamp doesn't match the latest
+    // metablock, so we must read the LBA.
+    write_whole_file(snapshot_path, first_snapshot);
+    {
+        log_serializer_t ser(index_snapshot_config(), &file_opener,
+                             &get_global_perfmon_collection());
+        EXPECT_FALSE(ser.index_loaded_from_snapshot());
+        check_filled_blocks(&ser, NUM_BLOCKS, 'b');
+    }
+
+    // The same goes for a snapshot that has been damaged.
+    std::vector<char> damaged_snapshot = read_whole_file(snapshot_path);
+    ASSERT_FALSE(damaged_snapshot.empty());
+    damaged_snapshot[damaged_snapshot.size() / 2] ^= 1;
+    write_whole_file(snapshot_path, damaged_snapshot);
+    {
+        log_serializer_t ser(index_snapshot_config(), &file_opener,
+                             &get_global_perfmon_collection());
+        EXPECT_FALSE(ser.index_loaded_from_snapshot());
+        check_filled_blocks(&ser, NUM_BLOCKS, 'b');
+    }
+}
+
 
 }  // namespace unittest
@@ -0,0 +1,156 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rdb_protocol/counted_term.hpp"
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/stream_cache.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/rdb_env.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+static const size_t ROW_SIZE = KILOBYTE;
+
+// Every row is `ROW_SIZE` characters long and starts with its index, so that we can
+// tell whether the rows came out in order.
+counted_t<ql::datum_stream_t> make_row_stream(int num_rows) {
+    std::vector<counted_t<const ql::datum_t> > rows;
+    for (int i = 0; i < num_rows; ++i) {
+        std::string row = strprintf("%08d", i);
+        row.resize(ROW_SIZE, 'x');
+        rows.push_back(make_counted<const ql::datum_t>(std::move(row)));
+    }
+    return make_counted<ql::array_datum_stream_t>(
+        make_counted<const ql::datum_t>(std::move(rows)),
+        ql::make_counted_backtrace());
+}
+
+int64_t get_counter(perfmon_counter_t *counter) {
+    void *ctx = counter->begin_stats();
+    counter->visit_stats(ctx);
+    scoped_ptr_t<perfmon_result_t> result = counter->end_stats(ctx);
+    return std::stoll(*result->get_string());
+}
+
+void insert_stream(ql::stream_cache_t *cache, int64_t key, int num_rows) {
+    cache->insert(key,
+                  ql::use_json_t::NO,
+                  std::map<std::string, ql::wire_func_t>(),
+                  profile_bool_t::DONT_PROFILE,
+                  ql::read_ahead_t::YES,
+                  make_row_stream(num_rows));
+}
+
+// Serves one batch of `key` and checks that its rows pick up at `*next_row`.
+Response::ResponseType serve_batch(ql::stream_cache_t *cache, int64_t key,
+                                   int *next_row) {
+    cond_t interruptor;
+    Response res;
+    EXPECT_TRUE(cache->serve(key, &res, &interruptor));
+    for (int i = 0; i < res.response_size(); ++i) {
+        EXPECT_EQ(strprintf("%08d", *next_row), res.response(i).r_str().substr(0, 8));
+        ++*next_row;
+    }
+    return res.type();
+}
+
+TPTEST(StreamCache, PrefetchHits) {
+    test_rdb_env_t test_env;
+    scoped_ptr_t<test_rdb_env_t::instance_t> env_instance = test_env.make_env();
+    rdb_context_t *rdb_ctx = env_instance->get()->get_rdb_ctx();
+    ql::stream_cache_t cache(rdb_ctx, ql::reject_cfeeds_t::NO);
+
+    const int num_rows = 4 * MEGABYTE / ROW_SIZE;
+    insert_stream(&cache, 1, num_rows);
+
+    int next_row = 0;
+    int num_batches = 0;
+    Response::ResponseType type;
+    do {
+        // Give the prefetch of the next batch time to finish before we ask for it.
+        let_stuff_happen();
+        type = serve_batch(&cache, 1, &next_row);
+        ++num_batches;
+    } while (type == Response::SUCCESS_PARTIAL);
+
+    EXPECT_EQ(Response::SUCCESS_SEQUENCE, type);
+    EXPECT_EQ(num_rows, next_row);
+    ASSERT_LE(3, num_batches);
+    // Every batch but the first was computed ahead.
+    EXPECT_EQ(num_batches - 1, get_counter(&rdb_ctx->ql_prefetch_hits));
+    EXPECT_EQ(0, get_counter(&rdb_ctx->ql_prefetch_wasted));
+    EXPECT_FALSE(cache.contains(1));
+}
+
+TPTEST(StreamCache, PrefetchWasted) {
+    test_rdb_env_t test_env;
+    scoped_ptr_t<test_rdb_env_t::instance_t> env_instance = test_env.make_env();
+    rdb_context_t *rdb_ctx = env_instance->get()->get_rdb_ctx();
+    ql::stream_cache_t cache(rdb_ctx, ql::reject_cfeeds_t::NO);
+
+    const int num_rows = 4 * MEGABYTE / ROW_SIZE;
+
+    // The client closes the cursor after the prefetch is done.
+    insert_stream(&cache, 1, num_rows);
+    int next_row = 0;
+    ASSERT_EQ(Response::SUCCESS_PARTIAL, serve_batch(&cache, 1, &next_row));
+    let_stuff_happen();
+    cache.erase(1);
+    EXPECT_EQ(1, get_counter(&rdb_ctx->ql_prefetch_wasted));
+
+    // The client closes the cursor while the prefetch hasn't even started.
+    insert_stream(&cache, 2, num_rows);
+    next_row = 0;
+    ASSERT_EQ(Response::SUCCESS_PARTIAL, serve_batch(&cache, 2, &next_row));
+    cache.erase(2);
+    EXPECT_EQ(2, get_counter(&rdb_ctx->ql_prefetch_wasted));
+
+    EXPECT_EQ(0, get_counter(&rdb_ctx->ql_prefetch_hits));
+}
+
+TPTEST(StreamCache, PrefetchMemoryBudget) {
+    test_rdb_env_t test_env;
+    scoped_ptr_t<test_rdb_env_t::instance_t> env_instance = test_env.make_env();
+    rdb_context_t *rdb_ctx = env_instance->get()->get_rdb_ctx();
+    ql::stream_cache_t cache(rdb_ctx, ql::reject_cfeeds_t::NO);
+
+    // Together, the cursors want to read ahead twice as much as the budget allows.
+    const int num_streams = 2 * CURSOR_PREFETCH_MAX_MEMORY / CURSOR_PREFETCH_MAX_BATCH_SIZE;
+    const int num_rows = 4 * CURSOR_PREFETCH_MAX_BATCH_SIZE / ROW_SIZE;
+    for (int key = 0; key < num_streams; ++key) {
+        insert_stream(&cache, key, num_rows);
+        int next_row = 0;
+        ASSERT_EQ(Response::SUCCESS_PARTIAL, serve_batch(&cache, key, &next_row));
+        // The prefetches that haven't finished yet count towards the budget.
+        EXPECT_LE(cache.prefetched_bytes,
+                  static_cast<size_t>(CURSOR_PREFETCH_MAX_MEMORY + key * 2 * ROW_SIZE));
+    }
+    let_stuff_happen();
+
+    // A batch can overshoot its reservation by the few rows that the batcher takes
+    // before it looks at the size.
+    int num_prefetching = 0;
+    for (auto it = cache.streams.begin(); it != cache.streams.end(); ++it) {
+        if (it->second->prefetch.has()) {
+            ++num_prefetching;
+        }
+    }
+    EXPECT_LT(0, num_prefetching);
+    EXPECT_GT(num_streams, num_prefetching);
+    EXPECT_LE(cache.prefetched_bytes,
+              static_cast<size_t>(CURSOR_PREFETCH_MAX_MEMORY
+                                  + num_prefetching * 2 * ROW_SIZE));
+
+    // Dropping the cursors gives all of the memory back.
+    for (int key = 0; key < num_streams; ++key) {
+        cache.erase(key);
+    }
+    EXPECT_EQ(0u, cache.prefetched_bytes);
+    EXPECT_EQ(num_prefetching, get_counter(&rdb_ctx->ql_prefetch_wasted));
+}
+
+}  // namespace unittest
@@ -129,7 +129,7 @@ reactor_test_cluster_t::reactor_test_cluster_t(int port) :
     heartbeat_manager_client_run(&heartbeat_manager_client, &heartbeat_manager),
 
     mailbox_manager_client(&message_multiplexer, 'M'),
-    mailbox_manager(&mailbox_manager_client),
+    mailbox_manager(&mailbox_manager_client, &mailbox_manager_perfmon_collection),
     mailbox_manager_client_run(&mailbox_manager_client, &mailbox_manager),
 
     our_directory_variable(test_cluster_directory_t()),
@@ -105,6 +105,7 @@ public:
     message_multiplexer_t::client_t::run_t heartbeat_manager_client_run;
 
     message_multiplexer_t::client_t mailbox_manager_client;
+    perfmon_collection_t mailbox_manager_perfmon_collection;
     mailbox_manager_t mailbox_manager;
     message_multiplexer_t::client_t::run_t mailbox_manager_client_run;
 
@@ -26,7 +26,7 @@ struct make_sindex_read_t {
                                       counted_t<const ql::datum_t>()),
                 std::vector<ql::transform_variant_t>(),
                 boost::optional<ql::terminal_variant_t>(),
-                sindex_rangespec_t(id, region_t(rng.to_sindex_keyrange()), rng),
+                sindex_rangespec_t(id, region_t(key_range_t::universe()), rng),
                 sorting_t::UNORDERED),
             profile_bool_t::PROFILE);
     }
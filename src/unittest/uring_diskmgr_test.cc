@@ -0,0 +1,82 @@
+// Copyright 2010-2014 RethinkDB, all rights reserved.
+#include <fcntl.h>
+#include <string.h>
+
+#include <functional>
+#include <vector>
+
+#include "arch/io/disk/uring.hpp"
+#include "arch/io/io_utils.hpp"
+#include "arch/runtime/thread_pool.hpp"
+#include "concurrency/cond_var.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
+#include "containers/scoped.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+#if USE_IO_URING
+
+// The kernel only gets to take one SQE per `io_uring_enter`, so that every
+// submission of more than one SQE comes up short.  All of the writes and reads
+// must still finish.
+TPTEST(UringDiskmgr, ShortSubmit) {
+    if (!uring_diskmgr_t::is_supported()) {
+        return;
+    }
+
+    static const int NUM_ACTIONS = 64;
+    static const size_t BLOCK_SIZE = 512;
+
+    temp_file_t file;
+    scoped_fd_t fd(::open(file.name().permanent_path().c_str(), O_RDWR | O_CREAT, 0644));
+    ASSERT_NE(-1, fd.get());
+
+    unlimited_fifo_queue_t<pool_diskmgr_action_t *> source;
+    uring_diskmgr_t diskmgr(&linux_thread_pool_t::get_thread()->queue, &source,
+                            NUM_ACTIONS);
+    diskmgr.set_max_submit_per_call(1);
+
+    int num_done = 0;
+    cond_t all_done;
+    diskmgr.done_fun = [&](pool_diskmgr_action_t *a) {
+        EXPECT_TRUE(a->get_succeeded());
+        if (++num_done == NUM_ACTIONS) {
+            all_done.pulse();
+        }
+    };
+
+    std::vector<std::vector<char> > blocks(NUM_ACTIONS);
+    std::vector<scoped_ptr_t<pool_diskmgr_action_t> > writes(NUM_ACTIONS);
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        blocks[i].assign(BLOCK_SIZE, static_cast<char>('a' + i % 26));
+        writes[i].init(new pool_diskmgr_action_t);
+        // Every other write is wrapped in datasyncs, which makes it three SQEs.
+        writes[i]->make_write(fd.get(), blocks[i].data(), BLOCK_SIZE,
+                              i * BLOCK_SIZE, i % 2 == 0);
+        source.push(writes[i].get());
+    }
+    all_done.wait();
+
+    num_done = 0;
+    all_done.reset();
+    std::vector<std::vector<char> > read_blocks(NUM_ACTIONS,
+                                                std::vector<char>(BLOCK_SIZE));
+    std::vector<scoped_ptr_t<pool_diskmgr_action_t> > reads(NUM_ACTIONS);
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        reads[i].init(new pool_diskmgr_action_t);
+        reads[i]->make_read(fd.get(), read_blocks[i].data(), BLOCK_SIZE,
+                            i * BLOCK_SIZE);
+        source.push(reads[i].get());
+    }
+    all_done.wait();
+
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        EXPECT_EQ(0, memcmp(blocks[i].data(), read_blocks[i].data(), BLOCK_SIZE));
+    }
+}
+
+#endif  // USE_IO_URING
+
+}  // namespace unittest
@@ -252,13 +252,44 @@ function test5() {
                 // We give the feed 1 second to get closed
                 assert.equal(feed._endFlag, true);
                 conn.close();
-                done();
+                test6();
             }, 1000);
         });
     });
 
 }
 
+function test6() {
+    // Test `filter` and `pluck` on a feed (the servers apply them before sending)
+    console.log("Running test6");
+    r.connect({port:port}, function(err, conn) {
+        if (err) throw err;
+
+        r.table(tableName).changes().filter(r.row('new_val')('value').eq('keep'))
+                .pluck({new_val: 'value'}).run(conn, function(err, feed) {
+            if (err) throw err;
+
+            feed.next(function(err, data) {
+                if (err) throw err;
+                assert.deepEqual(data, {new_val: {value: 'keep'}});
+                feed.close();
+                conn.close();
+                done();
+            });
+        });
+
+        setTimeout(function() { // Wait one seconds before doing the writes to be sure that the feed is opened
+            r.connect({port: port}, function(err, conn) {
+                r.table(tableName).insert({value: 'drop'}).run(conn).then(function() {
+                    return r.table(tableName).insert({value: 'keep'}).run(conn);
+                }).error(function(err) {
+                    throw err;
+                });
+            });
+        }, 1000);
+    });
+}
+
 function done() {
     console.log("Tests done.");
     process.exit(0);